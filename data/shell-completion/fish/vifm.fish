@@ -23,6 +23,7 @@ complete -c vifm -r -f        -l "server-list"
 complete -c vifm -r -f        -l "server-name"    -a "(vifm --server-list 2>/dev/null)" -d "Name of target or this instance"
 complete -c vifm    -f        -l "remote"                                               -d "Pass all arguments that left in command line to vifm server"
 complete -c vifm -r -f        -l "remote-expr"                                          -d "Pass expression to vifm server and print result"
+complete -c vifm -r -F        -l "remote-batch"                                         -d "Pass batch of requests to vifm server and print results"
 complete -c vifm -r -f -s "c"                                                           -d "Run specified Vifm's command on startup"
 complete -c vifm -r -f                            -a "+"                                -d "Run specified Vifm's command on startup"
 complete -c vifm -r -f -s "h" -l "help"                                                 -d "Show help message and quit"
@@ -19,8 +19,9 @@
 
 #include "args.h"
 
-#include <stdio.h> /* stderr fprintf() puts() snprintf() */
-#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS exit() */
+#include <stdio.h> /* FILE stderr stdin fclose() fopen() fprintf() puts()
+                      snprintf() */
+#include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS exit() free() */
 #include <string.h> /* strcmp() */
 
 #include "compat/fs_limits.h"
@@ -49,6 +50,7 @@ static void process_general_args(args_t *args);
 static void show_help_msg(const char wrong_arg[]);
 static void show_version_msg(void);
 static void process_ipc_args(args_t *args, ipc_t *ipc);
+static char * read_batch(const char path[]);
 static void process_other_args(args_t *args);
 static void quit_on_arg_parsing(int code);
 
@@ -68,6 +70,7 @@ static struct option long_opts[] = {
 	{ "server-name",  required_argument, .flag = NULL, .val = 'N' },
 	{ "remote",       no_argument,       .flag = NULL, .val = 'r' },
 	{ "remote-expr",  required_argument, .flag = NULL, .val = 'R' },
+	{ "remote-batch", required_argument, .flag = NULL, .val = 'B' },
 #endif
 
 	{ "help",         no_argument,       .flag = NULL, .val = 'h' },
@@ -121,6 +124,9 @@ args_parse(args_t *args, int argc, char *argv[], const char dir[])
 			case 'R': /* --remote-expr <expr> */
 				args->remote_expr = optarg;
 				break;
+			case 'B': /* --remote-batch <path>|- */
+				args->remote_batch = optarg;
+				break;
 
 			case 'h': /* -h, --help */
 				/* Only first one of -v and -h should take effect. */
@@ -196,7 +202,8 @@ args_parse(args_t *args, int argc, char *argv[], const char dir[])
 		}
 	}
 
-	if(args->remote_cmds != NULL || args->remote_expr != NULL)
+	if(args->remote_cmds != NULL || args->remote_expr != NULL ||
+			args->remote_batch != NULL)
 	{
 		args->target_name = args->server_name;
 		args->server_name = NULL;
@@ -356,7 +363,7 @@ args_process(args_t *args, ArgsSubset subset, ipc_t *ipc)
 		case AS_GENERAL: /* --help, --version */
 			process_general_args(args);
 			break;
-		case AS_IPC:     /* --remote, --remote-expr */
+		case AS_IPC:     /* --remote, --remote-expr, --remote-batch */
 			process_ipc_args(args, ipc);
 			break;
 		case AS_OTHER:   /* All other options. */
@@ -438,6 +445,9 @@ show_help_msg(const char wrong_arg[])
 	puts("    passes all arguments that left in command line to vifm server.\n");
 	puts("  vifm --remote-expr <expr>");
 	puts("    passes expression to vifm server and prints result.\n");
+	puts("  vifm --remote-batch <path>|-");
+	puts("    passes JSON batch of commands and expressions to vifm server and");
+	puts("    prints JSON array of results.  \"-\" means standard input.\n");
 #endif
 	puts("  vifm -c <command> | +<command>");
 	puts("    run command-line mode <command> on startup.\n");
@@ -472,9 +482,11 @@ show_version_msg(void)
 static void
 process_ipc_args(args_t *args, ipc_t *ipc)
 {
-	if(args->remote_cmds != NULL && args->remote_expr != NULL)
+	if((args->remote_cmds != NULL) + (args->remote_expr != NULL) +
+			(args->remote_batch != NULL) > 1)
 	{
-		fprintf(stderr, "%s\n", "--remote and --remote-expr can't be combined.");
+		fprintf(stderr, "%s\n",
+				"--remote, --remote-expr and --remote-batch can't be combined.");
 		quit_on_arg_parsing(EXIT_FAILURE);
 	}
 	else if(args->remote_cmds != NULL)
@@ -503,6 +515,49 @@ process_ipc_args(args_t *args, ipc_t *ipc)
 			quit_on_arg_parsing(EXIT_SUCCESS);
 		}
 	}
+	else if(args->remote_batch != NULL)
+	{
+		char *const batch = read_batch(args->remote_batch);
+		if(batch == NULL)
+		{
+			fprintf(stderr, "Failed to read batch from %s\n", args->remote_batch);
+			quit_on_arg_parsing(EXIT_FAILURE);
+			return;
+		}
+
+		char *const result = ipc_batch(ipc, args->target_name, batch);
+		free(batch);
+		if(result == NULL)
+		{
+			fprintf(stderr, "%s\n", "Executing batch remotely failed.");
+			quit_on_arg_parsing(EXIT_FAILURE);
+		}
+		else
+		{
+			fprintf(stdout, "%s\n", result);
+			quit_on_arg_parsing(EXIT_SUCCESS);
+		}
+	}
+}
+
+/* Reads batch for --remote-batch from a file or standard input if path is "-".
+ * Returns newly allocated string or NULL on error. */
+static char *
+read_batch(const char path[])
+{
+	FILE *const fp = (strcmp(path, "-") == 0 ? stdin : fopen(path, "rb"));
+	if(fp == NULL)
+	{
+		return NULL;
+	}
+
+	size_t len;
+	char *const batch = read_nonseekable_stream(fp, &len, NULL, NULL);
+	if(fp != stdin)
+	{
+		fclose(fp);
+	}
+	return batch;
 }
 
 /* Processes all non-general command-line arguments except for IPC ones. */
@@ -29,7 +29,8 @@
 typedef enum
 {
 	AS_GENERAL, /* --help and --version which depend on nothing. */
-	AS_IPC,     /* --remote and --remote-expr which require IPC. */
+	AS_IPC,     /* --remote, --remote-expr and --remote-batch which require
+	               IPC. */
 	AS_OTHER,   /* All other options. */
 }
 ArgsSubset;
@@ -55,6 +56,7 @@ typedef struct
 	const char *target_name; /* Name of target server. */
 	char **remote_cmds;      /* Arguments to pass to server instance. */
 	char *remote_expr;       /* Expression to evaluate remotely. */
+	char *remote_batch;      /* Path to a batch to execute remotely or "-". */
 
 	char lwin_path[PATH_MAX + 1]; /* Chosen path of the left pane. */
 	char rwin_path[PATH_MAX + 1]; /* Chosen path of the right pane. */
@@ -74,6 +74,10 @@
  *
  * Operations are displayed on designated job bar.
  *
+ * Tasks and operations are executed by a pool of worker threads limited by
+ * 'bgthreads' option.  Tasks are picked up before operations and operations
+ * don't occupy the last worker, so tasks aren't stuck behind long operations.
+ *
  * On non-Windows systems background thread reads data from error streams of
  * external applications, which are then displayed by main thread.  This thread
  * maintains its own list of jobs (via err_next field), which is added to by
@@ -103,16 +107,26 @@
 #define NO_JOB_ID INVALID_HANDLE_VALUE
 #endif
 
-/* Structure with passed to background_task_bootstrap() so it can perform
- * correct initialization/cleanup. */
-typedef struct
+/* Structure with passed to run_task() so it can perform correct
+ * initialization/cleanup. */
+typedef struct background_task_args
 {
 	bg_task_func func; /* Function to execute in a background thread. */
 	void *args;        /* Argument to pass. */
 	bg_job_t *job;     /* Job identifier that corresponds to the task. */
+
+	struct background_task_args *next; /* Next task in a queue. */
 }
 background_task_args;
 
+/* Queue of tasks waiting for a worker thread. */
+typedef struct
+{
+	background_task_args *head; /* Task to be executed next. */
+	background_task_args *tail; /* Task to be executed last. */
+}
+task_queue_t;
+
 static void set_jobcount_var(int count);
 static void job_check(bg_job_t *job);
 static void job_free(bg_job_t *job);
@@ -136,7 +150,10 @@ static void place_on_job_bar(bg_job_t *job);
 static void get_off_job_bar(bg_job_t *job);
 static bg_job_t * add_background_job(pid_t pid, const char cmd[],
 		uintptr_t err, uintptr_t data, BgJobType type, int with_bg_op);
-static void * background_task_bootstrap(void *arg);
+static int queue_task(background_task_args *task_args);
+static void * worker_thread(void *arg);
+static background_task_args * pick_task(void);
+static void run_task(background_task_args *task_args);
 static int update_job_status(bg_job_t *job);
 static void mark_job_finished(bg_job_t *job, int exit_code);
 static void maybe_wake_error_thread(void);
@@ -156,6 +173,24 @@ static pthread_mutex_t new_err_jobs_lock = PTHREAD_MUTEX_INITIALIZER;
 /* Conditional variable to signal availability of new jobs in new_err_jobs. */
 static pthread_cond_t new_err_jobs_cond = PTHREAD_COND_INITIALIZER;
 
+/* Queues of tasks waiting for a worker thread, auxiliary tasks come first and
+ * operations second. */
+static task_queue_t task_queues[2];
+/* Protects queues of tasks and state of the pool of worker threads. */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Signaled when there might be a task that can be picked up by a worker. */
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+/* Maximum number of worker threads or zero if there is no limit. */
+static int pool_limit;
+/* Number of worker threads. */
+static int pool_size;
+/* Number of worker threads waiting for tasks. */
+static int pool_idle;
+/* Number of tasks in the queues. */
+static int pool_queued;
+/* Number of operations being executed by worker threads. */
+static int pool_ops;
+
 /* Thread-local storage for bg_job_t associated with active thread. */
 static pthread_key_t current_job;
 
@@ -1377,7 +1412,6 @@ int
 bg_execute(const char descr[], const char op_descr[], int total, int important,
 		bg_task_func task_func, void *args)
 {
-	pthread_t id;
 	int ret;
 
 	background_task_args *const task_args = malloc(sizeof(*task_args));
@@ -1388,6 +1422,7 @@ bg_execute(const char descr[], const char op_descr[], int total, int important,
 
 	task_args->func = task_func;
 	task_args->args = args;
+	task_args->next = NULL;
 	task_args->job = add_background_job(WRONG_PID, descr, (uintptr_t)NO_JOB_ID,
 			(uintptr_t)NO_JOB_ID, important ? BJT_OPERATION : BJT_TASK, 1);
 
@@ -1406,7 +1441,7 @@ bg_execute(const char descr[], const char op_descr[], int total, int important,
 	}
 
 	ret = 0;
-	if(pthread_create(&id, NULL, &background_task_bootstrap, task_args) != 0)
+	if(queue_task(task_args) != 0)
 	{
 		/* Mark job as finished with error. */
 		if(pthread_spin_lock(&task_args->job->status_lock) == 0)
@@ -1546,20 +1581,134 @@ free_new:
 	return NULL;
 }
 
-/* pthreads entry point for a new background task.  Performs correct
- * startup/exit with related updates of internal data structures.  Returns
- * result for this thread. */
-static void *
-background_task_bootstrap(void *arg)
+/* Schedules task for execution by a worker thread, starting a new one if
+ * necessary.  Returns zero on success, otherwise non-zero is returned. */
+static int
+queue_task(background_task_args *task_args)
 {
-	background_task_args *const task_args = arg;
+	if(pthread_mutex_lock(&pool_lock) != 0)
+	{
+		return 1;
+	}
+
+	/* Changes of the limit are picked up here to not access configuration from
+	 * worker threads. */
+	pool_limit = cfg.bg_threads;
 
+	/* Idle workers that haven't woken up yet might be claimed by tasks that are
+	 * already queued. */
+	if(pool_idle <= pool_queued && (pool_limit == 0 || pool_size < pool_limit))
+	{
+		pthread_t id;
+		if(pthread_create(&id, NULL, &worker_thread, NULL) == 0)
+		{
+			++pool_size;
+		}
+		else if(pool_size == 0)
+		{
+			(void)pthread_mutex_unlock(&pool_lock);
+			return 1;
+		}
+	}
+
+	task_queue_t *const queue =
+		&task_queues[task_args->job->type == BJT_OPERATION];
+	if(queue->tail == NULL)
+	{
+		queue->head = task_args;
+	}
+	else
+	{
+		queue->tail->next = task_args;
+	}
+	queue->tail = task_args;
+	++pool_queued;
+
+	(void)pthread_cond_broadcast(&pool_cond);
+	(void)pthread_mutex_unlock(&pool_lock);
+	return 0;
+}
+
+/* pthreads entry point of a worker thread, which executes queued tasks until
+ * there are more workers than allowed.  Returns NULL. */
+static void *
+worker_thread(void *arg)
+{
 	(void)pthread_detach(pthread_self());
 	block_all_thread_signals();
 
+	(void)pthread_mutex_lock(&pool_lock);
+	while(pool_limit == 0 || pool_size <= pool_limit)
+	{
+		background_task_args *const task_args = pick_task();
+		if(task_args == NULL)
+		{
+			++pool_idle;
+			(void)pthread_cond_wait(&pool_cond, &pool_lock);
+			--pool_idle;
+			continue;
+		}
+
+		const int is_op = (task_args->job->type == BJT_OPERATION);
+		pool_ops += is_op;
+		(void)pthread_mutex_unlock(&pool_lock);
+
+		run_task(task_args);
+
+		(void)pthread_mutex_lock(&pool_lock);
+		if(is_op)
+		{
+			--pool_ops;
+			/* Another worker might be waiting for a chance to run an operation. */
+			(void)pthread_cond_broadcast(&pool_cond);
+		}
+	}
+	--pool_size;
+	(void)pthread_mutex_unlock(&pool_lock);
+
+	return NULL;
+}
+
+/* Takes the next task to execute off the queues.  Auxiliary tasks are preferred
+ * and operations don't take the last worker unless it's the only one.  Must be
+ * called with pool_lock held.  Returns the task or NULL if there is nothing to
+ * execute. */
+static background_task_args *
+pick_task(void)
+{
+	task_queue_t *queue = &task_queues[0];
+	if(queue->head == NULL)
+	{
+		const int ops_limit = (pool_limit == 1 ? 1 : pool_limit - 1);
+		if(pool_limit != 0 && pool_ops >= ops_limit)
+		{
+			return NULL;
+		}
+		queue = &task_queues[1];
+	}
+
+	background_task_args *const task_args = queue->head;
+	if(task_args != NULL)
+	{
+		queue->head = task_args->next;
+		if(queue->head == NULL)
+		{
+			queue->tail = NULL;
+		}
+		--pool_queued;
+	}
+	return task_args;
+}
+
+/* Executes a task in a worker thread.  Performs correct startup/exit with
+ * related updates of internal data structures. */
+static void
+run_task(background_task_args *task_args)
+{
 	if(pthread_setspecific(current_job, task_args->job) == 0)
 	{
 		task_args->func(&task_args->job->bg_op, task_args->args);
+		(void)pthread_setspecific(current_job, NULL);
 		mark_job_finished(task_args->job, /*exit_code=*/0);
 	}
 	else
@@ -1568,8 +1717,6 @@ background_task_bootstrap(void *arg)
 	}
 
 	free(task_args);
-
-	return NULL;
 }
 
 int
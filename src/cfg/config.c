@@ -151,6 +151,7 @@ cfg_init(void)
 	cfg.selection_is_primary = 1;
 	cfg.tab_switches_pane = 1;
 	cfg.use_system_calls = 0;
+	cfg.bg_threads = 4;
 	cfg.tab_stop = 8;
 	cfg.ruler_format = strdup("%l/%S ");
 	cfg.status_line = strdup("");
@@ -181,6 +182,7 @@ cfg_init(void)
 	cfg.short_term_mux_titles = 0;
 
 	cfg.slow_fs_list = strdup("");
+	cfg.no_cache_fs_list = strdup("");
 
 	cfg.cd_path = strdup(env_get_def("CDPATH", DEFAULT_CD_PATH));
 	replace_char(cfg.cd_path, ':', ',');
@@ -233,6 +235,9 @@ cfg_init(void)
 
 	cfg.fast_file_cloning = 0;
 	cfg.data_sync = 1;
+	cfg.no_cache = 0;
+	cfg.direct_io = 0;
+	cfg.io_rate = 0;
 
 	cfg.cvoptions = 0;
 
@@ -144,7 +144,8 @@ enum
 	VINFO_MCHISTORY = 1 << 16, /* Command-line history of menus. */
 	VINFO_SAVEDIRS  = 1 << 17, /* Restore last used directories on startup. */
 	VINFO_TABS      = 1 << 18, /* Restore global or pane tabs. */
-	NUM_VINFO       = 19,      /* Number of VINFO_* constants. */
+	VINFO_JOURNAL   = 1 << 19, /* Append changes to a journal on storing. */
+	NUM_VINFO       = 20,      /* Number of VINFO_* constants. */
 
 	EMPTY_VINFO = 0,                   /* Empty set of flags. */
 	FULL_VINFO  = (1 << NUM_VINFO) - 1 /* Full set of flags. */
@@ -254,6 +255,7 @@ typedef struct config_t
 	int selection_is_primary; /* For yy, dd and DD: act on selection not file. */
 	int tab_switches_pane; /* Whether <tab> is switch pane or history forward. */
 	int use_system_calls; /* Prefer performing operations with system calls. */
+	int bg_threads; /* Maximum number of threads for background tasks. */
 	int tab_stop;
 	char *ruler_format;
 	char *status_line; /* Format string for status line. */
@@ -291,6 +293,10 @@ typedef struct config_t
 	/* Comma-separated list of file system types which are slow to respond. */
 	char *slow_fs_list;
 
+	/* Comma-separated list of file system types for which copied data is kept
+	 * out of file-system cache. */
+	char *no_cache_fs_list;
+
 	/* Comma-separated list of places to look for relative path to directories. */
 	char *cd_path;
 
@@ -357,6 +363,12 @@ typedef struct config_t
 	int fast_file_cloning;
 	/* Force writing data onto media during file copying. */
 	int data_sync;
+	/* Evict data from file-system cache during file copying. */
+	int no_cache;
+	/* Try to bypass file-system cache during file copying. */
+	int direct_io;
+	/* Maximum speed of copying files in KiB per second or zero for no limit. */
+	int io_rate;
 
 	/* Whether various things should be reset on entering/leaving custom views. */
 	int cvoptions;
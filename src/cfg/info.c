@@ -25,8 +25,10 @@
 #include <stddef.h> /* NULL size_t */
 #include <stdio.h> /* FILE fpos_t fclose() fgetpos() fgets() fprintf() fputc()
                       fscanf() fsetpos() snprintf() */
+#include <stdint.h> /* uint64_t */
 #include <stdlib.h> /* abs() free() */
-#include <string.h> /* memcpy() memset() strtol() strcmp() strchr() strlen() */
+#include <string.h> /* memcpy() memset() strcmp() strchr() strcpy() strcspn()
+                        strlen() strspn() strtol() */
 #include <time.h> /* time_t time() */
 
 #include "../compat/fs_limits.h"
@@ -70,6 +72,9 @@
 #include "config.h"
 #include "info_chars.h"
 
+/* Minimal size of journal after which it gets folded into state file. */
+#define MIN_JOURNAL_LIMIT (64U*1024U)
+
 /**
  * Schema-like description of vifminfo.json data:
  *  gtabs = [ {
@@ -183,8 +188,34 @@
  *  - for elements of arrays timestamps act more like generation numbers and
  *    while merging happens per element, effectively it's generations (defined
  *    by time of storing of the array) which are being merged
+ *
+ * When "journal" is in 'vifminfo' (or 'sessionoptions'), storing state
+ * usually just appends a line with a JSON object to a file with ".journal"
+ * suffix next to the state file.  The object has the same structure as the
+ * state file except for the following:
+ *  - histories contain only elements added since last load or store
+ *  - marks and bmarks contain only elements changed since last load or store
+ *  - journal-removed key holds a table of arrays with names of marks and
+ *    bookmarks removed since last load or store
+ *  - journal-since key holds time of that last load or store, which allows
+ *    telling marks and bookmarks removed by the writer from those changed by
+ *    other instances later
+ *  - other sections are present only if they have changed since last load or
+ *    store
+ * Reading state file replays its journal in order on top of it.  Sections
+ * other than histories, marks and bookmarks are merged with the state in the
+ * same way as on storing the whole state.  Journal is folded into the state
+ * file once it grows comparable to it in size.
  */
 
+static void note_bmark(const char path[], const char tags[], time_t timestamp,
+		void *arg);
+static void load_info_file(int reread, int lazily);
+static JSON_Value * read_state_lazily(const char path[]);
+static int split_state_text(const char text[], char **eager, char **deferred);
+static const char * skip_json_value(const char text[]);
+static const char * skip_json_string(const char text[]);
+static const char * skip_json_ws(const char text[]);
 static JSON_Value * read_legacy_info_file(const char info_file[]);
 static void load_state(JSON_Object *root, int reread);
 static void load_gtabs(JSON_Object *root, int reread);
@@ -198,12 +229,14 @@ static void load_options(JSON_Object *parent);
 static void load_assocs(JSON_Object *root, const char node[], int for_x);
 static void load_viewers(JSON_Object *root);
 static void load_cmds(JSON_Object *root);
-static void load_marks(JSON_Object *root);
-static void load_bmarks(JSON_Object *root);
+static void load_marks(JSON_Object *root, int keep_newer);
+static void load_bmarks(JSON_Object *root, int keep_newer);
 static void load_regs(JSON_Object *root);
 static void load_dir_stack(JSON_Object *root);
 static void load_trash(JSON_Object *root);
 static void load_history(JSON_Object *root, const char node[], hist_t *hist);
+static void load_history_below(JSON_Object *root, const char node[],
+		hist_t *hist);
 static void load_sorting(JSON_Object *ptab, view_t *view);
 static void ensure_history_not_full(hist_t *hist);
 static void put_dhistory_entry(view_t *view, int reread, const char dir[],
@@ -211,7 +244,32 @@ static void put_dhistory_entry(view_t *view, int reread, const char dir[],
 static void set_manual_filter(view_t *view, const char value[]);
 TSTATIC void write_info_file(void);
 static int copy_file(const char src[], const char dst[]);
-static void update_info_file(const char filename[], int vinfo, int merge);
+static void update_info_file(const char filename[], const char journal[],
+		int vinfo, int merge);
+static JSON_Value * read_state_file(const char path[], const char journal[]);
+static void replay_journal(JSON_Object *root, const char journal[]);
+TSTATIC void apply_journal_entry(JSON_Object *root, const JSON_Object *entry);
+static void apply_history_delta(JSON_Object *root, const char node[],
+		const JSON_Array *delta);
+static void apply_timestamped_delta(JSON_Object *root, const char node[],
+		const JSON_Object *delta);
+static void apply_removals(JSON_Object *root, const JSON_Object *removed,
+		double since);
+static void apply_sections(JSON_Object *root, const JSON_Object *entry);
+static void merge_missing_elements(JSON_Object *current,
+		const JSON_Object *admixture, const char node[]);
+static int is_history_node(const char name[]);
+static int is_timestamped_node(const char name[]);
+static int is_deferred_node(const char name[]);
+static int append_journal(const char journal[], int vinfo,
+		JSON_Value **synced);
+static void add_changed_entries(JSON_Object *delta, const char node[],
+		const JSON_Object *entries, const JSON_Object *synced);
+static void drop_old_history(JSON_Object *root, const char node[],
+		double since);
+static void remember_state(JSON_Value **synced, int vinfo);
+static void forget_histories(JSON_Object *root);
+static void get_journal_path(const char path[], char buf[], size_t buf_size);
 TSTATIC char * drop_locale(void);
 TSTATIC void restore_locale(char locale[]);
 TSTATIC JSON_Value * serialize_state(int vinfo);
@@ -289,9 +347,27 @@ static void clone_array(JSON_Object *parent, const JSON_Array *array,
 		const char node[]);
 static void set_session(const char new_session[]);
 static void write_session_file(void);
-static void store_file(const char path[], filemon_t *mon, int vinfo);
+static void store_file(const char path[], filemon_t *mon, int vinfo,
+		JSON_Value **synced);
 static void get_session_dir(char buf[], size_t buf_size);
 
+/* Names of history arrays of state files. */
+static const char *history_nodes[] = {
+	"cmd-hist", "exprreg-hist", "search-hist", "prompt-hist", "lfilt-hist",
+	"menu-cmd-hist",
+};
+
+/* Time of the last load or store of state, used to form journal entries. */
+static time_t state_sync_time;
+
+/* State of this instance (without histories) as of the last load or store of
+ * vifminfo and of session file, used to form journal entries.  Can be NULL. */
+static JSON_Value *synced_info_state;
+static JSON_Value *synced_session_state;
+
+/* JSON text of sections of vifminfo whose loading was deferred or NULL. */
+static char *deferred_state;
+
 /* Monitor to check for changes of vifminfo file. */
 static filemon_t vifminfo_mon;
 /* Monitor to check for changes of file that backs current session. */
@@ -302,22 +378,116 @@ static sessions_changed session_changed_cb;
 void
 state_store(void)
 {
+	/* Storing state without parts of it would drop them. */
+	state_load_deferred();
+
 	write_info_file();
 
 	if(sessions_active())
 	{
 		write_session_file();
 	}
+
+	state_sync_time = time(NULL);
 }
 
 void
 state_load(int reread)
+{
+	load_info_file(reread, /*lazily=*/0);
+}
+
+void
+state_load_lazily(void)
+{
+	load_info_file(/*reread=*/0, /*lazily=*/1);
+}
+
+void
+state_load_deferred(void)
+{
+	if(deferred_state == NULL)
+	{
+		return;
+	}
+
+	char *text = deferred_state;
+	deferred_state = NULL;
+
+	char *locale = drop_locale();
+	JSON_Value *state = json_parse_string(text);
+	restore_locale(locale);
+	free(text);
+
+	if(state == NULL)
+	{
+		LOG_ERROR_MSG("Failed to parse deferred part of vifminfo");
+		return;
+	}
+
+	/* Configuration could have been sourced in the meantime, don't override
+	 * newer state it might have set.  Checking bookmarks is relatively
+	 * expensive, so do it only if there are any. */
+	JSON_Object *root = json_object(state);
+	load_marks(root, /*keep_newer=*/1);
+	int have_bmarks = 0;
+	bmarks_list(&note_bmark, &have_bmarks);
+	load_bmarks(root, /*keep_newer=*/have_bmarks);
+	load_history_below(root, "cmd-hist", &curr_stats.cmd_hist);
+	load_history_below(root, "exprreg-hist", &curr_stats.exprreg_hist);
+	load_history_below(root, "search-hist", &curr_stats.search_hist);
+	load_history_below(root, "prompt-hist", &curr_stats.prompt_hist);
+	load_history_below(root, "lfilt-hist", &curr_stats.filter_hist);
+	load_history_below(root, "menu-cmd-hist", &curr_stats.menucmd_hist);
+
+	json_value_free(state);
+
+	/* Otherwise loaded elements would look like added by this instance. */
+	locale = drop_locale();
+	if(synced_info_state != NULL && (cfg.vifm_info & VINFO_MARKS))
+	{
+		store_marks(json_object(synced_info_state));
+	}
+	if(synced_info_state != NULL && (cfg.vifm_info & VINFO_BOOKMARKS))
+	{
+		store_bmarks(json_object(synced_info_state));
+	}
+	restore_locale(locale);
+}
+
+/* bmarks_list() callback that records presence of bookmarks. */
+static void
+note_bmark(const char path[], const char tags[], time_t timestamp, void *arg)
+{
+	int *have_bmarks = arg;
+	*have_bmarks = 1;
+}
+
+/* Reads vifminfo file populating internal structures with information it
+ * contains.  When lazily is set, loading of some sections is deferred. */
+static void
+load_info_file(int reread, int lazily)
 {
 	char info_file[PATH_MAX + 16];
 	snprintf(info_file, sizeof(info_file), "%s/vifminfo.json", cfg.config_dir);
 
+	char journal[PATH_MAX + 32];
+	get_journal_path(info_file, journal, sizeof(journal));
+
+	/* Whatever was deferred is superseded by the new state. */
+	update_string(&deferred_state, NULL);
+
 	char *locale = drop_locale();
-	JSON_Value *state = json_parse_file(info_file);
+	JSON_Value *state = NULL;
+	/* Replaying journal needs whole state. */
+	if(lazily && !path_exists(journal, DEREF))
+	{
+		state = read_state_lazily(info_file);
+	}
+	if(state == NULL)
+	{
+		state = read_state_file(info_file, journal);
+	}
 	restore_locale(locale);
 
 	if(state == NULL)
@@ -336,10 +506,214 @@ state_load(int reread)
 	json_value_free(state);
 
 	(void)filemon_from_file(info_file, FMT_MODIFIED, &vifminfo_mon);
+	state_sync_time = time(NULL);
+	remember_state(&synced_info_state, cfg.vifm_info);
 
 	dir_stack_freeze();
 }
 
+/* Reads state file skipping sections that aren't needed right away, which are
+ * saved in deferred_state.  Should be called with C locale.  Returns JSON
+ * value or NULL on error. */
+static JSON_Value *
+read_state_lazily(const char path[])
+{
+	FILE *fp = os_fopen(path, "rb");
+	if(fp == NULL)
+	{
+		return NULL;
+	}
+
+	size_t len;
+	char *text = read_nonseekable_stream(fp, &len, NULL, NULL);
+	fclose(fp);
+	if(text == NULL)
+	{
+		return NULL;
+	}
+
+	char *eager, *deferred;
+	int error = split_state_text(text, &eager, &deferred);
+	free(text);
+	if(error)
+	{
+		return NULL;
+	}
+
+	JSON_Value *state = json_parse_string(eager);
+	free(eager);
+
+	if(state == NULL)
+	{
+		free(deferred);
+		return NULL;
+	}
+
+	deferred_state = deferred;
+	return state;
+}
+
+/* Splits JSON text of a state into texts of two objects: one with sections
+ * that are needed right away and one with sections whose loading can be
+ * deferred.  This skims over the text without building any values, which is
+ * much cheaper than parsing it.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+split_state_text(const char text[], char **eager, char **deferred)
+{
+	/* Each of the results can't be longer than the whole text. */
+	const size_t size = strlen(text) + 3U;
+	char *bufs[] = { malloc(size), malloc(size) };
+	size_t lens[] = { 1U, 1U };
+	if(bufs[0] == NULL || bufs[1] == NULL)
+	{
+		goto fail;
+	}
+	bufs[0][0] = '{';
+	bufs[1][0] = '{';
+
+	const char *p = skip_json_ws(text);
+	if(*p != '{')
+	{
+		goto fail;
+	}
+
+	p = skip_json_ws(p + 1);
+	while(*p != '}')
+	{
+		const char *key = p;
+		const char *key_end = skip_json_string(key);
+		if(key_end == NULL)
+		{
+			goto fail;
+		}
+
+		p = skip_json_ws(key_end);
+		if(*p != ':')
+		{
+			goto fail;
+		}
+
+		const char *value_end = skip_json_value(skip_json_ws(p + 1));
+		if(value_end == NULL)
+		{
+			goto fail;
+		}
+
+		char name[32];
+		const size_t name_len = key_end - key - 2;
+		const int is_deferred = name_len < sizeof(name)
+		                     && copy_str(name, name_len + 1U, key + 1) != 0
+		                     && is_deferred_node(name);
+
+		char *buf = bufs[is_deferred];
+		size_t *len = &lens[is_deferred];
+		if(*len != 1U)
+		{
+			buf[(*len)++] = ',';
+		}
+		memcpy(buf + *len, key, value_end - key);
+		*len += value_end - key;
+
+		p = skip_json_ws(value_end);
+		if(*p == ',')
+		{
+			p = skip_json_ws(p + 1);
+		}
+		else if(*p != '}')
+		{
+			goto fail;
+		}
+	}
+
+	strcpy(bufs[0] + lens[0], "}");
+	strcpy(bufs[1] + lens[1], "}");
+	*eager = bufs[0];
+	*deferred = bufs[1];
+	return 0;
+
+fail:
+	free(bufs[0]);
+	free(bufs[1]);
+	return 1;
+}
+
+/* Skips JSON value starting at the text.  Returns pointer past the value or
+ * NULL on error. */
+static const char *
+skip_json_value(const char text[])
+{
+	if(*text == '"')
+	{
+		return skip_json_string(text);
+	}
+
+	if(*text == '{' || *text == '[')
+	{
+		int depth = 0;
+		while(*text != '\0')
+		{
+			if(*text == '"')
+			{
+				text = skip_json_string(text);
+				if(text == NULL)
+				{
+					return NULL;
+				}
+				continue;
+			}
+
+			if(*text == '{' || *text == '[')
+			{
+				++depth;
+			}
+			else if((*text == '}' || *text == ']') && --depth == 0)
+			{
+				return text + 1;
+			}
+			++text;
+		}
+		return NULL;
+	}
+
+	const size_t len = strcspn(text, ",}] \t\r\n");
+	return (len == 0U ? NULL : text + len);
+}
+
+/* Skips JSON string starting at the text.  Returns pointer past closing double
+ * quote or NULL on error. */
+static const char *
+skip_json_string(const char text[])
+{
+	if(*text != '"')
+	{
+		return NULL;
+	}
+
+	++text;
+	while(*text != '"')
+	{
+		if(*text == '\\' && text[1] != '\0')
+		{
+			++text;
+		}
+		if(*text == '\0')
+		{
+			return NULL;
+		}
+		++text;
+	}
+	return text + 1;
+}
+
+/* Skips whitespace allowed in JSON.  Returns pointer to the first
+ * non-whitespace character. */
+static const char *
+skip_json_ws(const char text[])
+{
+	return text + strspn(text, " \t\r\n");
+}
+
 /* Reads legacy barely-structured vifminfo format as a JSON.  Returns JSON
  * value or NULL on error. */
 static JSON_Value *
@@ -675,8 +1049,8 @@ load_state(JSON_Object *root, int reread)
 	load_assocs(root, "xassocs", 1);
 	load_viewers(root);
 	load_cmds(root);
-	load_marks(root);
-	load_bmarks(root);
+	load_marks(root, /*keep_newer=*/0);
+	load_bmarks(root, /*keep_newer=*/0);
 	load_regs(root);
 	load_dir_stack(root);
 	load_trash(root);
@@ -1045,9 +1419,10 @@ load_cmds(JSON_Object *root)
 	}
 }
 
-/* Loads marks from JSON. */
+/* Loads marks from JSON.  When keep_newer is set, marks that are newer than
+ * loaded ones aren't replaced. */
 static void
-load_marks(JSON_Object *root)
+load_marks(JSON_Object *root, int keep_newer)
 {
 	JSON_Object *marks = json_object_get_object(root, "marks");
 
@@ -1060,16 +1435,18 @@ load_marks(JSON_Object *root)
 		const char *dir, *file;
 		double ts;
 		if(get_str(mark, "dir", &dir) && get_str(mark, "file", &file) &&
-				get_double(mark, "ts", &ts))
+				get_double(mark, "ts", &ts) &&
+				(!keep_newer || marks_is_older(curr_view, name[0], (time_t)ts)))
 		{
 			marks_setup_user(curr_view, name[0], dir, file, (time_t)ts);
 		}
 	}
 }
 
-/* Loads bookmarks from JSON. */
+/* Loads bookmarks from JSON.  When keep_newer is set, bookmarks that are newer
+ * than loaded ones aren't replaced. */
 static void
-load_bmarks(JSON_Object *root)
+load_bmarks(JSON_Object *root, int keep_newer)
 {
 	JSON_Object *bmarks = json_object_get_object(root, "bmarks");
 
@@ -1081,7 +1458,8 @@ load_bmarks(JSON_Object *root)
 
 		const char *tags;
 		double ts;
-		if(get_str(bmark, "tags", &tags) && get_double(bmark, "ts", &ts))
+		if(get_str(bmark, "tags", &tags) && get_double(bmark, "ts", &ts) &&
+				(!keep_newer || bmark_is_older(path, (time_t)ts)))
 		{
 			if(bmarks_setup(path, tags, (time_t)ts) != 0)
 			{
@@ -1179,6 +1557,47 @@ load_history(JSON_Object *root, const char node[], hist_t *hist)
 	}
 }
 
+/* Loads history from JSON putting its elements below those that are already
+ * in the history.  Elements that don't fit are dropped instead of extending the
+ * history. */
+static void
+load_history_below(JSON_Object *root, const char node[], hist_t *hist)
+{
+	JSON_Array *entries = json_object_get_array(root, node);
+	const int n = json_array_get_count(entries);
+	if(n == 0 || hist->capacity == 0)
+	{
+		return;
+	}
+
+	hist_t recent = *hist;
+	if(hist_init(hist, recent.capacity) != 0)
+	{
+		*hist = recent;
+		return;
+	}
+
+	int i;
+	for(i = MAX(0, n - hist->capacity); i < n; ++i)
+	{
+		JSON_Object *entry = json_array_get_object(entries, i);
+		const char *text;
+		if(get_str(entry, "text", &text))
+		{
+			/* Timestamp is optional here. */
+			double ts = -1;
+			get_double(entry, "ts", &ts);
+			hist_add(hist, text, (time_t)ts);
+		}
+	}
+
+	for(i = recent.size - 1; i >= 0; --i)
+	{
+		hist_add(hist, recent.items[i].text, recent.items[i].timestamp);
+	}
+	hist_reset(&recent);
+}
+
 /* Loads view sorting from JSON. */
 static void
 load_sorting(JSON_Object *ptab, view_t *view)
@@ -1280,7 +1699,7 @@ write_info_file(void)
 	char info_file[PATH_MAX + 16];
 	snprintf(info_file, sizeof(info_file), "%s/vifminfo.json", cfg.config_dir);
 
-	store_file(info_file, &vifminfo_mon, cfg.vifm_info);
+	store_file(info_file, &vifminfo_mon, cfg.vifm_info, &synced_info_state);
 }
 
 /* Copies the src file to the dst location.  Returns zero on success. */
@@ -1296,17 +1715,18 @@ copy_file(const char src[], const char dst[])
 	return (iop_cp(&args) == IO_RES_SUCCEEDED ? 0 : 1);
 }
 
-/* Reads contents of the filename file as a JSON info file and updates it with
- * the state of current instance. */
+/* Reads contents of the filename file as a JSON info file along with its
+ * journal (can be NULL) and updates it with the state of current instance. */
 static void
-update_info_file(const char filename[], int vinfo, int merge)
+update_info_file(const char filename[], const char journal[], int vinfo,
+		int merge)
 {
 	char *locale = drop_locale();
 	JSON_Value *current = serialize_state(vinfo);
 
 	if(merge)
 	{
-		JSON_Value *admixture = json_parse_file(filename);
+		JSON_Value *admixture = read_state_file(filename, journal);
 		if(admixture != NULL)
 		{
 			merge_states(vinfo, 0, json_object(current), json_object(admixture));
@@ -1323,6 +1743,500 @@ update_info_file(const char filename[], int vinfo, int merge)
 	restore_locale(locale);
 }
 
+/* Reads state file and replays its journal (can be NULL) on top of it.  Should
+ * be called with C locale.  Returns JSON value or NULL if there is no state. */
+static JSON_Value *
+read_state_file(const char path[], const char journal[])
+{
+	JSON_Value *state = json_parse_file(path);
+	if(journal == NULL || !path_exists(journal, DEREF))
+	{
+		return state;
+	}
+
+	if(json_object(state) == NULL)
+	{
+		json_value_free(state);
+		state = json_value_init_object();
+	}
+
+	replay_journal(json_object(state), journal);
+	return state;
+}
+
+/* Applies entries of the journal to the state in order of their appearance.
+ * Corrupted entries (e.g., partially written ones) are skipped. */
+static void
+replay_journal(JSON_Object *root, const char journal[])
+{
+	FILE *fp = os_fopen(journal, "rb");
+	if(fp == NULL)
+	{
+		return;
+	}
+
+	char *line = NULL;
+	while((line = read_line(fp, line)) != NULL)
+	{
+		JSON_Value *entry = json_parse_string(line);
+		if(json_object(entry) == NULL)
+		{
+			LOG_ERROR_MSG("Skipping malformed entry of journal: %s", journal);
+		}
+		else
+		{
+			apply_journal_entry(root, json_object(entry));
+		}
+		json_value_free(entry);
+	}
+
+	fclose(fp);
+}
+
+/* Updates state with a single journal entry. */
+TSTATIC void
+apply_journal_entry(JSON_Object *root, const JSON_Object *entry)
+{
+	double since = 0;
+	(void)get_double(entry, "journal-since", &since);
+
+	size_t i, n;
+	for(i = 0, n = json_object_get_count(entry); i < n; ++i)
+	{
+		const char *name = json_object_get_name(entry, i);
+		JSON_Value *value = json_object_get_value_at(entry, i);
+
+		if(is_history_node(name))
+		{
+			apply_history_delta(root, name, json_value_get_array(value));
+		}
+		else if(is_timestamped_node(name))
+		{
+			apply_timestamped_delta(root, name, json_value_get_object(value));
+		}
+	}
+
+	apply_removals(root, json_object_get_object(entry, "journal-removed"),
+			since);
+	apply_sections(root, entry);
+}
+
+/* Moves elements of history delta to the end of the history removing their
+ * older duplicates. */
+static void
+apply_history_delta(JSON_Object *root, const char node[],
+		const JSON_Array *delta)
+{
+	JSON_Array *entries = json_object_get_array(root, node);
+	if(entries == NULL)
+	{
+		clone_array(root, delta, node);
+		return;
+	}
+
+	trie_t *trie = trie_create(/*free_func=*/NULL);
+
+	const int ndelta = json_array_get_count(delta);
+	int i, n;
+	for(i = 0; i < ndelta; ++i)
+	{
+		const char *text;
+		if(get_str(json_array_get_object(delta, i), "text", &text))
+		{
+			(void)trie_put(trie, text);
+		}
+	}
+
+	JSON_Value *combined_value = json_value_init_array();
+	JSON_Array *combined = json_array(combined_value);
+
+	for(i = 0, n = json_array_get_count(entries); i < n; ++i)
+	{
+		void *data;
+		const char *text;
+		if(!get_str(json_array_get_object(entries, i), "text", &text) ||
+				trie_get(trie, text, &data) != 0)
+		{
+			JSON_Value *entry = json_array_get_value(entries, i);
+			json_array_append_value(combined, json_value_deep_copy(entry));
+		}
+	}
+
+	trie_free(trie);
+
+	for(i = 0; i < ndelta; ++i)
+	{
+		JSON_Value *entry = json_array_get_value(delta, i);
+		json_array_append_value(combined, json_value_deep_copy(entry));
+	}
+
+	/* Drop the oldest elements that don't fit into the history. */
+	n = json_array_get_count(combined);
+	if(cfg.history_len > 0 && n > cfg.history_len)
+	{
+		JSON_Value *trimmed_value = json_value_init_array();
+		JSON_Array *trimmed = json_array(trimmed_value);
+		for(i = n - cfg.history_len; i < n; ++i)
+		{
+			JSON_Value *entry = json_array_get_value(combined, i);
+			json_array_append_value(trimmed, json_value_deep_copy(entry));
+		}
+		json_value_free(combined_value);
+		combined_value = trimmed_value;
+	}
+
+	json_object_set_value(root, node, combined_value);
+}
+
+/* Merges changed elements of a dictionary of timestamped elements into the
+ * state.  Elements which were updated after the change are left intact. */
+static void
+apply_timestamped_delta(JSON_Object *root, const char node[],
+		const JSON_Object *delta)
+{
+	JSON_Object *entries = json_object_get_object(root, node);
+	if(entries == NULL)
+	{
+		clone_object(root, delta, node);
+		return;
+	}
+
+	size_t i, n;
+	for(i = 0, n = json_object_get_count(delta); i < n; ++i)
+	{
+		const char *name = json_object_get_name(delta, i);
+		JSON_Value *value = json_object_get_value_at(delta, i);
+
+		double ts = 0, newer_ts = 0;
+		(void)get_double(json_value_get_object(value), "ts", &ts);
+		const JSON_Object *newer = json_object_get_object(entries, name);
+		if(newer == NULL || !get_double(newer, "ts", &newer_ts) || newer_ts <= ts)
+		{
+			json_object_set_value(entries, name, json_value_deep_copy(value));
+		}
+	}
+}
+
+/* Removes elements of dictionaries of timestamped elements listed in the
+ * removed table (can be NULL).  Elements which were updated after the removal
+ * are left intact. */
+static void
+apply_removals(JSON_Object *root, const JSON_Object *removed, double since)
+{
+	size_t i, n;
+	for(i = 0, n = json_object_get_count(removed); i < n; ++i)
+	{
+		const char *node = json_object_get_name(removed, i);
+		JSON_Array *names = json_value_get_array(json_object_get_value_at(removed,
+					i));
+		JSON_Object *entries = json_object_get_object(root, node);
+		if(!is_timestamped_node(node) || entries == NULL)
+		{
+			continue;
+		}
+
+		size_t j, m;
+		for(j = 0, m = json_array_get_count(names); j < m; ++j)
+		{
+			const char *name = json_array_get_string(names, j);
+			const JSON_Object *entry = json_object_get_object(entries, name);
+
+			double ts = 0;
+			if(entry != NULL && (!get_double(entry, "ts", &ts) || ts <= since))
+			{
+				json_object_remove(entries, name);
+			}
+		}
+	}
+}
+
+/* Updates sections of state other than histories, marks and bookmarks with
+ * their newer versions from the entry merging them with the state. */
+static void
+apply_sections(JSON_Object *root, const JSON_Object *entry)
+{
+	JSON_Value *sections_value = json_value_init_object();
+	JSON_Object *sections = json_object(sections_value);
+
+	size_t i, n;
+	for(i = 0, n = json_object_get_count(entry); i < n; ++i)
+	{
+		const char *name = json_object_get_name(entry, i);
+		if(!starts_with_lit(name, "journal-") && !is_history_node(name) &&
+				!is_timestamped_node(name))
+		{
+			JSON_Value *value = json_object_get_value_at(entry, i);
+			json_object_set_value(sections, name, json_value_deep_copy(value));
+		}
+	}
+
+	if(json_object_get_count(sections) == 0)
+	{
+		json_value_free(sections_value);
+		return;
+	}
+
+	/* Merging which depends on state of this instance isn't applicable here.
+	 * Sections missing from the entry get cloned into it, they're not copied
+	 * back. */
+	merge_tabs(FULL_VINFO, 0, sections, root);
+	merge_commands(sections, root);
+	merge_regs(sections, root);
+	merge_missing_elements(sections, root, "assocs");
+	merge_missing_elements(sections, root, "xassocs");
+	merge_missing_elements(sections, root, "viewers");
+	merge_missing_elements(sections, root, "trash");
+
+	for(i = 0, n = json_object_get_count(entry); i < n; ++i)
+	{
+		const char *name = json_object_get_name(entry, i);
+		JSON_Value *value = json_object_get_value(sections, name);
+		if(value != NULL)
+		{
+			json_object_set_value(root, name, json_value_deep_copy(value));
+		}
+	}
+
+	json_value_free(sections_value);
+}
+
+/* Appends elements of admixture's array that are missing from the current
+ * one. */
+static void
+merge_missing_elements(JSON_Object *current, const JSON_Object *admixture,
+		const char node[])
+{
+	JSON_Array *entries = json_object_get_array(current, node);
+	JSON_Array *updated = json_object_get_array(admixture, node);
+	if(entries == NULL)
+	{
+		return;
+	}
+
+	const size_t count = json_array_get_count(entries);
+	size_t i, j, n;
+	for(i = 0, n = json_array_get_count(updated); i < n; ++i)
+	{
+		JSON_Value *value = json_array_get_value(updated, i);
+		for(j = 0; j < count; ++j)
+		{
+			if(json_value_equals(json_array_get_value(entries, j), value))
+			{
+				break;
+			}
+		}
+
+		if(j == count)
+		{
+			json_array_append_value(entries, json_value_deep_copy(value));
+		}
+	}
+}
+
+/* Checks whether the name is a name of history array.  Returns non-zero if so,
+ * otherwise zero is returned. */
+static int
+is_history_node(const char name[])
+{
+	return (string_array_pos((char **)history_nodes, ARRAY_LEN(history_nodes),
+				name) != -1);
+}
+
+/* Checks whether the name is a name of dictionary with timestamped elements
+ * (marks and bookmarks).  Returns non-zero if so, otherwise zero is
+ * returned. */
+static int
+is_timestamped_node(const char name[])
+{
+	return (strcmp(name, "marks") == 0 || strcmp(name, "bmarks") == 0);
+}
+
+/* Checks whether loading of a section of state can be deferred.  Returns
+ * non-zero if so, otherwise zero is returned. */
+static int
+is_deferred_node(const char name[])
+{
+	return (is_history_node(name) || is_timestamped_node(name));
+}
+
+/* Appends changes of state of the current instance since the last load or
+ * store to the journal as a single line.  The synced is state as of that load
+ * or store and gets updated on success.  Returns zero on success, otherwise
+ * non-zero is returned. */
+static int
+append_journal(const char journal[], int vinfo, JSON_Value **synced)
+{
+	char *locale = drop_locale();
+
+	JSON_Value *state_value = serialize_state(vinfo);
+	JSON_Object *state = json_object(state_value);
+	const JSON_Object *synced_state = json_object(*synced);
+
+	JSON_Value *delta_value = json_value_init_object();
+	JSON_Object *delta = json_object(delta_value);
+
+	size_t i, n;
+	for(i = 0, n = json_object_get_count(state); i < n; ++i)
+	{
+		const char *name = json_object_get_name(state, i);
+		JSON_Value *value = json_object_get_value_at(state, i);
+
+		if(is_history_node(name))
+		{
+			clone_array(delta, json_value_get_array(value), name);
+			drop_old_history(delta, name, state_sync_time);
+		}
+		else if(is_timestamped_node(name))
+		{
+			add_changed_entries(delta, name, json_value_get_object(value),
+					json_object_get_object(synced_state, name));
+		}
+		else if(!json_value_equals(value, json_object_get_value(synced_state,
+						name)))
+		{
+			json_object_set_value(delta, name, json_value_deep_copy(value));
+		}
+	}
+	set_double(delta, "journal-since", state_sync_time);
+
+	char *line = json_serialize_to_string(delta_value);
+	json_value_free(delta_value);
+	restore_locale(locale);
+
+	int error = 1;
+	if(line != NULL)
+	{
+		FILE *fp = os_fopen(journal, "ab");
+		if(fp != NULL)
+		{
+			error = (fprintf(fp, "%s\n", line) < 0);
+			error |= (fclose(fp) != 0);
+		}
+		free(line);
+	}
+
+	if(error)
+	{
+		LOG_ERROR_MSG("Error appending to journal: %s", journal);
+		json_value_free(state_value);
+		return 1;
+	}
+
+	forget_histories(state);
+	json_value_free(*synced);
+	*synced = state_value;
+	return 0;
+}
+
+/* Adds elements of the dictionary that differ from their synced versions to
+ * the delta and records names of elements that are gone.  synced can be NULL,
+ * in which case everything is considered to be changed. */
+static void
+add_changed_entries(JSON_Object *delta, const char node[],
+		const JSON_Object *entries, const JSON_Object *synced)
+{
+	JSON_Object *changed = NULL;
+
+	size_t i, n;
+	for(i = 0, n = json_object_get_count(entries); i < n; ++i)
+	{
+		const char *name = json_object_get_name(entries, i);
+		JSON_Value *value = json_object_get_value_at(entries, i);
+		if(!json_value_equals(value, json_object_get_value(synced, name)))
+		{
+			if(changed == NULL)
+			{
+				changed = add_object(delta, node);
+			}
+			json_object_set_value(changed, name, json_value_deep_copy(value));
+		}
+	}
+
+	JSON_Array *removed = NULL;
+
+	for(i = 0, n = json_object_get_count(synced); i < n; ++i)
+	{
+		const char *name = json_object_get_name(synced, i);
+		if(!json_object_has_value(entries, name))
+		{
+			if(removed == NULL)
+			{
+				JSON_Object *removals = json_object_get_object(delta,
+						"journal-removed");
+				if(removals == NULL)
+				{
+					removals = add_object(delta, "journal-removed");
+				}
+				removed = add_array(removals, node);
+			}
+			json_array_append_string(removed, name);
+		}
+	}
+}
+
+/* Removes elements of a history that are older than the specified time. */
+static void
+drop_old_history(JSON_Object *root, const char node[], double since)
+{
+	JSON_Array *entries = json_object_get_array(root, node);
+	if(entries == NULL)
+	{
+		return;
+	}
+
+	JSON_Value *recent_value = json_value_init_array();
+	JSON_Array *recent = json_array(recent_value);
+
+	size_t i, n;
+	for(i = 0, n = json_array_get_count(entries); i < n; ++i)
+	{
+		double ts;
+		if(get_double(json_array_get_object(entries, i), "ts", &ts) && ts >= since)
+		{
+			JSON_Value *entry = json_array_get_value(entries, i);
+			json_array_append_value(recent, json_value_deep_copy(entry));
+		}
+	}
+
+	if(json_array_get_count(recent) == 0)
+	{
+		json_value_free(recent_value);
+		json_object_remove(root, node);
+		return;
+	}
+
+	json_object_set_value(root, node, recent_value);
+}
+
+/* Replaces state (can point at NULL) with serialized state of this instance
+ * if journal is enabled. */
+static void
+remember_state(JSON_Value **synced, int vinfo)
+{
+	json_value_free(*synced);
+	*synced = NULL;
+
+	if(vinfo & VINFO_JOURNAL)
+	{
+		char *locale = drop_locale();
+		*synced = serialize_state(vinfo);
+		restore_locale(locale);
+
+		forget_histories(json_object(*synced));
+	}
+}
+
+/* Removes histories from the state as they are journaled differently. */
+static void
+forget_histories(JSON_Object *root)
+{
+	size_t i;
+	for(i = 0U; i < ARRAY_LEN(history_nodes); ++i)
+	{
+		json_object_remove(root, history_nodes[i]);
+	}
+}
+
 /* Replaces current locale with C locale and returns string to be passed to
  * restore_locale() to get previous state back. */
 TSTATIC char *
@@ -2233,6 +3147,7 @@ store_global_options(JSON_Object *root)
 	append_dstr(options, format_str("aproposprg=%s",
 				escape_spaces(cfg.apropos_prg)));
 	append_dstr(options, format_str("%sautochpos", cfg.auto_ch_pos ? "" : "no"));
+	append_dstr(options, format_str("bgthreads=%d", cfg.bg_threads));
 	append_dstr(options, format_str("cdpath=%s", cfg.cd_path));
 	append_dstr(options, format_str("%sautocd", cfg.auto_cd ? "" : "no"));
 	append_dstr(options, format_str("%schaselinks", cfg.chase_links ? "" : "no"));
@@ -2277,6 +3192,10 @@ store_global_options(JSON_Object *root)
 	append_dstr(options, format_str("%srunexec", cfg.auto_execute ? "" : "no"));
 	append_dstr(options, format_str("navoptions=%s",
 				escape_spaces(vle_opts_get("navoptions", OPT_GLOBAL))));
+#ifndef _WIN32
+	append_dstr(options, format_str("nocachefs=%s",
+				escape_spaces(cfg.no_cache_fs_list)));
+#endif
 	append_dstr(options, format_str("previewoptions=%s",
 				escape_spaces(vle_opts_get("previewoptions", OPT_GLOBAL))));
 	append_dstr(options, format_str("%sscrollbind", cfg.scroll_bind ? "" : "no"));
@@ -2337,6 +3256,9 @@ store_global_options(JSON_Object *root)
 			escape_spaces(vle_opts_get("suggestoptions", OPT_GLOBAL))));
 	append_dstr(options, format_str("iooptions=%s",
 			escape_spaces(vle_opts_get("iooptions", OPT_GLOBAL))));
+#ifndef _WIN32
+	append_dstr(options, format_str("iorate=%d", cfg.io_rate));
+#endif
 
 	append_dstr(options, format_str("dirsize=%s",
 				cfg.view_dir_size == VDS_SIZE ? "size" : "nitems"));
@@ -2542,15 +3464,17 @@ store_dir_stack(JSON_Object *root)
 static void
 store_trash(JSON_Object *root)
 {
-	if(trash_list_size > 0)
+	int count;
+	const trash_entry_t *const list = trash_get_list(&count);
+	if(count > 0)
 	{
 		int i;
 		JSON_Array *trash = add_array(root, "trash");
-		for(i = 0; i < trash_list_size; ++i)
+		for(i = 0; i < count; ++i)
 		{
 			JSON_Object *entry = append_object(trash);
-			set_str(entry, "trashed", trash_list[i].trash_name);
-			set_str(entry, "original", trash_list[i].path);
+			set_str(entry, "trashed", list[i].trash_name);
+			set_str(entry, "original", list[i].path);
 		}
 	}
 }
@@ -2948,8 +3872,14 @@ sessions_load(const char name[])
 	snprintf(session_file, sizeof(session_file), "%s/%s.json", sessions_dir,
 			name);
 
+	char session_journal[PATH_MAX + 64];
+	get_journal_path(session_file, session_journal, sizeof(session_journal));
+
+	/* Whatever was deferred is superseded by the session. */
+	update_string(&deferred_state, NULL);
+
 	char *locale = drop_locale();
-	JSON_Value *session = json_parse_file(session_file);
+	JSON_Value *session = read_state_file(session_file, session_journal);
 
 	if(session == NULL)
 	{
@@ -2961,7 +3891,9 @@ sessions_load(const char name[])
 
 	char info_file[PATH_MAX + 16];
 	snprintf(info_file, sizeof(info_file), "%s/vifminfo.json", cfg.config_dir);
-	JSON_Value *common = json_parse_file(info_file);
+	char info_journal[PATH_MAX + 32];
+	get_journal_path(info_file, info_journal, sizeof(info_journal));
+	JSON_Value *common = read_state_file(info_file, info_journal);
 	restore_locale(locale);
 
 	if(common != NULL)
@@ -2977,6 +3909,8 @@ sessions_load(const char name[])
 
 	set_session(name);
 	(void)filemon_from_file(session_file, FMT_MODIFIED, &session_mon);
+	state_sync_time = time(NULL);
+	remember_state(&synced_session_state, cfg.session_options);
 
 	return 0;
 }
@@ -2986,6 +3920,10 @@ static void
 set_session(const char new_session[])
 {
 	update_string(&cfg.session, new_session);
+
+	json_value_free(synced_session_state);
+	synced_session_state = NULL;
+
 	if(session_changed_cb != NULL)
 	{
 		session_changed_cb(sessions_current());
@@ -3010,23 +3948,50 @@ write_session_file(void)
 	snprintf(session_file, sizeof(session_file), "%s/%s.json", sessions_dir,
 			cfg.session);
 
-	store_file(session_file, &session_mon, cfg.session_options);
+	store_file(session_file, &session_mon, cfg.session_options,
+			&synced_session_state);
 }
 
-/* Writes file updating it with state of the current instance if necessary. */
+/* Writes file updating it with state of the current instance if necessary.
+ * Appends to a journal instead if it's enabled and isn't too large.  The synced
+ * is updated to match what's stored. */
 static void
-store_file(const char path[], filemon_t *mon, int vinfo)
+store_file(const char path[], filemon_t *mon, int vinfo, JSON_Value **synced)
 {
+	char journal[PATH_MAX + 32];
+	get_journal_path(path, journal, sizeof(journal));
+
+	/* Journal is folded into the file once it grows larger than the file.  The
+	 * file must exist for the state to be discoverable (e.g., as a session). */
+	if((vinfo & VINFO_JOURNAL) && path_exists(path, DEREF))
+	{
+		const uint64_t limit = MAX(get_file_size(path), MIN_JOURNAL_LIMIT);
+		if(get_file_size(journal) < limit &&
+				append_journal(journal, vinfo, synced) == 0)
+		{
+			return;
+		}
+	}
+
+	/* Move journal out of the way so that other instances start a new one
+	 * instead of appending to the one that's being folded. */
+	char old_journal[PATH_MAX + 64];
+	snprintf(old_journal, sizeof(old_journal), "%s_%u", journal, get_pid());
+	const int has_journal = path_exists(journal, NODEREF)
+	                     && rename_file(journal, old_journal) == 0;
+
 	char tmp_file[PATH_MAX + 64];
 	snprintf(tmp_file, sizeof(tmp_file), "%s_%u", path, get_pid());
 
+	int stored = 0;
 	if(os_access(path, R_OK) != 0 || copy_file(path, tmp_file) == 0)
 	{
 		filemon_t current_mon;
 		int file_changed = filemon_from_file(path, FMT_MODIFIED, &current_mon) != 0
 		                || !filemon_equal(mon, &current_mon);
 
-		update_info_file(tmp_file, vinfo, file_changed);
+		update_info_file(tmp_file, has_journal ? old_journal : NULL, vinfo,
+				file_changed || has_journal);
 		(void)filemon_from_file(tmp_file, FMT_MODIFIED, mon);
 
 		if(rename_file(tmp_file, path) != 0)
@@ -3034,6 +3999,24 @@ store_file(const char path[], filemon_t *mon, int vinfo)
 			LOG_ERROR_MSG("Can't replace \"%s\" file with updated temporary", path);
 			(void)remove(tmp_file);
 		}
+		else
+		{
+			stored = 1;
+			remember_state(synced, vinfo);
+		}
+	}
+
+	if(has_journal)
+	{
+		if(stored)
+		{
+			(void)remove(old_journal);
+		}
+		else if(path_exists(journal, NODEREF) ||
+				rename_file(old_journal, journal) != 0)
+		{
+			LOG_ERROR_MSG("Journal is left at: %s", old_journal);
+		}
 	}
 }
 
@@ -3045,7 +4028,15 @@ sessions_remove(const char name[])
 	char session_file[PATH_MAX + 32];
 	snprintf(session_file, sizeof(session_file), "%s/%s.json", sessions_dir,
 			name);
-	return (is_dir(session_file) || remove(session_file) != 0);
+	if(is_dir(session_file) || remove(session_file) != 0)
+	{
+		return 1;
+	}
+
+	char session_journal[PATH_MAX + 64];
+	get_journal_path(session_file, session_journal, sizeof(session_journal));
+	(void)remove(session_journal);
+	return 0;
 }
 
 void
@@ -3077,6 +4068,13 @@ sessions_complete(const char prefix[])
 	vle_compl_add_last_match(prefix);
 }
 
+/* Fills buffer with the path of journal that corresponds to a state file. */
+static void
+get_journal_path(const char path[], char buf[], size_t buf_size)
+{
+	snprintf(buf, buf_size, "%s.journal", path);
+}
+
 /* Fills buffer with the path at which sessions are stored. */
 static void
 get_session_dir(char buf[], size_t buf_size)
@@ -30,6 +30,14 @@ typedef void (*sessions_changed)(const char new_session[]);
  * during startup process. */
 void state_load(int reread);
 
+/* Same as state_load(0), but defers loading of histories, marks and bookmarks
+ * until state_load_deferred() is called, which makes startup faster. */
+void state_load_lazily(void);
+
+/* Loads parts of state that were skipped by state_load_lazily(), if any.
+ * Elements of state that were set in the meantime take precedence. */
+void state_load_deferred(void);
+
 /* Stores state of the application.  Always writes vifminfo and stores session
  * if any is active. */
 void state_store(void);
@@ -84,6 +92,7 @@ TSTATIC_DEFS(
 	JSON_Value * serialize_state(int vinfo);
 	void merge_states(int vinfo, int session_load, JSON_Object *current,
 		const JSON_Object *admixture);
+	void apply_journal_entry(JSON_Object *root, const JSON_Object *entry);
 )
 
 #endif /* VIFM__CFG__INFO_H__ */
@@ -37,7 +37,7 @@
 #include <stdlib.h> /* free() */
 #include <stdio.h> /* snprintf() */
 #include <string.h> /* memcpy() strdup() strlen() strncasecmp() strncmp()
-                       strrchr() */
+                       strpbrk() strrchr() */
 
 #include "cfg/config.h"
 #include "cfg/info.h"
@@ -117,6 +117,7 @@ static void complete_winrun(const char str[]);
 static void complete_from_string_list(const char str[], const char *items[][2],
 		size_t item_count, int ignore_case);
 static void complete_command_name(const char beginning[]);
+static int complete_cached_command_name(size_t i, const char beginning[]);
 static int filename_completion_in_dir(const char path[], const char str[],
 		CompletionType type);
 static void filename_completion_internal(DIR *dir, const char dir_path[],
@@ -1127,9 +1128,17 @@ complete_command_name(const char beginning[])
 	size_t paths_count;
 	char *const cwd = save_cwd();
 
+	/* Cached listings don't account for paths and environment variables. */
+	const int use_cache = (strpbrk(beginning, "/$") == NULL);
+
 	paths = get_paths(&paths_count);
 	for(i = 0U; i < paths_count; ++i)
 	{
+		if(use_cache && complete_cached_command_name(i, beginning))
+		{
+			continue;
+		}
+
 		if(vifm_chdir(paths[i]) == 0)
 		{
 			filename_completion(beginning, CT_EXECONLY, 1);
@@ -1140,6 +1149,43 @@ complete_command_name(const char beginning[])
 	restore_cwd(cwd);
 }
 
+/* Completes names of executables using cached listing of i-th directory of
+ * $PATH.  Returns non-zero if listing was available, otherwise zero is
+ * returned. */
+static int
+complete_cached_command_name(size_t i, const char beginning[])
+{
+	int count;
+	char **const names = get_path_files(i, &count);
+	if(names == NULL)
+	{
+		return 0;
+	}
+
+	size_t paths_count;
+	char **const paths = get_paths(&paths_count);
+
+	const size_t len = strlen(beginning);
+	int j;
+	for(j = 0; j < count; ++j)
+	{
+		if(beginning[0] == '\0' && names[j][0] == '.')
+			continue;
+		if(!file_matches(names[j], beginning, len))
+			continue;
+
+		char full_path[PATH_MAX + 1];
+		snprintf(full_path, sizeof(full_path), "%s/%s", paths[i], names[j]);
+		if(executable_exists(full_path))
+		{
+			vle_compl_add_path_match(names[j]);
+		}
+	}
+
+	vle_compl_finish_group();
+	return 1;
+}
+
 /* Does filename completion outside current working directory.  Returns
  * completion start offset. */
 static int
@@ -198,6 +198,7 @@ static int set_view_filter(view_t *view, const char filter[],
 static int get_filter_inversion_state(const cmd_info_t *cmd_info);
 static int find_cmd(const cmd_info_t *cmd_info);
 static int finish_cmd(const cmd_info_t *cmd_info);
+static int fuzzy_cmd(const cmd_info_t *cmd_info);
 static int goto_path_cmd(const cmd_info_t *cmd_info);
 static int grep_cmd(const cmd_info_t *cmd_info);
 static int help_cmd(const cmd_info_t *cmd_info);
@@ -580,6 +581,10 @@ const cmd_add_t cmds_list[] = {
 	  .descr = "stop script processing",
 	  .flags = HAS_COMMENT,
 	  .handler = &finish_cmd,      .min_args = 0,   .max_args = 0, },
+	{ .name = "fuzzy",             .abbr = NULL,    .id = -1,
+	  .descr = "fuzzy search for files under current directory",
+	  .flags = HAS_EMARK,
+	  .handler = &fuzzy_cmd,       .min_args = 0,   .max_args = NOT_DEF, },
 	{ .name = "goto",              .abbr = "go",    .id = COM_GOTO_PATH,
 	  .descr = "navigate to specified file/directory",
 	  .flags = HAS_ENVVARS | HAS_COMMENT | HAS_MACROS_FOR_CMD | HAS_QUOTED_ARGS,
@@ -1293,6 +1298,10 @@ bmgo_cmd(const cmd_info_t *cmd_info)
 static int
 bmarks_do(const cmd_info_t *cmd_info, int go)
 {
+	/* Bookmarks from vifminfo are loaded after the first frame is drawn, but
+	 * this can run before that as part of startup. */
+	state_load_deferred();
+
 	char *const tags = args_to_csl(cmd_info);
 	const int result = (show_bmarks_menu(curr_view, tags, go) != 0);
 	free(tags);
@@ -1952,6 +1961,8 @@ delete_cmd(const cmd_info_t *cmd_info)
 static int
 delmarks_cmd(const cmd_info_t *cmd_info)
 {
+	state_load_deferred();
+
 	int i;
 
 	if(cmd_info->emark)
@@ -2000,6 +2011,8 @@ delmarks_cmd(const cmd_info_t *cmd_info)
 static int
 delbmarks_cmd(const cmd_info_t *cmd_info)
 {
+	state_load_deferred();
+
 	if(cmd_info->emark)
 	{
 		int i;
@@ -2672,6 +2685,14 @@ finish_cmd(const cmd_info_t *cmd_info)
 	return 0;
 }
 
+/* Lists files under current directory that fuzzily match the query in a menu
+ * or in a custom view. */
+static int
+fuzzy_cmd(const cmd_info_t *cmd_info)
+{
+	return show_fuzzy_menu(curr_view, cmd_info->args, cmd_info->emark) != 0;
+}
+
 /* Changes view to have specified file/directory under the cursor. */
 static int
 goto_path_cmd(const cmd_info_t *cmd_info)
@@ -3425,6 +3446,8 @@ get_attrs(const char text[], int *combine_attrs)
 static int
 history_cmd(const cmd_info_t *cmd_info)
 {
+	state_load_deferred();
+
 	const char *const type = (cmd_info->argc == 0) ? "." : cmd_info->argv[0];
 	const size_t len = strlen(type);
 
@@ -3745,6 +3768,8 @@ mark_cmd(const cmd_info_t *cmd_info)
 static int
 marks_cmd(const cmd_info_t *cmd_info)
 {
+	state_load_deferred();
+
 	char buf[256];
 	int i, j;
 
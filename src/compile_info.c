@@ -0,0 +1 @@
+const char GIT_INFO[] = "e7044d522d6f-dirty";
@@ -37,6 +37,7 @@
 #include "engine/mode.h"
 #include "lua/vlua.h"
 #include "modes/dialogs/msg_dialog.h"
+#include "modes/menu.h"
 #include "modes/modes.h"
 #include "modes/wk.h"
 #include "ui/fileview.h"
@@ -394,7 +395,12 @@ get_char_async_loop(WINDOW *win, wint_t *c, int timeout, int process_callbacks)
 		{
 			if(curr_stats.ipc != NULL)
 			{
-				ipc_check(curr_stats.ipc);
+				/* Process all pending messages at once to not add delays to commands
+				 * that are sent as a sequence. */
+				while(ipc_check(curr_stats.ipc))
+				{
+					/* Do nothing. */
+				}
 			}
 
 			if(vcache_check(&is_previewed))
@@ -402,6 +408,8 @@ get_char_async_loop(WINDOW *win, wint_t *c, int timeout, int process_callbacks)
 				stats_redraw_later();
 			}
 
+			modmenu_check_for_updates();
+
 			if(process_callbacks)
 			{
 				bg_check();
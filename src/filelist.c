@@ -229,6 +229,7 @@ init_flist(view_t *view)
 {
 	view->list_pos = 0;
 	view->last_seen_pos = -1;
+	view->drawn_top = -1;
 	view->history_num = 0;
 	view->history_pos = 0;
 	view->on_slow_fs = 0;
@@ -285,6 +286,9 @@ flist_free_view(view_t *view)
 	update_string(&view->local_filter.prev, NULL);
 	free(view->local_filter.poshist);
 	view->local_filter.poshist = NULL;
+	free(view->local_filter.matches);
+	view->local_filter.matches = NULL;
+	update_string(&view->local_filter.matches_of, NULL);
 
 	filter_dispose(&view->local_filter.filter);
 	filter_dispose(&view->auto_filter);
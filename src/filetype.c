@@ -43,7 +43,10 @@ static assoc_records_t parse_command_list(const char cmds[], int with_descr);
 static void register_assoc(assoc_t assoc, int for_x, int in_x);
 static assoc_records_t clone_all_matching_records(const char file[],
 		const assoc_list_t *record_list);
+static int find_assoc(const assoc_list_t *assoc_list, const char file[],
+		int from);
 static int add_assoc(assoc_list_t *assoc_list, assoc_t assoc);
+static void index_assocs(assoc_list_t *assoc_list);
 static void assoc_viewers(matchers_t *matchers, const assoc_records_t *viewers);
 static assoc_records_t clone_assoc_records(const assoc_records_t *records,
 		const char pattern[], const assoc_list_t *dst);
@@ -117,15 +120,10 @@ ft_get_viewers(const char file[])
 	strlist_t viewers = {};
 
 	int i;
-	for(i = 0; i < fileviewers.count; ++i)
+	for(i = 0; (i = find_assoc(&fileviewers, file, i)) >= 0; ++i)
 	{
 		assoc_t *const assoc = &fileviewers.list[i];
 
-		if(!matchers_match(assoc->matchers, file))
-		{
-			continue;
-		}
-
 		int j;
 		for(j = 0; j < assoc->records.count; ++j)
 		{
@@ -149,16 +147,11 @@ find_existing_cmd(const assoc_list_t *record_list, const char file[])
 {
 	int i;
 
-	for(i = 0; i < record_list->count; ++i)
+	for(i = 0; (i = find_assoc(record_list, file, i)) >= 0; ++i)
 	{
 		assoc_record_t prog;
 		assoc_t *const assoc = &record_list->list[i];
 
-		if(!matchers_match(assoc->matchers, file))
-		{
-			continue;
-		}
-
 		prog = find_existing_cmd_record(&assoc->records);
 		if(!is_assoc_record_empty(&prog))
 		{
@@ -284,18 +277,34 @@ clone_all_matching_records(const char file[], const assoc_list_t *record_list)
 	int i;
 	assoc_records_t result = {};
 
-	for(i = 0; i < record_list->count; ++i)
+	for(i = 0; (i = find_assoc(record_list, file, i)) >= 0; ++i)
 	{
-		assoc_t *const assoc = &record_list->list[i];
-		if(matchers_match(assoc->matchers, file))
-		{
-			ft_assoc_record_add_all(&result, &assoc->records);
-		}
+		ft_assoc_record_add_all(&result, &record_list->list[i].records);
 	}
 
 	return result;
 }
 
+/* Finds first association starting at position from which pattern matches
+ * given file.  Returns position of the association or -1 if there is none. */
+static int
+find_assoc(const assoc_list_t *assoc_list, const char file[], int from)
+{
+	if(assoc_list->index != NULL)
+	{
+		return matchers_index_find(assoc_list->index, file, from);
+	}
+
+	for(; from < assoc_list->count; ++from)
+	{
+		if(matchers_match(assoc_list->list[from].matchers, file))
+		{
+			return from;
+		}
+	}
+	return -1;
+}
+
 void
 ft_set_viewers(matchers_t *matchers, const char viewers[])
 {
@@ -353,9 +362,34 @@ add_assoc(assoc_list_t *assoc_list, assoc_t assoc)
 	assoc_list->list = p;
 	assoc_list->list[assoc_list->count] = assoc;
 	assoc_list->count++;
+
+	if(assoc_list->index == NULL ||
+			matchers_index_add(assoc_list->index, assoc.matchers) != 0)
+	{
+		index_assocs(assoc_list);
+	}
 	return 0;
 }
 
+/* (Re)builds index over matchers of the list.  Leaves the index empty on error,
+ * in which case associations are checked one by one. */
+static void
+index_assocs(assoc_list_t *assoc_list)
+{
+	matchers_index_free(assoc_list->index);
+	assoc_list->index = matchers_index_alloc();
+
+	int i;
+	for(i = 0; i < assoc_list->count && assoc_list->index != NULL; ++i)
+	{
+		if(matchers_index_add(assoc_list->index, assoc_list->list[i].matchers) != 0)
+		{
+			matchers_index_free(assoc_list->index);
+			assoc_list->index = NULL;
+		}
+	}
+}
+
 ViewerKind
 ft_viewer_kind(const char viewer[])
 {
@@ -430,6 +464,9 @@ reset_list_head(assoc_list_t *assoc_list)
 	free(assoc_list->list);
 	assoc_list->list = NULL;
 	assoc_list->count = 0;
+
+	matchers_index_free(assoc_list->index);
+	assoc_list->index = NULL;
 }
 
 static void
@@ -22,6 +22,7 @@
 
 #define VIFM_PSEUDO_CMD "vifm"
 
+struct matchers_index_t;
 struct matchers_t;
 
 /* Type of file association by its source. */
@@ -70,6 +71,7 @@ typedef struct
 {
 	assoc_t *list;
 	int count;
+	struct matchers_index_t *index; /* Index over matchers of the list or NULL. */
 }
 assoc_list_t;
 
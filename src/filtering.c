@@ -20,7 +20,9 @@
 #include "filtering.h"
 
 #include <assert.h> /* assert() */
-#include <string.h> /* strdup() */
+#include <regex.h> /* REG_ICASE */
+#include <stdlib.h> /* free() */
+#include <string.h> /* strdup() strpbrk() */
 
 #include "cfg/config.h"
 #include "compat/reallocarray.h"
@@ -45,6 +47,11 @@ static int load_unfiltered_list(view_t *view);
 static int list_is_incomplete(view_t *view);
 static void store_local_filter_position(view_t *view, int pos);
 static int update_filtering_lists(view_t *view, int add, int clear);
+static int can_narrow_matches(const struct local_filter_t *lf);
+static int is_literal_pattern(const char pattern[]);
+static void remember_matches(struct local_filter_t *lf, int *matches,
+		size_t len);
+static void forget_matches(struct local_filter_t *lf);
 static void reparent_tree_node(dir_entry_t *original, dir_entry_t *filtered);
 static void ensure_filtered_list_not_empty(view_t *view,
 		dir_entry_t *parent_entry);
@@ -71,6 +78,10 @@ filters_view_reset(view_t *view)
 	view->local_filter.saved = NULL;
 	view->local_filter.poshist = NULL;
 	view->local_filter.poshist_len = 0U;
+	view->local_filter.matches = NULL;
+	view->local_filter.matches_len = 0U;
+	view->local_filter.matches_of = NULL;
+	view->local_filter.matches_case_sensitive = 0;
 }
 
 /* Resets filter to empty state (either initializes or clears it). */
@@ -469,6 +480,8 @@ load_unfiltered_list(view_t *view)
 	view->local_filter.prefiltered_count = view->filtered;
 	view->dir_entry = NULL;
 
+	forget_matches(&view->local_filter);
+
 	return current_file_pos;
 }
 
@@ -528,18 +541,41 @@ update_filtering_lists(view_t *view, int add, int clear)
 {
 	/* filters_drop_temporaries() is a similar function. */
 
+	struct local_filter_t *const lf = &view->local_filter;
+
 	size_t i;
 	size_t list_size = 0U;
 	dir_entry_t *parent_entry = NULL;
 	int parent_added = 0;
 
-	for(i = 0; i < view->local_filter.unfiltered_count; ++i)
+	/* While filter is being typed, entries are only copied and matches of the
+	 * previous filter can be used to avoid checking entries that can't match. */
+	const int track = (add && !clear);
+	const int narrow = (track && can_narrow_matches(lf));
+	const size_t count = (narrow ? lf->matches_len : lf->unfiltered_count);
+	int *matches = NULL;
+	size_t matches_len = 0U;
+
+	if(track)
+	{
+		/* Matches are narrowed in place. */
+		matches = narrow
+		        ? lf->matches
+		        : reallocarray(NULL, lf->unfiltered_count + 1, sizeof(*matches));
+		if(narrow)
+		{
+			lf->matches = NULL;
+		}
+	}
+
+	for(i = 0; i < count; ++i)
 	{
 		/* FIXME: some very long file names won't be matched against some
 		 * regexps. */
 		char name_with_slash[NAME_MAX + 1 + 1];
 
-		dir_entry_t *const entry = &view->local_filter.unfiltered[i];
+		const int pos = (narrow ? matches[i] : (int)i);
+		dir_entry_t *const entry = &lf->unfiltered[pos];
 		const char *name = entry->name;
 
 		if(is_parent_dir(name))
@@ -553,6 +589,10 @@ update_filtering_lists(view_t *view, int add, int clear)
 
 					parent_added = 1;
 				}
+				if(matches != NULL)
+				{
+					matches[matches_len++] = pos;
+				}
 				continue;
 			}
 			else if(!filter_is_empty(&view->local_filter.filter))
@@ -576,6 +616,11 @@ update_filtering_lists(view_t *view, int add, int clear)
 		entry->tag = -1;
 		if(filter_matches(&view->local_filter.filter, name) != 0)
 		{
+			if(matches != NULL)
+			{
+				matches[matches_len++] = pos;
+			}
+
 			if(add)
 			{
 				dir_entry_t *e = add_dir_entry(&view->dir_entry, &list_size, entry);
@@ -607,6 +652,11 @@ update_filtering_lists(view_t *view, int add, int clear)
 			fentry_free(parent_entry);
 		}
 	}
+	if(track)
+	{
+		remember_matches(lf, matches, matches_len);
+	}
+
 	if(add)
 	{
 		view->list_rows = list_size;
@@ -620,6 +670,77 @@ update_filtering_lists(view_t *view, int add, int clear)
 	return 0;
 }
 
+/* Checks whether entries that can match current value of the local filter are
+ * all among matches of its previous value.  Returns non-zero if so. */
+static int
+can_narrow_matches(const struct local_filter_t *lf)
+{
+	if(lf->matches == NULL || lf->matches_of == NULL)
+	{
+		return 0;
+	}
+
+	/* Ignoring case can only extend the set of matches. */
+	const int case_sensitive = !(lf->filter.cflags & REG_ICASE);
+	if(lf->matches_case_sensitive && !case_sensitive)
+	{
+		return 0;
+	}
+
+	/* Appending to a literal string yields a more specific literal, which isn't
+	 * true for regular expressions in general ("a" and "a*", "a|" and "a|b"). */
+	return starts_with(lf->filter.raw, lf->matches_of)
+	    && is_literal_pattern(lf->matches_of)
+	    && is_literal_pattern(lf->filter.raw);
+}
+
+/* Checks whether regular expression matches only its own text, possibly
+ * anchored at the beginning.  Returns non-zero if so. */
+static int
+is_literal_pattern(const char pattern[])
+{
+	if(pattern[0] == '^')
+	{
+		++pattern;
+	}
+	return strpbrk(pattern, ".[]()*+?{}|^$\\") == NULL;
+}
+
+/* Stores list of matches of current value of the local filter.  Takes
+ * ownership of the matches array, which can be NULL. */
+static void
+remember_matches(struct local_filter_t *lf, int *matches, size_t len)
+{
+	forget_matches(lf);
+
+	if(matches == NULL)
+	{
+		return;
+	}
+
+	lf->matches_of = strdup(lf->filter.raw);
+	if(lf->matches_of == NULL)
+	{
+		free(matches);
+		return;
+	}
+
+	lf->matches = matches;
+	lf->matches_len = len;
+	lf->matches_case_sensitive = !(lf->filter.cflags & REG_ICASE);
+}
+
+/* Drops list of matches of the local filter, which forces next update of the
+ * filter to check every entry. */
+static void
+forget_matches(struct local_filter_t *lf)
+{
+	free(lf->matches);
+	lf->matches = NULL;
+	lf->matches_len = 0U;
+	update_string(&lf->matches_of, NULL);
+}
+
 /* Reparents *filtered node by attaching it to the closes ancestor of *original
  * mapped onto the list of filtered nodes.  tag field of entries is used to
  * perform the mapping. */
@@ -674,6 +795,8 @@ ensure_filtered_list_not_empty(view_t *view, dir_entry_t *parent_entry)
 			(void)add_dir_entry(&view->local_filter.unfiltered,
 					&view->local_filter.unfiltered_count,
 					&view->dir_entry[view->list_rows - 1]);
+			/* The entry isn't among matches, so they are incomplete now. */
+			forget_matches(&view->local_filter);
 		}
 	}
 	else
@@ -846,6 +969,8 @@ local_filter_finish(view_t *view)
 	free(view->local_filter.poshist);
 	view->local_filter.poshist = NULL;
 	view->local_filter.poshist_len = 0U;
+
+	forget_matches(&view->local_filter);
 }
 
 void
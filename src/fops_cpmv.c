@@ -20,6 +20,8 @@
 #include "fops_cpmv.h"
 
 #include <assert.h> /* assert() */
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* calloc() free() */
 #include <string.h> /* strcmp() strdup() */
 
 #include "compat/reallocarray.h"
@@ -62,6 +64,7 @@ static int check_for_clashes(verify_args_t *args, char *list[], char *marked[],
 		int nlines, char **error);
 static const char * cmlo_to_str(CopyMoveLikeOp op);
 static void cpmv_files_in_bg(bg_op_t *bg_op, void *arg);
+static char * cpmv_files_in_bg_at_once(bg_op_t *bg_op, bg_args_t *args);
 static void set_cpmv_bg_descr(bg_op_t *bg_op, bg_args_t *args, size_t i);
 static void cpmv_file_in_bg(ops_t *ops, const char src[], const char dst[],
 		int move, int force, int skip, int from_trash, const char dst_dir[]);
@@ -604,11 +607,18 @@ cpmv_files_in_bg(bg_op_t *bg_op, void *arg)
 		}
 	}
 
+	char *const processed = cpmv_files_in_bg_at_once(bg_op, args);
+
 	for(i = 0U; i < args->sel_list_len; ++i)
 	{
 		const char *const src = args->sel_list[i];
 		const char *const dst = args->list[i];
 
+		if(processed != NULL && processed[i])
+		{
+			continue;
+		}
+
 		set_cpmv_bg_descr(bg_op, args, i);
 
 		cpmv_file_in_bg(ops, src, dst, args->move, args->force, args->skip,
@@ -616,9 +626,80 @@ cpmv_files_in_bg(bg_op_t *bg_op, void *arg)
 		++bg_op->done;
 	}
 
+	free(processed);
 	fops_free_bg_args(args);
 }
 
+/* Copies or moves files which keep their names and don't conflict with
+ * anything by as few invocations of an external command as possible.  Returns
+ * array of flags marking files that were processed successfully or NULL if
+ * none were. */
+static char *
+cpmv_files_in_bg_at_once(bg_op_t *bg_op, bg_args_t *args)
+{
+	char *const processed = calloc(args->sel_list_len, 1);
+	char **srcs = reallocarray(NULL, args->sel_list_len, sizeof(*srcs));
+	size_t *indexes = reallocarray(NULL, args->sel_list_len, sizeof(*indexes));
+	OpsResult *results = reallocarray(NULL, args->sel_list_len,
+			sizeof(*results));
+	if(processed == NULL || srcs == NULL || indexes == NULL || results == NULL)
+	{
+		free(results);
+		free(indexes);
+		free(srcs);
+		free(processed);
+		return NULL;
+	}
+
+	size_t i;
+	int nsrcs = 0;
+	for(i = 0U; i < args->sel_list_len; ++i)
+	{
+		const char *const src = args->sel_list[i];
+		const char *const dst = args->list[i];
+
+		char dst_full[PATH_MAX + 1];
+		build_path(dst_full, sizeof(dst_full), args->path, dst);
+
+		/* Conflicts and renames are handled on per-file basis. */
+		if(!args->is_in_trash[i] &&
+				strcmp(dst, get_last_path_component(src)) == 0 &&
+				!path_exists(dst_full, NODEREF))
+		{
+			indexes[nsrcs] = i;
+			srcs[nsrcs++] = args->sel_list[i];
+		}
+	}
+
+	bg_op_set_descr(bg_op, args->move ? "moving..." : "copying...");
+	const OPS op = (args->move ? OP_MOVE : OP_COPY);
+	if(ops_batch(op, args->ops, srcs, nsrcs, args->path, results) != 0)
+	{
+		free(results);
+		free(indexes);
+		free(srcs);
+		free(processed);
+		return NULL;
+	}
+
+	/* Files that weren't processed are retried one by one, which also reports
+	 * errors. */
+	int j;
+	for(j = 0; j < nsrcs; ++j)
+	{
+		if(results[j] == OPS_SUCCEEDED)
+		{
+			processed[indexes[j]] = 1;
+			++bg_op->done;
+		}
+	}
+
+	free(results);
+	free(indexes);
+	free(srcs);
+	return processed;
+}
+
 /* Sets nice title for the background job. */
 static void
 set_cpmv_bg_descr(bg_op_t *bg_op, bg_args_t *args, size_t i)
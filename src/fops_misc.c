@@ -26,6 +26,7 @@
 
 #include "cfg/config.h"
 #include "compat/os.h"
+#include "compat/reallocarray.h"
 #include "modes/dialogs/msg_dialog.h"
 #include "ui/cancellation.h"
 #include "ui/fileview.h"
@@ -63,10 +64,12 @@ typedef struct
 }
 verify_args_t;
 
+static int delete_marked_at_once(view_t *view, ops_t *ops);
 static int delete_file(dir_entry_t *entry, ops_t *ops, int reg, int use_trash,
 		int nested);
 static const char * get_top_dir(const view_t *view);
 static void delete_files_in_bg(bg_op_t *bg_op, void *arg);
+static int delete_files_in_bg_at_once(bg_op_t *bg_op, bg_args_t *args);
 static void delete_file_in_bg(ops_t *ops, const char path[], int use_trash);
 static int prepare_register(int reg);
 static char ** list_files_to_retarget(view_t *view, int *len);
@@ -162,9 +165,11 @@ fops_delete(view_t *view, int reg, int use_trash)
 
 	nmarked_files = fops_enqueue_marked_files(ops, view, NULL, use_trash);
 
+	const int batched = (!use_trash && delete_marked_at_once(view, ops) == 0);
+
 	entry = NULL;
 	i = 0;
-	while(iter_marked_entries(view, &entry) && fops_active(ops))
+	while(!batched && iter_marked_entries(view, &entry) && fops_active(ops))
 	{
 		int result;
 
@@ -219,6 +224,68 @@ fops_delete_entry(ops_t *ops, view_t *view, dir_entry_t *entry, int use_trash,
 	(void)delete_file(entry, ops, BLACKHOLE_REG_NAME, use_trash, nested);
 }
 
+/* Permanently removes marked files by as few invocations of an external
+ * command as possible.  Returns zero if files were processed, otherwise
+ * non-zero is returned and they should be removed one by one. */
+static int
+delete_marked_at_once(view_t *view, ops_t *ops)
+{
+	char **paths = NULL;
+	int npaths = 0;
+
+	dir_entry_t *entry = NULL;
+	while(iter_marked_entries(view, &entry))
+	{
+		char full_path[PATH_MAX + 1];
+		get_full_path_of(entry, sizeof(full_path), full_path);
+		if(add_to_string_array(&paths, npaths, full_path) != npaths + 1)
+		{
+			free_string_array(paths, npaths);
+			return 1;
+		}
+		++npaths;
+	}
+
+	OpsResult *results = reallocarray(NULL, npaths, sizeof(*results));
+	if(results == NULL)
+	{
+		free_string_array(paths, npaths);
+		return 1;
+	}
+
+	fops_progress_msg("Deleting files", 0, npaths);
+	if(ops_batch(OP_REMOVE, ops, paths, npaths, NULL, results) != 0)
+	{
+		free(results);
+		free_string_array(paths, npaths);
+		return 1;
+	}
+
+	int i = 0;
+	entry = NULL;
+	while(iter_marked_entries(view, &entry))
+	{
+		const int succeeded = (results[i] == OPS_SUCCEEDED);
+		if(succeeded)
+		{
+			un_group_add_op(OP_REMOVE, NULL, NULL, paths[i], "");
+
+			if(entry_to_pos(view, entry) == view->list_pos &&
+					view->list_pos + 1 < view->list_rows)
+			{
+				++view->list_pos;
+			}
+		}
+
+		ops_advance(ops, succeeded);
+		++i;
+	}
+
+	free(results);
+	free_string_array(paths, npaths);
+	return 0;
+}
+
 /* Removes single file specified by its entry.  Returns zero on success,
  * otherwise non-zero is returned. */
 static int
@@ -414,17 +481,47 @@ delete_files_in_bg(bg_op_t *bg_op, void *arg)
 		}
 	}
 
-	for(i = 0U; i < args->sel_list_len; ++i)
+	if(args->use_trash || delete_files_in_bg_at_once(bg_op, args) != 0)
 	{
-		const char *const src = args->sel_list[i];
-		bg_op_set_descr(bg_op, src);
-		delete_file_in_bg(ops, src, args->use_trash);
-		++bg_op->done;
+		for(i = 0U; i < args->sel_list_len; ++i)
+		{
+			const char *const src = args->sel_list[i];
+			bg_op_set_descr(bg_op, src);
+			delete_file_in_bg(ops, src, args->use_trash);
+			++bg_op->done;
+		}
 	}
 
 	fops_free_bg_args(args);
 }
 
+/* Permanently removes files of a background task by as few invocations of an
+ * external command as possible.  Returns zero if files were processed,
+ * otherwise non-zero is returned and they should be removed one by one. */
+static int
+delete_files_in_bg_at_once(bg_op_t *bg_op, bg_args_t *args)
+{
+	OpsResult *results = reallocarray(NULL, args->sel_list_len,
+			sizeof(*results));
+	if(results == NULL)
+	{
+		return 1;
+	}
+
+	bg_op_set_descr(bg_op, "deleting...");
+	if(ops_batch(OP_REMOVE, args->ops, args->sel_list, args->sel_list_len, NULL,
+				results) != 0)
+	{
+		free(results);
+		return 1;
+	}
+
+	bg_op->done += args->sel_list_len;
+
+	free(results);
+	return 0;
+}
+
 /* Actual implementation of background file removal. */
 static void
 delete_file_in_bg(ops_t *ops, const char path[], int use_trash)
@@ -28,6 +28,7 @@
 #include "compat/os.h"
 #include "compat/reallocarray.h"
 #include "engine/text_buffer.h"
+#include "io/ior.h"
 #include "modes/dialogs/msg_dialog.h"
 #include "modes/modes.h"
 #include "modes/wk.h"
@@ -1030,6 +1031,7 @@ prompt_what_to_do(const char fname[], const char caused_by[])
 		skip           = { .key = 's', .descr = "[s]kip /" },
 		skip_all       = { .key = 'S', .descr = " [S]kip all\n" },
 		append         = { .key = 'a', .descr = "[a]ppend the tail\n" },
+		resume         = { .key = 'c', .descr = "[c]ontinue interrupted copy\n" },
 		overwrite      = { .key = 'o', .descr = "[o]verwrite /" },
 		overwrite_all  = { .key = 'O', .descr = " [O]verwrite all\n" },
 		merge          = { .key = 'm', .descr = "[m]erge /" },
@@ -1038,7 +1040,7 @@ prompt_what_to_do(const char fname[], const char caused_by[])
 		escape         = { .key = NC_C_c, .descr = "\n   Esc or Ctrl-C to abort" };
 
 	/* Last element is a terminator. */
-	response_variant responses[12] = {};
+	response_variant responses[13] = {};
 	size_t i = 0;
 
 	char dst_buf[PATH_MAX + 1];
@@ -1058,6 +1060,11 @@ prompt_what_to_do(const char fname[], const char caused_by[])
 		{
 			responses[i++] = append;
 		}
+		else if(cfg.use_system_calls && put_confirm.allow_merge &&
+				ior_can_resume(caused_by, dst_buf))
+		{
+			responses[i++] = resume;
+		}
 		responses[i++] = overwrite;
 		responses[i++] = overwrite_all;
 		if(put_confirm.allow_merge)
@@ -1139,6 +1146,13 @@ handle_prompt_response(const char fname[], const char caused_by[],
 		put_confirm.append = 1;
 		put_continue(0);
 	}
+	else if(response == 'c' && cfg.use_system_calls &&
+			ior_can_resume(caused_by, dst_path))
+	{
+		/* Appending to a directory continues copying of its files. */
+		put_confirm.append = 1;
+		put_continue(0);
+	}
 	else if(response == 'O')
 	{
 		put_confirm.overwrite_all = 1;
@@ -19,19 +19,27 @@
 
 #include "instance.h"
 
+#include <stddef.h> /* NULL size_t */
+#include <stdlib.h> /* free() */
+
 #include "cfg/config.h"
 #include "engine/autocmds.h"
 #include "engine/cmds.h"
 #include "engine/keys.h"
 #include "engine/options.h"
+#include "engine/parsing.h"
+#include "engine/var.h"
 #include "engine/variables.h"
 #include "int/path_env.h"
 #include "lua/vlua.h"
+#include "modes/modes.h"
 #include "ui/tabs.h"
 #include "ui/ui.h"
+#include "utils/parson.h"
 #include "utils/str.h"
 #include "utils/utils.h"
 #include "bmarks.h"
+#include "cmd_core.h"
 #include "dir_stack.h"
 #include "filelist.h"
 #include "flist_hist.h"
@@ -157,5 +165,82 @@ instance_finish_restart(void)
 	update_screen(UT_REDRAW);
 }
 
+char *
+instance_eval_expr(const char expr[])
+{
+	parsing_result_t result = vle_parser_eval(expr, /*interactive=*/1);
+	if(result.error != PE_NO_ERROR)
+	{
+		var_free(result.value);
+		return NULL;
+	}
+
+	char *result_str = var_to_str(result.value);
+	var_free(result.value);
+	return result_str;
+}
+
+char *
+instance_exec_batch(const char batch[])
+{
+	JSON_Value *input = json_parse_string(batch);
+	JSON_Array *requests = json_array(input);
+	if(requests == NULL)
+	{
+		json_value_free(input);
+		return NULL;
+	}
+
+	JSON_Value *output = json_value_init_array();
+	JSON_Array *results = json_array(output);
+
+	modes_abort_menu_like();
+	stats_silence_ui(1);
+
+	size_t i;
+	const size_t count = json_array_get_count(requests);
+	for(i = 0U; i < count; ++i)
+	{
+		JSON_Object *request = json_array_get_object(requests, i);
+		const char *cmd = json_object_get_string(request, "cmd");
+		const char *expr = json_object_get_string(request, "expr");
+
+		JSON_Value *result = json_value_init_object();
+		JSON_Object *result_obj = json_object(result);
+		json_array_append_value(results, result);
+
+		if(cmd != NULL)
+		{
+			/* Make sure we're executing commands in correct directory. */
+			(void)vifm_chdir(flist_get_dir(curr_view));
+
+			int ret = cmds_dispatch(cmd, curr_view, CIT_COMMAND);
+			json_object_set_boolean(result_obj, "ok", ret >= 0);
+		}
+		else if(expr != NULL)
+		{
+			char *value = instance_eval_expr(expr);
+			json_object_set_boolean(result_obj, "ok", value != NULL);
+			if(value != NULL)
+			{
+				json_object_set_string(result_obj, "result", value);
+				free(value);
+			}
+		}
+		else
+		{
+			json_object_set_boolean(result_obj, "ok", 0);
+		}
+	}
+
+	stats_silence_ui(0);
+	update_screen(stats_update_fetch());
+
+	char *reply = json_serialize_to_string(output);
+	json_value_free(output);
+	json_value_free(input);
+	return reply;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
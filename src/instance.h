@@ -30,6 +30,16 @@ void instance_start_restart(void);
  * calls to instance_start_restart() and this function. */
 void instance_finish_restart(void);
 
+/* Evaluates expression received from a remote instance.  Returns newly
+ * allocated string with the result or NULL on error. */
+char * instance_eval_expr(const char expr[]);
+
+/* Executes batch of commands and expressions received from a remote instance.
+ * The batch is a JSON array of objects with either "cmd" or "expr" key.
+ * Screen is updated once after processing the whole batch.  Returns newly
+ * allocated JSON array of results or NULL if batch is malformed. */
+char * instance_exec_batch(const char batch[]);
+
 #endif /* VIFM__INSTANCE_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
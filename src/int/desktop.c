@@ -22,17 +22,46 @@
 
 #include <dirent.h>
 
-#include <stdio.h> /* snprintf() */
-#include <string.h> /* strstr() strchr() strlen() strcpy() */
+#include <stdio.h> /* remove() snprintf() */
+#include <stdlib.h> /* calloc() free() malloc() */
+#include <string.h> /* strchr() strcmp() strcpy() strdup() strlen() */
 
 #include "../compat/dtype.h"
 #include "../compat/fs_limits.h"
 #include "../compat/os.h"
+#include "../compat/reallocarray.h"
+#include "../utils/filemon.h"
+#include "../utils/fs.h"
+#include "../utils/parson.h"
 #include "../utils/path.h"
 #include "../utils/str.h"
+#include "../utils/string_array.h"
+#include "../utils/trie.h"
 #include "../utils/utils.h"
 #include "../filetype.h"
 
+/* Directory or .desktop file which was read to populate the database. */
+typedef struct
+{
+	char *path;    /* Path to the file. */
+	int exists;    /* Whether the file existed. */
+	filemon_t mon; /* Modification time of the file. */
+}
+desktop_path_t;
+
+/* Database of handlers found in .desktop files. */
+struct desktop_db_t
+{
+	char *root;            /* Root of the directory tree. */
+	char *cache;           /* File to store the database in or NULL. */
+	trie_t *handlers;      /* Maps MIME type to assoc_records_t. */
+	char **types;          /* MIME types which have handlers. */
+	int ntypes;            /* Number of elements in types array. */
+	desktop_path_t *paths; /* Directories and files which were read. */
+	int npaths;            /* Number of elements in paths array. */
+	int built;             /* Whether database was populated. */
+};
+
 static const char EXEC_KEY[] = "Exec=";
 static const char MIMETYPE_KEY[] = "MimeType=";
 static const char NAME_KEY[] = "Name=";
@@ -40,28 +69,442 @@ static const char NAME_KEY[] = "Name=";
 static const char CAPTION_MACRO = 'c';
 static const char FILE_MACROS[] = "Uuf";
 
-static void parse_desktop_files_internal(const char path[],
-		const char mime_type[], assoc_records_t *result);
-static void process_file(const char *path, const char *file_mime_type,
-		assoc_records_t *result);
+static void free_handlers(void *ptr);
+static int is_db_stale(const desktop_db_t *db);
+static void reset_db(desktop_db_t *db);
+static void build_db(desktop_db_t *db);
+static void load_db(desktop_db_t *db);
+static int load_paths(desktop_db_t *db, const JSON_Array *paths);
+static int load_handlers(desktop_db_t *db, const JSON_Object *handlers);
+static void save_db(const desktop_db_t *db);
+static JSON_Value * store_paths(const desktop_db_t *db);
+static JSON_Value * store_handlers(const desktop_db_t *db);
+static void read_dir(desktop_db_t *db, const char path[]);
+static void add_path(desktop_db_t *db, const char path[],
+		const filemon_t *mon);
+static void process_file(desktop_db_t *db, const char path[]);
+static void add_handler(desktop_db_t *db, const char mime_type[],
+		const char command[], const char name[]);
 static void expand_desktop(const char *str, char *buf);
 
-assoc_records_t
-parse_desktop_files(const char *path, const char *mime_type)
+desktop_db_t *
+desktop_db_alloc(const char root[], const char cache[])
 {
-	assoc_records_t result = {};
-	parse_desktop_files_internal(path, mime_type, &result);
-	return result;
+	desktop_db_t *const db = calloc(1, sizeof(*db));
+	if(db == NULL)
+	{
+		return NULL;
+	}
+
+	db->root = strdup(root);
+	db->cache = (cache == NULL ? NULL : strdup(cache));
+	if(db->root == NULL || (cache != NULL && db->cache == NULL))
+	{
+		free(db->root);
+		free(db->cache);
+		free(db);
+		return NULL;
+	}
+
+	return db;
 }
 
-static void
-parse_desktop_files_internal(const char path[], const char mime_type[],
+void
+desktop_db_free(desktop_db_t *db)
+{
+	if(db != NULL)
+	{
+		reset_db(db);
+		free(db->root);
+		free(db->cache);
+		free(db);
+	}
+}
+
+const char *
+desktop_db_root(const desktop_db_t *db)
+{
+	return db->root;
+}
+
+void
+desktop_db_find(desktop_db_t *db, const char mime_type[],
 		assoc_records_t *result)
+{
+	if(!db->built && db->cache != NULL)
+	{
+		load_db(db);
+	}
+
+	if(is_db_stale(db))
+	{
+		build_db(db);
+		if(db->cache != NULL)
+		{
+			save_db(db);
+		}
+	}
+
+	void *data;
+	if(trie_get(db->handlers, mime_type, &data) == 0)
+	{
+		ft_assoc_record_add_all(result, data);
+	}
+}
+
+/* Frees assoc_records_t stored in the trie.  ptr can be NULL. */
+static void
+free_handlers(void *ptr)
+{
+	assoc_records_t *const handlers = ptr;
+	if(handlers != NULL)
+	{
+		ft_assoc_records_free(handlers);
+		free(handlers);
+	}
+}
+
+/* Checks whether database doesn't reflect state of the file system.  Only
+ * modification times of directories and .desktop files are checked.  Returns
+ * non-zero if so, otherwise zero is returned. */
+static int
+is_db_stale(const desktop_db_t *db)
+{
+	if(!db->built)
+	{
+		return 1;
+	}
+
+	int i;
+	for(i = 0; i < db->npaths; ++i)
+	{
+		const desktop_path_t *const entry = &db->paths[i];
+
+		filemon_t mon;
+		const int exists =
+			(filemon_from_file(entry->path, FMT_MODIFIED, &mon) == 0);
+		if(exists != entry->exists ||
+				(exists && !filemon_equal(&mon, &entry->mon)))
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Empties the database. */
+static void
+reset_db(desktop_db_t *db)
+{
+	trie_free(db->handlers);
+	db->handlers = NULL;
+
+	int i;
+	for(i = 0; i < db->npaths; ++i)
+	{
+		free(db->paths[i].path);
+	}
+	free(db->paths);
+	db->paths = NULL;
+	db->npaths = 0;
+
+	free_string_array(db->types, db->ntypes);
+	db->types = NULL;
+	db->ntypes = 0;
+
+	db->built = 0;
+}
+
+/* Populates the database by reading .desktop files. */
+static void
+build_db(desktop_db_t *db)
+{
+	reset_db(db);
+
+	db->handlers = trie_create(&free_handlers);
+	if(db->handlers == NULL)
+	{
+		return;
+	}
+
+	read_dir(db, db->root);
+	db->built = 1;
+}
+
+/* Populates the database from its cache file.  The result still needs to be
+ * checked for being up to date. */
+static void
+load_db(desktop_db_t *db)
+{
+	JSON_Value *const value = json_parse_file(db->cache);
+	const JSON_Object *const root = json_object(value);
+
+	const char *const path = json_object_get_string(root, "root");
+	const JSON_Array *const paths = json_object_get_array(root, "paths");
+	const JSON_Object *const handlers = json_object_get_object(root, "handlers");
+	if(path == NULL || strcmp(path, db->root) != 0 || paths == NULL ||
+			handlers == NULL)
+	{
+		json_value_free(value);
+		return;
+	}
+
+	reset_db(db);
+
+	db->handlers = trie_create(&free_handlers);
+	if(db->handlers == NULL)
+	{
+		json_value_free(value);
+		return;
+	}
+
+	if(load_paths(db, paths) == 0 && load_handlers(db, handlers) == 0)
+	{
+		db->built = 1;
+	}
+	else
+	{
+		reset_db(db);
+	}
+
+	json_value_free(value);
+}
+
+/* Loads states of directories and files from their cache entries.  Returns
+ * zero on success, otherwise non-zero is returned. */
+static int
+load_paths(desktop_db_t *db, const JSON_Array *paths)
+{
+	int i;
+	const int n = json_array_get_count(paths);
+	for(i = 0; i < n; ++i)
+	{
+		const JSON_Object *const entry = json_array_get_object(paths, i);
+		const char *const path = json_object_get_string(entry, "path");
+		if(path == NULL)
+		{
+			return 1;
+		}
+
+		/* Missing timestamp means that the file didn't exist. */
+		const char *const mon_str = json_object_get_string(entry, "mon");
+		if(mon_str == NULL)
+		{
+			add_path(db, path, NULL);
+			continue;
+		}
+
+		filemon_t mon;
+		if(filemon_from_str(mon_str, &mon) != 0)
+		{
+			return 1;
+		}
+		add_path(db, path, &mon);
+	}
+
+	return (db->npaths == n ? 0 : 1);
+}
+
+/* Loads handlers from their cache entries.  Returns zero on success, otherwise
+ * non-zero is returned. */
+static int
+load_handlers(desktop_db_t *db, const JSON_Object *handlers)
+{
+	int i;
+	const int ntypes = json_object_get_count(handlers);
+	for(i = 0; i < ntypes; ++i)
+	{
+		const char *const type = json_object_get_name(handlers, i);
+		const JSON_Array *const list = json_object_get_array(handlers, type);
+		if(list == NULL)
+		{
+			return 1;
+		}
+
+		int j;
+		const int n = json_array_get_count(list);
+		for(j = 0; j < n; ++j)
+		{
+			const JSON_Object *const handler = json_array_get_object(list, j);
+			const char *const cmd = json_object_get_string(handler, "cmd");
+			const char *const descr = json_object_get_string(handler, "descr");
+			if(cmd == NULL || descr == NULL)
+			{
+				return 1;
+			}
+			add_handler(db, type, cmd, descr);
+		}
+	}
+
+	return 0;
+}
+
+/* Stores the database in its cache file.  The file is replaced atomically to
+ * not expose partially written file to other instances. */
+static void
+save_db(const desktop_db_t *db)
+{
+	JSON_Value *const value = json_value_init_object();
+	JSON_Object *const root = json_object(value);
+	if(root == NULL)
+	{
+		json_value_free(value);
+		return;
+	}
+
+	if(json_object_set_string(root, "root", db->root) != JSONSuccess)
+	{
+		json_value_free(value);
+		return;
+	}
+
+	JSON_Value *const paths = store_paths(db);
+	if(paths == NULL ||
+			json_object_set_value(root, "paths", paths) != JSONSuccess)
+	{
+		json_value_free(paths);
+		json_value_free(value);
+		return;
+	}
+
+	JSON_Value *const handlers = store_handlers(db);
+	if(handlers == NULL ||
+			json_object_set_value(root, "handlers", handlers) != JSONSuccess)
+	{
+		json_value_free(handlers);
+		json_value_free(value);
+		return;
+	}
+
+	char tmp_file[PATH_MAX + 32];
+	snprintf(tmp_file, sizeof(tmp_file), "%s_%u", db->cache, get_pid());
+
+	if(json_serialize_to_file(value, tmp_file) != JSONSuccess ||
+			rename_file(tmp_file, db->cache) != 0)
+	{
+		(void)remove(tmp_file);
+	}
+
+	json_value_free(value);
+}
+
+/* Makes cache entries for states of directories and files.  Returns the
+ * entries or NULL on error. */
+static JSON_Value *
+store_paths(const desktop_db_t *db)
+{
+	JSON_Value *const value = json_value_init_array();
+	JSON_Array *const paths = json_array(value);
+	if(paths == NULL)
+	{
+		json_value_free(value);
+		return NULL;
+	}
+
+	int i;
+	for(i = 0; i < db->npaths; ++i)
+	{
+		JSON_Value *const entry_value = json_value_init_object();
+		JSON_Object *const entry = json_object(entry_value);
+		if(entry == NULL)
+		{
+			json_value_free(value);
+			return NULL;
+		}
+
+		const desktop_path_t *const p = &db->paths[i];
+		int failed =
+			(json_object_set_string(entry, "path", p->path) != JSONSuccess);
+		if(!failed && p->exists)
+		{
+			char *const mon = filemon_to_str(&p->mon);
+			failed = (mon == NULL ||
+					json_object_set_string(entry, "mon", mon) != JSONSuccess);
+			free(mon);
+		}
+
+		if(failed || json_array_append_value(paths, entry_value) != JSONSuccess)
+		{
+			json_value_free(entry_value);
+			json_value_free(value);
+			return NULL;
+		}
+	}
+
+	return value;
+}
+
+/* Makes cache entries for handlers of MIME types.  Returns the entries or NULL
+ * on error. */
+static JSON_Value *
+store_handlers(const desktop_db_t *db)
+{
+	JSON_Value *const value = json_value_init_object();
+	JSON_Object *const handlers = json_object(value);
+	if(handlers == NULL)
+	{
+		json_value_free(value);
+		return NULL;
+	}
+
+	int i;
+	for(i = 0; i < db->ntypes; ++i)
+	{
+		void *data;
+		if(trie_get(db->handlers, db->types[i], &data) != 0)
+		{
+			continue;
+		}
+
+		const assoc_records_t *const records = data;
+		JSON_Value *const list_value = json_value_init_array();
+		JSON_Array *const list = json_array(list_value);
+		if(list == NULL ||
+				json_object_set_value(handlers, db->types[i], list_value)
+				!= JSONSuccess)
+		{
+			json_value_free(list_value);
+			json_value_free(value);
+			return NULL;
+		}
+
+		int j;
+		for(j = 0; j < records->count; ++j)
+		{
+			JSON_Value *const handler_value = json_value_init_object();
+			JSON_Object *const handler = json_object(handler_value);
+			if(handler == NULL ||
+					json_object_set_string(handler, "cmd", records->list[j].command)
+					!= JSONSuccess ||
+					json_object_set_string(handler, "descr",
+						records->list[j].description) != JSONSuccess ||
+					json_array_append_value(list, handler_value) != JSONSuccess)
+			{
+				json_value_free(handler_value);
+				json_value_free(value);
+				return NULL;
+			}
+		}
+	}
+
+	return value;
+}
+
+/* Processes .desktop files of the directory and its subdirectories. */
+static void
+read_dir(desktop_db_t *db, const char path[])
 {
 	DIR *dir;
 	struct dirent *dentry;
 	const char *slash;
 
+	/* Remember timestamp before reading to not miss changes made while the
+	 * directory is being read. */
+	filemon_t mon;
+	const int exists = (filemon_from_file(path, FMT_MODIFIED, &mon) == 0);
+	add_path(db, path, exists ? &mon : NULL);
+
 	if((dir = os_opendir(path)) == NULL)
 	{
 		return;
@@ -82,29 +525,71 @@ parse_desktop_files_internal(const char path[], const char mime_type[],
 				dentry->d_name);
 		if(get_dirent_type(dentry, full_path) == DT_DIR)
 		{
-			parse_desktop_files(full_path, mime_type);
+			read_dir(db, full_path);
 		}
 		else
 		{
-			process_file(full_path, mime_type, result);
+			process_file(db, full_path);
 		}
 	}
 
 	os_closedir(dir);
 }
 
+/* Records state of a directory or a file to be able to detect its changes
+ * later.  NULL mon means that the file doesn't exist. */
 static void
-process_file(const char *path, const char *file_mime_type,
-		assoc_records_t *result)
+add_path(desktop_db_t *db, const char path[], const filemon_t *mon)
+{
+	desktop_path_t *const paths = reallocarray(db->paths, db->npaths + 1,
+			sizeof(*paths));
+	if(paths == NULL)
+	{
+		return;
+	}
+	db->paths = paths;
+
+	desktop_path_t *const entry = &paths[db->npaths];
+	entry->path = strdup(path);
+	if(entry->path == NULL)
+	{
+		return;
+	}
+
+	entry->exists = (mon != NULL);
+	if(mon == NULL)
+	{
+		filemon_reset(&entry->mon);
+	}
+	else
+	{
+		entry->mon = *mon;
+	}
+	++db->npaths;
+}
+
+/* Parses .desktop file and adds its handler to the database for each MIME type
+ * it lists. */
+static void
+process_file(desktop_db_t *db, const char path[])
 {
 	FILE *f;
 	char exec[1024] = "", mime_type[2048] = "", name[2048] = "";
 	char buf[2048];
 
-	if(!ends_with(path, ".desktop") || (f = os_fopen(path, "r")) == NULL)
+	if(!ends_with(path, ".desktop"))
+	{
+		return;
+	}
+
+	/* Files can be changed in place without affecting their directory. */
+	filemon_t mon;
+	if(filemon_from_file(path, FMT_MODIFIED, &mon) != 0 ||
+			(f = os_fopen(path, "r")) == NULL)
 	{
 		return;
 	}
+	add_path(db, path, &mon);
 
 	while(fgets(buf, sizeof(buf), f) != NULL)
 	{
@@ -127,13 +612,56 @@ process_file(const char *path, const char *file_mime_type,
 
 	fclose(f);
 
-	if(strstr(mime_type, file_mime_type) == NULL || exec[0] == '\0')
+	if(exec[0] == '\0')
 	{
 		return;
 	}
 
 	expand_desktop(exec, buf);
-	ft_assoc_record_add(result, buf, name);
+
+	char *type = mime_type;
+	while(type[0] != '\0')
+	{
+		char *const end = until_first(type, ';');
+		const char next = *end;
+		*end = '\0';
+
+		if(type[0] != '\0')
+		{
+			add_handler(db, type, buf, name);
+		}
+
+		type = (next == '\0' ? end : end + 1);
+	}
+}
+
+/* Adds a handler of a MIME type. */
+static void
+add_handler(desktop_db_t *db, const char mime_type[], const char command[],
+		const char name[])
+{
+	void *data;
+	if(trie_get(db->handlers, mime_type, &data) != 0)
+	{
+		/* Trie can't be traversed, so keep track of its keys to be able to store
+		 * the database. */
+		const int ntypes = add_to_string_array(&db->types, db->ntypes, mime_type);
+		if(ntypes == db->ntypes)
+		{
+			return;
+		}
+
+		data = calloc(1, sizeof(assoc_records_t));
+		if(data == NULL || trie_set(db->handlers, mime_type, data) != 0)
+		{
+			free(data);
+			free(db->types[ntypes - 1]);
+			return;
+		}
+		db->ntypes = ntypes;
+	}
+
+	ft_assoc_record_add(data, command, name);
 }
 
 static void
@@ -21,7 +21,30 @@
 
 #include "../filetype.h"
 
-assoc_records_t parse_desktop_files(const char *path, const char *mime_type);
+/* Database of handlers of MIME types listed in .desktop files of a directory
+ * tree.  Files are read on the first lookup and then only if any of the
+ * directories or .desktop files changes.  Database can be stored in a cache
+ * file to be reused by other instances for as long as they stay the same. */
+
+/* Opaque declaration of the database. */
+typedef struct desktop_db_t desktop_db_t;
+
+/* Creates an empty database of .desktop files under the root.  The cache
+ * parameter specifies path to a file for storing the database and can be NULL.
+ * Returns NULL on error. */
+desktop_db_t * desktop_db_alloc(const char root[], const char cache[]);
+
+/* Frees the database.  Freeing NULL is OK. */
+void desktop_db_free(desktop_db_t *db);
+
+/* Retrieves root directory of the database.  Returns the path. */
+const char * desktop_db_root(const desktop_db_t *db);
+
+/* Appends handlers of the MIME type to the result.  Rereads .desktop files if
+ * they or their directories have changed since the last time they were read,
+ * in which case cache file is updated. */
+void desktop_db_find(desktop_db_t *db, const char mime_type[],
+		assoc_records_t *result);
 
 #endif /* VIFM__INT__DESKTOP_H__ */
 
@@ -29,16 +29,18 @@
 
 #include <stddef.h> /* size_t */
 #include <stdlib.h> /* free() malloc() */
-#include <stdio.h> /* popen() */
-#include <string.h> /* strdup() */
+#include <stdio.h> /* FILE fgets() pclose() popen() */
+#include <string.h> /* strchr() strcmp() strdup() */
 
 #include "../cfg/config.h"
 #include "../compat/fs_limits.h"
 #include "../compat/os.h"
+#include "../compat/reallocarray.h"
 #include "../utils/filemon.h"
 #include "../utils/fsddata.h"
 #include "../utils/path.h"
 #include "../utils/str.h"
+#include "../utils/string_array.h"
 #include "../utils/utils.h"
 #include "../filetype.h"
 #include "../status.h"
@@ -60,10 +62,11 @@ static void update_cache(fsddata_t *cache, const char path[],
 static int get_gtk_mimetype(const char filename[], char buf[], size_t buf_sz);
 static int get_magic_mimetype(const char filename[], char buf[], size_t buf_sz);
 static int get_file_mimetype(const char filename[], char buf[], size_t buf_sz);
+TSTATIC int get_file_mimetypes(char *paths[], int count, char *types[]);
 static assoc_records_t get_handlers(const char mime_type[]);
 #if !defined(_WIN32) && defined(ENABLE_DESKTOP_FILES)
-static void parse_app_dir(const char directory[], const char mime_type[],
-		assoc_records_t *result);
+static void parse_app_dir(desktop_db_t **db, const char directory[],
+		const char cache_name[], const char mime_type[], assoc_records_t *result);
 #endif
 
 assoc_records_t
@@ -112,6 +115,67 @@ get_mimetype(const char file[], int resolve_symlinks)
 	return mimetype;
 }
 
+void
+prefetch_mimetypes(char *paths[], int count)
+{
+	fsddata_t *const mime_cache = get_cache();
+
+	char **pending = NULL;
+	int npending = 0;
+
+	int i;
+	for(i = 0; i < count; ++i)
+	{
+		const char *file = paths[i];
+
+		char target[PATH_MAX + 1];
+		if(os_realpath(file, target) == target)
+		{
+			file = target;
+		}
+
+		filemon_t filemon;
+		cache_data_t *cache_data = NULL;
+		if(lookup_in_cache(mime_cache, file, &filemon, &cache_data))
+		{
+			continue;
+		}
+
+		/* These don't spawn processes and thus gain nothing from batching. */
+		char mimetype[128];
+		if(get_gtk_mimetype(file, mimetype, sizeof(mimetype)) == 0 ||
+				get_magic_mimetype(file, mimetype, sizeof(mimetype)) == 0)
+		{
+			update_cache(mime_cache, file, mimetype, &filemon, cache_data);
+			continue;
+		}
+
+		npending = add_to_string_array(&pending, npending, file);
+	}
+
+	char **types = reallocarray(NULL, npending, sizeof(*types));
+	if(types != NULL && get_file_mimetypes(pending, npending, types) == 0)
+	{
+		for(i = 0; i < npending; ++i)
+		{
+			if(types[i] != NULL)
+			{
+				filemon_t filemon;
+				cache_data_t *cache_data = NULL;
+				(void)lookup_in_cache(mime_cache, pending[i], &filemon, &cache_data);
+				update_cache(mime_cache, pending[i], types[i], &filemon, cache_data);
+			}
+		}
+		free_string_array(types, npending);
+	}
+	else
+	{
+		free(types);
+	}
+
+	free_string_array(pending, npending);
+}
+
 /* Retrieves mime-type cache, creating it on first call.  Returns the cache. */
 static fsddata_t *
 get_cache(void)
@@ -278,6 +342,98 @@ get_file_mimetype(const char filename[], char buf[], size_t buf_sz)
 #endif /* #ifdef HAVE_FILE_PROG */
 }
 
+/* Determines mime types of many files by running file command for groups of
+ * them.  Each element of types array is set to a newly allocated string or to
+ * NULL if type of corresponding file wasn't determined.  Output of the command
+ * is matched with files by lines, so files with new line characters in their
+ * names are skipped.  Returns zero on success, otherwise non-zero is returned
+ * and elements of types shouldn't be freed. */
+TSTATIC int
+get_file_mimetypes(char *paths[], int count, char *types[])
+{
+#ifdef HAVE_FILE_PROG
+	/* Limit on length of a command to stay well below system limits. */
+	enum { MAX_CMD_LEN = 16*1024 };
+
+	const ShellType shell_type = (get_env_type() == ET_UNIX ? ST_POSIX : ST_CMD);
+
+	int i;
+	for(i = 0; i < count; ++i)
+	{
+		types[i] = NULL;
+	}
+
+	i = 0;
+	while(i < count)
+	{
+		char *command = strdup("file -b --mime-type");
+		size_t len = (command == NULL ? 0U : strlen(command));
+
+		const int first = i;
+		int nargs = 0;
+		while(command != NULL && i < count && (i == first || len < MAX_CMD_LEN))
+		{
+			if(strchr(paths[i], '\n') != NULL)
+			{
+				++i;
+				continue;
+			}
+
+			char *const escaped = shell_arg_escape(paths[i], shell_type);
+			if(escaped == NULL || strappendch(&command, &len, ' ') != 0 ||
+					strappend(&command, &len, escaped) != 0)
+			{
+				free(escaped);
+				free(command);
+				command = NULL;
+				break;
+			}
+			free(escaped);
+			++nargs;
+			++i;
+		}
+
+		if(command != NULL && nargs == 0)
+		{
+			free(command);
+			continue;
+		}
+
+		FILE *pipe;
+		if(command == NULL || (pipe = popen(command, "r")) == NULL)
+		{
+			free(command);
+			free_strings(types, count);
+			return 1;
+		}
+		free(command);
+
+		int j;
+		for(j = first; j < i; ++j)
+		{
+			if(strchr(paths[j], '\n') != NULL)
+			{
+				continue;
+			}
+
+			char buf[128];
+			if(fgets(buf, sizeof(buf), pipe) != buf)
+			{
+				break;
+			}
+			chomp(buf);
+			types[j] = strdup(buf);
+		}
+
+		pclose(pipe);
+	}
+
+	return 0;
+#else /* #ifdef HAVE_FILE_PROG */
+	return 1;
+#endif /* #ifdef HAVE_FILE_PROG */
+}
+
 static assoc_records_t
 get_handlers(const char mime_type[])
 {
@@ -290,8 +446,13 @@ get_handlers(const char mime_type[])
 	}
 
 #if !defined(_WIN32) && defined(ENABLE_DESKTOP_FILES)
-	parse_app_dir("/usr/share/applications", mime_type, &handlers);
-	parse_app_dir("/usr/local/share/applications", mime_type, &handlers);
+	/* Databases of system, local and user's applications. */
+	static desktop_db_t *dbs[3];
+
+	parse_app_dir(&dbs[0], "/usr/share/applications", "desktop-system.json",
+			mime_type, &handlers);
+	parse_app_dir(&dbs[1], "/usr/local/share/applications", "desktop-local.json",
+			mime_type, &handlers);
 
 	char local_dir[PATH_MAX + 1];
 	const char *xdg_data_home = getenv("XDG_DATA_HOME");
@@ -304,20 +465,40 @@ get_handlers(const char mime_type[])
 	{
 		build_path(local_dir, sizeof(local_dir), xdg_data_home, "applications");
 	}
-	parse_app_dir(local_dir, mime_type, &handlers);
+	parse_app_dir(&dbs[2], local_dir, "desktop-user.json", mime_type, &handlers);
 #endif
 
 	return handlers;
 }
 
 #if !defined(_WIN32) && defined(ENABLE_DESKTOP_FILES)
+/* Looks up handlers of the MIME type in .desktop files of the directory using
+ * database which is (re)created if it's missing or is for another directory.
+ * The database is cached in a file of configuration directory. */
 static void
-parse_app_dir(const char directory[], const char mime_type[],
-		assoc_records_t *result)
+parse_app_dir(desktop_db_t **db, const char directory[],
+		const char cache_name[], const char mime_type[], assoc_records_t *result)
 {
-	assoc_records_t desktop_assocs = parse_desktop_files(directory, mime_type);
-	ft_assoc_record_add_all(result, &desktop_assocs);
-	ft_assoc_records_free(&desktop_assocs);
+	if(*db != NULL && strcmp(desktop_db_root(*db), directory) != 0)
+	{
+		desktop_db_free(*db);
+		*db = NULL;
+	}
+
+	if(*db == NULL)
+	{
+		char cache[PATH_MAX + 1];
+		build_path(cache, sizeof(cache), cfg.config_dir, cache_name);
+
+		*db = desktop_db_alloc(directory,
+				cfg.config_dir[0] == '\0' ? NULL : cache);
+		if(*db == NULL)
+		{
+			return;
+		}
+	}
+
+	desktop_db_find(*db, mime_type, result);
 }
 #endif
 
@@ -19,6 +19,7 @@
 #ifndef VIFM__INT__FILE_MAGIC_H__
 #define VIFM__INT__FILE_MAGIC_H__
 
+#include "../utils/test_helpers.h"
 #include "../filetype.h"
 
 /* Retrieves mime type of the file specified by its path.  The resolve_symlinks
@@ -26,10 +27,19 @@
  * Returns pointer to a statically allocated buffer. */
 const char * get_mimetype(const char file[], int resolve_symlinks);
 
+/* Determines mime types of multiple files at once (targets of symbolic links
+ * are examined) and caches them for get_mimetype().  Types of files that are
+ * already in the cache are not determined again. */
+void prefetch_mimetypes(char *paths[], int count);
+
 /* Retrieves system-wide desktop file associations.  Caller shouldn't free
  * anything. */
 assoc_records_t get_magic_handlers(const char file[]);
 
+TSTATIC_DEFS(
+	int get_file_mimetypes(char *paths[], int count, char *types[]);
+)
+
 #endif /* VIFM__INT__FILE_MAGIC_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -19,8 +19,9 @@
 #include "path_env.h"
 
 #include <stdio.h> /* snprintf() sprintf() */
-#include <stdlib.h> /* malloc() free() */
+#include <stdlib.h> /* bsearch() calloc() malloc() free() */
 #include <string.h> /* strchr() strlen() */
+#include <time.h> /* time_t time() */
 
 #include "../cfg/config.h"
 #include "../compat/dtype.h"
@@ -29,20 +30,42 @@
 #include "../compat/reallocarray.h"
 #include "../engine/variables.h"
 #include "../utils/env.h"
+#include "../utils/filemon.h"
 #include "../utils/fs.h"
 #include "../utils/path.h"
 #include "../utils/str.h"
 #include "../utils/string_array.h"
+#include "../utils/utils.h"
+
+/* Cached listing of a directory of PATH. */
+typedef struct
+{
+	char **names;      /* Sorted names of entries of the directory. */
+	int count;         /* Number of elements in names array. */
+	int listed;        /* Whether names contains listing of the directory. */
+	filemon_t mon;     /* Modification time of the directory when it was
+	                      listed. */
+	time_t checked_at; /* Last time when mon was compared against directory's
+	                      modification time. */
+}
+path_dir_t;
 
 static int path_env_was_changed(int force);
 static void append_scripts_dirs(void);
 static void add_dirs_to_path(const char *path);
 static void add_to_path(const char *path);
 static void split_path_list(void);
+static void reset_dirs(void);
+static path_dir_t * get_listed_dir(size_t i);
+static int list_dir(const char path[], path_dir_t *dir);
 
 static char **paths;
 static int paths_count;
 
+/* Cached listings of directories of paths array. */
+static path_dir_t *dirs;
+static int dirs_count;
+
 static char *clean_path;
 static char *real_path;
 
@@ -61,7 +84,34 @@ update_path_env(int force)
 	{
 		append_scripts_dirs();
 		split_path_list();
+		reset_dirs();
+	}
+}
+
+int
+path_may_have_file(size_t i, const char name[])
+{
+	const path_dir_t *const dir = get_listed_dir(i);
+	if(dir == NULL || strchr(name, '/') != NULL)
+	{
+		return 1;
+	}
+
+	return bsearch(&name, dir->names, dir->count, sizeof(dir->names[0]),
+			&strsorter) != NULL;
+}
+
+char **
+get_path_files(size_t i, int *count)
+{
+	const path_dir_t *const dir = get_listed_dir(i);
+	if(dir == NULL)
+	{
+		return NULL;
 	}
+
+	*count = dir->count;
+	return dir->names;
 }
 
 /* Checks if PATH environment variable was changed. Returns non-zero if path was
@@ -241,6 +291,101 @@ split_path_list(void)
 	paths_count = i;
 }
 
+/* Drops cached listings of directories and allocates empty ones for the current
+ * list of paths. */
+static void
+reset_dirs(void)
+{
+	int i;
+	for(i = 0; i < dirs_count; ++i)
+	{
+		free_string_array(dirs[i].names, dirs[i].count);
+	}
+	free(dirs);
+
+	dirs = calloc(paths_count, sizeof(*dirs));
+	dirs_count = (dirs == NULL ? 0 : paths_count);
+}
+
+/* Retrieves cached listing of i-th directory of PATH making sure it's up to
+ * date.  Modification time of a directory is checked at most once a second.
+ * Returns NULL if directory can't be or isn't listed. */
+static path_dir_t *
+get_listed_dir(size_t i)
+{
+#ifndef _WIN32
+	if(i >= (size_t)dirs_count || !is_path_absolute(paths[i]))
+	{
+		/* Relative paths depend on current directory and are checked directly. */
+		return NULL;
+	}
+
+	path_dir_t *const dir = &dirs[i];
+
+	const time_t now = time(NULL);
+	if(dir->listed && dir->checked_at == now)
+	{
+		return dir;
+	}
+	dir->checked_at = now;
+
+	filemon_t mon;
+	if(filemon_from_file(paths[i], FMT_MODIFIED, &mon) != 0)
+	{
+		return NULL;
+	}
+
+	if(!dir->listed || !filemon_equal(&mon, &dir->mon))
+	{
+		dir->mon = mon;
+		dir->listed = (list_dir(paths[i], dir) == 0);
+	}
+
+	return (dir->listed ? dir : NULL);
+#else
+	/* Names of executables omit extensions on Windows, so just list of files is
+	 * of no use for lookups. */
+	return NULL;
+#endif
+}
+
+/* Reads names of entries of directory at path into the dir.  Returns zero on
+ * success, otherwise non-zero is returned. */
+static int
+list_dir(const char path[], path_dir_t *dir)
+{
+	free_string_array(dir->names, dir->count);
+	dir->names = NULL;
+	dir->count = 0;
+
+	DIR *const d = os_opendir(path);
+	if(d == NULL)
+	{
+		return 1;
+	}
+
+	struct dirent *dentry;
+	while((dentry = os_readdir(d)) != NULL)
+	{
+		if(is_builtin_dir(dentry->d_name))
+		{
+			continue;
+		}
+
+		int count = add_to_string_array(&dir->names, dir->count, dentry->d_name);
+		if(count == dir->count)
+		{
+			os_closedir(d);
+			return 1;
+		}
+		dir->count = count;
+	}
+	os_closedir(d);
+
+	safe_qsort(dir->names, dir->count, sizeof(dir->names[0]), &strsorter);
+	return 0;
+}
+
 void
 load_clean_path_env(void)
 {
@@ -29,6 +29,19 @@ void update_path_env(int force);
  * the count argument. */
 char ** get_paths(size_t *count);
 
+/* Checks whether i-th directory of the list returned by get_paths() might
+ * contain file named name.  Relies on cached listing of the directory, which
+ * is updated when directory changes.  Returns zero if there is definitely no
+ * such file, otherwise non-zero is returned. */
+int path_may_have_file(size_t i, const char name[]);
+
+/* Retrieves cached listing of i-th directory of the list returned by
+ * get_paths(), which is updated when directory changes.  Returns sorted array
+ * of *count names of all entries (not only executables), which shouldn't be
+ * freed by the caller and is valid until the next call of any function of this
+ * unit, or NULL if directory isn't cached. */
+char ** get_path_files(size_t i, int *count);
+
 /* Sets PATH to its value that was set by user or another program. Use
  * load_real_path_env() function to revert this effect. */
 void load_clean_path_env(void);
@@ -39,7 +39,8 @@ typedef enum
 	IO_CRS_REPLACE_FILES,
 
 	/* Appends the reset of data to files at destination (assumes previously
-	 * terminated operation). */
+	 * terminated operation).  For directories this continues interrupted
+	 * copying skipping files that were copied already. */
 	IO_CRS_APPEND_TO_FILES,
 }
 IoCrs;
@@ -125,6 +126,12 @@ struct io_args_t
 			unsigned int fast_file_cloning : 1;
 			/* Whether to call fdatasync() periodically. */
 			unsigned int data_sync : 1;
+			/* Whether to evict copied data from file-system cache. */
+			unsigned int no_cache : 1;
+			/* Whether to try to bypass file-system cache entirely. */
+			unsigned int direct_io : 1;
+			/* Maximum speed of copying in KiB per second or zero for no limit. */
+			unsigned int rate_limit;
 		};
 	}
 	arg4;
@@ -139,6 +146,10 @@ struct io_args_t
 	/* Set to NULL to do not use estimates. */
 	struct ioeta_estim_t *estim;
 
+	/* Journal of copying a directory, NULL if there is none.  Managed by
+	 * ior_cp(). */
+	struct cpjournal_t *journal;
+
 	/* Output of the operation after it finishes. */
 	io_result_t result;
 };
@@ -23,12 +23,39 @@
 #include <stdint.h> /* uint64_t */
 #include <stdlib.h> /* calloc() free() */
 
+#include "../compat/pthread.h"
+#include "../utils/fs.h"
+#include "../utils/string_array.h"
 #include "private/ioc.h"
 #include "private/ioeta.h"
 #include "private/traverser.h"
 
+/* State of asynchronous estimation. */
+typedef struct ioeta_async_t
+{
+	pthread_mutex_t lock; /* Protects all fields below. */
+	pthread_t thread;     /* Thread that performs estimation. */
+	int started;          /* Whether the thread was started and not joined. */
+	int active;           /* Whether the thread still processes the queue. */
+	int stop;             /* Request for the thread to finish. */
+
+	char **queue;    /* Roots of subtrees to estimate. */
+	int queue_len;   /* Number of elements in the queue. */
+	int queue_next;  /* Index of the next subtree to process. */
+
+	size_t items;   /* Number of found items not yet added to totals. */
+	uint64_t bytes; /* Number of found bytes not yet added to totals. */
+}
+ioeta_async_t;
+
 static VisitResult eta_visitor(const char full_path[], VisitAction action,
 		void *param);
+static ioeta_async_t * async_alloc(void);
+static void async_free(ioeta_async_t *async);
+static int async_start(ioeta_async_t *async);
+static void * async_estimation(void *arg);
+static VisitResult async_visitor(const char full_path[], VisitAction action,
+		void *param);
 
 ioeta_estim_t *
 ioeta_alloc(void *param, io_cancellation_t cancellation)
@@ -49,6 +76,7 @@ ioeta_free(ioeta_estim_t *estim)
 {
 	if(estim != NULL)
 	{
+		async_free(estim->async);
 		ioeta_release(estim);
 		free(estim);
 	}
@@ -67,6 +95,88 @@ ioeta_calculate(ioeta_estim_t *estim, const char path[], int shallow)
 	}
 }
 
+void
+ioeta_calculate_async(ioeta_estim_t *estim, const char path[], int shallow)
+{
+	if(shallow)
+	{
+		ioeta_add_item(estim, path);
+		return;
+	}
+
+	if(estim->async == NULL)
+	{
+		estim->async = async_alloc();
+		if(estim->async == NULL)
+		{
+			ioeta_calculate(estim, path, shallow);
+			return;
+		}
+	}
+
+	ioeta_async_t *const async = estim->async;
+
+	pthread_mutex_lock(&async->lock);
+	int queued = (add_to_string_array(&async->queue, async->queue_len, path)
+	           == async->queue_len + 1);
+	if(queued)
+	{
+		++async->queue_len;
+		if(!async->active && async_start(async) != 0)
+		{
+			free(async->queue[--async->queue_len]);
+			queued = 0;
+		}
+	}
+	pthread_mutex_unlock(&async->lock);
+
+	if(!queued)
+	{
+		ioeta_calculate(estim, path, shallow);
+	}
+}
+
+void
+ioeta_async_merge(ioeta_estim_t *estim)
+{
+	ioeta_async_t *const async = estim->async;
+	if(async == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&async->lock);
+	estim->async_items += async->items;
+	estim->async_bytes += async->bytes;
+	async->items = 0U;
+	async->bytes = 0U;
+	pthread_mutex_unlock(&async->lock);
+
+	ioeta_update_totals(estim);
+}
+
+void
+ioeta_async_wait(ioeta_estim_t *estim)
+{
+	ioeta_async_t *const async = estim->async;
+	if(async == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&async->lock);
+	const int started = async->started;
+	async->started = 0;
+	pthread_mutex_unlock(&async->lock);
+
+	if(started)
+	{
+		(void)pthread_join(async->thread, NULL);
+	}
+
+	ioeta_async_merge(estim);
+}
+
 /* Implementation of traverse() visitor for subtree copying.  Returns 0 on
  * success, otherwise non-zero is returned. */
 static VisitResult
@@ -95,5 +205,126 @@ eta_visitor(const char full_path[], VisitAction action, void *param)
 	return VR_OK;
 }
 
+/* Allocates state of asynchronous estimation.  Returns the state or NULL on
+ * error. */
+static ioeta_async_t *
+async_alloc(void)
+{
+	ioeta_async_t *const async = calloc(1U, sizeof(*async));
+	if(async == NULL)
+	{
+		return NULL;
+	}
+
+	if(pthread_mutex_init(&async->lock, NULL) != 0)
+	{
+		free(async);
+		return NULL;
+	}
+
+	return async;
+}
+
+/* Stops estimation thread and frees the state.  The async can be NULL. */
+static void
+async_free(ioeta_async_t *async)
+{
+	if(async == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&async->lock);
+	async->stop = 1;
+	pthread_mutex_unlock(&async->lock);
+
+	if(async->started)
+	{
+		(void)pthread_join(async->thread, NULL);
+	}
+
+	free_string_array(async->queue, async->queue_len);
+	pthread_mutex_destroy(&async->lock);
+	free(async);
+}
+
+/* Starts estimation thread.  Must be called with the lock held when the thread
+ * isn't active.  Returns zero on success, otherwise non-zero is returned. */
+static int
+async_start(ioeta_async_t *async)
+{
+	if(async->started)
+	{
+		/* Collect previous thread which has finished its work or is about to. */
+		(void)pthread_join(async->thread, NULL);
+		async->started = 0;
+	}
+
+	if(pthread_create(&async->thread, NULL, &async_estimation, async) != 0)
+	{
+		return 1;
+	}
+
+	async->started = 1;
+	async->active = 1;
+	return 0;
+}
+
+/* Entry point of estimation thread.  Processes queued subtrees until queue is
+ * empty or stop is requested.  Returns NULL. */
+static void *
+async_estimation(void *arg)
+{
+	ioeta_async_t *const async = arg;
+
+	while(1)
+	{
+		pthread_mutex_lock(&async->lock);
+		if(async->stop || async->queue_next == async->queue_len)
+		{
+			async->active = 0;
+			pthread_mutex_unlock(&async->lock);
+			break;
+		}
+		char *const path = async->queue[async->queue_next];
+		async->queue[async->queue_next++] = NULL;
+		pthread_mutex_unlock(&async->lock);
+
+		(void)traverse(path, &async_visitor, async);
+		free(path);
+	}
+
+	return NULL;
+}
+
+/* Implementation of traverse() visitor for asynchronous estimation.  Returns 0
+ * on success, otherwise non-zero is returned. */
+static VisitResult
+async_visitor(const char full_path[], VisitAction action, void *param)
+{
+	ioeta_async_t *const async = param;
+
+	uint64_t size = 0U;
+	if(action == VA_FILE && !is_symlink(full_path))
+	{
+		size = get_file_size(full_path);
+	}
+
+	pthread_mutex_lock(&async->lock);
+	const int stop = async->stop;
+	if(action == VA_FILE)
+	{
+		++async->items;
+		async->bytes += size;
+	}
+	pthread_mutex_unlock(&async->lock);
+
+	if(stop)
+	{
+		return VR_CANCELLED;
+	}
+	return (action == VA_DIR_ENTER ? VR_SKIP_DIR_LEAVE : VR_OK);
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
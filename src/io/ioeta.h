@@ -53,6 +53,16 @@ typedef struct ioeta_estim_t
 	/* Number of inspected items. */
 	size_t inspected_items;
 
+	/* Number of items and bytes found by synchronous estimation. */
+	size_t sync_items;
+	uint64_t sync_bytes;
+
+	/* Number of items and bytes found by asynchronous estimation.  Totals are
+	 * sums of results of both estimations unless processing gets ahead of
+	 * them. */
+	size_t async_items;
+	uint64_t async_bytes;
+
 	/* Path to currently processed file. */
 	char *item;
 
@@ -68,6 +78,9 @@ typedef struct ioeta_estim_t
 
 	/* Provides means for cancellation checking. */
 	io_cancellation_t cancellation;
+
+	/* State of asynchronous estimation or NULL. */
+	struct ioeta_async_t *async;
 }
 ioeta_estim_t;
 
@@ -82,6 +95,22 @@ void ioeta_free(ioeta_estim_t *estim);
  * directories. */
 void ioeta_calculate(ioeta_estim_t *estim, const char path[], int shallow);
 
+/* Same as ioeta_calculate(), but deep estimation is performed by a separate
+ * thread while the caller proceeds with processing files.  Results become part
+ * of the estim on its updates or on ioeta_async_merge() call.  Subtrees are
+ * estimated in the order of calls.  Falls back to ioeta_calculate() on errors.
+ * Shallow estimation is always synchronous. */
+void ioeta_calculate_async(ioeta_estim_t *estim, const char path[],
+		int shallow);
+
+/* Adds results of asynchronous estimation found so far to totals of the estim.
+ * Does nothing if there is no asynchronous estimation. */
+void ioeta_async_merge(ioeta_estim_t *estim);
+
+/* Waits for asynchronous estimation to finish and adds its results to totals
+ * of the estim.  Does nothing if there is no asynchronous estimation. */
+void ioeta_async_wait(ioeta_estim_t *estim);
+
 #endif /* VIFM__IO__IOETA_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
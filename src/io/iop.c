@@ -24,18 +24,22 @@
 
 #ifndef _WIN32
 #include <sys/ioctl.h> /* ioctl() */
+#include <fcntl.h> /* F_GETFL F_SETFL O_DIRECT POSIX_FADV_* fcntl()
+                      posix_fadvise() */
 #endif
 #include <sys/stat.h> /* stat */
-#include <sys/types.h> /* mode_t */
-#include <unistd.h> /* symlink() unlink() */
+#include <sys/types.h> /* mode_t off_t ssize_t */
+#include <unistd.h> /* lseek() read() symlink() unlink() usleep() write() */
 
 #include <assert.h> /* assert() */
-#include <errno.h> /* EEXIST ENOENT EISDIR errno */
+#include <errno.h> /* EEXIST EINTR EINVAL ENOENT EISDIR errno */
 #include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* int64_t uint64_t */
 #include <stdio.h> /* FILE fpos_t fclose() fgetpos() fflush() fread() fseek()
                       fsetpos() fwrite() snprintf() */
-#include <stdlib.h> /* free() */
+#include <stdlib.h> /* free() posix_memalign() */
 #include <string.h> /* strchr() */
+#include <time.h> /* CLOCK_MONOTONIC clock_gettime() timespec */
 
 #include "../compat/fs_limits.h"
 #include "../compat/os.h"
@@ -46,6 +50,7 @@
 #include "../utils/str.h"
 #include "../utils/utf8.h"
 #include "../utils/utils.h"
+#include "private/cpjournal.h"
 #include "private/ioc.h"
 #include "private/ioe.h"
 #include "private/ioeta.h"
@@ -57,6 +62,20 @@
 /* Amount of data after which data flush should be performed. */
 #define FLUSH_SIZE 256*1024*1024
 
+/* Amount of data to transfer at once when bypassing file-system cache or
+ * limiting speed of copying. */
+#define UNCACHED_BLOCK_SIZE 1024*1024
+
+/* Alignment of buffers, offsets and sizes for direct I/O. */
+#define DIRECT_IO_ALIGNMENT 4096
+
+/* Amount of data after which it's evicted from file-system cache. */
+#define EVICT_SIZE 8*1024*1024
+
+/* Maximum time to sleep at once while limiting speed of copying so that
+ * cancellation isn't delayed. */
+#define THROTTLE_SLICE_US 100*1000
+
 /* Type of io function used by retry_wrapper(). */
 typedef IoRes (*iop_func)(io_args_t *args);
 
@@ -66,6 +85,14 @@ static IoRes iop_rmfile_internal(io_args_t *args);
 static IoRes iop_rmdir_internal(io_args_t *args);
 static IoRes iop_cp_internal(io_args_t *args);
 static int clone_file(int dst_fd, int src_fd);
+#ifndef _WIN32
+static int copy_uncached(io_args_t *args, int in_fd, int out_fd);
+static int write_all(int fd, const char buf[], size_t len, int *direct);
+static int set_direct_io(int fd, int enable);
+static void evict_range(int fd, off_t *from, off_t to);
+static void throttle(io_args_t *args, const struct timespec *start,
+		uint64_t ncopied, uint64_t rate);
+#endif
 #ifdef _WIN32
 static DWORD CALLBACK win_progress_cb(LARGE_INTEGER total,
 		LARGE_INTEGER transferred, LARGE_INTEGER stream_size,
@@ -546,6 +573,14 @@ iop_cp_internal(io_args_t *args)
 
 	/* TODO: use sendfile() if platform supports it. */
 
+#ifndef _WIN32
+	if(!error && !cloned && (args->arg4.no_cache || args->arg4.direct_io ||
+				args->arg4.rate_limit != 0))
+	{
+		error = copy_uncached(args, fileno(in), fileno(out));
+	}
+	else
+#endif
 	if(!error && !cloned)
 	{
 		char block[BLOCK_SIZE];
@@ -575,11 +610,14 @@ iop_cp_internal(io_args_t *args)
 
 #ifndef _WIN32
 			/* Force flushing data to disk to not pollute RAM with this data too
-			 * much. */
+			 * much.  Buffered data needs to reach the file first. */
 			ncopied += nread;
 			if(data_sync && ncopied >= FLUSH_SIZE)
 			{
-				(void)os_fdatasync(fileno(out));
+				if(fflush(out) == 0 && os_fdatasync(fileno(out)) == 0)
+				{
+					cpjournal_synced(args->journal, dst, ftell(out));
+				}
 				ncopied -= FLUSH_SIZE;
 			}
 #endif
@@ -668,7 +706,234 @@ clone_file(int dst_fd, int src_fd)
 #endif
 }
 
-#ifdef _WIN32
+#ifndef _WIN32
+
+/* Copies contents of a file between descriptors keeping data out of
+ * file-system cache and/or limiting speed of copying as requested by args.
+ * Direct I/O is used only where it's supported and falls back to regular I/O
+ * otherwise.  Returns zero on success, otherwise non-zero is returned. */
+static int
+copy_uncached(io_args_t *args, int in_fd, int out_fd)
+{
+	const uint64_t rate = (uint64_t)args->arg4.rate_limit*1024U;
+	const int no_cache = (args->arg4.no_cache || args->arg4.direct_io);
+
+	/* Appending leaves offsets unaligned. */
+	int direct_in = 0, direct_out = 0;
+	if(args->arg4.direct_io && args->arg3.crs != IO_CRS_APPEND_TO_FILES)
+	{
+		direct_in = (set_direct_io(in_fd, 1) == 0);
+		direct_out = (set_direct_io(out_fd, 1) == 0);
+	}
+
+	/* Smaller blocks make speed more even when it's limited. */
+	size_t block_size = UNCACHED_BLOCK_SIZE;
+	if(rate != 0U && rate/10U < block_size)
+	{
+		block_size = MAX(rate/10U/DIRECT_IO_ALIGNMENT, 1U)*DIRECT_IO_ALIGNMENT;
+	}
+
+	void *buf;
+	if(posix_memalign(&buf, DIRECT_IO_ALIGNMENT, block_size) != 0)
+	{
+		(void)ioe_errlst_append(&args->result.errors, args->arg1.src, ENOMEM,
+				"Failed to allocate memory");
+		return 1;
+	}
+
+	off_t in_off = lseek(in_fd, 0, SEEK_CUR);
+	off_t out_off = lseek(out_fd, 0, SEEK_CUR);
+	in_off = MAX(in_off, 0);
+	out_off = MAX(out_off, 0);
+	off_t in_evicted = in_off, out_evicted = out_off;
+
+	if(no_cache)
+	{
+#if defined(HAVE_POSIX_FADVISE)
+		(void)posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#elif defined(F_NOCACHE)
+		/* There is no posix_fadvise() on OS X, but there is this. */
+		(void)fcntl(in_fd, F_NOCACHE, 1);
+		(void)fcntl(out_fd, F_NOCACHE, 1);
+#endif
+	}
+
+	struct timespec start;
+	(void)clock_gettime(CLOCK_MONOTONIC, &start);
+
+	uint64_t ncopied = 0U, nsynced = 0U;
+	int error = 0;
+	while(1)
+	{
+		if(io_cancelled(args))
+		{
+			error = 1;
+			break;
+		}
+
+		const ssize_t nread = read(in_fd, buf, block_size);
+		if(nread < 0 && errno == EINVAL && direct_in)
+		{
+			/* File or file system doesn't suit direct I/O after all. */
+			(void)set_direct_io(in_fd, 0);
+			direct_in = 0;
+			continue;
+		}
+		if(nread < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if(nread < 0)
+		{
+			(void)ioe_errlst_append(&args->result.errors, args->arg1.src, errno,
+					"Read from source file failed");
+			error = 1;
+			break;
+		}
+		if(nread == 0)
+		{
+			break;
+		}
+
+		if(direct_out && nread%DIRECT_IO_ALIGNMENT != 0)
+		{
+			/* Tail of a file can't be written directly. */
+			(void)set_direct_io(out_fd, 0);
+			direct_out = 0;
+		}
+
+		if(write_all(out_fd, buf, nread, &direct_out) != 0)
+		{
+			(void)ioe_errlst_append(&args->result.errors, args->arg2.dst, errno,
+					"Write to destination file failed");
+			error = 1;
+			break;
+		}
+
+		in_off += nread;
+		out_off += nread;
+		ncopied += nread;
+		ioeta_update(args->estim, NULL, NULL, 0, nread);
+
+		int synced = 0;
+		if(no_cache && out_off - out_evicted >= EVICT_SIZE)
+		{
+			/* Dirty data can't be evicted, so it's written out first. */
+			synced = (os_fdatasync(out_fd) == 0);
+			evict_range(in_fd, &in_evicted, in_off);
+			evict_range(out_fd, &out_evicted, out_off);
+		}
+		else if(args->arg4.data_sync && ncopied - nsynced >= FLUSH_SIZE)
+		{
+			synced = (os_fdatasync(out_fd) == 0);
+			nsynced = ncopied;
+		}
+		if(synced)
+		{
+			cpjournal_synced(args->journal, args->arg2.dst, out_off);
+		}
+
+		if(rate != 0U)
+		{
+			throttle(args, &start, ncopied, rate);
+		}
+	}
+
+	if(no_cache)
+	{
+		(void)os_fdatasync(out_fd);
+		evict_range(in_fd, &in_evicted, in_off);
+		evict_range(out_fd, &out_evicted, out_off);
+	}
+
+	free(buf);
+	return error;
+}
+
+/* Writes whole buffer to a descriptor disabling direct I/O on it if it fails
+ * because of it.  Returns zero on success, otherwise non-zero is returned. */
+static int
+write_all(int fd, const char buf[], size_t len, int *direct)
+{
+	while(len != 0U)
+	{
+		const ssize_t nwritten = write(fd, buf, len);
+		if(nwritten < 0 && errno == EINVAL && *direct)
+		{
+			(void)set_direct_io(fd, 0);
+			*direct = 0;
+			continue;
+		}
+		if(nwritten < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if(nwritten <= 0)
+		{
+			return 1;
+		}
+
+		buf += nwritten;
+		len -= nwritten;
+	}
+	return 0;
+}
+
+/* Enables or disables direct I/O for a descriptor.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+set_direct_io(int fd, int enable)
+{
+#ifdef O_DIRECT
+	const int flags = fcntl(fd, F_GETFL);
+	if(flags == -1)
+	{
+		return 1;
+	}
+	return fcntl(fd, F_SETFL, enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT));
+#else
+	return 1;
+#endif
+}
+
+/* Evicts part of a file that starts at *from and ends at to from file-system
+ * cache.  Updates *from. */
+static void
+evict_range(int fd, off_t *from, off_t to)
+{
+#ifdef HAVE_POSIX_FADVISE
+	if(to > *from)
+	{
+		(void)posix_fadvise(fd, *from, to - *from, POSIX_FADV_DONTNEED);
+	}
+#endif
+	*from = to;
+}
+
+/* Sleeps until average speed of copying drops to the rate (in bytes per
+ * second).  Returns early if operation is cancelled. */
+static void
+throttle(io_args_t *args, const struct timespec *start, uint64_t ncopied,
+		uint64_t rate)
+{
+	const int64_t due_us = ncopied*1000000U/rate;
+	while(!io_cancelled(args))
+	{
+		struct timespec now;
+		(void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+		const int64_t elapsed_us = (int64_t)(now.tv_sec - start->tv_sec)*1000000
+		                         + (now.tv_nsec - start->tv_nsec)/1000;
+		if(elapsed_us >= due_us)
+		{
+			break;
+		}
+
+		usleep(MIN(due_us - elapsed_us, THROTTLE_SLICE_US));
+	}
+}
+
+#else
 
 static DWORD CALLBACK win_progress_cb(LARGE_INTEGER total,
 		LARGE_INTEGER transferred, LARGE_INTEGER stream_size,
@@ -18,11 +18,12 @@
 
 #include "ior.h"
 
-#include <sys/stat.h> /* stat */
-#include <unistd.h> /* unlink() */
+#include <sys/stat.h> /* S_ISDIR() S_ISREG() stat */
+#include <unistd.h> /* truncate() unlink() */
 
 #include <errno.h> /* EEXIST EISDIR ENOTEMPTY EXDEV errno */
 #include <stddef.h> /* NULL */
+#include <stdint.h> /* uint64_t */
 #include <stdio.h> /* remove() snprintf() */
 #include <stdlib.h> /* free() */
 #include <string.h> /* strlen() */
@@ -35,17 +36,32 @@
 #include "../utils/str.h"
 #include "../utils/utils.h"
 #include "../background.h"
+#include "private/cpbatch.h"
+#include "private/cpjournal.h"
 #include "private/ioc.h"
 #include "private/ioe.h"
 #include "private/ioeta.h"
+#include "private/rmtree.h"
 #include "private/traverser.h"
 #include "ioc.h"
 #include "iop.h"
 
+/* State of copying a subtree. */
+typedef struct
+{
+	io_args_t *args;  /* Arguments of the operation. */
+	cpbatch_t *batch; /* Small files waiting to be copied or NULL. */
+}
+cp_state_t;
+
 static VisitResult rm_visitor(const char full_path[], VisitAction action,
 		void *param);
 static VisitResult cp_visitor(const char full_path[], VisitAction action,
 		void *param);
+static int batch_file(cp_state_t *state, const char full_path[],
+		VisitResult *result);
+static int prepare_file_copy(io_args_t *args, const char src[],
+		const char dst[], IoCrs *crs);
 static IoRes mv_by_copy(io_args_t *args, int confirmed);
 static IoRes mv_replacing_all(io_args_t *args);
 static IoRes mv_replacing_files(io_args_t *args);
@@ -54,12 +70,28 @@ static VisitResult mv_visitor(const char full_path[], VisitAction action,
 		void *param);
 static VisitResult cp_mv_visitor(const char full_path[], VisitAction action,
 		void *param, int cp);
+static const char * get_dst_path(const io_args_t *args, const char full_path[],
+		char **free_me);
 static VisitResult vr_from_io_res(IoRes result);
 
 IoRes
 ior_rm(io_args_t *args)
 {
 	const char *const path = args->arg1.path;
+
+#ifndef _WIN32
+	if(!is_symlink(path) && is_dir(path))
+	{
+		const IoRes result = rmtree(args);
+		if(result != IO_RES_FAILED)
+		{
+			return result;
+		}
+		/* Whatever is left is removed in a regular way, which also takes care of
+		 * reporting the error. */
+	}
+#endif
+
 	return traverse(path, &rm_visitor, args);
 }
 
@@ -154,7 +186,36 @@ ior_cp(io_args_t *args)
 		}
 	}
 
-	return traverse(src, &cp_visitor, args);
+	cp_state_t state = { .args = args };
+	/* Small files are copied in batches unless each of them needs special
+	 * treatment.  Periodic syncing doesn't matter for them. */
+	if(args->arg3.crs != IO_CRS_APPEND_TO_FILES &&
+			!args->arg4.fast_file_cloning && !args->arg4.no_cache &&
+			!args->arg4.direct_io && args->arg4.rate_limit == 0)
+	{
+		state.batch = cpbatch_alloc();
+	}
+
+	/* Copying of a directory is journaled to be able to continue it after
+	 * interruption.  There is nothing to continue if copying can't start. */
+	struct stat st;
+	if(os_lstat(src, &st) == 0 && S_ISDIR(st.st_mode) &&
+			(args->arg3.crs != IO_CRS_FAIL || !path_exists(dst, NODEREF)))
+	{
+		args->journal = cpjournal_open(src, dst,
+				args->arg3.crs == IO_CRS_APPEND_TO_FILES);
+	}
+	const int nerrors = args->result.errors.error_count;
+
+	const IoRes result = traverse(src, &cp_visitor, &state);
+	cpbatch_free(state.batch);
+
+	/* Errors ignored by the user leave some files uncopied. */
+	cpjournal_close(args->journal, result == IO_RES_SUCCEEDED &&
+			args->result.errors.error_count == nerrors);
+	args->journal = NULL;
+
+	return result;
 }
 
 /* Implementation of traverse() visitor for subtree copying.  Returns 0 on
@@ -162,7 +223,60 @@ ior_cp(io_args_t *args)
 static VisitResult
 cp_visitor(const char full_path[], VisitAction action, void *param)
 {
-	return cp_mv_visitor(full_path, action, param, 1);
+	cp_state_t *const state = param;
+
+	if(state->batch != NULL)
+	{
+		VisitResult result;
+		if(action == VA_FILE && batch_file(state, full_path, &result))
+		{
+			return result;
+		}
+
+		/* Files must be in place before permissions of a directory are set. */
+		if(action == VA_DIR_LEAVE)
+		{
+			result = vr_from_io_res(cpbatch_flush(state->batch, state->args));
+			if(result != VR_OK)
+			{
+				return result;
+			}
+		}
+	}
+
+	return cp_mv_visitor(full_path, action, state->args, 1);
+}
+
+/* Adds a small regular file to the batch flushing it when it becomes full.
+ * Returns non-zero if the file was handled and *result was set, otherwise zero
+ * is returned and the file should be copied in a regular way. */
+static int
+batch_file(cp_state_t *state, const char full_path[], VisitResult *result)
+{
+	struct stat st;
+	if(os_lstat(full_path, &st) != 0 || !S_ISREG(st.st_mode) ||
+			st.st_size > CPBATCH_MAX_FILE_SIZE)
+	{
+		return 0;
+	}
+
+	char *free_me = NULL;
+	const char *const dst = get_dst_path(state->args, full_path, &free_me);
+	/* The root is processed alone, there is no point in batching it. */
+	const int added = (free_me != NULL &&
+	                   cpbatch_add(state->batch, full_path, dst, &st) == 0);
+	free(free_me);
+	if(!added)
+	{
+		return 0;
+	}
+
+	*result = VR_OK;
+	if(cpbatch_is_full(state->batch))
+	{
+		*result = vr_from_io_res(cpbatch_flush(state->batch, state->args));
+	}
+	return 1;
 }
 
 IoRes
@@ -184,6 +298,12 @@ ior_mv(io_args_t *args)
 
 	if(crs == IO_CRS_APPEND_TO_FILES)
 	{
+		if(!is_file(src) && ior_can_resume(src, dst))
+		{
+			/* Interrupted move of a directory could have been performed only by
+			 * copying.  Journal is required to not remove source by mistake. */
+			return mv_by_copy(args, 0);
+		}
 		if(!is_file(src))
 		{
 			(void)ioe_errlst_append(&args->result.errors, src, EISDIR,
@@ -389,23 +509,20 @@ cp_mv_visitor(const char full_path[], VisitAction action, void *param, int cp)
 	const char *dst_full_path;
 	char *free_me = NULL;
 	VisitResult result = VR_OK;
-	const char *rel_part;
 
 	if(io_cancelled(cp_args))
 	{
 		return VR_CANCELLED;
 	}
 
-	/* TODO: come up with something better than this. */
-	rel_part = full_path + strlen(cp_args->arg1.src);
-	dst_full_path = (rel_part[0] == '\0')
-	              ? cp_args->arg2.dst
-	              : (free_me = join_paths(cp_args->arg2.dst, rel_part));
+	dst_full_path = get_dst_path(cp_args, full_path, &free_me);
 
 	switch(action)
 	{
 		case VA_DIR_ENTER:
-			if(cp_args->arg3.crs != IO_CRS_REPLACE_FILES || !is_dir(dst_full_path))
+			if((cp_args->arg3.crs != IO_CRS_REPLACE_FILES &&
+						cp_args->arg3.crs != IO_CRS_APPEND_TO_FILES) ||
+					!is_dir(dst_full_path))
 			{
 				io_args_t args = {
 					.arg1.path = dst_full_path,
@@ -425,22 +542,38 @@ cp_mv_visitor(const char full_path[], VisitAction action, void *param, int cp)
 			break;
 		case VA_FILE:
 			{
+				IoCrs crs = cp_args->arg3.crs;
+				if(cp && prepare_file_copy(cp_args, full_path, dst_full_path, &crs))
+				{
+					break;
+				}
+
 				io_args_t args = {
 					.arg1.src = full_path,
 					.arg2.dst = dst_full_path,
-					.arg3.crs = cp_args->arg3.crs,
+					.arg3.crs = crs,
 					/* It's safe to always use fast file cloning on moving files. */
 					.arg4.fast_file_cloning = cp ? cp_args->arg4.fast_file_cloning : 1,
 					.arg4.data_sync = cp_args->arg4.data_sync,
+					.arg4.no_cache = cp_args->arg4.no_cache,
+					.arg4.direct_io = cp_args->arg4.direct_io,
+					.arg4.rate_limit = cp_args->arg4.rate_limit,
 
 					.cancellation = cp_args->cancellation,
 					.confirm = cp_args->confirm,
 					.estim = cp_args->estim,
+					.journal = cp_args->journal,
 
 					.result = cp_args->result,
 				};
 
-				result = vr_from_io_res(cp ? iop_cp(&args) : ior_mv(&args));
+				const IoRes io_res = (cp ? iop_cp(&args) : ior_mv(&args));
+				if(cp && io_res == IO_RES_SUCCEEDED)
+				{
+					cpjournal_finished(cp_args->journal, dst_full_path);
+				}
+
+				result = vr_from_io_res(io_res);
 				cp_args->result = args.result;
 				break;
 			}
@@ -488,6 +621,94 @@ cp_mv_visitor(const char full_path[], VisitAction action, void *param, int cp)
 	return result;
 }
 
+/* Records copying of a file in the journal and when continuing interrupted
+ * copying picks conflict resolution strategy for the file.  Returns non-zero
+ * if the file is already copied, otherwise zero is returned. */
+static int
+prepare_file_copy(io_args_t *args, const char src[], const char dst[],
+		IoCrs *crs)
+{
+	struct stat src_st;
+	const int tracked = (os_lstat(src, &src_st) == 0 && S_ISREG(src_st.st_mode));
+
+	if(*crs != IO_CRS_APPEND_TO_FILES)
+	{
+		if(tracked)
+		{
+			cpjournal_started(args->journal, dst, &src_st);
+		}
+		return 0;
+	}
+
+	struct stat dst_st;
+	const int exists = (os_lstat(dst, &dst_st) == 0);
+	if(!exists || !tracked || !S_ISREG(dst_st.st_mode))
+	{
+		*crs = (exists ? IO_CRS_REPLACE_FILES : IO_CRS_FAIL);
+	}
+	else
+	{
+		const uint64_t src_size = src_st.st_size;
+		const uint64_t dst_size = dst_st.st_size;
+
+		uint64_t offset;
+		int copied = 0;
+		switch(cpjournal_query(args->journal, dst, &src_st, &offset))
+		{
+			case CPJ_DONE:
+				copied = (dst_size == src_size);
+				break;
+			case CPJ_PARTIAL:
+#ifndef _WIN32
+				/* Data past the offset might not have reached storage. */
+				if(offset <= dst_size && truncate(dst, offset) == 0)
+				{
+					return 0;
+				}
+#endif
+				break;
+			case CPJ_UNKNOWN:
+				/* Attributes are cloned after a file is copied. */
+				copied = (dst_size == src_size &&
+				          dst_st.st_mtime == src_st.st_mtime);
+				break;
+		}
+
+		if(copied)
+		{
+			ioeta_update(args->estim, src, dst, 1, src_size);
+			return 1;
+		}
+
+		*crs = IO_CRS_REPLACE_FILES;
+	}
+
+	if(tracked)
+	{
+		cpjournal_started(args->journal, dst, &src_st);
+	}
+	return 0;
+}
+
+int
+ior_can_resume(const char src[], const char dst[])
+{
+	return cpjournal_exists(src, dst);
+}
+
+/* Maps path within source subtree onto the destination subtree.  *free_me is
+ * set to a newly allocated string to be freed by the caller or to NULL for the
+ * root of the subtree.  Returns the path. */
+static const char *
+get_dst_path(const io_args_t *args, const char full_path[], char **free_me)
+{
+	/* TODO: come up with something better than this. */
+	const char *const rel_part = full_path + strlen(args->arg1.src);
+	return (rel_part[0] == '\0')
+	     ? args->arg2.dst
+	     : (*free_me = join_paths(args->arg2.dst, rel_part));
+}
+
 /* Turns IoRes into VisitResult.  Returns VisitResult. */
 static VisitResult
 vr_from_io_res(IoRes result)
@@ -36,6 +36,11 @@ IoRes ior_cp(io_args_t *args);
  * and overwrite in arg3. */
 IoRes ior_mv(io_args_t *args);
 
+/* Checks whether copying or moving of src directory to dst was interrupted.
+ * Such operation is continued by passing IO_CRS_APPEND_TO_FILES to ior_cp() or
+ * ior_mv().  Returns non-zero if so, otherwise zero is returned. */
+int ior_can_resume(const char src[], const char dst[]);
+
 /* Change owner of file/directory recursively.  Expects path in arg1 and uid in
  * arg3. */
 IoRes ior_chown(io_args_t *args);
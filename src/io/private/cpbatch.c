@@ -0,0 +1,665 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "cpbatch.h"
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h> /* IORING_* io_uring_* */
+#include <sys/mman.h> /* MAP_* PROT_* mmap() munmap() */
+#include <sys/stat.h> /* fchmod() mode_t */
+#include <sys/syscall.h> /* __NR_io_uring_enter __NR_io_uring_setup */
+#include <fcntl.h> /* AT_FDCWD O_* */
+#endif
+#include <unistd.h> /* close() syscall() unlink() */
+
+#include <errno.h> /* EAGAIN EBUSY ECANCELED EINTR EINVAL errno */
+#include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* uintptr_t */
+#include <stdlib.h> /* calloc() free() realloc() */
+#include <string.h> /* memset() strdup() */
+
+#include "../../utils/macros.h"
+#include "../../utils/utils.h"
+#include "../iop.h"
+#include "ioc.h"
+#include "ioeta.h"
+
+/* IORING_FEAT_RW_CUR_POS was introduced along with operations used below. */
+#if defined(HAVE_LINUX_IO_URING_H) && defined(IORING_FEAT_RW_CUR_POS) && \
+    defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define USE_IO_URING
+#endif
+
+enum
+{
+	BATCH_SIZE = 64,          /* Maximum number of files in a batch. */
+	RING_SIZE = 2*BATCH_SIZE, /* Number of submission entries of the ring. */
+};
+
+/* File of a batch. */
+typedef struct
+{
+	char *src;      /* Path to the source file. */
+	char *dst;      /* Path to the destination file. */
+	struct stat st; /* Information about the source file. */
+	char *buf;      /* Storage for contents of the file. */
+	int src_fd;     /* Descriptor of the source file or -1. */
+	int dst_fd;     /* Descriptor of the destination file or -1. */
+	int created;    /* Whether destination file was created. */
+	int failed;     /* Whether batched copying of the file has failed. */
+}
+file_t;
+
+#ifdef USE_IO_URING
+/* State of io_uring instance. */
+typedef struct
+{
+	int fd;        /* Descriptor of the ring or -1 if it's not set up. */
+	int broken;    /* Whether the ring failed to set up or to work. */
+	unsigned tail; /* Local copy of tail of submission queue. */
+
+	unsigned *sq_head;          /* Head of submission queue. */
+	unsigned *sq_tail;          /* Tail of submission queue. */
+	unsigned *sq_mask;          /* Mask for indexing submission queue. */
+	unsigned *sq_array;         /* Indexes of submitted entries. */
+	struct io_uring_sqe *sqes;  /* Submission entries. */
+	unsigned *cq_head;          /* Head of completion queue. */
+	unsigned *cq_tail;          /* Tail of completion queue. */
+	unsigned *cq_mask;          /* Mask for indexing completion queue. */
+	struct io_uring_cqe *cqes;  /* Completion entries. */
+
+	void *sq_ptr;     /* Mapping of submission queue. */
+	size_t sq_size;   /* Size of sq_ptr mapping. */
+	void *cq_ptr;     /* Mapping of completion queue (can be sq_ptr). */
+	size_t cq_size;   /* Size of cq_ptr mapping. */
+	size_t sqes_size; /* Size of sqes mapping. */
+}
+ring_t;
+#endif
+
+/* Batch of files to be copied. */
+struct cpbatch_t
+{
+	file_t files[BATCH_SIZE]; /* Files of the batch. */
+	int count;                /* Number of files in the batch. */
+	char *buf;                /* Storage for contents of files. */
+	size_t buf_size;          /* Size of the storage. */
+#ifdef USE_IO_URING
+	ring_t ring;              /* Ring used to submit requests. */
+#endif
+};
+
+static void drop_files(cpbatch_t *batch);
+static IoRes fallback(file_t *file, io_args_t *args);
+#ifdef USE_IO_URING
+static void copy_batch(cpbatch_t *batch);
+static int prepare_buffers(cpbatch_t *batch);
+static void open_files(cpbatch_t *batch, int res[]);
+static void read_files(cpbatch_t *batch, int res[]);
+static void write_files(cpbatch_t *batch, int res[]);
+static void close_files(cpbatch_t *batch, int res[]);
+static int ring_setup(ring_t *ring);
+static void ring_close(ring_t *ring);
+static struct io_uring_sqe * ring_get_sqe(ring_t *ring, int opcode, int fd,
+		int id);
+static int ring_run(ring_t *ring, int n, int res[]);
+#endif
+
+cpbatch_t *
+cpbatch_alloc(void)
+{
+#ifdef USE_IO_URING
+	cpbatch_t *const batch = calloc(1, sizeof(*batch));
+	if(batch != NULL)
+	{
+		batch->ring.fd = -1;
+	}
+	return batch;
+#else
+	return NULL;
+#endif
+}
+
+void
+cpbatch_free(cpbatch_t *batch)
+{
+	if(batch == NULL)
+	{
+		return;
+	}
+
+	drop_files(batch);
+#ifdef USE_IO_URING
+	ring_close(&batch->ring);
+#endif
+	free(batch->buf);
+	free(batch);
+}
+
+int
+cpbatch_add(cpbatch_t *batch, const char src[], const char dst[],
+		const struct stat *st)
+{
+	file_t *const file = &batch->files[batch->count];
+	file->src = strdup(src);
+	file->dst = strdup(dst);
+	if(file->src == NULL || file->dst == NULL)
+	{
+		free(file->src);
+		free(file->dst);
+		file->src = NULL;
+		file->dst = NULL;
+		return 1;
+	}
+
+	file->st = *st;
+	++batch->count;
+	return 0;
+}
+
+int
+cpbatch_is_full(const cpbatch_t *batch)
+{
+	return (batch->count == BATCH_SIZE);
+}
+
+IoRes
+cpbatch_flush(cpbatch_t *batch, io_args_t *args)
+{
+	if(batch->count == 0)
+	{
+		return IO_RES_SUCCEEDED;
+	}
+
+	if(io_cancelled(args))
+	{
+		drop_files(batch);
+		return IO_RES_ABORTED;
+	}
+
+#ifdef USE_IO_URING
+	copy_batch(batch);
+#endif
+
+	IoRes result = IO_RES_SUCCEEDED;
+	int i;
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+
+		if(file->failed)
+		{
+			if(file->created)
+			{
+				(void)unlink(file->dst);
+			}
+
+			if(result != IO_RES_FAILED && result != IO_RES_ABORTED)
+			{
+				result = io_cancelled(args) ? IO_RES_ABORTED : fallback(file, args);
+			}
+			continue;
+		}
+
+		clone_attribs(file->dst, file->src, &file->st);
+		ioeta_update(args->estim, file->src, file->dst, 1, file->st.st_size);
+	}
+
+	drop_files(batch);
+	return result;
+}
+
+/* Empties the batch. */
+static void
+drop_files(cpbatch_t *batch)
+{
+	int i;
+	for(i = 0; i < batch->count; ++i)
+	{
+		free(batch->files[i].src);
+		free(batch->files[i].dst);
+	}
+	memset(batch->files, 0, sizeof(batch->files[0])*batch->count);
+	batch->count = 0;
+}
+
+/* Copies a file which couldn't be copied in a batch in a regular way.  Returns
+ * status. */
+static IoRes
+fallback(file_t *file, io_args_t *args)
+{
+	io_args_t cp_args = {
+		.arg1.src = file->src,
+		.arg2.dst = file->dst,
+		.arg3.crs = args->arg3.crs,
+
+		.cancellation = args->cancellation,
+		.confirm = args->confirm,
+		.estim = args->estim,
+
+		.result = args->result,
+	};
+
+	const IoRes result = iop_cp(&cp_args);
+	args->result = cp_args.result;
+	return result;
+}
+
+#ifdef USE_IO_URING
+
+/* Copies files of the batch by passing requests for all of them through the
+ * ring at once.  Files which weren't copied are marked as failed. */
+static void
+copy_batch(cpbatch_t *batch)
+{
+	int res[RING_SIZE];
+	int i;
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+		file->src_fd = -1;
+		file->dst_fd = -1;
+		file->created = 0;
+		file->failed = 0;
+	}
+
+	if(batch->ring.fd == -1 && !batch->ring.broken)
+	{
+		batch->ring.broken = (ring_setup(&batch->ring) != 0);
+	}
+
+	if(batch->ring.broken || prepare_buffers(batch) != 0)
+	{
+		for(i = 0; i < batch->count; ++i)
+		{
+			batch->files[i].failed = 1;
+		}
+		return;
+	}
+
+	open_files(batch, res);
+	read_files(batch, res);
+	write_files(batch, res);
+	close_files(batch, res);
+}
+
+/* Makes sure there is enough storage for contents of all files in the batch and
+ * distributes it among them.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+prepare_buffers(cpbatch_t *batch)
+{
+	size_t size = 0U;
+	int i;
+
+	/* An extra byte lets us notice files that got longer. */
+	for(i = 0; i < batch->count; ++i)
+	{
+		size += batch->files[i].st.st_size + 1;
+	}
+
+	if(size > batch->buf_size)
+	{
+		char *const buf = realloc(batch->buf, size);
+		if(buf == NULL)
+		{
+			return 1;
+		}
+		batch->buf = buf;
+		batch->buf_size = size;
+	}
+
+	size = 0U;
+	for(i = 0; i < batch->count; ++i)
+	{
+		batch->files[i].buf = batch->buf + size;
+		size += batch->files[i].st.st_size + 1;
+	}
+
+	return 0;
+}
+
+/* Opens source and creates destination files.  If the ring fails, files that
+ * were opened before the failure are closed and created ones are left to be
+ * removed. */
+static void
+open_files(cpbatch_t *batch, int res[])
+{
+	int n = 0;
+	int i;
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+		struct io_uring_sqe *sqe;
+
+		sqe = ring_get_sqe(&batch->ring, IORING_OP_OPENAT, AT_FDCWD, i*2);
+		sqe->addr = (uintptr_t)file->src;
+		sqe->open_flags = O_RDONLY | O_NOFOLLOW | O_CLOEXEC;
+
+		/* Permissions are set after the file is written. */
+		sqe = ring_get_sqe(&batch->ring, IORING_OP_OPENAT, AT_FDCWD, i*2 + 1);
+		sqe->addr = (uintptr_t)file->dst;
+		sqe->open_flags = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+		sqe->len = 0600;
+
+		n += 2;
+	}
+
+	/* Requests which didn't complete haven't opened anything. */
+	for(i = 0; i < n; ++i)
+	{
+		res[i] = -ECANCELED;
+	}
+
+	const int failed = (ring_run(&batch->ring, n, res) != 0);
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+
+		/* Kernels that predate IORING_OP_OPENAT reject it as invalid. */
+		if(res[i*2] == -EINVAL || res[i*2 + 1] == -EINVAL)
+		{
+			batch->ring.broken = 1;
+		}
+
+		file->src_fd = (res[i*2] >= 0 ? res[i*2] : -1);
+		file->dst_fd = (res[i*2 + 1] >= 0 ? res[i*2 + 1] : -1);
+		file->created = (file->dst_fd != -1);
+		file->failed = (failed || file->src_fd == -1 || file->dst_fd == -1);
+
+		/* The ring can't be used to close descriptors after it failed. */
+		if(failed)
+		{
+			if(file->src_fd != -1)
+			{
+				(void)close(file->src_fd);
+				file->src_fd = -1;
+			}
+			if(file->dst_fd != -1)
+			{
+				(void)close(file->dst_fd);
+				file->dst_fd = -1;
+			}
+		}
+	}
+}
+
+/* Reads contents of source files. */
+static void
+read_files(cpbatch_t *batch, int res[])
+{
+	int n = 0;
+	int i;
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+		if(!file->failed)
+		{
+			struct io_uring_sqe *const sqe =
+				ring_get_sqe(&batch->ring, IORING_OP_READ, file->src_fd, i);
+			sqe->addr = (uintptr_t)file->buf;
+			sqe->len = file->st.st_size + 1;
+			++n;
+		}
+	}
+
+	const int failed = (n != 0 && ring_run(&batch->ring, n, res) != 0);
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+		if(!file->failed)
+		{
+			/* File must not have changed its size since it was added. */
+			file->failed = (failed || res[i] != file->st.st_size);
+		}
+	}
+}
+
+/* Writes contents of destination files and sets their permissions. */
+static void
+write_files(cpbatch_t *batch, int res[])
+{
+	int n = 0;
+	int i;
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+		if(!file->failed && file->st.st_size != 0)
+		{
+			struct io_uring_sqe *const sqe =
+				ring_get_sqe(&batch->ring, IORING_OP_WRITE, file->dst_fd, i);
+			sqe->addr = (uintptr_t)file->buf;
+			sqe->len = file->st.st_size;
+			++n;
+		}
+	}
+
+	const int failed = (n != 0 && ring_run(&batch->ring, n, res) != 0);
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+		if(file->failed)
+		{
+			continue;
+		}
+
+		if(file->st.st_size != 0)
+		{
+			file->failed = (failed || res[i] != file->st.st_size);
+		}
+		if(!file->failed)
+		{
+			file->failed = (fchmod(file->dst_fd, file->st.st_mode & 07777) != 0);
+		}
+	}
+}
+
+/* Closes all opened files. */
+static void
+close_files(cpbatch_t *batch, int res[])
+{
+	int n = 0;
+	int i;
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+		if(file->src_fd != -1)
+		{
+			(void)ring_get_sqe(&batch->ring, IORING_OP_CLOSE, file->src_fd, i*2);
+			++n;
+		}
+		if(file->dst_fd != -1)
+		{
+			(void)ring_get_sqe(&batch->ring, IORING_OP_CLOSE, file->dst_fd, i*2 + 1);
+			++n;
+		}
+	}
+
+	if(n != 0 && ring_run(&batch->ring, n, res) != 0)
+	{
+		/* It's unknown which descriptors were closed, so leave them be. */
+		for(i = 0; i < batch->count; ++i)
+		{
+			batch->files[i].failed = 1;
+		}
+		return;
+	}
+
+	for(i = 0; i < batch->count; ++i)
+	{
+		file_t *const file = &batch->files[i];
+		if(file->dst_fd != -1 && res[i*2 + 1] < 0)
+		{
+			/* Closing is where delayed write errors can show up. */
+			file->failed = 1;
+		}
+		file->src_fd = -1;
+		file->dst_fd = -1;
+	}
+}
+
+/* Creates and maps io_uring instance.  Returns zero on success, otherwise
+ * non-zero is returned. */
+static int
+ring_setup(ring_t *ring)
+{
+	struct io_uring_params p;
+	memset(&p, 0, sizeof(p));
+
+	const int fd = syscall(__NR_io_uring_setup, RING_SIZE, &p);
+	if(fd < 0)
+	{
+		return 1;
+	}
+
+	ring->fd = fd;
+	ring->sq_size = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+	ring->cq_size = p.cq_off.cqes + p.cq_entries*sizeof(struct io_uring_cqe);
+	ring->sqes_size = p.sq_entries*sizeof(struct io_uring_sqe);
+
+	const int single_mmap = ((p.features & IORING_FEAT_SINGLE_MMAP) != 0);
+	if(single_mmap)
+	{
+		ring->sq_size = MAX(ring->sq_size, ring->cq_size);
+		ring->cq_size = ring->sq_size;
+	}
+
+	ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	ring->cq_ptr = single_mmap
+	             ? ring->sq_ptr
+	             : mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+	                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+	if(ring->sq_ptr == MAP_FAILED || ring->cq_ptr == MAP_FAILED ||
+			ring->sqes == MAP_FAILED)
+	{
+		ring_close(ring);
+		return 1;
+	}
+
+	char *const sq = ring->sq_ptr;
+	ring->sq_head = (unsigned *)(sq + p.sq_off.head);
+	ring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+	ring->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+	ring->sq_array = (unsigned *)(sq + p.sq_off.array);
+	ring->tail = *ring->sq_tail;
+
+	char *const cq = ring->cq_ptr;
+	ring->cq_head = (unsigned *)(cq + p.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+	ring->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+	return 0;
+}
+
+/* Unmaps and closes the ring if it was set up. */
+static void
+ring_close(ring_t *ring)
+{
+	if(ring->fd == -1)
+	{
+		return;
+	}
+
+	if(ring->sqes != NULL && ring->sqes != MAP_FAILED)
+	{
+		(void)munmap(ring->sqes, ring->sqes_size);
+	}
+	if(ring->cq_ptr != NULL && ring->cq_ptr != MAP_FAILED &&
+			ring->cq_ptr != ring->sq_ptr)
+	{
+		(void)munmap(ring->cq_ptr, ring->cq_size);
+	}
+	if(ring->sq_ptr != NULL && ring->sq_ptr != MAP_FAILED)
+	{
+		(void)munmap(ring->sq_ptr, ring->sq_size);
+	}
+
+	(void)close(ring->fd);
+	ring->fd = -1;
+}
+
+/* Puts a new zero-initialized entry into submission queue without submitting
+ * it.  Result of the request will be stored at res[id] by ring_run().  Returns
+ * the entry. */
+static struct io_uring_sqe *
+ring_get_sqe(ring_t *ring, int opcode, int fd, int id)
+{
+	const unsigned idx = ring->tail++ & *ring->sq_mask;
+	struct io_uring_sqe *const sqe = &ring->sqes[idx];
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->user_data = id;
+	ring->sq_array[idx] = idx;
+	return sqe;
+}
+
+/* Submits queued entries and waits for n of their completions storing their
+ * results in the res array.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+ring_run(ring_t *ring, int n, int res[])
+{
+	__atomic_store_n(ring->sq_tail, ring->tail, __ATOMIC_RELEASE);
+
+	while(n > 0)
+	{
+		const unsigned to_submit =
+			ring->tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+		if(syscall(__NR_io_uring_enter, ring->fd, to_submit, 1,
+					IORING_ENTER_GETEVENTS, NULL, 0) < 0)
+		{
+			if(errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			{
+				ring->broken = 1;
+				return 1;
+			}
+		}
+
+		unsigned head = *ring->cq_head;
+		while(head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+		{
+			const struct io_uring_cqe *const cqe =
+				&ring->cqes[head & *ring->cq_mask];
+			res[cqe->user_data] = cqe->res;
+			++head;
+			--n;
+		}
+		__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	return 0;
+}
+
+#endif
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
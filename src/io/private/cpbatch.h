@@ -0,0 +1,64 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__IO__PRIVATE__CPBATCH_H__
+#define VIFM__IO__PRIVATE__CPBATCH_H__
+
+#include <sys/stat.h> /* stat */
+
+#include "../ioc.h"
+
+/* cpbatch - copying of many small files with few system calls (Linux only) */
+
+enum
+{
+	/* Maximum size of a file that can be added to a batch. */
+	CPBATCH_MAX_FILE_SIZE = 64*1024,
+};
+
+/* Declaration of opaque batch type. */
+typedef struct cpbatch_t cpbatch_t;
+
+/* Allocates an empty batch.  Returns the batch or NULL when batched copying
+ * isn't supported. */
+cpbatch_t * cpbatch_alloc(void);
+
+/* Frees the batch dropping files that weren't copied.  The batch can be
+ * NULL. */
+void cpbatch_free(cpbatch_t *batch);
+
+/* Adds a regular file of at most CPBATCH_MAX_FILE_SIZE bytes described by st to
+ * the batch, which must not be full.  Destination file must not exist.  Returns
+ * zero on success, otherwise non-zero is returned. */
+int cpbatch_add(cpbatch_t *batch, const char src[], const char dst[],
+		const struct stat *st);
+
+/* Checks whether the batch is full and should be flushed.  Returns non-zero if
+ * so, otherwise zero is returned. */
+int cpbatch_is_full(const cpbatch_t *batch);
+
+/* Copies all files of the batch and empties it.  Files that can't be copied
+ * this way are copied one by one via iop_cp() using conflict resolution
+ * strategy, callbacks and estimation from args, which also receives errors.
+ * Returns status. */
+IoRes cpbatch_flush(cpbatch_t *batch, io_args_t *args);
+
+#endif /* VIFM__IO__PRIVATE__CPBATCH_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,438 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "cpjournal.h"
+
+#include <sys/stat.h> /* stat */
+#include <unistd.h> /* unlink() */
+
+#include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* uint64_t */
+#include <stdio.h> /* FILE fclose() fflush() fileno() fprintf() */
+#include <stdlib.h> /* calloc() free() malloc() strtoll() strtoull() */
+#include <string.h> /* strchr() strcmp() strdup() strlen() strncmp() */
+
+#include "../../compat/fs_limits.h"
+#include "../../compat/os.h"
+#include "../../utils/file_streams.h"
+#include "../../utils/path.h"
+#include "../../utils/str.h"
+#include "../../utils/trie.h"
+
+/* Format of journal files:
+ *
+ *   vifm copy journal 1
+ *   <source path>
+ *   f <size> <mtime> <relative path>    -- copying of a file has started
+ *   s <offset> <relative path>          -- data up to offset is on storage
+ *   d <relative path>                   -- copying of a file has finished
+ *
+ * Records are only appended, so interruption can damage at most the last
+ * line, which is then ignored.  Relative paths start with a slash. */
+
+/* First line of journal files. */
+#define HEADER "vifm copy journal 1"
+
+/* Information about a file loaded from the journal. */
+typedef struct
+{
+	uint64_t size;   /* Size of the source file. */
+	long long mtime; /* Modification time of the source file. */
+	uint64_t offset; /* Amount of data known to be written. */
+	int done;        /* Whether copying has finished. */
+}
+entry_t;
+
+/* Journal of copying a directory. */
+struct cpjournal_t
+{
+	FILE *fp;       /* Journal file opened for appending. */
+	char *path;     /* Path to the journal file. */
+	char *dst;      /* Path to the destination directory. */
+	size_t dst_len; /* Length of the dst field. */
+	trie_t *files;  /* Relative path -> entry_t for loaded state. */
+};
+
+#ifndef _WIN32
+static char * get_journal_path(const char dst[]);
+static int dst_exists(const char dst[]);
+static int check_header(FILE *fp, const char src[]);
+static trie_t * load_entries(FILE *fp);
+static void load_entry(trie_t *files, const char line[]);
+static entry_t * get_entry(trie_t *files, const char rel[], int create);
+static const char * get_rel_path(const cpjournal_t *journal, const char dst[]);
+#endif
+
+cpjournal_t *
+cpjournal_open(const char src[], const char dst[], int resume)
+{
+#ifndef _WIN32
+	if(strchr(src, '\n') != NULL)
+	{
+		return NULL;
+	}
+
+	cpjournal_t *const journal = calloc(1, sizeof(*journal));
+	if(journal == NULL)
+	{
+		return NULL;
+	}
+
+	journal->path = get_journal_path(dst);
+	journal->dst = strdup(dst);
+	if(journal->path == NULL || journal->dst == NULL)
+	{
+		cpjournal_close(journal, 0);
+		return NULL;
+	}
+	chosp(journal->dst);
+	journal->dst_len = strlen(journal->dst);
+
+	if(resume)
+	{
+		FILE *const fp = os_fopen(journal->path, "r");
+		if(fp != NULL)
+		{
+			if(check_header(fp, src))
+			{
+				journal->files = load_entries(fp);
+			}
+			fclose(fp);
+		}
+	}
+
+	/* Previous state is either reused or discarded. */
+	journal->fp = os_fopen(journal->path, journal->files != NULL ? "a" : "w");
+	if(journal->fp == NULL)
+	{
+		cpjournal_close(journal, 0);
+		return NULL;
+	}
+
+	if(journal->files == NULL)
+	{
+		fprintf(journal->fp, "%s\n%s\n", HEADER, src);
+		fflush(journal->fp);
+	}
+
+	return journal;
+#else
+	return NULL;
+#endif
+}
+
+void
+cpjournal_close(cpjournal_t *journal, int finished)
+{
+	if(journal == NULL)
+	{
+		return;
+	}
+
+	if(journal->fp != NULL)
+	{
+		fclose(journal->fp);
+		/* There is nothing to continue if destination wasn't even created. */
+		if(finished || !dst_exists(journal->dst))
+		{
+			(void)unlink(journal->path);
+		}
+	}
+
+	trie_free(journal->files);
+	free(journal->dst);
+	free(journal->path);
+	free(journal);
+}
+
+int
+cpjournal_exists(const char src[], const char dst[])
+{
+#ifndef _WIN32
+	char *const path = get_journal_path(dst);
+	if(path == NULL)
+	{
+		return 0;
+	}
+
+	/* Journal is useless without destination, which might have been deleted by
+	 * the user after interruption. */
+	if(!dst_exists(dst))
+	{
+		(void)unlink(path);
+		free(path);
+		return 0;
+	}
+
+	FILE *const fp = os_fopen(path, "r");
+	free(path);
+	if(fp == NULL)
+	{
+		return 0;
+	}
+
+	const int exists = check_header(fp, src);
+	fclose(fp);
+	return exists;
+#else
+	return 0;
+#endif
+}
+
+void
+cpjournal_started(cpjournal_t *journal, const char dst[],
+		const struct stat *st)
+{
+#ifndef _WIN32
+	const char *const rel = get_rel_path(journal, dst);
+	if(rel != NULL)
+	{
+		fprintf(journal->fp, "f %" PRINTF_ULL " %lld %s\n",
+				(unsigned long long)st->st_size, (long long)st->st_mtime, rel);
+		fflush(journal->fp);
+	}
+#endif
+}
+
+void
+cpjournal_synced(cpjournal_t *journal, const char dst[], uint64_t offset)
+{
+#ifndef _WIN32
+	const char *const rel = get_rel_path(journal, dst);
+	if(rel != NULL)
+	{
+		fprintf(journal->fp, "s %" PRINTF_ULL " %s\n", (unsigned long long)offset,
+				rel);
+		/* The record is useless if it can be lost while the data isn't. */
+		if(fflush(journal->fp) == 0)
+		{
+			(void)os_fdatasync(fileno(journal->fp));
+		}
+	}
+#endif
+}
+
+void
+cpjournal_finished(cpjournal_t *journal, const char dst[])
+{
+#ifndef _WIN32
+	const char *const rel = get_rel_path(journal, dst);
+	if(rel != NULL)
+	{
+		fprintf(journal->fp, "d %s\n", rel);
+		fflush(journal->fp);
+	}
+#endif
+}
+
+CpjState
+cpjournal_query(cpjournal_t *journal, const char dst[], const struct stat *st,
+		uint64_t *offset)
+{
+#ifndef _WIN32
+	const char *const rel = get_rel_path(journal, dst);
+	if(rel == NULL)
+	{
+		return CPJ_UNKNOWN;
+	}
+
+	const entry_t *const entry = get_entry(journal->files, rel, 0);
+	if(entry == NULL || entry->size != (uint64_t)st->st_size ||
+			entry->mtime != (long long)st->st_mtime)
+	{
+		return CPJ_UNKNOWN;
+	}
+
+	if(entry->done)
+	{
+		return CPJ_DONE;
+	}
+
+	*offset = entry->offset;
+	return CPJ_PARTIAL;
+#else
+	return CPJ_UNKNOWN;
+#endif
+}
+
+#ifndef _WIN32
+
+/* Builds path to journal of copying to dst.  Returns newly allocated string or
+ * NULL on error. */
+static char *
+get_journal_path(const char dst[])
+{
+	char dir[PATH_MAX + 1];
+	copy_str(dir, sizeof(dir), dst);
+	chosp(dir);
+
+	char *const name = get_last_path_component(dir);
+	if(name == dir)
+	{
+		return format_str(".%s.vifm-journal", name);
+	}
+
+	name[-1] = '\0';
+	return format_str("%s/.%s.vifm-journal", dir, name);
+}
+
+/* Checks whether destination directory exists.  Returns non-zero if so,
+ * otherwise zero is returned. */
+static int
+dst_exists(const char dst[])
+{
+	struct stat st;
+	return os_lstat(dst, &st) == 0;
+}
+
+/* Reads and checks header of the journal.  Returns non-zero if it's a journal
+ * for copying src, otherwise zero is returned. */
+static int
+check_header(FILE *fp, const char src[])
+{
+	char line[PATH_MAX + 2];
+
+	if(get_line(fp, line, sizeof(line)) == NULL ||
+			strcmp(line, HEADER "\n") != 0)
+	{
+		return 0;
+	}
+
+	const size_t len = strlen(src);
+	return get_line(fp, line, sizeof(line)) != NULL
+	    && strncmp(line, src, len) == 0
+	    && strcmp(line + len, "\n") == 0;
+}
+
+/* Loads state of files from records of the journal.  Returns the state or NULL
+ * on error. */
+static trie_t *
+load_entries(FILE *fp)
+{
+	trie_t *const files = trie_create(&free);
+	if(files == NULL)
+	{
+		return NULL;
+	}
+
+	/* Last line might be incomplete and too long lines are split. */
+	char line[64 + PATH_MAX + 2];
+	int whole = 1;
+	while(get_line(fp, line, sizeof(line)) != NULL)
+	{
+		const size_t len = strlen(line);
+		const int complete = (line[len - 1] == '\n');
+		if(whole && complete)
+		{
+			line[len - 1] = '\0';
+			load_entry(files, line);
+		}
+		whole = complete;
+	}
+
+	return files;
+}
+
+/* Applies a single record of the journal to the state. */
+static void
+load_entry(trie_t *files, const char line[])
+{
+	char *end;
+	entry_t *entry;
+
+	switch(line[0])
+	{
+		case 'f':
+			{
+				const uint64_t size = strtoull(line + 1, &end, 10);
+				const long long mtime = strtoll(end, &end, 10);
+				if(end[0] == ' ' && end[1] == '/' &&
+						(entry = get_entry(files, end + 1, 1)) != NULL)
+				{
+					entry->size = size;
+					entry->mtime = mtime;
+					entry->offset = 0;
+					entry->done = 0;
+				}
+				break;
+			}
+		case 's':
+			{
+				const uint64_t offset = strtoull(line + 1, &end, 10);
+				if(end[0] == ' ' && (entry = get_entry(files, end + 1, 0)) != NULL)
+				{
+					entry->offset = offset;
+				}
+				break;
+			}
+		case 'd':
+			if(line[1] == ' ' && (entry = get_entry(files, line + 2, 0)) != NULL)
+			{
+				entry->done = 1;
+			}
+			break;
+	}
+}
+
+/* Retrieves entry of the state optionally creating it.  Returns the entry or
+ * NULL if it doesn't exist or on error. */
+static entry_t *
+get_entry(trie_t *files, const char rel[], int create)
+{
+	void *data;
+	if(trie_get(files, rel, &data) == 0)
+	{
+		return data;
+	}
+
+	if(!create)
+	{
+		return NULL;
+	}
+
+	entry_t *const entry = malloc(sizeof(*entry));
+	if(entry == NULL || trie_set(files, rel, entry) < 0)
+	{
+		free(entry);
+		return NULL;
+	}
+	return entry;
+}
+
+/* Retrieves path of a file relative to the destination directory suitable for
+ * recording.  Returns the path or NULL if nothing should be recorded. */
+static const char *
+get_rel_path(const cpjournal_t *journal, const char dst[])
+{
+	if(journal == NULL || strncmp(dst, journal->dst, journal->dst_len) != 0)
+	{
+		return NULL;
+	}
+
+	const char *const rel = dst + journal->dst_len;
+	if(rel[0] != '/' || strchr(rel, '\n') != NULL)
+	{
+		return NULL;
+	}
+	return rel;
+}
+
+#endif
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,80 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__IO__PRIVATE__CPJOURNAL_H__
+#define VIFM__IO__PRIVATE__CPJOURNAL_H__
+
+#include <sys/stat.h> /* stat */
+
+#include <stdint.h> /* uint64_t */
+
+/* cpjournal - journal of copying a directory to continue it after
+ * interruption (not for Windows) */
+
+/* The journal is a text file next to the destination directory, which is
+ * removed after successful copying or once the destination is gone.  All
+ * functions accept NULL journal and do nothing for it. */
+
+/* State of a file according to the journal. */
+typedef enum
+{
+	CPJ_UNKNOWN, /* Nothing is known about the file. */
+	CPJ_PARTIAL, /* Copying of the file has started, but didn't finish. */
+	CPJ_DONE,    /* The file was copied. */
+}
+CpjState;
+
+/* Declaration of opaque journal type. */
+typedef struct cpjournal_t cpjournal_t;
+
+/* Opens journal of copying src directory to dst.  When resume is non-zero,
+ * state of previous copying is loaded if it was done for the same source.
+ * Returns the journal or NULL if journaling isn't available. */
+cpjournal_t * cpjournal_open(const char src[], const char dst[], int resume);
+
+/* Closes the journal.  Its file is removed if copying has finished or
+ * destination doesn't exist, otherwise it's left to continue copying later. */
+void cpjournal_close(cpjournal_t *journal, int finished);
+
+/* Checks whether there is a journal left by interrupted copying of src to dst.
+ * Journal of destination that doesn't exist is removed.  Returns non-zero if
+ * there is a journal, otherwise zero is returned. */
+int cpjournal_exists(const char src[], const char dst[]);
+
+/* Records that copying of a file to dst (within destination directory) has
+ * started from scratch.  st describes the source file. */
+void cpjournal_started(cpjournal_t *journal, const char dst[],
+		const struct stat *st);
+
+/* Records that first offset bytes of dst file are written to storage. */
+void cpjournal_synced(cpjournal_t *journal, const char dst[], uint64_t offset);
+
+/* Records that copying of a file to dst has finished. */
+void cpjournal_finished(cpjournal_t *journal, const char dst[]);
+
+/* Queries state of dst file as of the time the journal was opened.  Source
+ * file described by st must be the same as the one recorded.  For CPJ_PARTIAL
+ * *offset is set to size of data that is known to be written.  Returns the
+ * state. */
+CpjState cpjournal_query(cpjournal_t *journal, const char dst[],
+		const struct stat *st, uint64_t *offset);
+
+#endif /* VIFM__IO__PRIVATE__CPJOURNAL_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
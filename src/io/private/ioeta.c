@@ -18,12 +18,13 @@
 
 #include "ioeta.h"
 
-#include <stddef.h> /* NULL */
+#include <stddef.h> /* NULL size_t */
 #include <stdint.h> /* uint64_t */
 #include <stdlib.h> /* free() */
 #include <string.h> /* strdup() */
 
 #include "../../utils/fs.h"
+#include "../../utils/macros.h"
 #include "../../utils/str.h"
 #include "../ioeta.h"
 #include "ionotif.h"
@@ -38,7 +39,8 @@ ioeta_release(ioeta_estim_t *estim)
 void
 ioeta_add_item(ioeta_estim_t *estim, const char path[])
 {
-	++estim->total_items;
+	++estim->sync_items;
+	ioeta_update_totals(estim);
 
 	replace_string(&estim->item, path);
 
@@ -50,7 +52,7 @@ ioeta_add_file(ioeta_estim_t *estim, const char path[])
 {
 	if(!is_symlink(path))
 	{
-		estim->total_bytes += get_file_size(path);
+		estim->sync_bytes += get_file_size(path);
 	}
 
 	ioeta_add_item(estim, path);
@@ -73,27 +75,24 @@ void
 ioeta_update(ioeta_estim_t *estim, const char path[], const char target[],
 		int finished, uint64_t bytes)
 {
-	if(estim == NULL || estim->silent)
+	if(estim == NULL)
 	{
 		return;
 	}
 
-	estim->current_byte += bytes;
-	estim->current_file_byte += bytes;
-	if(estim->current_byte > estim->total_bytes)
+	ioeta_async_merge(estim);
+
+	if(estim->silent)
 	{
-		/* Estimations are out of date, update them. */
-		estim->total_bytes = estim->current_byte;
+		return;
 	}
 
+	estim->current_byte += bytes;
+	estim->current_file_byte += bytes;
+
 	if(finished)
 	{
 		++estim->current_item;
-		if(estim->current_item > estim->total_items)
-		{
-			/* Estimations are out of date, update them. */
-			estim->total_items = estim->current_item;
-		}
 		estim->current_file_byte = 0U;
 		estim->total_file_bytes = 0U;
 	}
@@ -103,6 +102,8 @@ ioeta_update(ioeta_estim_t *estim, const char path[], const char target[],
 		estim->total_file_bytes = get_file_size(path);
 	}
 
+	ioeta_update_totals(estim);
+
 	if(path != NULL)
 	{
 		replace_string(&estim->item, path);
@@ -116,6 +117,34 @@ ioeta_update(ioeta_estim_t *estim, const char path[], const char target[],
 	ionotif_notify(IO_PS_IN_PROGRESS, estim);
 }
 
+void
+ioeta_update_bulk(ioeta_estim_t *estim, const char path[], size_t items,
+		uint64_t bytes)
+{
+	if(estim == NULL)
+	{
+		return;
+	}
+
+	ioeta_async_merge(estim);
+
+	if(estim->silent)
+	{
+		return;
+	}
+
+	estim->current_byte += bytes;
+	estim->current_item += items;
+	estim->current_file_byte = 0U;
+	estim->total_file_bytes = 0U;
+	ioeta_update_totals(estim);
+
+	replace_string(&estim->item, path);
+	replace_string(&estim->target, path);
+
+	ionotif_notify(IO_PS_IN_PROGRESS, estim);
+}
+
 int
 ioeta_silent_on(ioeta_estim_t *estim)
 {
@@ -155,6 +184,7 @@ ioeta_restore(ioeta_estim_t *estim, const ioeta_estim_t *save)
 {
 	char *item = estim->item;
 	char *target = estim->target;
+	struct ioeta_async_t *const async = estim->async;
 
 	if(estim->silent)
 	{
@@ -164,9 +194,29 @@ ioeta_restore(ioeta_estim_t *estim, const ioeta_estim_t *save)
 	update_string(&item, save->item);
 	update_string(&target, save->target);
 
+	/* Results of asynchronous estimation which were added since the save aren't
+	 * part of the state and must be preserved. */
+	const size_t async_items = estim->async_items - save->async_items;
+	const uint64_t async_bytes = estim->async_bytes - save->async_bytes;
+
 	*estim = *save;
 	estim->item = item;
 	estim->target = target;
+	estim->async = async;
+	estim->async_items += async_items;
+	estim->async_bytes += async_bytes;
+	ioeta_update_totals(estim);
+}
+
+void
+ioeta_update_totals(ioeta_estim_t *estim)
+{
+	/* Estimations might be out of date, in which case progress is what's known
+	 * to be there. */
+	estim->total_items = MAX(estim->current_item,
+			estim->sync_items + estim->async_items);
+	estim->total_bytes = MAX(estim->current_byte,
+			estim->sync_bytes + estim->async_bytes);
 }
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -19,6 +19,7 @@
 #ifndef VIFM__IO__PRIVATE__IOETA_H__
 #define VIFM__IO__PRIVATE__IOETA_H__
 
+#include <stddef.h> /* size_t */
 #include <stdint.h> /* uint64_t */
 
 #include "../ioeta.h"
@@ -48,6 +49,12 @@ void ioeta_add_dir(ioeta_estim_t *estim, const char path[]);
 void ioeta_update(ioeta_estim_t *estim, const char path[], const char target[],
 		int finished, uint64_t bytes);
 
+/* Accounts for a number of items of the given total size that were processed
+ * at once, path is reported as the current one.  When estim is NULL, the
+ * function just returns.  Calls progress changed notification handler. */
+void ioeta_update_bulk(ioeta_estim_t *estim, const char path[], size_t items,
+		uint64_t bytes);
+
 /* Silence future progress reports.  Returns previous state to be passed to
  * ioeta_silent_set() later.  If estim is NULL, returns zero. */
 int ioeta_silent_on(ioeta_estim_t *estim);
@@ -63,6 +70,9 @@ ioeta_estim_t ioeta_save(const ioeta_estim_t *estim);
 /* Restores estimation to its previous state. */
 void ioeta_restore(ioeta_estim_t *estim, const ioeta_estim_t *save);
 
+/* Recomputes totals from results of estimations and progress of processing. */
+void ioeta_update_totals(ioeta_estim_t *estim);
+
 #endif /* VIFM__IO__PRIVATE__IOETA_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -0,0 +1,550 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "rmtree.h"
+
+#include <sys/stat.h> /* S_ISDIR() S_ISREG() fstatat() stat */
+#include <dirent.h> /* DIR closedir() dirfd() fdopendir() readdir() */
+#include <fcntl.h> /* AT_REMOVEDIR AT_SYMLINK_NOFOLLOW O_* open() openat() */
+#include <unistd.h> /* close() rmdir() unlinkat() */
+
+#include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* uint64_t */
+#include <stdlib.h> /* free() malloc() */
+#include <string.h> /* strdup() strlen() */
+#include <time.h> /* CLOCK_REALTIME clock_gettime() timespec */
+
+#include "../../compat/dtype.h"
+#include "../../compat/fs_limits.h"
+#include "../../compat/pthread.h"
+#include "../../utils/path.h"
+#include "../../utils/str.h"
+#include "ioc.h"
+#include "ioeta.h"
+
+enum
+{
+	MAX_WORKERS = 4,       /* Maximum number of threads that remove files. */
+	FLUSH_PERIOD = 64,     /* Number of removals accumulated before sharing. */
+	POLL_INTERVAL_MS = 50, /* Period of reporting progress and cancellation. */
+};
+
+/* Directory which is being removed. */
+typedef struct node_t
+{
+	struct node_t *parent; /* Parent directory or NULL for the root. */
+	char *path;            /* Full path to the directory. */
+	const char *name;      /* Name of the directory within path. */
+	int pending;           /* Number of unfinished scans of this directory and of
+	                          its subdirectories. */
+	struct node_t *next;   /* Next directory in the list of work. */
+}
+node_t;
+
+/* State of removal shared by all threads. */
+typedef struct
+{
+	pthread_mutex_t lock; /* Protects fields below. */
+	pthread_cond_t work;  /* Signaled on new work or when it's over. */
+	pthread_cond_t done;  /* Signaled when a worker finishes. */
+
+	node_t *todo; /* Directories waiting for a worker. */
+	int todo_len; /* Number of elements in todo list. */
+	int workers;  /* Number of started workers. */
+	int busy;     /* Number of workers that are processing directories. */
+	int running;  /* Number of workers that haven't finished yet. */
+	int stop;     /* Whether processing should be stopped. */
+	int failed;   /* Whether an error has occurred. */
+
+	int sizes;                   /* Whether sizes of files are needed. */
+	size_t items;                /* Number of removed items to be reported. */
+	uint64_t bytes;              /* Size of removed files to be reported. */
+	char last_dir[PATH_MAX + 1]; /* Directory of the last removals. */
+}
+rmtree_t;
+
+/* Removals by a worker that weren't yet added to the shared state. */
+typedef struct
+{
+	size_t items;   /* Number of removed items. */
+	uint64_t bytes; /* Size of removed files. */
+	int stop;       /* Last seen value of stop flag of the shared state. */
+}
+local_t;
+
+static void * worker(void *arg);
+static void process_dir(rmtree_t *rt, node_t *node);
+static void scan_dir(rmtree_t *rt, node_t *node, int fd, local_t *local);
+static int is_dir_entry(int dfd, const struct dirent *d, struct stat *st,
+		int *have_st);
+static void remove_file(rmtree_t *rt, node_t *node, int dfd, const char name[],
+		struct stat *st, int have_st, local_t *local);
+static int hand_off(rmtree_t *rt, node_t *node);
+static node_t * node_alloc(rmtree_t *rt, node_t *parent, const char name[]);
+static void finish_node(rmtree_t *rt, node_t *node, int parent_fd,
+		local_t *local);
+static void fail(rmtree_t *rt, local_t *local);
+static void flush(rmtree_t *rt, local_t *local, const char dir[]);
+static void report_progress(rmtree_t *rt, ioeta_estim_t *estim);
+static void get_deadline(struct timespec *ts);
+
+IoRes
+rmtree(io_args_t *args)
+{
+	rmtree_t rt = { .sizes = (args->estim != NULL) };
+	pthread_t threads[MAX_WORKERS];
+
+	if(pthread_mutex_init(&rt.lock, NULL) != 0)
+	{
+		return IO_RES_FAILED;
+	}
+	if(pthread_cond_init(&rt.work, NULL) != 0)
+	{
+		pthread_mutex_destroy(&rt.lock);
+		return IO_RES_FAILED;
+	}
+	if(pthread_cond_init(&rt.done, NULL) != 0)
+	{
+		pthread_cond_destroy(&rt.work);
+		pthread_mutex_destroy(&rt.lock);
+		return IO_RES_FAILED;
+	}
+
+	rt.todo = node_alloc(&rt, NULL, args->arg1.path);
+	if(rt.todo == NULL)
+	{
+		rt.failed = 1;
+	}
+	rt.todo_len = (rt.todo != NULL);
+
+	pthread_mutex_lock(&rt.lock);
+	while(rt.todo != NULL && rt.workers < MAX_WORKERS)
+	{
+		if(pthread_create(&threads[rt.workers], NULL, &worker, &rt) != 0)
+		{
+			break;
+		}
+		++rt.workers;
+	}
+	rt.running = rt.workers;
+
+	int cancelled = 0;
+	while(rt.running != 0)
+	{
+		struct timespec deadline;
+		get_deadline(&deadline);
+		(void)pthread_cond_timedwait(&rt.done, &rt.lock, &deadline);
+
+		pthread_mutex_unlock(&rt.lock);
+		report_progress(&rt, args->estim);
+		const int cancel = io_cancelled(args);
+		pthread_mutex_lock(&rt.lock);
+
+		if(cancel && !rt.stop && rt.running != 0)
+		{
+			rt.stop = 1;
+			cancelled = 1;
+			pthread_cond_broadcast(&rt.work);
+		}
+	}
+	pthread_mutex_unlock(&rt.lock);
+
+	int i;
+	for(i = 0; i < rt.workers; ++i)
+	{
+		(void)pthread_join(threads[i], NULL);
+	}
+
+	/* Work is left only if processing was stopped or no worker was started. */
+	local_t local = {};
+	if(rt.todo != NULL)
+	{
+		rt.stop = 1;
+		rt.failed |= !cancelled;
+	}
+	while(rt.todo != NULL)
+	{
+		node_t *const node = rt.todo;
+		rt.todo = node->next;
+		finish_node(&rt, node, -1, &local);
+	}
+
+	report_progress(&rt, args->estim);
+
+	pthread_cond_destroy(&rt.done);
+	pthread_cond_destroy(&rt.work);
+	pthread_mutex_destroy(&rt.lock);
+
+	if(cancelled)
+	{
+		return IO_RES_ABORTED;
+	}
+	return (rt.failed ? IO_RES_FAILED : IO_RES_SUCCEEDED);
+}
+
+/* Entry point of a thread that removes directories from todo list until there
+ * is no more work or processing is stopped.  Returns NULL. */
+static void *
+worker(void *arg)
+{
+	rmtree_t *const rt = arg;
+
+	pthread_mutex_lock(&rt->lock);
+	while(!rt->stop)
+	{
+		if(rt->todo != NULL)
+		{
+			node_t *const node = rt->todo;
+			rt->todo = node->next;
+			--rt->todo_len;
+			++rt->busy;
+			pthread_mutex_unlock(&rt->lock);
+
+			process_dir(rt, node);
+
+			pthread_mutex_lock(&rt->lock);
+			--rt->busy;
+			continue;
+		}
+
+		if(rt->busy == 0)
+		{
+			/* Nothing is left and no new work can appear. */
+			break;
+		}
+
+		pthread_cond_wait(&rt->work, &rt->lock);
+	}
+
+	--rt->running;
+	pthread_cond_broadcast(&rt->work);
+	pthread_cond_signal(&rt->done);
+	pthread_mutex_unlock(&rt->lock);
+
+	return NULL;
+}
+
+/* Removes directory taken from todo list. */
+static void
+process_dir(rmtree_t *rt, node_t *node)
+{
+	local_t local = {};
+
+	const int fd = open(node->path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW |
+			O_CLOEXEC);
+	if(fd == -1)
+	{
+		fail(rt, &local);
+	}
+	else
+	{
+		scan_dir(rt, node, fd, &local);
+	}
+
+	char dir[PATH_MAX + 1];
+	copy_str(dir, sizeof(dir), node->path);
+	finish_node(rt, node, -1, &local);
+	flush(rt, &local, dir);
+}
+
+/* Removes content of the directory opened as fd, which is closed afterwards.
+ * Subdirectories are either handed off to idle workers or processed in
+ * place. */
+static void
+scan_dir(rmtree_t *rt, node_t *node, int fd, local_t *local)
+{
+	DIR *const dir = fdopendir(fd);
+	if(dir == NULL)
+	{
+		(void)close(fd);
+		fail(rt, local);
+		return;
+	}
+
+	const int dfd = dirfd(dir);
+
+	struct dirent *d;
+	while(!local->stop && (d = readdir(dir)) != NULL)
+	{
+		if(is_builtin_dir(d->d_name))
+		{
+			continue;
+		}
+
+		struct stat st;
+		int have_st = 0;
+		const int is_dir = is_dir_entry(dfd, d, &st, &have_st);
+		if(is_dir < 0)
+		{
+			fail(rt, local);
+			break;
+		}
+
+		if(!is_dir)
+		{
+			remove_file(rt, node, dfd, d->d_name, &st, have_st, local);
+			continue;
+		}
+
+		node_t *const child = node_alloc(rt, node, d->d_name);
+		if(child == NULL)
+		{
+			fail(rt, local);
+			break;
+		}
+
+		if(hand_off(rt, child))
+		{
+			continue;
+		}
+
+		const int child_fd = openat(dfd, d->d_name, O_RDONLY | O_DIRECTORY |
+				O_NOFOLLOW | O_CLOEXEC);
+		if(child_fd == -1)
+		{
+			fail(rt, local);
+		}
+		else
+		{
+			scan_dir(rt, child, child_fd, local);
+		}
+		finish_node(rt, child, dfd, local);
+	}
+
+	(void)closedir(dir);
+}
+
+/* Checks whether directory entry is a directory (symbolic links aren't
+ * followed).  Fills *st and sets *have_st if it had to query the file.
+ * Returns positive number for a directory, zero for other entries and negative
+ * number on error. */
+static int
+is_dir_entry(int dfd, const struct dirent *d, struct stat *st, int *have_st)
+{
+#if defined(HAVE_STRUCT_DIRENT_D_TYPE) && HAVE_STRUCT_DIRENT_D_TYPE
+	if(d->d_type != DT_UNKNOWN)
+	{
+		return (d->d_type == DT_DIR);
+	}
+#endif
+
+	if(fstatat(dfd, d->d_name, st, AT_SYMLINK_NOFOLLOW) != 0)
+	{
+		return -1;
+	}
+
+	*have_st = 1;
+	return (S_ISDIR(st->st_mode) != 0);
+}
+
+/* Removes a file which isn't a directory. */
+static void
+remove_file(rmtree_t *rt, node_t *node, int dfd, const char name[],
+		struct stat *st, int have_st, local_t *local)
+{
+	if(rt->sizes && !have_st &&
+			fstatat(dfd, name, st, AT_SYMLINK_NOFOLLOW) == 0)
+	{
+		have_st = 1;
+	}
+
+	if(unlinkat(dfd, name, 0) != 0)
+	{
+		fail(rt, local);
+		return;
+	}
+
+	if(rt->sizes && have_st && S_ISREG(st->st_mode))
+	{
+		local->bytes += st->st_size;
+	}
+
+	if(++local->items == FLUSH_PERIOD)
+	{
+		flush(rt, local, node->path);
+	}
+}
+
+/* Passes directory to an idle worker if there is one.  Returns non-zero if
+ * the directory was handed off. */
+static int
+hand_off(rmtree_t *rt, node_t *node)
+{
+	int handed_off = 0;
+
+	pthread_mutex_lock(&rt->lock);
+	if(!rt->stop && rt->todo_len < rt->workers - rt->busy)
+	{
+		node->next = rt->todo;
+		rt->todo = node;
+		++rt->todo_len;
+		handed_off = 1;
+		pthread_cond_signal(&rt->work);
+	}
+	pthread_mutex_unlock(&rt->lock);
+
+	return handed_off;
+}
+
+/* Allocates node for a directory, which is a root if parent is NULL.  For
+ * non-root nodes name is a name of the directory, otherwise it's a path.
+ * Returns the node or NULL on error. */
+static node_t *
+node_alloc(rmtree_t *rt, node_t *parent, const char name[])
+{
+	node_t *const node = malloc(sizeof(*node));
+	if(node == NULL)
+	{
+		return NULL;
+	}
+
+	node->path = (parent == NULL ? strdup(name) : join_paths(parent->path, name));
+	if(node->path == NULL)
+	{
+		free(node);
+		return NULL;
+	}
+
+	node->parent = parent;
+	node->name = node->path + strlen(node->path) - strlen(name);
+	node->pending = 1;
+	node->next = NULL;
+
+	if(parent != NULL)
+	{
+		pthread_mutex_lock(&rt->lock);
+		++parent->pending;
+		pthread_mutex_unlock(&rt->lock);
+	}
+
+	return node;
+}
+
+/* Marks end of processing of the node, removing the directory if nothing is
+ * left to be done for it and for its subdirectories.  parent_fd is either a
+ * descriptor of parent directory or -1. */
+static void
+finish_node(rmtree_t *rt, node_t *node, int parent_fd, local_t *local)
+{
+	pthread_mutex_lock(&rt->lock);
+	const int done = (--node->pending == 0);
+	const int stop = rt->stop;
+	pthread_mutex_unlock(&rt->lock);
+
+	if(!done)
+	{
+		return;
+	}
+
+	if(!stop)
+	{
+		const int error = (parent_fd == -1)
+		                ? rmdir(node->path)
+		                : unlinkat(parent_fd, node->name, AT_REMOVEDIR);
+		if(error != 0)
+		{
+			fail(rt, local);
+		}
+		else
+		{
+			++local->items;
+		}
+	}
+
+	node_t *const parent = node->parent;
+	free(node->path);
+	free(node);
+
+	if(parent != NULL)
+	{
+		finish_node(rt, parent, -1, local);
+	}
+}
+
+/* Records failure and requests all workers to stop. */
+static void
+fail(rmtree_t *rt, local_t *local)
+{
+	pthread_mutex_lock(&rt->lock);
+	rt->failed = 1;
+	rt->stop = 1;
+	pthread_cond_broadcast(&rt->work);
+	pthread_mutex_unlock(&rt->lock);
+
+	local->stop = 1;
+}
+
+/* Moves removals of a worker to the shared state. */
+static void
+flush(rmtree_t *rt, local_t *local, const char dir[])
+{
+	pthread_mutex_lock(&rt->lock);
+	if(local->items != 0U)
+	{
+		rt->items += local->items;
+		rt->bytes += local->bytes;
+		copy_str(rt->last_dir, sizeof(rt->last_dir), dir);
+	}
+	local->stop = rt->stop;
+	pthread_mutex_unlock(&rt->lock);
+
+	local->items = 0U;
+	local->bytes = 0U;
+}
+
+/* Reports removals made since the last call, if any. */
+static void
+report_progress(rmtree_t *rt, ioeta_estim_t *estim)
+{
+	char dir[PATH_MAX + 1];
+
+	pthread_mutex_lock(&rt->lock);
+	const size_t items = rt->items;
+	const uint64_t bytes = rt->bytes;
+	copy_str(dir, sizeof(dir), rt->last_dir);
+	rt->items = 0U;
+	rt->bytes = 0U;
+	pthread_mutex_unlock(&rt->lock);
+
+	if(items != 0U)
+	{
+		ioeta_update_bulk(estim, dir, items, bytes);
+	}
+}
+
+/* Computes absolute time of the next check of progress and cancellation. */
+static void
+get_deadline(struct timespec *ts)
+{
+	if(clock_gettime(CLOCK_REALTIME, ts) != 0)
+	{
+		ts->tv_sec = 0;
+		ts->tv_nsec = 0;
+		return;
+	}
+
+	ts->tv_nsec += POLL_INTERVAL_MS*1000000L;
+	if(ts->tv_nsec >= 1000000000L)
+	{
+		++ts->tv_sec;
+		ts->tv_nsec -= 1000000000L;
+	}
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,37 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__IO__PRIVATE__RMTREE_H__
+#define VIFM__IO__PRIVATE__RMTREE_H__
+
+#include "../ioc.h"
+
+/* rmtree - removal of directory trees by several threads (not for Windows) */
+
+/* Removes directory at args->arg1.path along with all of its content.  Files
+ * are removed relative to descriptors of their directories and independent
+ * subtrees are processed in parallel.  Progress is reported and cancellation
+ * is checked by the calling thread.  Nothing is reported on errors, instead
+ * processing stops as soon as possible and IO_RES_FAILED is returned to let
+ * the caller finish removal in a regular way.  Returns status. */
+IoRes rmtree(io_args_t *args);
+
+#endif /* VIFM__IO__PRIVATE__RMTREE_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -29,6 +29,9 @@
 #ifndef WIN32_PIPE_READ
 # include <sys/types.h>
 # include <sys/select.h> /* FD_* select() */
+# include <sys/socket.h> /* AF_UNIX SOCK_STREAM accept() bind() connect()
+                            listen() send() socket() */
+# include <sys/un.h> /* sockaddr_un */
 #else
 # define O_NONBLOCK 0
 # include <windows.h>
@@ -40,16 +43,19 @@
 # endif
 #endif
 
-#include <sys/stat.h> /* mkfifo() stat() */
+#include <sys/stat.h> /* chmod() lstat() stat() */
 #include <dirent.h> /* DIR closedir() opendir() readdir() */
 #include <fcntl.h>
-#include <unistd.h> /* close() open() select() unlink() usleep() */
+#include <unistd.h> /* close() getuid() read() select() unlink() usleep() */
 
-#include <errno.h> /* EACCES EEXIST EDQUOT ENOSPC ENXIO errno */
+#include <errno.h> /* EACCES EADDRINUSE EAGAIN ECONNREFUSED EDQUOT EINTR
+                      ENOSPC errno */
 #include <stddef.h> /* NULL size_t ssize_t */
-#include <stdio.h> /* FILE fclose() fdopen() fread() fwrite() */
-#include <stdlib.h> /* free() malloc() snprintf() */
-#include <string.h> /* strcmp() strcpy() strlen() */
+#include <stdint.h> /* uint32_t */
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* free() malloc() realloc() */
+#include <string.h> /* memcpy() memmove() memset() strcmp() strcpy() strdup()
+                        strlen() */
 
 #include "compat/fs_limits.h"
 #include "compat/os.h"
@@ -88,25 +94,57 @@
  *  - "args" to pass list of arguments, in which case body is prepended with CWD
  *    unconditionally;
  *  - "eval" to pass an expression for evaluation in a single line;
- *  - "eval-result" to communicate result of successful evaluation in a single
- *    line;
+ *  - "batch" to pass a batch of requests for execution in a single line;
+ *  - "eval-result" to communicate result of successful evaluation of an
+ *    expression or a batch in a single line;
  *  - "eval-error" to communicate failure of evaluation with no strings.
  *
  * On version mismatch or unknown field name, packet is discarded which is
  * logged.
+ *
+ * Every package is framed by prepending it with its size as a 32-bit unsigned
+ * integer in host byte order.
+ *
+ * On *nix each server listens on a Unix-domain stream socket.  A client
+ * connects to it and can send any number of packages over the same connection
+ * (they are processed in order).  Replies to "eval" packages are sent back over
+ * the connection on which the request was received, so clients don't need to
+ * be servers themselves.
+ *
+ * On Windows named pipes are used and replies are sent to a pipe of the
+ * instance specified in "from" field.
  */
 
-/* Prefix for names of all pipes to distinguish them from other pipes. */
+/* Prefix for names of all sockets and pipes to distinguish them from other
+ * files. */
 #define PREFIX "vifm-ipc-"
 
+/* Name of a server that's used when no name is provided. */
+#define DEFAULT_NAME "vifm"
+
 #ifndef WIN32_PIPE_READ
-typedef FILE *read_pipe_t;
-#define NULL_READ_PIPE NULL
+typedef int read_pipe_t;
+#define NULL_READ_PIPE (-1)
 #else
 typedef HANDLE read_pipe_t;
 #define NULL_READ_PIPE INVALID_HANDLE_VALUE
 #endif
 
+#ifndef WIN32_PIPE_READ
+
+/* Connection of a client accepted by a server or of a client to a server. */
+typedef struct
+{
+	int fd;     /* Socket of the connection. */
+	char *buf;  /* Data that was received, but wasn't processed yet. */
+	size_t len; /* Number of bytes in the buffer. */
+	size_t cap; /* Capacity of the buffer. */
+	int eof;    /* Whether the other side closed the connection or it failed. */
+}
+conn_t;
+
+#endif
+
 /* Holds list information for add_to_list(). */
 typedef struct
 {
@@ -124,33 +162,59 @@ struct ipc_t
 	ipc_args_cb args_cb;
 	/* Stores callback used for evaluation of expressions. */
 	ipc_eval_cb eval_cb;
+	/* Stores callback used for execution of batches. */
+	ipc_eval_cb batch_cb;
 	/* Whether this IPC instance should ignore check requests from outside. */
 	int locked;
-	/* Path to the pipe used by this instance. */
+	/* Path to the socket or pipe used by this instance. */
 	char pipe_path[PATH_MAX + 1];
-	/* Opened file of the pipe. */
+	/* Listening socket or opened pipe. */
 	read_pipe_t pipe_file;
+#ifndef WIN32_PIPE_READ
+	/* Connections of clients. */
+	conn_t *conns;
+	/* Number of elements in conns array. */
+	int nconns;
+#endif
 	/* Holds result of expression evaluation or NULL on evaluation error. */
 	char *eval_result;
 };
 
 static read_pipe_t create_pipe(const char name[], char path_buf[], size_t len);
-static char * receive_pkg(ipc_t *ipc, int *len);
+static char * receive_pkg(ipc_t *ipc, int *len, int *reply_fd);
 static read_pipe_t try_use_pipe(const char path[], int *fatal);
-static void handle_pkg(ipc_t *ipc, const char pkg[], const char *end);
+static void handle_pkg(ipc_t *ipc, int reply_fd, const char pkg[],
+		const char *end);
 static void handle_args(ipc_t *ipc, char ***array, int len);
-static void handle_expr(ipc_t *ipc, const char from[], char *array[], int len);
+static void handle_expr(ipc_t *ipc, const char from[], int reply_fd,
+		ipc_eval_cb cb, char *array[], int len);
 static void handle_eval_result(ipc_t *ipc, char *array[], int len);
+static char * request(ipc_t *ipc, const char whom[], const char type[],
+		const char payload[], int timeout_ms);
+static int send_reply(ipc_t *ipc, const char whom[], int reply_fd,
+		char *data[], const char type[]);
 static int format_and_send(ipc_t *ipc, const char whom[], char *data[],
-		const char type[]);
+		const char type[], int *conn_fd);
+static vle_textbuf * format_pkg(ipc_t *ipc, char *data[], const char type[]);
 static int send_pkg(ipc_t *ipc, const char whom[], const char what[],
-		size_t len);
+		size_t len, int *conn_fd);
 static char * get_the_only_target(const ipc_t *ipc);
 static char ** list_servers(const ipc_t *ipc, int *len);
 static int add_to_list(const char name[], const void *data, void *param);
 static const char * get_ipc_dir(void);
 #ifndef WIN32_PIPE_READ
-static int pipe_is_in_use(const char path[]);
+static char * receive_reply(ipc_t *ipc, int fd, int timeout_ms);
+static void accept_clients(ipc_t *ipc);
+static void drop_conn(ipc_t *ipc, int idx);
+static void conn_read(conn_t *conn);
+static char * conn_take_pkg(conn_t *conn, int *len);
+static int write_pkg(int fd, const char what[], size_t len);
+static int write_all(int fd, const char data[], size_t len);
+static int wait_for_fd(int fd, int for_write, int timeout_ms);
+static int connect_to(const char path[]);
+static int make_addr(const char path[], struct sockaddr_un *addr);
+static int set_nonblocking(int fd);
+static int socket_is_in_use(const char path[]);
 #endif
 
 /* Current version string. */
@@ -159,11 +223,28 @@ static const char IPC_VERSION[] = "version:1";
 static const char ARGS_TYPE[] = "args";
 /* Request to process remote expression. */
 static const char EVAL_TYPE[] = "eval";
+/* Request to process a batch of remote commands and expressions. */
+static const char BATCH_TYPE[] = "batch";
 /* Reply to remote expression with the result after successful evaluation. */
 static const char EVAL_RESULT_TYPE[] = "eval-result";
 /* Reply to remote expression on error. */
 static const char EVAL_ERROR_TYPE[] = "eval-error";
 
+/* Maximum time to wait for a reply to an expression in milliseconds. */
+static const int EVAL_TIMEOUT_MS = 1000;
+/* Maximum time to wait for a reply to a batch in milliseconds.  Negative value
+ * means waiting for as long as the connection is open (*nix only, Windows uses
+ * a limit of ten minutes instead). */
+static const int BATCH_TIMEOUT_MS = -1;
+
+#ifndef WIN32_PIPE_READ
+/* Maximum time to wait for the other side to accept more data in
+ * milliseconds. */
+static const int WRITE_TIMEOUT_MS = 1000;
+/* Minimal number of bytes to request on reading from a socket. */
+static const size_t READ_CHUNK = 4096;
+#endif
+
 int
 ipc_enabled(void)
 {
@@ -171,7 +252,8 @@ ipc_enabled(void)
 }
 
 ipc_t *
-ipc_init(const char name[], ipc_args_cb args_cb, ipc_eval_cb eval_cb)
+ipc_init(const char name[], ipc_args_cb args_cb, ipc_eval_cb eval_cb,
+		ipc_eval_cb batch_cb)
 {
 	ipc_t *const ipc = malloc(sizeof(*ipc));
 	if(ipc == NULL)
@@ -181,11 +263,16 @@ ipc_init(const char name[], ipc_args_cb args_cb, ipc_eval_cb eval_cb)
 
 	ipc->args_cb = args_cb;
 	ipc->eval_cb = eval_cb;
+	ipc->batch_cb = batch_cb;
 	ipc->locked = 0;
+#ifndef WIN32_PIPE_READ
+	ipc->conns = NULL;
+	ipc->nconns = 0;
+#endif
 
 	if(name == NULL)
 	{
-		name = "vifm";
+		name = DEFAULT_NAME;
 	}
 
 	ipc->pipe_file = create_pipe(name, ipc->pipe_path, sizeof(ipc->pipe_path));
@@ -207,7 +294,13 @@ ipc_free(ipc_t *ipc)
 	}
 
 #ifndef WIN32_PIPE_READ
-	fclose(ipc->pipe_file);
+	while(ipc->nconns != 0)
+	{
+		drop_conn(ipc, ipc->nconns - 1);
+	}
+	free(ipc->conns);
+
+	close(ipc->pipe_file);
 	unlink(ipc->pipe_path);
 #else
 	CloseHandle(ipc->pipe_file);
@@ -225,6 +318,7 @@ int
 ipc_check(ipc_t *ipc)
 {
 	int len;
+	int reply_fd;
 	char *pkg;
 
 	if(ipc->locked)
@@ -232,87 +326,68 @@ ipc_check(ipc_t *ipc)
 		return 0;
 	}
 
-	pkg = receive_pkg(ipc, &len);
+	pkg = receive_pkg(ipc, &len, &reply_fd);
 	if(pkg != NULL)
 	{
-		handle_pkg(ipc, pkg, pkg + len);
+		handle_pkg(ipc, reply_fd, pkg, pkg + len);
 		free(pkg);
 		return 1;
 	}
 	return 0;
 }
 
-/* Receives message addressed to this instance.  Returns NULL if there was no
- * message or on failure to read it, otherwise newly allocated string is
- * returned. */
+/* Receives message addressed to this instance.  *reply_fd is set to descriptor
+ * to be used for sending a reply or to -1 if replies should be sent to sender's
+ * pipe.  Returns NULL if there was no message or on failure to read it,
+ * otherwise newly allocated string is returned. */
 static char *
-receive_pkg(ipc_t *ipc, int *len)
+receive_pkg(ipc_t *ipc, int *len, int *reply_fd)
 {
 #ifndef WIN32_PIPE_READ
-	uint32_t size;
+	int i;
 	char *pkg;
-	char *p;
-
-	fd_set ready;
-	int max_fd;
-	struct timeval ts = { .tv_sec = 0, .tv_usec = 10000 };
 
-	/* At least on OS X pipe might get into EOF state, so reset it.  This will
-	 * also reset any errors, which is fine with us. */
-	clearerr(ipc->pipe_file);
+	accept_clients(ipc);
 
-	if(fread(&size, sizeof(size), 1U, ipc->pipe_file) != 1U ||
-			size >= 4294967294U)
+	/* Go from the end to be able to drop connections while iterating. */
+	for(i = ipc->nconns - 1; i >= 0; --i)
 	{
-		return NULL;
-	}
-
-	pkg = malloc(size + 1U);
-	if(pkg == NULL)
-	{
-		LOG_ERROR_MSG("Failed to allocate memory: %lu", (unsigned long)(size + 1));
-		return NULL;
-	}
-
-	max_fd = fileno(ipc->pipe_file);
-	FD_ZERO(&ready);
-	FD_SET(max_fd, &ready);
-
-	p = pkg;
-	while(size != 0U && select(max_fd + 1, &ready, NULL, NULL, &ts) > 0)
-	{
-		const size_t nread = fread(p, 1U, size, ipc->pipe_file);
-		size -= nread;
-		p += nread;
+		conn_t *const conn = &ipc->conns[i];
 
-		if(nread == 0U)
+		/* Process what was received earlier before reading more data. */
+		pkg = conn_take_pkg(conn, len);
+		if(pkg == NULL && !conn->eof)
 		{
-			break;
+			conn_read(conn);
+			pkg = conn_take_pkg(conn, len);
 		}
 
-		ts.tv_sec = 0;
-		ts.tv_usec = 10000;
-	}
+		if(pkg != NULL)
+		{
+			*reply_fd = conn->fd;
+			return pkg;
+		}
 
-	if(size != 0U)
-	{
-		free(pkg);
-		LOG_ERROR_MSG("Failed to read whole packet, left: %lu",
-				(unsigned long)size);
-		return NULL;
+		if(conn->eof)
+		{
+			if(conn->len != 0U)
+			{
+				LOG_ERROR_MSG("Failed to read whole packet, got: %lu",
+						(unsigned long)conn->len);
+			}
+			drop_conn(ipc, i);
+		}
 	}
 
-	/* Make sure we have a trailing zero. */
-	*p = '\0';
-	*len = p - pkg;
-
-	return pkg;
+	return NULL;
 #else
 	uint32_t size;
 	char *pkg;
 	char *p;
 	DWORD nread;
 
+	*reply_fd = -1;
+
 	if(ReadFile(ipc->pipe_file, &size, sizeof(size), &nread, NULL) == FALSE ||
 			size >= 4294967294U)
 	{
@@ -387,60 +462,70 @@ create_pipe(const char name[], char path_buf[], size_t len)
 	return rp;
 }
 
-/* Either creates a pipe or reused previously abandoned one.  Returns
- * NULL_READ_PIPE on failure (with *fatal set to non-zero if further tries don't
- * make any sense) or valid file descriptor otherwise. */
+/* Either creates a socket (pipe on Windows) or reuses previously abandoned one.
+ * Returns NULL_READ_PIPE on failure (with *fatal set to non-zero if further
+ * tries don't make any sense) or valid file descriptor otherwise. */
 static read_pipe_t
 try_use_pipe(const char path[], int *fatal)
 {
 #ifndef WIN32_PIPE_READ
-	FILE *f;
+	struct sockaddr_un addr;
 	int fd;
 
 	*fatal = 0;
 
-	/* Try to create a pipe. */
-	if(mkfifo(path, 0600) == 0)
+	if(make_addr(path, &addr) != 0)
 	{
-		/* Open if created. */
-		const int fd = open(path, O_RDONLY | O_NONBLOCK);
-		if(fd == -1)
-		{
-			if(errno == EACCES)
-			{
-				/* If we created a file that we can't open, remove it and assume that
-				 * something is fundamentally wrong with the system setup. */
-				(void)unlink(path);
-				*fatal = 1;
-			}
-			return NULL_READ_PIPE;
-		}
-		return fdopen(fd, "r");
+		LOG_ERROR_MSG("Path to socket is too long: %s", path);
+		*fatal = 1;
+		return NULL_READ_PIPE;
 	}
 
-	/* Fail fast if the error is not related to existence of the file or pipe
-	 * exists and is in use. */
-	if(errno != EEXIST || pipe_is_in_use(path))
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd == -1)
 	{
-		/* No retries if file-system is unable to create more files. */
-		*fatal = (errno == EDQUOT || errno == ENOSPC);
+		LOG_SERROR_MSG(errno, "Failed to create a socket");
+		*fatal = 1;
 		return NULL_READ_PIPE;
 	}
 
-	/* Use this file if we're the only one willing to read from it. */
-	fd = open(path, O_RDONLY | O_NONBLOCK);
-
-	if(fd == -1)
+	if(bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
 	{
-		return NULL_READ_PIPE;
+		const int error = errno;
+
+		/* Fail fast if the error is not related to existence of the file or
+		 * socket exists and is in use. */
+		if(error != EADDRINUSE || socket_is_in_use(path))
+		{
+			/* No retries if file-system is unable to create more files. */
+			*fatal = (error == EDQUOT || error == ENOSPC);
+			close(fd);
+			return NULL_READ_PIPE;
+		}
+
+		/* Take over socket that was left behind by an instance that wasn't shut
+		 * down properly. */
+		if(unlink(path) != 0 ||
+				bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+		{
+			close(fd);
+			return NULL_READ_PIPE;
+		}
 	}
 
-	f = fdopen(fd, "r");
-	if(f == NULL_READ_PIPE)
+	/* Permissions of the socket file depend on umask, restrict them before
+	 * anyone can connect to be the only user able to send commands. */
+	if(chmod(path, 0600) != 0 || listen(fd, SOMAXCONN) != 0 ||
+			set_nonblocking(fd) != 0)
 	{
+		LOG_SERROR_MSG(errno, "Failed to start listening on a socket");
 		close(fd);
+		(void)unlink(path);
+		*fatal = 1;
+		return NULL_READ_PIPE;
 	}
-	return f;
+
+	return fd;
 #else
 	*fatal = 0;
 	return CreateNamedPipeA(path,
@@ -450,9 +535,10 @@ try_use_pipe(const char path[], int *fatal)
 #endif
 }
 
-/* Parses pkg into array of strings and invokes callback. */
+/* Parses pkg into array of strings and invokes callback.  reply_fd is passed
+ * through to handlers that might need to reply. */
 static void
-handle_pkg(ipc_t *ipc, const char pkg[], const char *end)
+handle_pkg(ipc_t *ipc, int reply_fd, const char pkg[], const char *end)
 {
 	char **array = NULL;
 	size_t len = 0U;
@@ -507,7 +593,11 @@ handle_pkg(ipc_t *ipc, const char pkg[], const char *end)
 	}
 	else if(strcmp(type, EVAL_TYPE) == 0)
 	{
-		handle_expr(ipc, from, array, len);
+		handle_expr(ipc, from, reply_fd, ipc->eval_cb, array, len);
+	}
+	else if(strcmp(type, BATCH_TYPE) == 0)
+	{
+		handle_expr(ipc, from, reply_fd, ipc->batch_cb, array, len);
 	}
 	else if(strcmp(type, EVAL_RESULT_TYPE) == 0)
 	{
@@ -542,9 +632,10 @@ handle_args(ipc_t *ipc, char ***array, int len)
 	}
 }
 
-/* Handles received message with expression to evaluate. */
+/* Handles received message with expression or batch to evaluate via the cb. */
 static void
-handle_expr(ipc_t *ipc, const char from[], char *array[], int len)
+handle_expr(ipc_t *ipc, const char from[], int reply_fd, ipc_eval_cb cb,
+		char *array[], int len)
 {
 	char *result;
 
@@ -555,12 +646,12 @@ handle_expr(ipc_t *ipc, const char from[], char *array[], int len)
 	}
 
 	ipc->locked = 1;
-	result = ipc->eval_cb(array[0]);
+	result = cb(array[0]);
 	ipc->locked = 0;
 	if(result == NULL)
 	{
 		char *data[] = { NULL };
-		if(format_and_send(ipc, from, data, EVAL_ERROR_TYPE) != 0)
+		if(send_reply(ipc, from, reply_fd, data, EVAL_ERROR_TYPE) != 0)
 		{
 			LOG_ERROR_MSG("Failed to report evaluation failure");
 		}
@@ -568,7 +659,7 @@ handle_expr(ipc_t *ipc, const char from[], char *array[], int len)
 	else
 	{
 		char *data[] = { result, NULL };
-		if(format_and_send(ipc, from, data, EVAL_RESULT_TYPE) != 0)
+		if(send_reply(ipc, from, reply_fd, data, EVAL_RESULT_TYPE) != 0)
 		{
 			LOG_ERROR_MSG("Failed to report evaluation result");
 		}
@@ -587,22 +678,78 @@ handle_eval_result(ipc_t *ipc, char *array[], int len)
 	}
 }
 
+/* Sends a reply either over connection on which request was received or to
+ * the whom instance if reply_fd is -1.  Returns zero on success and non-zero
+ * otherwise. */
+static int
+send_reply(ipc_t *ipc, const char whom[], int reply_fd, char *data[],
+		const char type[])
+{
+#ifndef WIN32_PIPE_READ
+	if(reply_fd != -1)
+	{
+		vle_textbuf *pkg = format_pkg(ipc, data, type);
+		if(pkg == NULL)
+		{
+			return 1;
+		}
+
+		int ret = write_pkg(reply_fd, vle_tb_get_data(pkg), vle_tb_get_len(pkg));
+		vle_tb_free(pkg);
+		return ret;
+	}
+#endif
+
+	return format_and_send(ipc, whom, data, type, NULL);
+}
+
 int
 ipc_send(ipc_t *ipc, const char whom[], char *data[])
 {
-	return format_and_send(ipc, whom, data, ARGS_TYPE);
+	return format_and_send(ipc, whom, data, ARGS_TYPE, NULL);
 }
 
 char *
 ipc_eval(ipc_t *ipc, const char whom[], const char expr[])
 {
-	enum { MAX_USEC = 1000000, MAX_REPEATS = 20 };
+	return request(ipc, whom, EVAL_TYPE, expr, EVAL_TIMEOUT_MS);
+}
+
+char *
+ipc_batch(ipc_t *ipc, const char whom[], const char batch[])
+{
+	/* Batches can take arbitrary amount of time to process. */
+	return request(ipc, whom, BATCH_TYPE, batch, BATCH_TIMEOUT_MS);
+}
+
+/* Sends a request of the specified type and waits for a reply for at most
+ * timeout_ms milliseconds (negative value means no limit).  Returns result
+ * converted to a string or NULL on error. */
+static char *
+request(ipc_t *ipc, const char whom[], const char type[], const char payload[],
+		int timeout_ms)
+{
+	char *data[] = { (char *)payload, NULL };
+
+#ifndef WIN32_PIPE_READ
+	int fd;
+	if(format_and_send(ipc, whom, data, type, &fd) != 0)
+	{
+		LOG_ERROR_MSG("Failed to send %s request", type);
+		return NULL;
+	}
+
+	char *result = receive_reply(ipc, fd, timeout_ms);
+	close(fd);
+	return result;
+#else
+	enum { DELAY_MS = 50, NO_LIMIT_MS = 10*60*1000 };
 	int repeats;
+	const int max_repeats = (timeout_ms < 0 ? NO_LIMIT_MS : timeout_ms)/DELAY_MS;
 
-	char *data[] = { (char *)expr, NULL };
-	if(format_and_send(ipc, whom, data, EVAL_TYPE) != 0)
+	if(format_and_send(ipc, whom, data, type, NULL) != 0)
 	{
-		LOG_ERROR_MSG("Failed to send expression");
+		LOG_ERROR_MSG("Failed to send %s request", type);
 		return NULL;
 	}
 
@@ -611,26 +758,61 @@ ipc_eval(ipc_t *ipc, const char whom[], const char expr[])
 	repeats = 0;
 	while(!ipc_check(ipc))
 	{
-		if(++repeats > MAX_REPEATS)
+		if(++repeats > max_repeats)
 		{
-			LOG_ERROR_MSG("Timed out on waiting for --remote-expr response");
+			LOG_ERROR_MSG("Timed out on waiting for a reply");
 			return NULL;
 		}
-		usleep(MAX_USEC/MAX_REPEATS);
+		usleep(DELAY_MS*1000);
 	}
 
 	return ipc->eval_result;
+#endif
 }
 
 /* Formats and sends a message of specified type.  The data array should be NULL
- * terminated.  Returns zero on successful send and non-zero otherwise. */
+ * terminated.  If conn_fd isn't NULL, connection is left open for receiving a
+ * reply and its descriptor is stored in *conn_fd (*nix only).  Returns zero on
+ * successful send and non-zero otherwise. */
 static int
-format_and_send(ipc_t *ipc, const char whom[], char *data[], const char type[])
+format_and_send(ipc_t *ipc, const char whom[], char *data[], const char type[],
+		int *conn_fd)
+{
+	vle_textbuf *pkg = format_pkg(ipc, data, type);
+	if(pkg == NULL)
+	{
+		return 1;
+	}
+
+	char *name = NULL;
+	if(whom == NULL)
+	{
+		name = get_the_only_target(ipc);
+		if(name == NULL)
+		{
+			vle_tb_free(pkg);
+			return 1;
+		}
+		whom = name;
+	}
+
+	int ret = send_pkg(ipc, whom, vle_tb_get_data(pkg), vle_tb_get_len(pkg),
+			conn_fd);
+	vle_tb_free(pkg);
+
+	free(name);
+	return ret;
+}
+
+/* Formats a message of specified type.  The data array should be NULL
+ * terminated.  Returns the package or NULL on error. */
+static vle_textbuf *
+format_pkg(ipc_t *ipc, char *data[], const char type[])
 {
 	vle_textbuf *pkg = vle_tb_create();
 	if(pkg == NULL)
 	{
-		return -1;
+		return NULL;
 	}
 
 	/* Compose "header". */
@@ -645,7 +827,7 @@ format_and_send(ipc_t *ipc, const char whom[], char *data[], const char type[])
 		{
 			vle_tb_free(pkg);
 			LOG_ERROR_MSG("Can't get working directory");
-			return 1;
+			return NULL;
 		}
 		vle_tb_appendf(pkg, "%s%c", cwd, '\0');
 	}
@@ -655,29 +837,15 @@ format_and_send(ipc_t *ipc, const char whom[], char *data[], const char type[])
 		vle_tb_appendf(pkg, "%s%c", *data++, '\0');
 	}
 
-	char *name = NULL;
-	if(whom == NULL)
-	{
-		name = get_the_only_target(ipc);
-		if(name == NULL)
-		{
-			vle_tb_free(pkg);
-			return 1;
-		}
-		whom = name;
-	}
-
-	int ret = send_pkg(ipc, whom, vle_tb_get_data(pkg), vle_tb_get_len(pkg));
-	vle_tb_free(pkg);
-
-	free(name);
-	return ret;
+	return pkg;
 }
 
-/* Performs actual sending of package to another instance.  Returns zero on
- * success and non-zero otherwise. */
+/* Performs actual sending of package to another instance.  See
+ * format_and_send() for description of conn_fd.  Returns zero on success and
+ * non-zero otherwise. */
 static int
-send_pkg(ipc_t *ipc, const char whom[], const char what[], size_t len)
+send_pkg(ipc_t *ipc, const char whom[], const char what[], size_t len,
+		int *conn_fd)
 {
 	if(stroscmp(ipc_get_name(ipc), whom) == 0)
 	{
@@ -688,38 +856,30 @@ send_pkg(ipc_t *ipc, const char whom[], const char what[], size_t len)
 #ifndef WIN32_PIPE_READ
 	char path[PATH_MAX + 1];
 	int fd;
-	FILE *dst;
-	uint32_t size;
 
 	snprintf(path, sizeof(path), "%s/" PREFIX "%s", get_ipc_dir(), whom);
 
-	fd = open(path, O_WRONLY);
+	fd = connect_to(path);
 	if(fd == -1)
 	{
-		LOG_SERROR_MSG(errno, "Failed to open destination pipe");
+		LOG_SERROR_MSG(errno, "Failed to connect to destination socket");
 		return 1;
 	}
 
-	dst = fdopen(fd, "w");
-	if(dst == NULL)
+	if(write_pkg(fd, what, len) != 0)
 	{
-		LOG_SERROR_MSG(errno, "Failed to turn file descriptor into a FILE");
+		LOG_SERROR_MSG(errno, "Failed to write into a socket");
 		close(fd);
 		return 1;
 	}
 
-	size = len;
-	if(fwrite(&size, sizeof(size), 1U, dst) != 1U ||
-			fwrite(what, len, 1U, dst) != 1U)
+	if(conn_fd != NULL)
 	{
-		LOG_SERROR_MSG(errno, "Failed to write into a pipe");
-		(void)fclose(dst);
-		return 1;
+		*conn_fd = fd;
 	}
-
-	if(fclose(dst) != 0)
+	else
 	{
-		LOG_SERROR_MSG(errno, "Failure on close a pipe");
+		close(fd);
 	}
 	return 0;
 #else
@@ -758,8 +918,9 @@ get_the_only_target(const ipc_t *ipc)
 {
 	int len;
 	char *name;
-	char **list = list_servers(ipc, &len);
+	char **list;
 
+	list = list_servers(ipc, &len);
 	if(len == 0)
 	{
 		return NULL;
@@ -825,8 +986,8 @@ list_servers(const ipc_t *ipc, int *len)
 	return data.lst;
 }
 
-/* Analyzes pipe and adds it to the list of pipes.  Returns zero on success or
- * non-zero on error. */
+/* Analyzes socket or pipe and adds it to the list of servers.  Returns zero on
+ * success or non-zero on error. */
 static int
 add_to_list(const char name[], const void *data, void *param)
 {
@@ -851,8 +1012,9 @@ add_to_list(const char name[], const void *data, void *param)
 		char path[PATH_MAX + 1];
 		struct stat statbuf;
 		snprintf(path, sizeof(path), "%s/%s", list_data->ipc_dir, name);
-		if(stat(path, &statbuf) != 0 || !S_ISFIFO(statbuf.st_mode) ||
-				!pipe_is_in_use(path) || os_access(path, R_OK) != 0)
+		/* Sockets of other users can't be used to communicate. */
+		if(lstat(path, &statbuf) != 0 || !S_ISSOCK(statbuf.st_mode) ||
+				statbuf.st_uid != getuid() || !socket_is_in_use(path))
 		{
 			return 0;
 		}
@@ -864,7 +1026,7 @@ add_to_list(const char name[], const void *data, void *param)
 	return 0;
 }
 
-/* Retrieves directory where FIFO objects are created.  Returns the path. */
+/* Retrieves directory where IPC objects are created.  Returns the path. */
 static const char *
 get_ipc_dir(void)
 {
@@ -877,24 +1039,335 @@ get_ipc_dir(void)
 
 #ifndef WIN32_PIPE_READ
 
-/* Tries to open a pipe to check whether it has any readers or it's
- * abandoned.  Returns non-zero if somebody is reading from the pipe and zero
- * otherwise. */
-static int
-pipe_is_in_use(const char path[])
+/* Waits for reply to a request sent over the fd connection for at most
+ * timeout_ms milliseconds between pieces of data (negative value means no
+ * limit).  Returns result of evaluation or NULL on error. */
+static char *
+receive_reply(ipc_t *ipc, int fd, int timeout_ms)
+{
+	conn_t conn = { .fd = fd };
+	char *pkg;
+	int len;
+
+	while((pkg = conn_take_pkg(&conn, &len)) == NULL)
+	{
+		if(conn.eof)
+		{
+			LOG_ERROR_MSG("Connection was closed before receiving a reply");
+			free(conn.buf);
+			return NULL;
+		}
+
+		if(wait_for_fd(fd, 0, timeout_ms) <= 0)
+		{
+			LOG_ERROR_MSG("Timed out on waiting for a reply");
+			free(conn.buf);
+			return NULL;
+		}
+
+		conn_read(&conn);
+	}
+	free(conn.buf);
+
+	ipc->eval_result = NULL;
+	handle_pkg(ipc, -1, pkg, pkg + len);
+	free(pkg);
+
+	return ipc->eval_result;
+}
+
+/* Accepts all pending connections to the server. */
+static void
+accept_clients(ipc_t *ipc)
 {
-	const int fd = open(path, O_WRONLY | O_NONBLOCK);
-	if(fd != -1 || errno != ENXIO)
+	for(;;)
 	{
-		if(fd != -1)
+		const int fd = accept(ipc->pipe_file, NULL, NULL);
+		if(fd == -1)
 		{
+			if(errno == EINTR)
+			{
+				continue;
+			}
+			if(errno != EAGAIN && errno != EWOULDBLOCK)
+			{
+				LOG_SERROR_MSG(errno, "Failed to accept a connection");
+			}
+			break;
+		}
+
+		void *const conns = realloc(ipc->conns,
+				sizeof(*ipc->conns)*(ipc->nconns + 1));
+		if(conns == NULL || set_nonblocking(fd) != 0)
+		{
+			ipc->conns = (conns == NULL ? ipc->conns : conns);
 			close(fd);
+			continue;
+		}
+
+		ipc->conns = conns;
+		ipc->conns[ipc->nconns++] = (conn_t){ .fd = fd };
+	}
+}
+
+/* Closes connection and removes it from the list. */
+static void
+drop_conn(ipc_t *ipc, int idx)
+{
+	close(ipc->conns[idx].fd);
+	free(ipc->conns[idx].buf);
+
+	--ipc->nconns;
+	memmove(&ipc->conns[idx], &ipc->conns[idx + 1],
+			sizeof(*ipc->conns)*(ipc->nconns - idx));
+}
+
+/* Reads all data that's currently available on the connection without
+ * blocking.  Sets eof field at the end of the stream or on error. */
+static void
+conn_read(conn_t *conn)
+{
+	for(;;)
+	{
+		if(conn->cap - conn->len < READ_CHUNK)
+		{
+			const size_t new_cap = conn->cap*2 + READ_CHUNK;
+			char *const buf = realloc(conn->buf, new_cap);
+			if(buf == NULL)
+			{
+				conn->eof = 1;
+				break;
+			}
+			conn->buf = buf;
+			conn->cap = new_cap;
+		}
+
+		const ssize_t nread = read(conn->fd, conn->buf + conn->len,
+				conn->cap - conn->len);
+		if(nread > 0)
+		{
+			conn->len += nread;
+			continue;
+		}
+
+		if(nread == -1 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if(nread == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+		{
+			conn->eof = 1;
 		}
+		break;
+	}
+}
+
+/* Extracts first complete package from buffer of the connection.  Returns NULL
+ * if there is no complete package, otherwise newly allocated string is
+ * returned. */
+static char *
+conn_take_pkg(conn_t *conn, int *len)
+{
+	uint32_t size;
+	char *pkg;
+
+	if(conn->len < sizeof(size))
+	{
+		return NULL;
+	}
+
+	memcpy(&size, conn->buf, sizeof(size));
+	if(size >= 4294967294U)
+	{
+		LOG_ERROR_MSG("Dropping connection due to invalid packet size: %lu",
+				(unsigned long)size);
+		conn->len = 0U;
+		conn->eof = 1;
+		return NULL;
+	}
+
+	if(conn->len - sizeof(size) < size)
+	{
+		return NULL;
+	}
+
+	pkg = malloc(size + 1U);
+	if(pkg == NULL)
+	{
+		LOG_ERROR_MSG("Failed to allocate memory: %lu", (unsigned long)(size + 1));
+		return NULL;
+	}
+
+	memcpy(pkg, conn->buf + sizeof(size), size);
+	/* Make sure we have a trailing zero. */
+	pkg[size] = '\0';
+	*len = size;
+
+	conn->len -= sizeof(size) + size;
+	memmove(conn->buf, conn->buf + sizeof(size) + size, conn->len);
+
+	return pkg;
+}
+
+/* Writes a package prepended with its size.  Returns zero on success and
+ * non-zero otherwise. */
+static int
+write_pkg(int fd, const char what[], size_t len)
+{
+	const uint32_t size = len;
+	if(write_all(fd, (const char *)&size, sizeof(size)) != 0)
+	{
 		return 1;
 	}
+	return write_all(fd, what, len);
+}
+
+/* Writes all of the data into a non-blocking socket waiting for it to become
+ * writable when necessary.  Returns zero on success and non-zero otherwise. */
+static int
+write_all(int fd, const char data[], size_t len)
+{
+	while(len != 0U)
+	{
+#ifdef MSG_NOSIGNAL
+		const ssize_t nwritten = send(fd, data, len, MSG_NOSIGNAL);
+#else
+		const ssize_t nwritten = send(fd, data, len, 0);
+#endif
+		if(nwritten > 0)
+		{
+			data += nwritten;
+			len -= nwritten;
+			continue;
+		}
+
+		if(nwritten == -1 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if(nwritten == 0 || (errno != EAGAIN && errno != EWOULDBLOCK) ||
+				wait_for_fd(fd, 1, WRITE_TIMEOUT_MS) <= 0)
+		{
+			return 1;
+		}
+	}
 	return 0;
 }
 
+/* Waits for file descriptor to become readable or writable (if for_write is
+ * non-zero).  Negative timeout means waiting without a limit.  Returns positive
+ * number if it did, zero on timeout and negative number on error. */
+static int
+wait_for_fd(int fd, int for_write, int timeout_ms)
+{
+	fd_set fds;
+	struct timeval tv = {
+		.tv_sec = timeout_ms/1000,
+		.tv_usec = (timeout_ms%1000)*1000,
+	};
+
+	int ret;
+	do
+	{
+		FD_ZERO(&fds);
+		FD_SET(fd, &fds);
+		ret = select(fd + 1, for_write ? NULL : &fds, for_write ? &fds : NULL,
+				NULL, timeout_ms < 0 ? NULL : &tv);
+	}
+	while(ret == -1 && errno == EINTR);
+	return ret;
+}
+
+/* Connects to a server listening on the path.  Returns non-blocking socket or
+ * -1 on error. */
+static int
+connect_to(const char path[])
+{
+	struct sockaddr_un addr;
+	if(make_addr(path, &addr) != 0)
+	{
+		return -1;
+	}
+
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd == -1)
+	{
+		return -1;
+	}
+
+	if(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+			set_nonblocking(fd) != 0)
+	{
+		const int error = errno;
+		close(fd);
+		errno = error;
+		return -1;
+	}
+
+#ifdef SO_NOSIGPIPE
+	const int on = 1;
+	(void)setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+	return fd;
+}
+
+/* Fills address structure for the path.  Returns zero on success and non-zero
+ * if the path is too long. */
+static int
+make_addr(const char path[], struct sockaddr_un *addr)
+{
+	if(strlen(path) >= sizeof(addr->sun_path))
+	{
+		return 1;
+	}
+
+	memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+	strcpy(addr->sun_path, path);
+	return 0;
+}
+
+/* Makes file descriptor non-blocking and not inheritable by child processes
+ * (otherwise they could keep server socket alive after vifm exits).  Returns
+ * zero on success and non-zero otherwise. */
+static int
+set_nonblocking(int fd)
+{
+	const int flags = fcntl(fd, F_GETFL);
+	if(flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+	{
+		return 1;
+	}
+	return (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1);
+}
+
+/* Tries to connect to a socket to check whether it has a server or it's
+ * abandoned.  Files that aren't sockets or belong to other users are considered
+ * to be in use to avoid removing them.  Returns non-zero if socket is in use
+ * and zero otherwise. */
+static int
+socket_is_in_use(const char path[])
+{
+	struct stat statbuf;
+	if(lstat(path, &statbuf) != 0 || !S_ISSOCK(statbuf.st_mode) ||
+			statbuf.st_uid != getuid())
+	{
+		return 1;
+	}
+
+	const int fd = connect_to(path);
+	if(fd != -1)
+	{
+		close(fd);
+		return 1;
+	}
+	/* Socket which can't be accessed isn't served by our instance. */
+	return (errno != ECONNREFUSED && errno != EACCES);
+}
+
 #endif
 
 #else
@@ -915,7 +1388,8 @@ ipc_list(int *len)
 }
 
 ipc_t *
-ipc_init(const char name[], ipc_args_cb args_cb, ipc_eval_cb eval_cb)
+ipc_init(const char name[], ipc_args_cb args_cb, ipc_eval_cb eval_cb,
+		ipc_eval_cb batch_cb)
 {
 	return NULL;
 }
@@ -949,6 +1423,12 @@ ipc_eval(ipc_t *ipc, const char whom[], const char expr[])
 	return NULL;
 }
 
+char *
+ipc_batch(ipc_t *ipc, const char whom[], const char batch[])
+{
+	return NULL;
+}
+
 #endif
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -27,9 +27,9 @@ typedef struct ipc_t ipc_t;
  * be processed. */
 typedef void (*ipc_args_cb)(char *args[]);
 
-/* Type of function that is invoked when expression is received.  Evaluates
- * expression from a remote instance.  Should return newly allocated string
- * with the result or NULL on error. */
+/* Type of function that is invoked when expression or batch is received.
+ * Evaluates expression or executes batch from a remote instance.  Should return
+ * newly allocated string with the result or NULL on error. */
 typedef char * (*ipc_eval_cb)(const char expr[]);
 
 /* Checks whether IPC is in use.  Returns non-zero if so, otherwise zero is
@@ -42,7 +42,8 @@ char ** ipc_list(int *len);
 
 /* Initializes IPC unit state.  name can be NULL, which will use the default
  * one (VIFM).  Callbacks will be called on ipc_check(). */
-ipc_t * ipc_init(const char name[], ipc_args_cb args_cb, ipc_eval_cb eval_cb);
+ipc_t * ipc_init(const char name[], ipc_args_cb args_cb, ipc_eval_cb eval_cb,
+		ipc_eval_cb batch_cb);
 
 /* Frees resources associated with an instance of IPC.  The parameter can be
  * NULL. */
@@ -64,6 +65,11 @@ int ipc_send(ipc_t *ipc, const char whom[], char *data[]);
  * of ipc_send().  Returns result converted to a string or NULL on error. */
 char * ipc_eval(ipc_t *ipc, const char whom[], const char expr[]);
 
+/* Executes batch of requests in a remote instance.  Format of the batch is
+ * defined by the callback of the server.  Rules for arguments match those of
+ * ipc_send().  Returns result of the batch or NULL on error. */
+char * ipc_batch(ipc_t *ipc, const char whom[], const char batch[]);
+
 #endif /* VIFM__IPC_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -26,8 +26,10 @@
 #include "../ui/fileview.h"
 #include "../ui/statusbar.h"
 #include "../ui/ui.h"
+#include "../utils/macros.h"
 #include "../utils/str.h"
 #include "../filelist.h"
+#include "../status.h"
 #include "../types.h"
 #include "lua/lauxlib.h"
 #include "lua/lua.h"
@@ -39,12 +41,23 @@
 static int check_viewcolumn_name(vlua_t *vlua, const char name[]);
 static void lua_viewcolumn_handler(void *data, size_t buf_len, char buf[],
 		const format_info_t *info);
+static int fill_values(lua_State *lua, void *handler, column_data_t *cdt,
+		int width, int batch, int async);
+static int call_handler(lua_State *lua, void *handler);
+static void print_result(lua_State *lua, column_data_t *cdt, size_t buf_len,
+		char buf[]);
+static void push_key(lua_State *lua, const dir_entry_t *entry, int width);
+static int get_flag(lua_State *lua, int table_idx, const char name[]);
+static int VLUA_API(viewcolumn_set)(lua_State *lua);
+
+VLUA_DECLARE_SAFE(viewcolumn_set);
 
 /* Minimal ID for columns added by this view. */
 enum { FIRST_LUA_COLUMN_ID = SK_TOTAL };
 
 /* Address of this variable serves as a key in Lua table.  The associated table
- * is doubly keyed: by column name and by corresponding ID. */
+ * is doubly keyed: by column name and by corresponding ID.  Columns that cache
+ * their values have "values" table keyed by strings produced by push_key(). */
 static char viewcolumns_key;
 /* Next id for a view column. */
 static int viewcolumn_next_id = FIRST_LUA_COLUMN_ID;
@@ -122,6 +135,27 @@ vifm_viewcolumns_is_primary(vlua_t *vlua, int column_id)
 	return is_primary;
 }
 
+void
+vifm_viewcolumns_drop_cache(vlua_t *vlua)
+{
+	lua_State *lua = vlua->lua;
+
+	/* Don't need lua_pcall() to handle errors, because no one should be able to
+	 * mess with internal tables. */
+	vlua_state_get_table(vlua, &viewcolumns_key);
+	lua_pushnil(lua);
+	while(lua_next(lua, -2) != 0)
+	{
+		if(lua_getfield(lua, -1, "values") == LUA_TTABLE)
+		{
+			lua_newtable(lua);
+			lua_setfield(lua, -3, "values");
+		}
+		lua_pop(lua, 2);
+	}
+	lua_pop(lua, 1);
+}
+
 int
 VLUA_API(vifm_addcolumntype)(lua_State *lua)
 {
@@ -142,6 +176,25 @@ VLUA_API(vifm_addcolumntype)(lua_State *lua)
 		is_primary = lua_toboolean(vlua->lua, -1);
 	}
 
+	int batch = 0;
+	if(vlua_cmn_check_opt_field(lua, 1, "batch", LUA_TBOOLEAN))
+	{
+		batch = lua_toboolean(vlua->lua, -1);
+	}
+
+	int async = 0;
+	if(vlua_cmn_check_opt_field(lua, 1, "async", LUA_TBOOLEAN))
+	{
+		async = lua_toboolean(vlua->lua, -1);
+	}
+
+	/* Values produced in batches or asynchronously have to be stored. */
+	int cache = (batch || async);
+	if(vlua_cmn_check_opt_field(lua, 1, "cache", LUA_TBOOLEAN))
+	{
+		cache |= lua_toboolean(vlua->lua, -1);
+	}
+
 	void *data = vlua_state_store_pointer(vlua, handler);
 	if(data == NULL)
 	{
@@ -150,13 +203,22 @@ VLUA_API(vifm_addcolumntype)(lua_State *lua)
 
 	int column_id = viewcolumn_next_id++;
 	vlua_state_get_table(vlua, &viewcolumns_key); /* viewcolumns table */
-	lua_createtable(lua, /*narr=*/0, /*nrec=*/2); /* viewcolumn table */
+	lua_createtable(lua, /*narr=*/0, /*nrec=*/6); /* viewcolumn table */
 	lua_pushinteger(lua, column_id);
 	lua_setfield(lua, -2, "id");
 	lua_pushstring(lua, name);
 	lua_setfield(lua, -2, "name");
 	lua_pushboolean(lua, is_primary);
 	lua_setfield(lua, -2, "isprimary");
+	lua_pushboolean(lua, batch);
+	lua_setfield(lua, -2, "batch");
+	lua_pushboolean(lua, async);
+	lua_setfield(lua, -2, "async");
+	if(cache)
+	{
+		lua_newtable(lua);
+		lua_setfield(lua, -2, "values");
+	}
 	lua_pushvalue(lua, -1);                       /* viewcolumn table */
 	lua_setfield(lua, -3, name);                  /* viewcolumns[name] */
 	lua_seti(lua, -2, column_id);                 /* viewcolumns[id] */
@@ -210,24 +272,202 @@ lua_viewcolumn_handler(void *data, size_t buf_len, char buf[],
 {
 	state_ptr_t *p = data;
 	lua_State *lua = p->vlua->lua;
-
-	vlua_cmn_from_pointer(lua, p->ptr);
-
-	lua_createtable(lua, /*narr=*/0, /*nrec=*/2);
-
-	lua_pushinteger(lua, info->width);
-	lua_setfield(lua, -2, "width");
-
 	column_data_t *cdt = info->data;
-	dir_entry_t *entry = cdt->entry;
-	vifmentry_new(lua, entry);
-	lua_setfield(lua, -2, "entry");
 
 	/* No match highlighting by default. */
 	cdt->custom_match = 1;
 	cdt->match_from = 0;
 	cdt->match_to = 0;
 
+	vlua_state_get_table(p->vlua, &viewcolumns_key); /* viewcolumns */
+	lua_geti(lua, -1, info->id);                     /* viewcolumn */
+	lua_getfield(lua, -1, "values");                 /* values */
+
+	if(lua_isnil(lua, -1))
+	{
+		lua_pop(lua, 3);
+
+		lua_createtable(lua, /*narr=*/0, /*nrec=*/2);
+		lua_pushinteger(lua, info->width);
+		lua_setfield(lua, -2, "width");
+		vifmentry_new(lua, cdt->entry);
+		lua_setfield(lua, -2, "entry");
+
+		if(call_handler(lua, p->ptr) != 0)
+		{
+			copy_str(buf, buf_len, "ERROR");
+			return;
+		}
+
+		print_result(lua, cdt, buf_len, buf);
+		lua_pop(lua, 1);
+		return;
+	}
+
+	push_key(lua, cdt->entry, info->width);
+	if(lua_rawget(lua, -2) == LUA_TNIL)
+	{
+		lua_pop(lua, 1);
+
+		const int batch = get_flag(lua, -2, "batch");
+		const int async = get_flag(lua, -2, "async");
+		if(fill_values(lua, p->ptr, cdt, info->width, batch, async) != 0)
+		{
+			copy_str(buf, buf_len, "ERROR");
+			lua_pop(lua, 3);
+			return;
+		}
+
+		push_key(lua, cdt->entry, info->width);
+		lua_rawget(lua, -2);
+	}
+
+	print_result(lua, cdt, buf_len, buf);
+	lua_pop(lua, 4);
+}
+
+/* Invokes handler of a caching column to compute values for the entry and, in
+ * case of a batch column, for other visible entries without values.  Expects
+ * values table at the top of the stack and stores results there.  Returns zero
+ * on success, otherwise non-zero is returned. */
+static int
+fill_values(lua_State *lua, void *handler, column_data_t *cdt, int width,
+		int batch, int async)
+{
+	const int values = lua_gettop(lua);
+
+	lua_newtable(lua); /* keys */
+	const int keys = lua_gettop(lua);
+
+	lua_createtable(lua, /*narr=*/0, /*nrec=*/3); /* info */
+	lua_pushinteger(lua, width);
+	lua_setfield(lua, -2, "width");
+
+	int n = 1;
+	if(batch)
+	{
+		view_t *view = cdt->view;
+		int first = view->top_line;
+		int end = MIN(view->list_rows, view->top_line + view->window_cells);
+		if(cdt->line_pos < first || cdt->line_pos >= end ||
+				&view->dir_entry[cdt->line_pos] != cdt->entry)
+		{
+			/* The entry isn't part of the view, so can't get its neighbours. */
+			first = 0;
+			end = 0;
+		}
+
+		lua_newtable(lua); /* info.entries */
+		n = 0;
+
+		int i;
+		for(i = first; i < end; ++i)
+		{
+			const dir_entry_t *entry = &view->dir_entry[i];
+			push_key(lua, entry, width);
+			lua_pushvalue(lua, -1);
+			if(lua_rawget(lua, values) != LUA_TNIL)
+			{
+				lua_pop(lua, 2);
+				continue;
+			}
+			lua_pop(lua, 1);
+
+			lua_seti(lua, keys, ++n);
+			vifmentry_new(lua, entry);
+			lua_seti(lua, -2, n);
+		}
+
+		if(n == 0)
+		{
+			push_key(lua, cdt->entry, width);
+			lua_seti(lua, keys, ++n);
+			vifmentry_new(lua, cdt->entry);
+			lua_seti(lua, -2, n);
+		}
+
+		lua_setfield(lua, -2, "entries");
+	}
+	else
+	{
+		push_key(lua, cdt->entry, width);
+		lua_seti(lua, keys, 1);
+		vifmentry_new(lua, cdt->entry);
+		lua_setfield(lua, -2, "entry");
+	}
+
+	if(async)
+	{
+		lua_pushvalue(lua, values);
+		lua_pushvalue(lua, keys);
+		lua_pushcclosure(lua, VLUA_REF(viewcolumn_set), 2);
+		lua_setfield(lua, -2, "set");
+	}
+
+	if(call_handler(lua, handler) != 0)
+	{
+		lua_pop(lua, 1);
+		return 1;
+	}
+
+	int i;
+	for(i = 1; i <= n; ++i)
+	{
+		lua_geti(lua, keys, i);
+
+		if(!batch)
+		{
+			lua_pushvalue(lua, -2);
+		}
+		else if(lua_istable(lua, -2))
+		{
+			lua_geti(lua, -2, i);
+		}
+		else
+		{
+			lua_pushnil(lua);
+		}
+
+		if(async)
+		{
+			/* Value might have been set already, otherwise the result is
+			 * a placeholder and absence of it is an empty value. */
+			lua_pushvalue(lua, -2);
+			if(lua_rawget(lua, values) != LUA_TNIL)
+			{
+				lua_pop(lua, 3);
+				continue;
+			}
+			lua_pop(lua, 1);
+
+			if(!lua_istable(lua, -1))
+			{
+				lua_pop(lua, 1);
+				lua_pushboolean(lua, 1);
+			}
+		}
+		else if(!lua_istable(lua, -1))
+		{
+			lua_pop(lua, 1);
+			lua_pushboolean(lua, 0);
+		}
+
+		lua_rawset(lua, values);
+	}
+
+	lua_pop(lua, 2);
+	return 0;
+}
+
+/* Calls handler passing it info table from the top of the stack, which is
+ * replaced with the result.  Returns zero on success, otherwise non-zero is
+ * returned, error is reported and the stack has no info table. */
+static int
+call_handler(lua_State *lua, void *handler)
+{
+	vlua_cmn_from_pointer(lua, handler);
+	lua_insert(lua, -2);
+
 	const int sm_cookie = vlua_state_safe_mode_on(lua);
 	if(lua_pcall(lua, 1, 1, 0) != LUA_OK)
 	{
@@ -235,24 +475,36 @@ lua_viewcolumn_handler(void *data, size_t buf_len, char buf[],
 
 		const char *error = lua_tostring(lua, -1);
 		ui_sb_err(error);
-		copy_str(buf, buf_len, "ERROR");
 		lua_pop(lua, 1);
-		return;
+		return 1;
 	}
 
 	vlua_state_safe_mode_off(lua, sm_cookie);
+	return 0;
+}
+
+/* Prints value of a cell from the top of the stack into the buffer.  The value
+ * is either a table returned by a handler, false for a missing value or true
+ * for an empty one. */
+static void
+print_result(lua_State *lua, column_data_t *cdt, size_t buf_len, char buf[])
+{
+	if(lua_isboolean(lua, -1) && lua_toboolean(lua, -1))
+	{
+		copy_str(buf, buf_len, "");
+		return;
+	}
 
 	if(!lua_istable(lua, -1))
 	{
 		copy_str(buf, buf_len, "NOVALUE");
-		lua_pop(lua, 1);
 		return;
 	}
 
 	if(lua_getfield(lua, -1, "text") == LUA_TNIL)
 	{
 		copy_str(buf, buf_len, "NOVALUE");
-		lua_pop(lua, 2);
+		lua_pop(lua, 1);
 		return;
 	}
 
@@ -274,7 +526,56 @@ lua_viewcolumn_handler(void *data, size_t buf_len, char buf[],
 		}
 	}
 
-	lua_pop(lua, 3);
+	lua_pop(lua, 2);
+}
+
+/* Pushes key of a cached value, which identifies the entry and its
+ * modification as well as width of the column. */
+static void
+push_key(lua_State *lua, const dir_entry_t *entry, int width)
+{
+	char full_path[PATH_MAX + 1];
+	get_full_path_of(entry, sizeof(full_path), full_path);
+	lua_pushfstring(lua, "%d:%I:%s", width, (lua_Integer)entry->mtime,
+			full_path);
+}
+
+/* Retrieves boolean field of a table.  Returns the value. */
+static int
+get_flag(lua_State *lua, int table_idx, const char name[])
+{
+	lua_getfield(lua, table_idx, name);
+	const int value = lua_toboolean(lua, -1);
+	lua_pop(lua, 1);
+	return value;
+}
+
+/* Sets value of a cell of an asynchronous column.  Accepts a result table for
+ * a single entry or an index and a result table for a batch.  Returns
+ * nothing. */
+static int
+VLUA_API(viewcolumn_set)(lua_State *lua)
+{
+	int idx = 1;
+	int result = 1;
+	if(lua_gettop(lua) > 1)
+	{
+		idx = luaL_checkinteger(lua, 1);
+		result = 2;
+	}
+	luaL_checktype(lua, result, LUA_TTABLE);
+
+	if(lua_geti(lua, lua_upvalueindex(2), idx) == LUA_TNIL)
+	{
+		return luaL_error(lua, "Entry index is out of range: %d", idx);
+	}
+
+	lua_pushvalue(lua, result);
+	lua_rawset(lua, lua_upvalueindex(1));
+
+	/* The value is likely to be on the screen. */
+	stats_redraw_later();
+	return 0;
 }
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
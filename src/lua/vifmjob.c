@@ -18,12 +18,24 @@
 
 #include "vifmjob.h"
 
+#ifndef _WIN32
+#include <fcntl.h> /* F_GETFL F_SETFL O_NONBLOCK fcntl() */
+#include <unistd.h> /* read() */
+#else
+#include <windows.h>
+#include <io.h> /* _get_osfhandle() */
+#endif
+
 #include <assert.h> /* assert() */
-#include <stdio.h> /* fclose() */
+#include <errno.h> /* EAGAIN EINTR EWOULDBLOCK errno */
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* SIZE_MAX */
+#include <stdio.h> /* FILE fclose() fileno() fread() */
 #include <stdlib.h> /* free() */
-#include <string.h> /* strcmp() */
+#include <string.h> /* memchr() strcmp() */
 
 #include "../compat/pthread.h"
+#include "../utils/macros.h"
 #include "../utils/str.h"
 #include "../background.h"
 #include "lua/lauxlib.h"
@@ -48,9 +60,14 @@ typedef struct
 	bg_job_t *job;        /* Link to the native job. */
 	job_stream_t *input;  /* Cached input stream or NULL. */
 	job_stream_t *output; /* Cached output stream or NULL. */
+	int streaming;        /* Whether output is passed to callbacks. */
 }
 vifm_job_t;
 
+/* Maximum amount of output of a single job delivered to callbacks per check,
+ * the rest stays in the pipe blocking the job. */
+enum { STREAM_BUDGET = 64*1024 };
+
 static int VLUA_API(vifmjob_gc)(lua_State *lua);
 static int VLUA_API(vifmjob_wait)(lua_State *lua);
 static int VLUA_API(vifmjob_exitcode)(lua_State *lua);
@@ -58,6 +75,14 @@ static int VLUA_API(vifmjob_stdin)(lua_State *lua);
 static int VLUA_API(vifmjob_stdout)(lua_State *lua);
 static int VLUA_API(vifmjob_errors)(lua_State *lua);
 static void job_exit_cb(struct bg_job_t *job, void *arg);
+static int stream_output(vlua_t *vlua, bg_job_t *job, size_t budget,
+		int block);
+static int read_output(FILE *stream, char buf[], size_t size, int block);
+static void dispatch_output(vlua_t *vlua, const char data[], size_t len);
+static void push_line(lua_State *lua, int job_idx, const char data[],
+		size_t len);
+static void drop_trailing_cr(lua_State *lua);
+static void flush_partial_line(vlua_t *vlua);
 static job_stream_t * job_stream_open(lua_State *lua, bg_job_t *job,
 		FILE *stream);
 static void job_stream_close(lua_State *lua, job_stream_t *js);
@@ -86,6 +111,9 @@ static const luaL_Reg vifmjob_methods[] = {
  * instances onto dictionary with such fields:
  *  - "obj" - vifm_job_t user data
  *  - "on_exit" - Lua callback to invoke when the job is done
+ *  - "online" - Lua callback to invoke for each line of output
+ *  - "onchunk" - Lua callback to invoke for each piece of output
+ *  - "partial" - incomplete last line of output for "online"
  */
 static char jobs_key;
 
@@ -116,6 +144,29 @@ vifmjob_finish(lua_State *lua)
 	lua_pop(lua, 1);
 }
 
+void
+vifmjob_check(lua_State *lua)
+{
+	vlua_t *vlua = vlua_state_get(lua);
+
+	vlua_state_get_table(vlua, &jobs_key);
+	lua_pushnil(lua);
+	while(lua_next(lua, -2) != 0)
+	{
+		lua_getfield(lua, -1, "obj");
+		vifm_job_t *vifm_job = lua_touserdata(lua, -1);
+		lua_pop(lua, 1);
+
+		if(vifm_job->streaming)
+		{
+			(void)stream_output(vlua, vifm_job->job, STREAM_BUDGET, /*block=*/0);
+		}
+
+		lua_pop(lua, 1);
+	}
+	lua_pop(lua, 1);
+}
+
 int
 VLUA_API(vifmjob_new)(lua_State *lua)
 {
@@ -161,6 +212,21 @@ VLUA_API(vifmjob_new)(lua_State *lua)
 	}
 
 	int with_on_exit = vlua_cmn_check_opt_field(lua, 1, "onexit", LUA_TFUNCTION);
+	const int on_exit_idx = lua_gettop(lua);
+
+	int with_on_line = vlua_cmn_check_opt_field(lua, 1, "online", LUA_TFUNCTION);
+	const int on_line_idx = lua_gettop(lua);
+
+	int with_on_chunk = vlua_cmn_check_opt_field(lua, 1, "onchunk",
+			LUA_TFUNCTION);
+	const int on_chunk_idx = lua_gettop(lua);
+
+	const int streaming = (with_on_line || with_on_chunk);
+	if(streaming && !(flags & BJF_CAPTURE_OUT))
+	{
+		return luaL_error(lua, "%s",
+				"'online' and 'onchunk' require 'iomode' to be \"r\"");
+	}
 
 	bg_job_t *job = bg_run_external_job(cmd, flags, descr);
 	if(job == NULL)
@@ -168,20 +234,41 @@ VLUA_API(vifmjob_new)(lua_State *lua)
 		return luaL_error(lua, "%s", "Failed to start a job");
 	}
 
+#ifndef _WIN32
+	if(streaming && job->output != NULL)
+	{
+		/* Enable non-blocking read from output pipe.  On Windows we read the
+		 * exact amount of data present in the stream. */
+		int fd = fileno(job->output);
+		int file_flags = fcntl(fd, F_GETFL, 0);
+		fcntl(fd, F_SETFL, file_flags | O_NONBLOCK);
+	}
+#endif
+
 	vifm_job_t *data = lua_newuserdatauv(lua, sizeof(*data), 0);
 
 	luaL_getmetatable(lua, "VifmJob");
 	lua_setmetatable(lua, -2);
 
 	/* Map job onto a table describing it in Lua. */
-	lua_createtable(lua, /*narr=*/0, /*nrec=*/(with_on_exit ? 2 : 1));
+	lua_createtable(lua, /*narr=*/0, /*nrec=*/4);
 	lua_pushvalue(lua, -2);
 	lua_setfield(lua, -2, "obj");
 	if(with_on_exit)
 	{
-		lua_pushvalue(lua, -3);
+		lua_pushvalue(lua, on_exit_idx);
 		lua_setfield(lua, -2, "onexit");
 	}
+	if(with_on_line)
+	{
+		lua_pushvalue(lua, on_line_idx);
+		lua_setfield(lua, -2, "online");
+	}
+	if(with_on_chunk)
+	{
+		lua_pushvalue(lua, on_chunk_idx);
+		lua_setfield(lua, -2, "onchunk");
+	}
 	vlua_state_get_table(vlua, &jobs_key);
 	lua_pushlightuserdata(lua, job);
 	lua_pushvalue(lua, -3);
@@ -193,6 +280,7 @@ VLUA_API(vifmjob_new)(lua_State *lua)
 	data->job = job;
 	data->input = NULL;
 	data->output = NULL;
+	data->streaming = streaming;
 	return 1;
 }
 
@@ -212,11 +300,25 @@ job_exit_cb(struct bg_job_t *job, void *arg)
 		return;
 	}
 
+	lua_getfield(vlua->lua, -1, "obj");
+	vifm_job_t *vifm_job = lua_touserdata(vlua->lua, -1);
+	assert(vifm_job != NULL && "List of Lua jobs is includes bad element!");
+	lua_pop(vlua->lua, 1);
+
+	if(vifm_job->streaming && job->output != NULL)
+	{
+		/* Deliver what's left in the pipe, the job can't produce more. */
+		if(!stream_output(vlua, job, SIZE_MAX, /*block=*/0))
+		{
+			flush_partial_line(vlua);
+			fclose(job->output);
+			job->output = NULL;
+		}
+	}
+
 	int with_on_exit = (lua_getfield(vlua->lua, -1, "onexit") == LUA_TFUNCTION);
 
 	lua_getfield(vlua->lua, -2, "obj");
-	vifm_job_t *vifm_job = lua_touserdata(vlua->lua, -1);
-	assert(vifm_job != NULL && "List of Lua jobs is includes bad element!");
 
 	/* Remove the table entry we've just used. */
 	lua_pushlightuserdata(vlua->lua, job);
@@ -303,6 +405,20 @@ VLUA_API(vifmjob_wait)(lua_State *lua)
 		}
 	}
 
+	if(vifm_job->streaming && vifm_job->job->output != NULL)
+	{
+		/* Callbacks are invoked later, but output must be consumed right now to
+		 * not block the job on write. */
+		vlua_t *vlua = vlua_state_get(lua);
+		vlua_state_get_table(vlua, &jobs_key);
+		lua_pushlightuserdata(lua, vifm_job->job);
+		if(lua_gettable(lua, -2) == LUA_TTABLE)
+		{
+			(void)stream_output(vlua, vifm_job->job, SIZE_MAX, /*block=*/1);
+		}
+		lua_pop(lua, 2);
+	}
+
 	if(bg_job_wait(vifm_job->job) != 0)
 	{
 		return luaL_error(lua, "%s", "Waiting for job has failed");
@@ -368,6 +484,11 @@ VLUA_API(vifmjob_stdout)(lua_State *lua)
 {
 	vifm_job_t *vifm_job = luaL_checkudata(lua, 1, "VifmJob");
 
+	if(vifm_job->streaming)
+	{
+		return luaL_error(lua, "%s", "Output of the job is passed to callbacks");
+	}
+
 	if(vifm_job->job->output == NULL)
 	{
 		return luaL_error(lua, "%s", "The job has no output stream");
@@ -416,6 +537,194 @@ VLUA_API(vifmjob_errors)(lua_State *lua)
 	return 1;
 }
 
+/* Reads output of a job and schedules callbacks for it.  Expects table of the
+ * job at the top of the stack.  Reads at most budget bytes unless end of output
+ * is reached first.  Returns non-zero on reaching the end, in which case the
+ * output stream is closed. */
+static int
+stream_output(vlua_t *vlua, bg_job_t *job, size_t budget, int block)
+{
+	while(budget != 0 && job->output != NULL)
+	{
+		char piece[4096];
+		const int len = read_output(job->output, piece, MIN(sizeof(piece), budget),
+				block);
+		if(len == 0)
+		{
+			return 0;
+		}
+
+		if(len < 0)
+		{
+			flush_partial_line(vlua);
+			fclose(job->output);
+			job->output = NULL;
+			break;
+		}
+
+		dispatch_output(vlua, piece, len);
+		budget -= len;
+	}
+
+	return (job->output == NULL);
+}
+
+/* Reads data from the output stream of a job.  Unless block is set, doesn't
+ * wait for data to become available.  Returns number of bytes read, zero if
+ * there is no data yet or negative number at the end or on error. */
+static int
+read_output(FILE *stream, char buf[], size_t size, int block)
+{
+#ifndef _WIN32
+	int fd = fileno(stream);
+	if(block)
+	{
+		int file_flags = fcntl(fd, F_GETFL, 0);
+		fcntl(fd, F_SETFL, file_flags & ~O_NONBLOCK);
+	}
+
+	ssize_t len;
+	do
+	{
+		len = read(fd, buf, size);
+	}
+	while(len < 0 && errno == EINTR);
+
+	if(len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+	{
+		return 0;
+	}
+	return (len > 0 ? (int)len : -1);
+#else
+	if(!block)
+	{
+		/* Simulate asynchronous reading by not reading more than stream has. */
+		HANDLE hpipe = (HANDLE)_get_osfhandle(fileno(stream));
+		DWORD bytes_available = 0;
+		if(!PeekNamedPipe(hpipe, NULL, 0, NULL, &bytes_available, NULL))
+		{
+			return -1;
+		}
+		if(bytes_available == 0)
+		{
+			return 0;
+		}
+		if(bytes_available < size)
+		{
+			size = bytes_available;
+		}
+	}
+
+	const size_t len = fread(buf, 1, size, stream);
+	return (len > 0 ? (int)len : -1);
+#endif
+}
+
+/* Schedules callbacks of a job for a piece of its output.  Expects table of the
+ * job at the top of the stack. */
+static void
+dispatch_output(vlua_t *vlua, const char data[], size_t len)
+{
+	lua_State *lua = vlua->lua;
+	const int job_idx = lua_gettop(lua);
+
+	if(lua_getfield(lua, job_idx, "onchunk") == LUA_TFUNCTION)
+	{
+		lua_pushlstring(lua, data, len);
+		vlua_cbacks_schedule(vlua, /*argc=*/1);
+	}
+	else
+	{
+		lua_pop(lua, 1);
+	}
+
+	if(lua_getfield(lua, job_idx, "online") != LUA_TFUNCTION)
+	{
+		lua_pop(lua, 1);
+		return;
+	}
+	lua_pop(lua, 1);
+
+	const char *nl;
+	while((nl = memchr(data, '\n', len)) != NULL)
+	{
+		size_t line_len = nl - data;
+
+		lua_getfield(lua, job_idx, "online");
+		push_line(lua, job_idx, data, line_len);
+		drop_trailing_cr(lua);
+		vlua_cbacks_schedule(vlua, /*argc=*/1);
+
+		data += line_len + 1;
+		len -= line_len + 1;
+	}
+
+	if(len != 0)
+	{
+		push_line(lua, job_idx, data, len);
+		lua_setfield(lua, job_idx, "partial");
+	}
+}
+
+/* Pushes a line prepending it with the incomplete line kept in job's table,
+ * which is then removed from the table. */
+static void
+push_line(lua_State *lua, int job_idx, const char data[], size_t len)
+{
+	if(lua_getfield(lua, job_idx, "partial") != LUA_TSTRING)
+	{
+		lua_pop(lua, 1);
+		lua_pushlstring(lua, data, len);
+		return;
+	}
+
+	lua_pushlstring(lua, data, len);
+	lua_concat(lua, 2);
+
+	lua_pushnil(lua);
+	lua_setfield(lua, job_idx, "partial");
+}
+
+/* Removes trailing carriage return from a line at the top of the stack.  This
+ * is done after joining the line with its beginning from previous reads as
+ * "\r\n" can be split between them. */
+static void
+drop_trailing_cr(lua_State *lua)
+{
+	size_t len;
+	const char *line = lua_tolstring(lua, -1, &len);
+	if(len != 0 && line[len - 1] == '\r')
+	{
+		lua_pushlstring(lua, line, len - 1);
+		lua_replace(lua, -2);
+	}
+}
+
+/* Schedules "online" callback for the last line of output if it didn't end
+ * with a newline.  Expects table of the job at the top of the stack. */
+static void
+flush_partial_line(vlua_t *vlua)
+{
+	lua_State *lua = vlua->lua;
+
+	if(lua_getfield(lua, -1, "online") != LUA_TFUNCTION)
+	{
+		lua_pop(lua, 1);
+		return;
+	}
+
+	if(lua_getfield(lua, -2, "partial") != LUA_TSTRING)
+	{
+		lua_pop(lua, 2);
+		return;
+	}
+
+	lua_pushnil(lua);
+	lua_setfield(lua, -4, "partial");
+
+	vlua_cbacks_schedule(vlua, /*argc=*/1);
+}
+
 /* Creates a job stream.  Returns a pointer to new user data. */
 static job_stream_t *
 job_stream_open(lua_State *lua, bg_job_t *job, FILE *stream)
@@ -29,10 +29,12 @@
 #include "../modes/visual.h"
 #include "../ui/tabs.h"
 #include "../ui/ui.h"
+#include "../utils/macros.h"
 #include "../filelist.h"
 #include "../flist_pos.h"
 #include "../flist_sel.h"
 #include "../opt_handlers.h"
+#include "../types.h"
 #include "lua/lauxlib.h"
 #include "lua/lua.h"
 #include "api.h"
@@ -55,6 +57,9 @@ static int VLUA_IMPL(get_opt_wrapper)(lua_State *lua);
 static int VLUA_IMPL(set_opt_wrapper)(lua_State *lua);
 static int VLUA_API(vifmview_cd)(lua_State *lua);
 static int VLUA_API(vifmview_entry)(lua_State *lua);
+static int VLUA_API(vifmview_entries)(lua_State *lua);
+static void push_entries_field(lua_State *lua, const view_t *view,
+		const char field[]);
 static int VLUA_API(vifmview_select)(lua_State *lua);
 static int VLUA_API(vifmview_unselect)(lua_State *lua);
 static int select_unselect(lua_State *lua, int select);
@@ -71,6 +76,7 @@ VLUA_DECLARE_SAFE(locopts_index);
 VLUA_DECLARE_UNSAFE(locopts_newindex);
 VLUA_DECLARE_UNSAFE(vifmview_cd);
 VLUA_DECLARE_SAFE(vifmview_entry);
+VLUA_DECLARE_SAFE(vifmview_entries);
 VLUA_DECLARE_UNSAFE(vifmview_select);
 VLUA_DECLARE_UNSAFE(vifmview_unselect);
 
@@ -78,6 +84,7 @@ VLUA_DECLARE_UNSAFE(vifmview_unselect);
 static const luaL_Reg vifmview_methods[] = {
 	{ "cd",       VLUA_REF(vifmview_cd)       },
 	{ "entry",    VLUA_REF(vifmview_entry)    },
+	{ "entries",  VLUA_REF(vifmview_entries)  },
 	{ "select",   VLUA_REF(vifmview_select)   },
 	{ "unselect", VLUA_REF(vifmview_unselect) },
 	{ NULL,       NULL                        }
@@ -456,6 +463,91 @@ VLUA_API(vifmview_entry)(lua_State *lua)
 	return 1;
 }
 
+/* Method of `VifmView` that retrieves fields of all entries at once.  Returns
+ * a table of arrays keyed by field names. */
+static int
+VLUA_API(vifmview_entries)(lua_State *lua)
+{
+	view_t *view = check_view(lua);
+
+	luaL_checktype(lua, 2, LUA_TTABLE);
+	vlua_cmn_check_field(lua, 2, "fields", LUA_TTABLE);
+
+	lua_newtable(lua);
+
+	int i;
+	for(i = 1; lua_geti(lua, -2, i) != LUA_TNIL; ++i)
+	{
+		const char *field = lua_tostring(lua, -1);
+		if(field == NULL)
+		{
+			return luaL_error(lua, "%s", "Field name must be a string");
+		}
+		push_entries_field(lua, view, field);
+		lua_settable(lua, -3);
+	}
+	lua_pop(lua, 1);
+
+	return 1;
+}
+
+/* Pushes array of values of the field for all entries of the view.  Aborts
+ * (Lua does longjmp()) on unknown field. */
+static void
+push_entries_field(lua_State *lua, const view_t *view, const char field[])
+{
+	enum
+	{
+		EF_NAME, EF_LOCATION, EF_SIZE, EF_MTIME, EF_ATIME, EF_CTIME, EF_TYPE,
+		EF_ISDIR, EF_SELECTED
+	};
+	static const char *names[] = {
+		[EF_NAME]     = "name",
+		[EF_LOCATION] = "location",
+		[EF_SIZE]     = "size",
+		[EF_MTIME]    = "mtime",
+		[EF_ATIME]    = "atime",
+		[EF_CTIME]    = "ctime",
+		[EF_TYPE]     = "type",
+		[EF_ISDIR]    = "isdir",
+		[EF_SELECTED] = "selected",
+	};
+
+	int kind;
+	for(kind = 0; kind < (int)ARRAY_LEN(names); ++kind)
+	{
+		if(strcmp(names[kind], field) == 0)
+		{
+			break;
+		}
+	}
+	if(kind == (int)ARRAY_LEN(names))
+	{
+		luaL_error(lua, "Unknown entry field: %s", field);
+	}
+
+	lua_createtable(lua, view->list_rows, /*nrec=*/0);
+
+	int i;
+	for(i = 0; i < view->list_rows; ++i)
+	{
+		const dir_entry_t *entry = &view->dir_entry[i];
+		switch(kind)
+		{
+			case EF_NAME:     lua_pushstring(lua, entry->name); break;
+			case EF_LOCATION: lua_pushstring(lua, entry->origin); break;
+			case EF_SIZE:     lua_pushinteger(lua, entry->size); break;
+			case EF_MTIME:    lua_pushinteger(lua, entry->mtime); break;
+			case EF_ATIME:    lua_pushinteger(lua, entry->atime); break;
+			case EF_CTIME:    lua_pushinteger(lua, entry->ctime); break;
+			case EF_TYPE:     lua_pushstring(lua, get_type_str(entry->type)); break;
+			case EF_ISDIR:    lua_pushboolean(lua, fentry_is_dir(entry)); break;
+			case EF_SELECTED: lua_pushboolean(lua, entry->selected); break;
+		}
+		lua_rawseti(lua, -2, i + 1);
+	}
+}
+
 /* Method of `VifmView` that selects entries a view.  Returns number of new
  * selected entries. */
 static int
@@ -420,6 +420,12 @@ vlua_viewcolumn_is_primary(vlua_t *vlua, int column_id)
 	return vifm_viewcolumns_is_primary(vlua, column_id);
 }
 
+void
+vlua_viewcolumns_drop_cache(vlua_t *vlua)
+{
+	vifm_viewcolumns_drop_cache(vlua);
+}
+
 int
 vlua_handler_cmd(vlua_t *vlua, const char cmd[])
 {
@@ -488,6 +494,7 @@ vlua_edit_list(vlua_t *vlua, const char handler[], char *entries[],
 void
 vlua_process_callbacks(vlua_t *vlua)
 {
+	vifmjob_check(vlua->lua);
 	vlua_cbacks_process(vlua);
 }
 
@@ -70,6 +70,9 @@ char * vlua_viewcolumn_map_back(vlua_t *vlua, int id);
  * Returns non-zero if so, otherwise zero is returned. */
 int vlua_viewcolumn_is_primary(vlua_t *vlua, int column_id);
 
+/* Drops values cached by view columns, because they might be out of date. */
+void vlua_viewcolumns_drop_cache(vlua_t *vlua);
+
 /* Handlers. */
 
 /* Checks command for a Lua handler.  Returns non-zero if it's present and zero
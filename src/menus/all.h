@@ -30,6 +30,7 @@
 #include "dirstack_menu.h"
 #include "filetypes_menu.h"
 #include "find_menu.h"
+#include "fuzzy_menu.h"
 #include "grep_menu.h"
 #include "history_menu.h"
 #include "jobs_menu.h"
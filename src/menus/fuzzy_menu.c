@@ -0,0 +1,185 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "fuzzy_menu.h"
+
+#include <stddef.h> /* NULL */
+#include <stdlib.h> /* free() */
+#include <string.h> /* strdup() */
+
+#include "../ui/cancellation.h"
+#include "../ui/statusbar.h"
+#include "../ui/ui.h"
+#include "../utils/cancellation.h"
+#include "../utils/fuzzy.h"
+#include "../utils/path.h"
+#include "../utils/str.h"
+#include "../utils/string_array.h"
+#include "../filelist.h"
+#include "menus.h"
+
+static fuzzy_index_t * get_index(const char root[]);
+static int index_cancellation_hook(void *arg);
+static int fill_custom_view(view_t *view, const char query[],
+		const char *paths[], int count);
+static int execute_fuzzy_cb(view_t *view, menu_data_t *m);
+
+/* Index of files of the directory that was searched last.  It's kept around
+ * because the next search is likely to be performed in the same place. */
+static fuzzy_index_t *last_index;
+
+int
+show_fuzzy_menu(view_t *view, const char query[], int to_custom_view)
+{
+	const char *const root = flist_get_dir(view);
+
+	ui_cancellation_push_on();
+	fuzzy_index_t *const index = get_index(root);
+	ui_cancellation_pop();
+
+	/* Clear progress message displayed while indexing. */
+	ui_sb_quick_msg_clear();
+
+	if(ui_cancellation_requested())
+	{
+		ui_sb_msg("Indexing has been cancelled");
+		return 1;
+	}
+	if(index == NULL)
+	{
+		ui_sb_errf("Failed to list files of %s", root);
+		return 1;
+	}
+
+	int count;
+	const char **const paths = fuzzy_index_query(index, query, &count);
+	if(paths == NULL)
+	{
+		ui_sb_err("Not enough memory");
+		return 1;
+	}
+
+	if(to_custom_view)
+	{
+		return fill_custom_view(view, query, paths, count);
+	}
+
+	static menu_data_t m;
+	menus_init_data(&m, view, format_str("Fuzzy %s", query),
+			strdup("No files found"));
+
+	m.stashable = 1;
+	m.execute_handler = &execute_fuzzy_cb;
+	m.key_handler = &menus_def_khandler;
+
+	int i;
+	for(i = 0; i < count; ++i)
+	{
+		m.len = add_to_string_array(&m.items, m.len, paths[i]);
+	}
+
+	return menus_enter(&m, view);
+}
+
+void
+fuzzy_menu_reset(void)
+{
+	fuzzy_index_free(last_index);
+	last_index = NULL;
+}
+
+/* Retrieves up-to-date index of files under the root.  Failed or cancelled
+ * update leaves the index as it was for the next time.  Returns the index or
+ * NULL on error. */
+static fuzzy_index_t *
+get_index(const char root[])
+{
+	if(last_index != NULL && !paths_are_equal(fuzzy_index_root(last_index), root))
+	{
+		fuzzy_menu_reset();
+	}
+
+	if(last_index == NULL)
+	{
+		last_index = fuzzy_index_alloc(root);
+		if(last_index == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	const cancellation_t cancellation = { .hook = &index_cancellation_hook };
+	if(fuzzy_index_update(last_index, &cancellation) != 0)
+	{
+		return NULL;
+	}
+
+	return last_index;
+}
+
+/* Displays progress of indexing and checks whether the user wants to stop it.
+ * Returns non-zero if so. */
+static int
+index_cancellation_hook(void *arg)
+{
+	show_progress("Indexing...", 1000);
+	return ui_cancellation_requested();
+}
+
+/* Makes custom view out of matched paths preserving their order.  Returns
+ * non-zero if status bar message should be saved. */
+static int
+fill_custom_view(view_t *view, const char query[], const char *paths[],
+		int count)
+{
+	char *const title = format_str("Fuzzy %s", query);
+	flist_custom_start(view, title);
+	free(title);
+
+	int i;
+	for(i = 0; i < count; ++i)
+	{
+		char *const path = join_paths(flist_get_dir(view), paths[i]);
+		if(path != NULL)
+		{
+			chosp(path);
+			flist_custom_add(view, path);
+			free(path);
+		}
+	}
+
+	if(flist_custom_finish(view, CV_VERY, 0) != 0)
+	{
+		ui_sb_msg("No files found");
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Callback that is called when menu item is selected.  Should return non-zero
+ * to stay in menu mode. */
+static int
+execute_fuzzy_cb(view_t *view, menu_data_t *m)
+{
+	(void)menus_goto_file(m, view, m->items[m->pos], 0);
+	return 0;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
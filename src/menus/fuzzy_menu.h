@@ -0,0 +1,36 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__MENUS__FUZZY_MENU_H__
+#define VIFM__MENUS__FUZZY_MENU_H__
+
+struct view_t;
+
+/* Lists files under current directory of the view that fuzzily match the
+ * query either in a menu or in a custom view.  Returns non-zero if status bar
+ * message should be saved. */
+int show_fuzzy_menu(struct view_t *view, const char query[],
+		int to_custom_view);
+
+/* Frees index of files kept between invocations of the menu. */
+void fuzzy_menu_reset(void);
+
+#endif /* VIFM__MENUS__FUZZY_MENU_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
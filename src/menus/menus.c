@@ -19,19 +19,29 @@
 
 #include "menus.h"
 
+#ifndef _WIN32
+#include <fcntl.h> /* F_GETFL F_SETFL O_NONBLOCK fcntl() */
+#include <unistd.h> /* read() */
+#else
+#include <windows.h>
+#include <io.h> /* _get_osfhandle() */
+#endif
+
 #include <curses.h>
 
 #include <assert.h> /* assert() */
+#include <errno.h> /* EAGAIN EINTR EWOULDBLOCK errno */
 #include <stddef.h> /* NULL size_t */
-#include <stdio.h> /* FILE */
-#include <stdlib.h> /* free() malloc() */
-#include <string.h> /* memmove() memset() strdup() strcat() strncat() strchr()
-                       strlen() strrchr() */
+#include <stdio.h> /* FILE fileno() fread() */
+#include <stdlib.h> /* free() malloc() realloc() */
+#include <string.h> /* memcpy() memmove() memset() strdup() strcat() strncat()
+                       strchr() strlen() strrchr() */
 #include <wchar.h> /* wchar_t wcscmp() */
 
 #include "../cfg/config.h"
 #include "../compat/fs_limits.h"
 #include "../compat/os.h"
+#include "../compat/pthread.h"
 #include "../compat/reallocarray.h"
 #include "../engine/mode.h"
 #include "../int/term_title.h"
@@ -76,6 +86,14 @@ static void draw_search_match(char str[], int start, int end, int line,
 static void normalize_top(menu_state_t *ms);
 static void draw_menu_frame(const menu_state_t *ms);
 static void output_handler(const char line[], void *arg);
+static int start_stream(menu_data_t *m, const char cmd[]);
+static void wait_for_first_item(menu_data_t *m);
+static void read_stream_output(menu_data_t *m);
+static int read_output(FILE *stream, char buf[], size_t size);
+static void append_output(menu_data_t *m, const char data[], size_t len);
+static void append_lines(menu_data_t *m, char text[], size_t len);
+static void stop_stream(menu_data_t *m, int cancel);
+static void show_stream_errors(bg_job_t *job);
 static void append_to_string(char **str, const char suffix[]);
 static char * expand_tabulation_a(const char line[], size_t tab_stops);
 static void init_menu_state(menu_state_t *ms, menu_data_t *m, view_t *view);
@@ -89,6 +107,7 @@ static const char * get_relative_path_base(const menu_data_t *m,
 		const view_t *view);
 static int menu_and_view_are_in_sync(const menu_data_t *m, const view_t *view);
 static int search_menu(menu_state_t *ms, int print_errors);
+static int match_new_items(menu_state_t *ms, int from, int print_errors);
 static int search_menu_forwards(menu_state_t *ms, int start_pos);
 static int search_menu_backwards(menu_state_t *ms, int start_pos);
 static int navigate_to_match(menu_state_t *ms, int pos);
@@ -123,6 +142,14 @@ struct menu_state_t
 }
 menu_state;
 
+/* State of loading menu items from output of a command. */
+struct menu_stream_t
+{
+	bg_job_t *job;      /* Job of the command. */
+	char *partial;      /* Output which doesn't form a complete line yet. */
+	size_t partial_len; /* Length of the partial field. */
+};
+
 /* Storage for data of stashable menus in chronological order (newest to
  * oldest). */
 static menu_data_t menu_data_stash[10];
@@ -195,6 +222,7 @@ menus_init_data(menu_data_t *m, view_t *view, char title[], char empty_msg[])
 	m->execute_handler = NULL;
 	m->empty_msg = empty_msg;
 	m->cwd = strdup(flist_get_dir(view));
+	m->stream = NULL;
 	m->state = &menu_state;
 	m->initialized = 1;
 }
@@ -227,6 +255,8 @@ deinit_menu_data(menu_data_t *m)
 		return;
 	}
 
+	stop_stream(m, /*cancel=*/1);
+
 	/* Menu elements don't always have data associated with them, but len isn't
 	 * zero.  That's why we need this check. */
 	if(m->data != NULL)
@@ -1092,7 +1122,19 @@ menus_capture(view_t *view, const char cmd[], int user_sh, menu_data_t *m,
 
 	FILE *input_tmp = make_in_file(view, flags);
 
-	if(process_cmd_output("Loading menu", cmd, input_tmp, user_sh, 0,
+	if(input_tmp == NULL && !user_sh)
+	{
+		if(start_stream(m, cmd) != 0)
+		{
+			show_error_msgf("Trouble running command", "Unable to run: %s", cmd);
+			return 0;
+		}
+
+		ui_cancellation_push_on();
+		wait_for_first_item(m);
+		ui_cancellation_pop();
+	}
+	else if(process_cmd_output("Loading menu", cmd, input_tmp, user_sh, 0,
 				&output_handler, m) != 0)
 	{
 		show_error_msgf("Trouble running command", "Unable to run: %s", cmd);
@@ -1106,6 +1148,7 @@ menus_capture(view_t *view, const char cmd[], int user_sh, menu_data_t *m,
 
 	if(ui_cancellation_requested())
 	{
+		stop_stream(m, /*cancel=*/1);
 		append_to_string(&m->title, "(cancelled)");
 		append_to_string(&m->empty_msg, " (cancelled)");
 	}
@@ -1113,6 +1156,291 @@ menus_capture(view_t *view, const char cmd[], int user_sh, menu_data_t *m,
 	return menus_enter(m, view);
 }
 
+/* Starts a background job whose output provides items of the menu.  Returns
+ * zero on success, otherwise non-zero is returned. */
+static int
+start_stream(menu_data_t *m, const char cmd[])
+{
+	LOG_INFO_MSG("Loading menu from output of the command: %s", cmd);
+
+	menu_stream_t *const stream = calloc(1, sizeof(*stream));
+	if(stream == NULL)
+	{
+		return 1;
+	}
+
+	stream->job = bg_run_external_job(cmd, BJF_CAPTURE_OUT | BJF_MENU_VISIBLE,
+			/*descr=*/NULL);
+	if(stream->job == NULL)
+	{
+		free(stream);
+		return 1;
+	}
+
+#ifndef _WIN32
+	/* Enable non-blocking read from output pipe.  On Windows we read the exact
+	 * amount of data present in the stream. */
+	int fd = fileno(stream->job->output);
+	int file_flags = fcntl(fd, F_GETFL, 0);
+	fcntl(fd, F_SETFL, file_flags | O_NONBLOCK);
+#endif
+
+	m->stream = stream;
+	return 0;
+}
+
+/* Loads menu items until there is at least one of them or the command is done
+ * producing them.  The wait can be cancelled by the user. */
+static void
+wait_for_first_item(menu_data_t *m)
+{
+	show_progress("", 0);
+
+	while(m->len == 0 && m->stream != NULL)
+	{
+		bg_job_t *const job = m->stream->job;
+		wait_for_data_from(job->pid, job->output, 0, &ui_cancellation_info);
+		if(ui_cancellation_requested())
+		{
+			break;
+		}
+
+		read_stream_output(m);
+	}
+}
+
+/* Adds menu items out of output of the command that is available at the
+ * moment.  Finishes loading on reaching end of the output. */
+static void
+read_stream_output(menu_data_t *m)
+{
+	enum { BUDGET = 64*1024 };
+
+	/* Don't read too much at once to keep user interface responsive. */
+	size_t budget = BUDGET;
+	while(budget != 0 && m->stream != NULL)
+	{
+		char piece[4096];
+		const int len = read_output(m->stream->job->output, piece,
+				MIN(sizeof(piece), budget));
+		if(len == 0)
+		{
+			break;
+		}
+
+		if(len < 0)
+		{
+			stop_stream(m, /*cancel=*/0);
+			break;
+		}
+
+		append_output(m, piece, len);
+		budget -= len;
+	}
+}
+
+/* Reads data from the output stream of a job without waiting for it to become
+ * available.  Returns number of bytes read, zero if there is no data yet or
+ * negative number at the end or on error. */
+static int
+read_output(FILE *stream, char buf[], size_t size)
+{
+#ifndef _WIN32
+	ssize_t len;
+	do
+	{
+		len = read(fileno(stream), buf, size);
+	}
+	while(len < 0 && errno == EINTR);
+
+	if(len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+	{
+		return 0;
+	}
+	return (len > 0 ? (int)len : -1);
+#else
+	/* Simulate asynchronous reading by not reading more than stream has. */
+	HANDLE hpipe = (HANDLE)_get_osfhandle(fileno(stream));
+	DWORD bytes_available = 0;
+	if(!PeekNamedPipe(hpipe, NULL, 0, NULL, &bytes_available, NULL))
+	{
+		return -1;
+	}
+	if(bytes_available == 0)
+	{
+		return 0;
+	}
+	if(bytes_available < size)
+	{
+		size = bytes_available;
+	}
+
+	const size_t len = fread(buf, 1, size, stream);
+	return (len > 0 ? (int)len : -1);
+#endif
+}
+
+/* Adds a piece of output of the command to the menu.  Incomplete last line is
+ * kept until the rest of it arrives. */
+static void
+append_output(menu_data_t *m, const char data[], size_t len)
+{
+	menu_stream_t *const stream = m->stream;
+
+	char *const text = realloc(stream->partial, stream->partial_len + len + 1U);
+	if(text == NULL)
+	{
+		return;
+	}
+
+	memcpy(text + stream->partial_len, data, len);
+	stream->partial = text;
+	stream->partial_len += len;
+	text[stream->partial_len] = '\0';
+
+	/* Line that ends with \r is incomplete as \n might be the next character. */
+	size_t complete = stream->partial_len;
+	while(complete != 0 && text[complete - 1] != '\n' &&
+			text[complete - 1] != '\0')
+	{
+		--complete;
+	}
+
+	if(complete != 0)
+	{
+		append_lines(m, text, complete);
+		stream->partial_len -= complete;
+		memmove(text, text + complete, stream->partial_len + 1U);
+	}
+}
+
+/* Adds lines of the text as new menu items.  The text is modified. */
+static void
+append_lines(menu_data_t *m, char text[], size_t len)
+{
+	int nlines;
+	char **const lines = break_into_lines(text, len, &nlines, /*null_sep=*/0);
+
+	int i;
+	for(i = 0; i < nlines; ++i)
+	{
+		output_handler(lines[i], m);
+	}
+
+	free_string_array(lines, nlines);
+}
+
+/* Finishes loading menu items.  The command is either cancelled or its
+ * remaining output is added to the menu and its errors are reported.  The
+ * caller is responsible for reflecting cancellation in the title. */
+static void
+stop_stream(menu_data_t *m, int cancel)
+{
+	menu_stream_t *const stream = m->stream;
+	if(stream == NULL)
+	{
+		return;
+	}
+
+	m->stream = NULL;
+
+	bg_job_t *const job = stream->job;
+	if(cancel)
+	{
+		(void)bg_job_cancel(job);
+
+		/* The command might ignore the request, but it won't be able to write
+		 * anything. */
+		fclose(job->output);
+		job->output = NULL;
+	}
+	else
+	{
+		if(stream->partial_len != 0)
+		{
+			append_lines(m, stream->partial, stream->partial_len);
+		}
+		show_stream_errors(job);
+	}
+
+	if(!cancel && bg_job_cancelled(job))
+	{
+		/* The command was cancelled from elsewhere (e.g., from :jobs menu). */
+		append_to_string(&m->title, "(cancelled)");
+	}
+
+	bg_job_decref(job);
+	free(stream->partial);
+	free(stream);
+}
+
+/* Displays errors printed by a finished command, if there were any. */
+static void
+show_stream_errors(bg_job_t *job)
+{
+	if(bg_job_wait(job) != 0 || bg_job_wait_errors(job) != 0)
+	{
+		return;
+	}
+
+	char *errors = NULL;
+	pthread_spin_lock(&job->errors_lock);
+	update_string(&errors, job->errors);
+	pthread_spin_unlock(&job->errors_lock);
+
+	if(!is_null_or_empty(errors))
+	{
+		show_error_msg("Loading menu", errors);
+	}
+	free(errors);
+}
+
+void
+menus_load_more(menu_state_t *ms)
+{
+	menu_data_t *const m = ms->d;
+	if(m == NULL || !m->initialized || m->stream == NULL)
+	{
+		return;
+	}
+
+	const int old_len = m->len;
+	read_stream_output(m);
+
+	if(m->stream != NULL && m->len == old_len)
+	{
+		/* Nothing has changed. */
+		return;
+	}
+
+	if(ms->matches != NULL)
+	{
+		(void)match_new_items(ms, old_len, /*print_errors=*/0);
+	}
+
+	menus_partial_redraw(ms);
+	menus_set_pos(ms, m->pos);
+	ui_refresh_win(menu_win);
+}
+
+int
+menus_stop_loading(menu_state_t *ms)
+{
+	menu_data_t *const m = ms->d;
+	if(m == NULL || !m->initialized || m->stream == NULL)
+	{
+		return 0;
+	}
+
+	stop_stream(m, /*cancel=*/1);
+	append_to_string(&m->title, "(cancelled)");
+
+	menus_partial_redraw(ms);
+	menus_set_pos(ms, m->pos);
+	ui_refresh_win(menu_win);
+	return 1;
+}
+
 void
 menus_search_repeat(menu_state_t *ms, int backward)
 {
@@ -1180,6 +1508,16 @@ menus_search(const char pattern[], menu_data_t *m, int print_errors)
  * Returns non-zero on error. */
 static int
 search_menu(menu_state_t *ms, int print_errors)
+{
+	ms->matching_entries = 0;
+	return match_new_items(ms, 0, print_errors);
+}
+
+/* Marks menu items starting with the one at from index that match search
+ * pattern.  Array of matches is extended to cover all items.  Returns non-zero
+ * on error. */
+static int
+match_new_items(menu_state_t *ms, int from, int print_errors)
 {
 	menu_data_t *const m = ms->d;
 	int cflags;
@@ -1187,15 +1525,17 @@ search_menu(menu_state_t *ms, int print_errors)
 	int err;
 	int i;
 
-	if(ms->matches == NULL)
+	short int (*const new_matches)[2] = reallocarray(ms->matches, m->len,
+			sizeof(*ms->matches));
+	if(new_matches == NULL)
 	{
-		ms->matches = reallocarray(NULL, m->len, sizeof(*ms->matches));
+		return -1;
 	}
+	ms->matches = new_matches;
 
-	memset(ms->matches, -1, 2*sizeof(**ms->matches)*m->len);
-	ms->matching_entries = 0;
+	memset(ms->matches + from, -1, 2*sizeof(**ms->matches)*(m->len - from));
 
-	if(ms->regexp[0] == '\0')
+	if(is_null_or_empty(ms->regexp))
 	{
 		return 0;
 	}
@@ -1212,7 +1552,7 @@ search_menu(menu_state_t *ms, int print_errors)
 		return -1;
 	}
 
-	for(i = 0; i < m->len; ++i)
+	for(i = from; i < m->len; ++i)
 	{
 		regmatch_t matches[1];
 		const char *item = m->items[i];
@@ -40,6 +40,10 @@ KHandlerResponse;
 /* Opaque declaration of structure describing menu state. */
 typedef struct menu_state_t menu_state_t;
 
+/* Opaque declaration of structure describing loading of menu items from output
+ * of a command. */
+typedef struct menu_stream_t menu_stream_t;
+
 /* Menu data related to specific menu rather than to state of menu mode or its
  * UI. */
 typedef struct menu_data_t
@@ -85,6 +89,9 @@ typedef struct menu_data_t
 	 * execute_handler. */
 	int menu_context;
 
+	/* Command which is still producing items of the menu or NULL. */
+	menu_stream_t *stream;
+
 	menu_state_t *state; /* Opaque pointer to menu mode state. */
 	int initialized;     /* Marker that shows whether menu data needs freeing. */
 }
@@ -145,11 +152,23 @@ const menu_data_t * menus_get_stash(int index, int *current);
  * non-zero is returned. */
 int menus_to_custom_view(menu_state_t *ms, struct view_t *view, int very);
 
-/* Either makes a menu or custom view out of command output.  Returns non-zero
- * if status bar message should be saved. */
+/* Either makes a menu or custom view out of command output.  Menu is displayed
+ * as soon as the first item is available while the rest of items are loaded
+ * in background unless the command requires input or user's shell.  Returns
+ * non-zero if status bar message should be saved. */
 int menus_capture(struct view_t *view, const char cmd[], int user_sh,
 		menu_data_t *m, MacroFlags flags);
 
+/* Adds items that were produced by the command of the active menu since the
+ * last call and redraws the menu.  Does nothing if the menu isn't being
+ * loaded. */
+void menus_load_more(menu_state_t *ms);
+
+/* Stops loading items of the active menu and terminates the command that
+ * produces them.  Returns non-zero if the menu was being loaded, otherwise zero
+ * is returned. */
+int menus_stop_loading(menu_state_t *ms);
+
 /* Menu drawing. */
 
 /* Erases current menu item in menu window. */
@@ -52,9 +52,11 @@ show_trash_menu(view_t *view)
 
 	trash_prune_dead_entries();
 
-	for(i = 0; i < trash_list_size; ++i)
+	int count;
+	const trash_entry_t *const list = trash_get_list(&count);
+	for(i = 0; i < count; ++i)
 	{
-		const trash_entry_t *const entry = &trash_list[i];
+		const trash_entry_t *const entry = &list[i];
 		if(trash_has_path(entry->trash_name))
 		{
 			m.len = add_to_string_array(&m.items, m.len, entry->path);
@@ -90,8 +92,11 @@ restore_current(menu_data_t *m)
 	un_group_open("restore: ");
 	un_group_close();
 
+	int count;
+	const trash_entry_t *const list = trash_get_list(&count);
+
 	/* The string is freed in trash_restore(), thus must be cloned. */
-	trash_path = strdup(trash_list[m->pos].trash_name);
+	trash_path = strdup(list[m->pos].trash_name);
 	err = trash_restore(trash_path);
 	free(trash_path);
 
@@ -111,8 +116,11 @@ restore_current(menu_data_t *m)
 static KHandlerResponse
 delete_current(menu_data_t *m)
 {
+	int count;
+	const trash_entry_t *const list = trash_get_list(&count);
+
 	io_args_t args = {
-		.arg1.path = trash_list[m->pos].trash_name,
+		.arg1.path = list[m->pos].trash_name,
 
 		.cancellation.hook = &ui_cancellation_hook,
 	};
@@ -66,6 +66,10 @@ void modmenu_morph_into_cline(CmdLineSubmode submode, const char input[],
 /* Allows running regular command-line mode commands from menu mode. */
 void modmenu_run_command(const char cmd[]);
 
+/* Adds items of the active menu that became available since the last check
+ * while the menu is still being loaded. */
+void modmenu_check_for_updates(void);
+
 /* Returns index of last visible line in the menu.  Value returned may be
  * greater than or equal to number of lines in the menu, which should be
  * treated correctly. */
@@ -23,6 +23,8 @@
 #include <shellapi.h>
 
 #include "utils/utf8.h"
+#else
+#include <unistd.h> /* _SC_ARG_MAX sysconf() */
 #endif
 
 #include <sys/stat.h> /* gid_t uid_t */
@@ -31,7 +33,7 @@
 #include <stddef.h> /* NULL size_t */
 #include <stdio.h> /* snprintf() */
 #include <stdlib.h> /* calloc() free() */
-#include <string.h> /* strdup() */
+#include <string.h> /* strdup() strlen() */
 
 #include "cfg/config.h"
 #include "compat/fs_limits.h"
@@ -52,6 +54,7 @@
 #include "utils/utils.h"
 #include "background.h"
 #include "bmarks.h"
+#include "macros.h"
 #include "status.h"
 #include "trash.h"
 
@@ -130,8 +133,11 @@ static OpsResult op_rmdir(ops_t *ops, void *data, const char src[],
 		const char dst[]);
 static OpsResult op_mkfile(ops_t *ops, void *data, const char src[],
 		const char dst[]);
+static int confirm_removal(ops_t *ops, const char path[]);
 static int ops_uses_syscalls(const ops_t *ops);
 static ShellType ops_shell_type(const ops_t *ops);
+static void setup_caching(const ops_t *ops, const char src[], const char dst[],
+		io_args_t *args);
 static OpsResult exec_io_op(ops_t *ops, IoRes (*func)(io_args_t *),
 		io_args_t *args, int cancellable);
 static int confirm_overwrite(io_args_t *args, const char src[],
@@ -143,6 +149,16 @@ static char prompt_user(const io_args_t *args, const char title[],
 static int ui_cancellation_hook(void *arg);
 #ifndef _WIN32
 static OpsResult run_operation_command(ops_t *ops, char cmd[], int cancellable);
+static char * get_batch_cmd(OPS op, const ops_t *ops, const char args[],
+		const char escaped_dst[]);
+static char * expand_delete_prg(const char delete_prg[], const char args[],
+		int *explicit);
+static size_t get_max_cmd_len(void);
+static void get_batch_dst(const char src[], const char dst_dir[], char buf[],
+		size_t buf_len);
+static OpsResult check_batch_item(OPS op, const char src[],
+		const char dst_dir[]);
+static int ops_cancelled(const ops_t *ops);
 #endif
 static int ops_runs_in_bg(const ops_t *ops);
 static int bg_cancellation_hook(void *arg);
@@ -195,10 +211,14 @@ ops_alloc(OPS main_op, int bg, const char descr[], const char base_dir[],
 	ops->bg = bg;
 
 	update_string(&ops->slow_fs_list, cfg.slow_fs_list);
+	update_string(&ops->no_cache_fs_list, cfg.no_cache_fs_list);
 	update_string(&ops->delete_prg, cfg.delete_prg);
 	ops->use_system_calls = cfg.use_system_calls;
 	ops->fast_file_cloning = cfg.fast_file_cloning;
 	ops->data_sync = cfg.data_sync;
+	ops->no_cache = cfg.no_cache;
+	ops->direct_io = cfg.direct_io;
+	ops->io_rate = cfg.io_rate;
 	ops->shell_type = curr_stats.shell_type;
 
 	ops->choose = choose;
@@ -227,7 +247,7 @@ ops_enqueue(ops_t *ops, const char src[], const char dst[])
 	}
 
 	/* Check once and cache result, it should be the same for each invocation. */
-	if(ops->estim->total_items == 0)
+	if(ops->total == 1)
 	{
 		switch(ops->main_op)
 		{
@@ -263,7 +283,16 @@ ops_enqueue(ops_t *ops, const char src[], const char dst[])
 		}
 	}
 
-	ioeta_calculate(ops->estim, src, ops->shallow_eta);
+	if(ops->bg)
+	{
+		/* Let estimation run alongside the operation instead of delaying its
+		 * start. */
+		ioeta_calculate_async(ops->estim, src, ops->shallow_eta);
+	}
+	else
+	{
+		ioeta_calculate(ops->estim, src, ops->shallow_eta);
+	}
 }
 
 void
@@ -289,6 +318,7 @@ ops_free(ops_t *ops)
 	ioeta_free(ops->estim);
 	free(ops->errors);
 	free(ops->slow_fs_list);
+	free(ops->no_cache_fs_list);
 	free(ops->delete_prg);
 	free(ops->base_dir);
 	free(ops->target_dir);
@@ -323,6 +353,193 @@ perform_operation(OPS op, ops_t *ops, void *data, const char src[],
 	return status;
 }
 
+int
+ops_batch(OPS op, ops_t *ops, char *srcs[], int count, const char dst_dir[],
+		OpsResult results[])
+{
+#ifndef _WIN32
+	if(count < 2)
+	{
+		return 1;
+	}
+
+	char *escaped_dst = NULL;
+	if(dst_dir != NULL)
+	{
+		escaped_dst = shell_arg_escape(dst_dir, ops_shell_type(ops));
+		if(escaped_dst == NULL)
+		{
+			return 1;
+		}
+	}
+
+	/* Commands without arguments tell how much space is left for paths and how
+	 * many times they are repeated. */
+	char *const empty_cmd = get_batch_cmd(op, ops, "", escaped_dst);
+	char *const probe_cmd = get_batch_cmd(op, ops, "x", escaped_dst);
+	char *is_dir_list = calloc(count, 1);
+	if(empty_cmd == NULL || probe_cmd == NULL || is_dir_list == NULL)
+	{
+		free(empty_cmd);
+		free(probe_cmd);
+		free(is_dir_list);
+		free(escaped_dst);
+		return 1;
+	}
+
+	const size_t cmd_len = strlen(empty_cmd);
+	const size_t nuses = strlen(probe_cmd) - cmd_len;
+	free(empty_cmd);
+	free(probe_cmd);
+
+	int i;
+	if(op == OP_REMOVE && !confirm_removal(ops, srcs[0]))
+	{
+		for(i = 0; i < count; ++i)
+		{
+			results[i] = OPS_SKIPPED;
+		}
+		free(is_dir_list);
+		free(escaped_dst);
+		return 0;
+	}
+
+	for(i = 0; i < count; ++i)
+	{
+		char dst[PATH_MAX + 1];
+		results[i] = OPS_SUCCEEDED;
+
+		if(dst_dir != NULL)
+		{
+			/* Files aren't overwritten, so existing destination is an error just
+			 * like it is when processing files one by one. */
+			get_batch_dst(srcs[i], dst_dir, dst, sizeof(dst));
+			if(path_exists(dst, NODEREF))
+			{
+				results[i] = OPS_FAILED;
+			}
+		}
+
+		if(!ops_runs_in_bg(ops))
+		{
+			is_dir_list[i] = is_dir(srcs[i]);
+		}
+	}
+
+	const size_t max_len = get_max_cmd_len();
+
+	int first = 0;
+	while(first < count && !ops_cancelled(ops))
+	{
+		char *args = strdup("");
+		size_t len = 0U;
+
+		int last = first;
+		int nargs = 0;
+		while(args != NULL && last < count)
+		{
+			if(results[last] != OPS_SUCCEEDED)
+			{
+				++last;
+				continue;
+			}
+
+			char *const escaped = shell_arg_escape(srcs[last], ops_shell_type(ops));
+			if(escaped == NULL)
+			{
+				results[last++] = OPS_FAILED;
+				continue;
+			}
+
+			const size_t new_len = len + (nargs == 0 ? 0U : 1U) + strlen(escaped);
+			const int fits = (cmd_len + nuses*new_len <= max_len);
+			if(!fits && nargs != 0)
+			{
+				free(escaped);
+				break;
+			}
+
+			if((nargs != 0 && strappendch(&args, &len, ' ') != 0) ||
+					strappend(&args, &len, escaped) != 0)
+			{
+				free(escaped);
+				free(args);
+				args = NULL;
+				break;
+			}
+			free(escaped);
+
+			++nargs;
+			++last;
+		}
+
+		char *const cmd = (args == NULL)
+		                ? NULL
+		                : get_batch_cmd(op, ops, args, escaped_dst);
+		free(args);
+		if(cmd == NULL)
+		{
+			break;
+		}
+
+		if(nargs != 0)
+		{
+			LOG_INFO_MSG("Running batch command for %d files: \"%s\"", nargs, cmd);
+			(void)run_operation_command(ops, cmd, 1);
+		}
+		free(cmd);
+
+		/* Exit code can't be attributed to a particular file, so look at the file
+		 * system instead. */
+		for(i = first; i < last; ++i)
+		{
+			if(results[i] != OPS_SUCCEEDED)
+			{
+				continue;
+			}
+
+			results[i] = check_batch_item(op, srcs[i], dst_dir);
+			if(results[i] != OPS_SUCCEEDED || ops_runs_in_bg(ops))
+			{
+				continue;
+			}
+
+			char dst[PATH_MAX + 1];
+			if(dst_dir != NULL)
+			{
+				get_batch_dst(srcs[i], dst_dir, dst, sizeof(dst));
+			}
+
+			if(op == OP_MOVE)
+			{
+				trash_file_moved(srcs[i], dst);
+				bmarks_file_moved(srcs[i], dst);
+			}
+
+			vlua_events_app_fsop(curr_stats.vlua, op, srcs[i],
+					(dst_dir == NULL ? NULL : dst), NULL, is_dir_list[i]);
+		}
+
+		first = last;
+	}
+
+	/* Whatever wasn't processed due to cancellation or an error. */
+	for(i = first; i < count; ++i)
+	{
+		if(results[i] == OPS_SUCCEEDED)
+		{
+			results[i] = OPS_SKIPPED;
+		}
+	}
+
+	free(is_dir_list);
+	free(escaped_dst);
+	return 0;
+#else
+	return 1;
+#endif
+}
+
 static OpsResult
 op_none(ops_t *ops, void *data, const char src[], const char dst[])
 {
@@ -331,6 +548,19 @@ op_none(ops_t *ops, void *data, const char src[], const char dst[])
 
 static OpsResult
 op_remove(ops_t *ops, void *data, const char src[], const char dst[])
+{
+	if(!confirm_removal(ops, src))
+	{
+		return OPS_SKIPPED;
+	}
+
+	return op_removesl(ops, data, src, dst);
+}
+
+/* Asks user to confirm permanent removal of files unless it's not needed.
+ * Returns non-zero if removal can proceed. */
+static int
+confirm_removal(ops_t *ops, const char path[])
 {
 	if((ops == NULL || !ops->bg) && cfg_confirm_delete(0) &&
 			!curr_stats.confirmed)
@@ -341,14 +571,13 @@ op_remove(ops_t *ops, void *data, const char src[], const char dst[])
 				"At least the following file is about to be deleted:\n \n%s\n \n"
 				"If you're undoing a command and want to see file names, use "
 				":undolist! command.",
-				replace_home_part(src));
+				replace_home_part(path));
 		curr_stats.confirmed = confirm("Permanent deletion", msg);
 		free(msg);
 		if(!curr_stats.confirmed)
-			return OPS_SKIPPED;
+			return 0;
 	}
-
-	return op_removesl(ops, data, src, dst);
+	return 1;
 }
 
 static OpsResult
@@ -360,21 +589,25 @@ op_removesl(ops_t *ops, void *data, const char src[], const char dst[])
 	if(delete_prg[0] != '\0')
 	{
 #ifndef _WIN32
-		char *escaped;
-		char cmd[2*PATH_MAX + 1];
 		const int cancellable = (data == NULL);
 
-		escaped = shell_arg_escape(src, ops_shell_type(ops));
+		char *const escaped = shell_arg_escape(src, ops_shell_type(ops));
 		if(escaped == NULL)
 		{
 			return OPS_FAILED;
 		}
 
-		snprintf(cmd, sizeof(cmd), "%s %s", delete_prg, escaped);
+		char *const cmd = expand_delete_prg(delete_prg, escaped, NULL);
 		free(escaped);
+		if(cmd == NULL)
+		{
+			return OPS_FAILED;
+		}
 
 		LOG_INFO_MSG("Running trash command: \"%s\"", cmd);
-		return run_operation_command(ops, cmd, cancellable);
+		const OpsResult result = run_operation_command(ops, cmd, cancellable);
+		free(cmd);
+		return result;
 #else
 		char *src_copy = strdup(src);
 		internal_to_system_slashes(src_copy);
@@ -382,11 +615,16 @@ op_removesl(ops_t *ops, void *data, const char src[], const char dst[])
 		char *escaped_src = shell_arg_escape(src_copy, ST_CMD);
 		free(src_copy);
 
-		char cmd[PATH_MAX*2 + 1];
-		snprintf(cmd, sizeof(cmd), "%s %s", delete_prg, escaped_src);
+		char *const cmd = expand_delete_prg(delete_prg, escaped_src, NULL);
 		free(escaped_src);
+		if(cmd == NULL)
+		{
+			return OPS_FAILED;
+		}
 
-		return result_from_code(os_system(cmd));
+		const OpsResult result = result_from_code(os_system(cmd));
+		free(cmd);
+		return result;
 #endif
 	}
 
@@ -587,6 +825,7 @@ op_cp(ops_t *ops, void *data, const char src[], const char dst[],
 			.data_sync = data_sync,
 		},
 	};
+	setup_caching(ops, src, dst, &args);
 	return exec_io_op(ops, &ior_cp, &args, data == NULL);
 }
 
@@ -686,6 +925,7 @@ op_mv(ops_t *ops, void *data, const char src[], const char dst[],
 				.data_sync = (ops == NULL ? cfg.data_sync : ops->data_sync),
 			},
 		};
+		setup_caching(ops, src, dst, &args);
 
 		result = exec_io_op(ops, &ior_mv, &args, data == NULL);
 	}
@@ -1041,6 +1281,28 @@ ops_shell_type(const ops_t *ops)
 	return (ops == NULL ? curr_stats.shell_type : (ShellType)ops->shell_type);
 }
 
+/* Fills in parameters of interaction with file-system cache for copying from
+ * src to dst. */
+static void
+setup_caching(const ops_t *ops, const char src[], const char dst[],
+		io_args_t *args)
+{
+	const char *const no_cache_fs_list = (ops == NULL)
+	                                    ? cfg.no_cache_fs_list
+	                                    : ops->no_cache_fs_list;
+	const int io_rate = (ops == NULL ? cfg.io_rate : ops->io_rate);
+
+	args->arg4.no_cache = (ops == NULL ? cfg.no_cache : ops->no_cache);
+	args->arg4.direct_io = (ops == NULL ? cfg.direct_io : ops->direct_io);
+	args->arg4.rate_limit = (io_rate > 0 ? io_rate : 0);
+
+	if(!args->arg4.no_cache && no_cache_fs_list != NULL)
+	{
+		args->arg4.no_cache = is_on_slow_fs(src, no_cache_fs_list)
+		                   || is_on_slow_fs(dst, no_cache_fs_list);
+	}
+}
+
 /* Executes i/o operation with some predefined pre/post actions.  Returns
  * status. */
 static OpsResult
@@ -1296,6 +1558,142 @@ run_operation_command(ops_t *ops, char cmd[], int cancellable)
 	}
 }
 
+/* Forms a command that processes multiple files at once.  The args is a list
+ * of escaped paths and escaped_dst is escaped destination directory (can be
+ * NULL).  Returns newly allocated string or NULL if operation isn't performed
+ * by an external command or doesn't support processing several files. */
+static char *
+get_batch_cmd(OPS op, const ops_t *ops, const char args[],
+		const char escaped_dst[])
+{
+	const char *const delete_prg = (ops == NULL)
+	                             ? cfg.delete_prg
+	                             : ops->delete_prg;
+	const int fast_file_cloning = (ops == NULL)
+	                             ? cfg.fast_file_cloning
+	                             : ops->fast_file_cloning;
+
+	switch(op)
+	{
+		case OP_REMOVE:
+		case OP_REMOVESL:
+			if(delete_prg[0] != '\0')
+			{
+				/* Whether the command accepts several files is unknown unless it says
+				 * so by using %f macro. */
+				int explicit;
+				char *const cmd = expand_delete_prg(delete_prg, args, &explicit);
+				if(!explicit)
+				{
+					free(cmd);
+					return NULL;
+				}
+				return cmd;
+			}
+			return ops_uses_syscalls(ops) ? NULL : format_str("rm -rf %s", args);
+		case OP_COPY:
+			if(ops_uses_syscalls(ops) || escaped_dst == NULL)
+			{
+				return NULL;
+			}
+			return format_str("cp %s %s -R " PRESERVE_FLAGS " %s %s", NO_CLOBBER,
+					fast_file_cloning ? REFLINK_AUTO : "", args, escaped_dst);
+		case OP_MOVE:
+			if(ops_uses_syscalls(ops) || escaped_dst == NULL)
+			{
+				return NULL;
+			}
+			return format_str("mv %s %s %s", NO_CLOBBER, args, escaped_dst);
+
+		default:
+			return NULL;
+	}
+}
+
+/* Expands value of 'deleteprg' replacing %f with the args, which are appended
+ * if there is no %f.  *explicit (can be NULL) is set to whether %f was used.
+ * Returns newly allocated string or NULL on error. */
+static char *
+expand_delete_prg(const char delete_prg[], const char args[], int *explicit)
+{
+	custom_macro_t macros[] = {
+		{ .letter = 'f', .value = args, .uses_left = 1, .group = -1 },
+	};
+
+	char *const cmd = ma_expand_custom(delete_prg, ARRAY_LEN(macros), macros,
+			MA_NOOPT);
+	if(explicit != NULL)
+	{
+		*explicit = macros[0].explicit_use;
+	}
+	return cmd;
+}
+
+/* Computes maximum length of a command that packs multiple paths.  Returns the
+ * length. */
+static size_t
+get_max_cmd_len(void)
+{
+	/* Shell receives the whole command as a single argument, whose length is
+	 * limited separately from ARG_MAX on Linux (MAX_ARG_STRLEN is 128 KiB). */
+	size_t max_len = 128*1024;
+
+	const long arg_max = sysconf(_SC_ARG_MAX);
+	if(arg_max > 0 && (size_t)arg_max/2 < max_len)
+	{
+		/* Leave the other half for environment. */
+		max_len = arg_max/2;
+	}
+
+	return max_len - 1U;
+}
+
+/* Forms destination path of a file that is copied or moved into a directory by
+ * a batch command. */
+static void
+get_batch_dst(const char src[], const char dst_dir[], char buf[],
+		size_t buf_len)
+{
+	snprintf(buf, buf_len, "%s/%s", dst_dir, get_last_path_component(src));
+}
+
+/* Determines outcome of processing a single file by a batch command.  Returns
+ * the status. */
+static OpsResult
+check_batch_item(OPS op, const char src[], const char dst_dir[])
+{
+	char dst[PATH_MAX + 1];
+	if(dst_dir != NULL)
+	{
+		get_batch_dst(src, dst_dir, dst, sizeof(dst));
+	}
+
+	int ok;
+	switch(op)
+	{
+		case OP_COPY:
+			ok = path_exists(dst, NODEREF);
+			break;
+		case OP_MOVE:
+			ok = !path_exists(src, NODEREF) && path_exists(dst, NODEREF);
+			break;
+
+		default:
+			ok = !path_exists(src, NODEREF);
+			break;
+	}
+	return (ok ? OPS_SUCCEEDED : OPS_FAILED);
+}
+
+/* Checks whether processing of files was cancelled by the user.  Returns
+ * non-zero if so. */
+static int
+ops_cancelled(const ops_t *ops)
+{
+	return ops_runs_in_bg(ops) ? bg_op_cancelled(ops->bg_op)
+	                           : ui_cancellation_requested();
+}
+
 #endif
 
 /* Checks whether operation is a background one.  The parameter can be NULL.
@@ -111,10 +111,14 @@ typedef struct ops_t
 	/* It's unsafe to access global cfg object from threads performing background
 	 * operations, so copy them and use the copies. */
 	char *slow_fs_list;    /* Copy of 'slowfs' option value. */
+	char *no_cache_fs_list; /* Copy of 'nocachefs' option value. */
 	char *delete_prg;      /* Copy of 'deleteprg' option value. */
 	int use_system_calls;  /* Copy of 'syscalls' option value. */
 	int fast_file_cloning; /* Copy of part of 'iooptions' option value. */
 	int data_sync;         /* Copy of part of 'iooptions' option value. */
+	int no_cache;          /* Copy of part of 'iooptions' option value. */
+	int direct_io;         /* Copy of part of 'iooptions' option value. */
+	int io_rate;           /* Copy of 'iorate' option value. */
 	int shell_type;        /* Copy of curr_stats.shell_type */
 
 	/* Pointers to user-interaction functions. */
@@ -155,6 +159,17 @@ void ops_free(ops_t *ops);
 OpsResult perform_operation(OPS op, ops_t *ops, void *data, const char src[],
 		const char dst[]);
 
+/* Performs the same operation on multiple files at once when it's done by an
+ * external command ('deleteprg' or 'nosyscalls') packing as many paths into a
+ * single invocation as the system allows.  Supported operations are removal
+ * (dst_dir is NULL) and copying or moving of files into dst_dir under their
+ * own names.  As exit code of a command can't be attributed to a single file,
+ * results[i] for srcs[i] is set by checking the file system.  Returns zero if
+ * files were processed and non-zero if the caller should process them one by
+ * one. */
+int ops_batch(OPS op, ops_t *ops, char *srcs[], int count, const char dst_dir[],
+		OpsResult results[]);
+
 #endif /* VIFM__OPS_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
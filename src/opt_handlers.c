@@ -114,6 +114,7 @@ static void load_sort_option_inner(view_t *view, signed char sort_keys[]);
 static void aproposprg_handler(OPT_OP op, optval_t val);
 static void autocd_handler(OPT_OP op, optval_t val);
 static void autochpos_handler(OPT_OP op, optval_t val);
+static void bgthreads_handler(OPT_OP op, optval_t val);
 static void caseoptions_handler(OPT_OP op, optval_t val);
 static void cdpath_handler(OPT_OP op, optval_t val);
 static void chaselinks_handler(OPT_OP op, optval_t val);
@@ -146,6 +147,9 @@ static void iec_handler(OPT_OP op, optval_t val);
 static void ignorecase_handler(OPT_OP op, optval_t val);
 static void incsearch_handler(OPT_OP op, optval_t val);
 static void iooptions_handler(OPT_OP op, optval_t val);
+#ifndef _WIN32
+static void iorate_handler(OPT_OP op, optval_t val);
+#endif
 static void laststatus_handler(OPT_OP op, optval_t val);
 static void lines_handler(OPT_OP op, optval_t val);
 static void locateprg_handler(OPT_OP op, optval_t val);
@@ -156,6 +160,9 @@ static void mintimeoutlen_handler(OPT_OP op, optval_t val);
 static void scroll_line_down(view_t *view);
 static void mouse_handler(OPT_OP op, optval_t val);
 static void navoptions_handler(OPT_OP op, optval_t val);
+#ifndef _WIN32
+static void nocachefs_handler(OPT_OP op, optval_t val);
+#endif
 static void previewoptions_handler(OPT_OP op, optval_t val);
 static void quickview_handler(OPT_OP op, optval_t val);
 static void rulerformat_handler(OPT_OP op, optval_t val);
@@ -361,6 +368,8 @@ ARRAY_GUARD(suggestoptions_vals, NUM_SUGGESTION_FLAGS);
 static const char *iooptions_vals[][2] = {
 	{ "fastfilecloning", "use COW if FS supports it" },
 	{ "datasync",        "synchronize writes to storage" },
+	{ "nocache",         "evict copied data from file-system cache" },
+	{ "directio",        "bypass file-system cache if possible" },
 };
 
 /* Possible flags of 'shortmess' and their count. */
@@ -551,6 +560,7 @@ static const char *vifminfo_set[][2] = {
 	[BIT(VINFO_FHISTORY)]  = { "fhistory",  "local filter history" },
 	[BIT(VINFO_MCHISTORY)] = { "mchistory", "menu cmdline history" },
 	[BIT(VINFO_TABS)]      = { "tabs",      "global or pane tabs" },
+	[BIT(VINFO_JOURNAL)]   = { "journal",   "append changes to a journal" },
 };
 ARRAY_GUARD(vifminfo_set, NUM_VINFO);
 
@@ -593,6 +603,10 @@ options[] = {
 	  OPT_BOOL, 0, NULL, &autochpos_handler, NULL,
 	  { .ref.bool_val = &cfg.auto_ch_pos },
 	},
+	{ "bgthreads", "", "max number of threads for background jobs",
+	  OPT_INT, 0, NULL, &bgthreads_handler, NULL,
+	  { .ref.int_val = &cfg.bg_threads },
+	},
 	{ "caseoptions", "", "case sensitivity overrides",
 	  OPT_CHARSET, ARRAY_LEN(caseoptions_vals), caseoptions_vals,
 		&caseoptions_handler, NULL,
@@ -704,6 +718,12 @@ options[] = {
 		NULL,
 	  { .init = &init_iooptions },
 	},
+#ifndef _WIN32
+	{ "iorate", "", "max speed of copying files in KiB/s",
+	  OPT_INT, 0, NULL, &iorate_handler, NULL,
+	  { .ref.int_val = &cfg.io_rate },
+	},
+#endif
 	{ "laststatus", "ls", "visibility of status bar",
 	  OPT_BOOL, 0, NULL, &laststatus_handler, NULL,
 	  { .ref.bool_val = &cfg.display_statusline },
@@ -735,6 +755,12 @@ options[] = {
 	  &navoptions_handler, NULL,
 	  { .init = &init_navoptions },
 	},
+#ifndef _WIN32
+	{ "nocachefs", "", "filesystems to keep out of cache on copying",
+	  OPT_STRLIST, 0, NULL, &nocachefs_handler, NULL,
+	  { .ref.str_val = &cfg.no_cache_fs_list },
+	},
+#endif
 	{ "previewoptions", "", "tweaks for how preview is done",
 	  OPT_STRLIST, ARRAY_LEN(previewoptions_vals), previewoptions_vals,
 		&previewoptions_handler, NULL,
@@ -1312,7 +1338,9 @@ static void
 init_iooptions(optval_t *val)
 {
 	val->set_items = (cfg.fast_file_cloning != 0) << 0
-	               | (cfg.data_sync         != 0) << 1;
+	               | (cfg.data_sync         != 0) << 1
+	               | (cfg.no_cache          != 0) << 2
+	               | (cfg.direct_io         != 0) << 3;
 }
 
 /* Default-initializes whether to display file numbers. */
@@ -1749,6 +1777,23 @@ autochpos_handler(OPT_OP op, optval_t val)
 	}
 }
 
+/* Limits number of threads that execute background tasks and operations, zero
+ * means no limit. */
+static void
+bgthreads_handler(OPT_OP op, optval_t val)
+{
+	if(val.int_val < 0)
+	{
+		vle_tb_append_linef(vle_err, "Argument must be >= 0: %d", val.int_val);
+		error = 1;
+		val.int_val = cfg.bg_threads;
+		vle_opts_assign("bgthreads", val, OPT_GLOBAL);
+		return;
+	}
+
+	cfg.bg_threads = val.int_val;
+}
+
 /* Handles changes of 'caseoptions' option.  Updates configuration and
  * normalizes option value. */
 static void
@@ -2354,7 +2399,27 @@ iooptions_handler(OPT_OP op, optval_t val)
 {
 	cfg.fast_file_cloning = ((val.set_items & 1) != 0);
 	cfg.data_sync = ((val.set_items & 2) != 0);
+	cfg.no_cache = ((val.set_items & 4) != 0);
+	cfg.direct_io = ((val.set_items & 8) != 0);
+}
+
+#ifndef _WIN32
+/* Limits speed of copying files, zero means no limit. */
+static void
+iorate_handler(OPT_OP op, optval_t val)
+{
+	if(val.int_val < 0)
+	{
+		vle_tb_append_linef(vle_err, "Argument must be >= 0: %d", val.int_val);
+		error = 1;
+		val.int_val = cfg.io_rate;
+		vle_opts_assign("iorate", val, OPT_GLOBAL);
+		return;
+	}
+
+	cfg.io_rate = val.int_val;
 }
+#endif
 
 static void
 laststatus_handler(OPT_OP op, optval_t val)
@@ -2819,6 +2884,15 @@ slowfs_handler(OPT_OP op, optval_t val)
 }
 #endif
 
+#ifndef _WIN32
+/* Handles updates of the 'nocachefs' option. */
+static void
+nocachefs_handler(OPT_OP op, optval_t val)
+{
+	(void)replace_string(&cfg.no_cache_fs_list, val.str_val);
+}
+#endif
+
 static void
 smartcase_handler(OPT_OP op, optval_t val)
 {
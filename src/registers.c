@@ -95,6 +95,14 @@ typedef struct
 }
 shared_state_t;
 
+/* Describes local state of a register with regard to shared memory. */
+typedef struct
+{
+	unsigned int generation; /* Generation of the data we have. */
+	int dirty;               /* Whether register was changed locally. */
+}
+reg_sync_t;
+
 /* Size of the metadata. */
 #define SHARED_ALL_METADATA_SIZE (sizeof(shared_state_t))
 
@@ -160,11 +168,14 @@ static char *shmem_raw;
 static shared_state_t *shmem;
 /* Last generation number that we've seen. */
 static unsigned int seen_generation;
+/* Synchronization state of each of the registers. */
+static reg_sync_t regs_sync[NUM_REGISTERS];
 /* Whether we're in debug mode. */
 static int debug_print_to_stdout;
 
 static int find_in_reg(const reg_t *reg, const char file[]);
 static reg_t * reg_from_name(int reg_name);
+static void mark_dirty(const reg_t *reg);
 static void regs_sync_error(const char msg[]);
 static int regs_sync_to_shared_memory_critical(void);
 static int regs_sync_enter_critical_section(void);
@@ -175,6 +186,8 @@ static size_t regs_sync_store_register_contents_in_place(size_t current_offset,
 	size_t reg_id);
 static int regs_sync_resize_allocation(size_t newsz);
 static void regs_sync_leave_critical_section(void);
+static void regs_sync_from_shared_memory_critical(int skip_dirty);
+static void regs_sync_load_register_critical(size_t reg_id);
 TSTATIC int regs_sync_enabled(void);
 TSTATIC void regs_sync_debug_print_memory(void);
 static void regs_sync_debug_print_area(size_t offset, size_t length);
@@ -189,6 +202,7 @@ regs_init(void)
 		registers[i].name = valid_registers[i];
 		registers[i].nfiles = 0;
 		registers[i].files = NULL;
+		regs_sync[i].dirty = 0;
 	}
 }
 
@@ -236,6 +250,7 @@ regs_append(int reg_name, const char file[])
 	memmove(reg->files + pos + 1, reg->files + pos,
 			sizeof(*reg->files)*(nfiles - 1 - pos));
 	reg->files[pos] = file_copy;
+	mark_dirty(reg);
 	return 0;
 }
 
@@ -282,6 +297,7 @@ regs_set(int reg_name, char **files, int nfiles)
 	free_string_array(reg->files, reg->nfiles);
 	reg->files = files;
 	reg->nfiles = nfiles;
+	mark_dirty(reg);
 }
 
 void
@@ -306,6 +322,7 @@ regs_clear(int reg_name)
 	free_string_array(reg->files, reg->nfiles);
 	reg->files = NULL;
 	reg->nfiles = 0;
+	mark_dirty(reg);
 }
 
 void
@@ -326,7 +343,12 @@ regs_pack(int reg_name)
 			reg->files[j++] = reg->files[i];
 		}
 	}
-	reg->nfiles = j;
+
+	if(reg->nfiles != j)
+	{
+		reg->nfiles = j;
+		mark_dirty(reg);
+	}
 }
 
 char **
@@ -371,6 +393,7 @@ regs_rename_contents(const char old[], const char new[])
 		if(pos >= 0)
 		{
 			(void)replace_string(&registers[i].files[pos], new);
+			mark_dirty(&registers[i]);
 		}
 	}
 }
@@ -419,6 +442,14 @@ reg_from_name(int reg_name)
 	return NULL;
 }
 
+/* Remembers that register has changed and needs to be written to shared
+ * memory. */
+static void
+mark_dirty(const reg_t *reg)
+{
+	regs_sync[reg - registers].dirty = 1;
+}
+
 void
 regs_remove_trashed_files(const char trash_dir[])
 {
@@ -555,6 +586,17 @@ regs_sync_enable(const char shared_memory_name[])
 			return;
 		}
 	}
+	else
+	{
+		/* Whatever we've got doesn't come from this shared memory, so make sure
+		 * that everything gets loaded on the next synchronization. */
+		seen_generation = ~shmem->generation;
+		int i;
+		for(i = 0; i < NUM_REGISTERS; ++i)
+		{
+			regs_sync[i].generation = ~shmem->reg_metadata[i].generation;
+		}
+	}
 
 	regs_sync_leave_critical_section();
 }
@@ -600,18 +642,41 @@ regs_sync_to_shared_memory(void)
 static int
 regs_sync_to_shared_memory_critical(void)
 {
+	int i;
+	int j;
+
+	if(shmem->data_is_consistent)
+	{
+		/* Pick up changes of other instances to registers we haven't modified, so
+		 * that they aren't overwritten by stale data if the area is rewritten. */
+		regs_sync_from_shared_memory_critical(1);
+	}
+	else
+	{
+		/* Nothing in shared memory can be relied upon, so write everything. */
+		for(i = 0; i < NUM_REGISTERS; ++i)
+		{
+			regs_sync[i].dirty = 1;
+		}
+	}
+
 	shmem->data_is_consistent = 0;
 	seen_generation = ++shmem->generation;
 
-	/* Determine memory requirements for state to be synchronized. */
+	/* Determine memory requirements for state to be synchronized.  Clean
+	 * registers match what's in shared memory and can't grow. */
 	size_t new_register_sizes_total = 0;
 	size_t new_register_sizes[NUM_REGISTERS];
 
-	int i;
-	int j;
-
 	for(i = 0; i < NUM_REGISTERS; ++i)
 	{
+		if(!regs_sync[i].dirty)
+		{
+			new_register_sizes[i] = shmem->reg_metadata[i].length_used;
+			new_register_sizes_total += new_register_sizes[i];
+			continue;
+		}
+
 		new_register_sizes[i] = 0;
 		for(j = 0; j < registers[i].nfiles; ++j)
 		{
@@ -650,7 +715,11 @@ regs_sync_to_shared_memory_critical(void)
 			size_t offset = SHARED_ALL_METADATA_SIZE + shmem->length_area_used;
 			for(i = 0; i < NUM_REGISTERS; ++i)
 			{
-				if(new_register_sizes[i] >
+				if(!regs_sync[i].dirty)
+				{
+					/* Leave unchanged register alone. */
+				}
+				else if(new_register_sizes[i] >
 						shmem->reg_metadata[i].length_available)
 				{
 					/* Append at the end. */
@@ -683,6 +752,12 @@ regs_sync_to_shared_memory_critical(void)
 		regs_sync_rewrite_critical();
 	}
 
+	for(i = 0; i < NUM_REGISTERS; ++i)
+	{
+		regs_sync[i].generation = shmem->reg_metadata[i].generation;
+		regs_sync[i].dirty = 0;
+	}
+
 	return 1;
 }
 
@@ -733,12 +808,17 @@ regs_sync_store_register_contents_critical(size_t current_offset, size_t reg_id)
 }
 
 /* Dumps contents of a register into shared memory at specified offset.
- * Returns new offset. */
+ * Generation is updated only for registers with changed contents, so that
+ * other instances don't reload registers that were just moved around.  Returns
+ * new offset. */
 static size_t
 regs_sync_store_register_contents_in_place(size_t current_offset, size_t reg_id)
 {
 	int i;
-	shmem->reg_metadata[reg_id].generation  = seen_generation;
+	if(regs_sync[reg_id].dirty)
+	{
+		shmem->reg_metadata[reg_id].generation = seen_generation;
+	}
 	shmem->reg_metadata[reg_id].num_entries = registers[reg_id].nfiles;
 	shmem->reg_metadata[reg_id].offset      = current_offset;
 	for(i = 0; i < registers[reg_id].nfiles; ++i)
@@ -790,33 +870,57 @@ regs_sync_from_shared_memory(void)
 	if(shmem->generation != seen_generation && shmem->data_is_consistent)
 	{
 		/* Other instance changed the register contents, let's check the details. */
+		regs_sync_from_shared_memory_critical(0);
+		seen_generation = shmem->generation;
+	}
 
-		int i;
-		for(i = 0; i < NUM_REGISTERS; ++i)
-		{
-			if(shmem->reg_metadata[i].generation != seen_generation)
-			{
-				free_string_array(registers[i].files, registers[i].nfiles);
+	regs_sync_leave_critical_section();
+}
 
-				registers[i].nfiles = shmem->reg_metadata[i].num_entries;
-				registers[i].files = reallocarray(NULL, registers[i].nfiles,
-						sizeof(char *));
+/* Loads registers changed by other instances from shared memory.  Registers
+ * with local changes are left as is if skip_dirty is set. */
+static void
+regs_sync_from_shared_memory_critical(int skip_dirty)
+{
+	int i;
+	for(i = 0; i < NUM_REGISTERS; ++i)
+	{
+		if(skip_dirty && regs_sync[i].dirty)
+		{
+			continue;
+		}
 
-				int j;
-				const char *curstrptr = shmem_raw + shmem->reg_metadata[i].offset;
-				for(j = 0; j < registers[i].nfiles; ++j)
-				{
-					size_t curlen = strlen(curstrptr) + 1;
-					registers[i].files[j] = malloc(curlen);
-					memcpy(registers[i].files[j], curstrptr, curlen);
-					curstrptr += curlen;
-				}
-			}
+		if(shmem->reg_metadata[i].generation != regs_sync[i].generation)
+		{
+			regs_sync_load_register_critical(i);
 		}
-		seen_generation = shmem->generation;
 	}
+}
 
-	regs_sync_leave_critical_section();
+/* Replaces contents of a register with data from shared memory. */
+static void
+regs_sync_load_register_critical(size_t reg_id)
+{
+	const reg_metadata_t *const meta = &shmem->reg_metadata[reg_id];
+	reg_t *const reg = &registers[reg_id];
+
+	free_string_array(reg->files, reg->nfiles);
+
+	reg->nfiles = meta->num_entries;
+	reg->files = reallocarray(NULL, reg->nfiles, sizeof(char *));
+
+	int i;
+	const char *curstrptr = shmem_raw + meta->offset;
+	for(i = 0; i < reg->nfiles; ++i)
+	{
+		size_t curlen = strlen(curstrptr) + 1;
+		reg->files[i] = malloc(curlen);
+		memcpy(reg->files[i], curstrptr, curlen);
+		curstrptr += curlen;
+	}
+
+	regs_sync[reg_id].generation = meta->generation;
+	regs_sync[reg_id].dirty = 0;
 }
 
 TSTATIC int
@@ -43,6 +43,7 @@ const char *tags[] = {
 	"vifm-'aproposprg'",
 	"vifm-'autocd'",
 	"vifm-'autochpos'",
+	"vifm-'bgthreads'",
 	"vifm-'caseoptions'",
 	"vifm-'cd'",
 	"vifm-'cdpath'",
@@ -79,6 +80,7 @@ const char *tags[] = {
 	"vifm-'ignorecase'",
 	"vifm-'incsearch'",
 	"vifm-'iooptions'",
+	"vifm-'iorate'",
 	"vifm-'is'",
 	"vifm-'laststatus'",
 	"vifm-'lines'",
@@ -92,6 +94,7 @@ const char *tags[] = {
 	"vifm-'mintimeoutlen'",
 	"vifm-'mouse'",
 	"vifm-'navoptions'",
+	"vifm-'nocachefs'",
 	"vifm-'nu'",
 	"vifm-'number'",
 	"vifm-'numberwidth'",
@@ -174,6 +177,7 @@ const char *tags[] = {
 	"vifm---on-choose",
 	"vifm---plugins-dir",
 	"vifm---remote",
+	"vifm---remote-batch",
 	"vifm---remote-expr",
 	"vifm---select",
 	"vifm---server-list",
@@ -280,6 +284,7 @@ const char *tags[] = {
 	"vifm-:find",
 	"vifm-:fini",
 	"vifm-:finish",
+	"vifm-:fuzzy",
 	"vifm-:go",
 	"vifm-:goto",
 	"vifm-:gr",
@@ -727,6 +732,7 @@ const char *tags[] = {
 	"vifm-l_VifmView.locopts",
 	"vifm-l_VifmView.viewopts",
 	"vifm-l_VifmView:cd()",
+	"vifm-l_VifmView:entries()",
 	"vifm-l_VifmView:entry()",
 	"vifm-l_VifmView:select()",
 	"vifm-l_VifmView:unselect()",
@@ -981,6 +987,7 @@ const char *tags[] = {
 	"vifm-view",
 	"vifm-view-look",
 	"vifm-vifminfo",
+	"vifm-vifminfo-journal",
 	"vifm-vifmrc",
 	"vifm-visual",
 	"vifm-y",
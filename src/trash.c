@@ -25,8 +25,8 @@
 #include <errno.h> /* EROFS errno */
 #include <stddef.h> /* NULL size_t */
 #include <stdio.h> /* remove() snprintf() */
-#include <stdlib.h> /* free() realloc() */
-#include <string.h> /* memmove() strchr() strcmp() strdup() strlen() strspn() */
+#include <stdlib.h> /* free() qsort() realloc() */
+#include <string.h> /* strchr() strcmp() strdup() strlen() strspn() */
 
 #include "cfg/config.h"
 #include "compat/fs_limits.h"
@@ -104,7 +104,14 @@ static int is_trash_valid(const char trash_dir[], int allow_empty);
 static void add_trash_to_list(trashes_list *list, const char path[],
 		int can_delete);
 static void remove_from_trash(const char trash_name[]);
+static void remove_entry(int pos);
 static void free_entry(const trash_entry_t *entry);
+static void sort_list(void);
+static void drop_removed_entries(void);
+static int entry_cmp(const void *a, const void *b);
+static int find_by_trash_name(const char trash_name[]);
+static int build_name_index(void);
+static int name_index_cmp(const void *a, const void *b);
 static int pick_trash_dir_traverser(const char base_path[],
 		const char trash_dir[], int user_specific, void *arg);
 static int is_rooted_trash_dir(const char spec[]);
@@ -114,17 +121,28 @@ static int get_resident_type_traverser(const char path[],
 static int is_trash_directory_traverser(const char path[],
 		const char trash_dir[], int user_specific, void *arg);
 static int path_is(PathCheckType check, const char path[], const char other[]);
-static int entry_is(PathCheckType check, trash_entry_t *entry,
-		const char other[]);
-static const char * get_real_trash_name(trash_entry_t *entry);
 static void make_real_path(const char path[], char buf[], size_t buf_len);
 static void traverse_specs(const char base_path[], traverser client, void *arg);
 static char * expand_uid(const char spec[], int *expanded);
 static char * get_rooted_trash_dir(const char base_path[], const char spec[]);
 static char * format_root_spec(const char spec[], const char mount_point[]);
 
-trash_entry_t *trash_list;
-int trash_list_size;
+/* List of items in all trashes.  First sorted_count entries are sorted by
+ * entry_cmp() and have no duplicates, the rest are in order of addition.
+ * Removed entries have NULL trash_name and are dropped when the list is
+ * queried or sorted. */
+static trash_entry_t *trash_list;
+/* Number of items in the trash_list. */
+static int trash_list_size;
+/* Number of allocated items in the trash_list. */
+static int trash_list_capacity;
+/* Number of leading items of the trash_list that are sorted. */
+static int sorted_count;
+/* Number of removed items in the trash_list. */
+static int removed_count;
+/* Indexes of items of the trash_list sorted by their real_trash_name or NULL
+ * if it needs to be built. */
+static int *name_index;
 
 TSTATIC char **specs;
 TSTATIC int nspecs;
@@ -341,25 +359,29 @@ empty_trash_in_bg(bg_op_t *bg_op, void *arg)
 static void
 remove_trash_entries(const char trash_dir[])
 {
-	int i;
-	int j = 0;
+	char trash_dir_real[PATH_MAX*2 + 1];
+	if(trash_dir != NULL)
+	{
+		make_real_path(trash_dir, trash_dir_real, sizeof(trash_dir_real));
+	}
 
+	int i;
 	for(i = 0; i < trash_list_size; ++i)
 	{
-		if(trash_dir == NULL || entry_is(PREFIXED_WITH, &trash_list[i], trash_dir))
+		if(trash_list[i].trash_name != NULL && (trash_dir == NULL ||
+					path_starts_with(trash_list[i].real_trash_name, trash_dir_real)))
 		{
-			free_entry(&trash_list[i]);
-			continue;
+			remove_entry(i);
 		}
-
-		trash_list[j++] = trash_list[i];
 	}
 
-	trash_list_size = j;
+	sort_list();
+	drop_removed_entries();
 	if(trash_list_size == 0)
 	{
 		free(trash_list);
 		trash_list = NULL;
+		trash_list_capacity = 0;
 	}
 }
 
@@ -382,43 +404,52 @@ trash_file_moved(const char src[], const char dst[])
 int
 trash_add_entry(const char original_path[], const char trash_name[])
 {
-	/* XXX: we check duplicates by original_path+trash_name, which allows
-	 *      multiple original path to be mapped to one trash file, might want to
-	 *      forbid this.  */
-	int pos = find_in_trash(original_path, trash_name);
-	if(pos >= 0)
-	{
-		LOG_INFO_MSG("File is already in trash: (`%s`, `%s`)", original_path,
-				trash_name);
-		return 0;
-	}
-	pos = -(pos + 1);
+	/* Entries are only appended here, sorting them and dropping duplicates is
+	 * postponed until the list is queried, which makes adding of many entries in
+	 * a row cheap. */
 
-	void *p = reallocarray(trash_list, trash_list_size + 1, sizeof(*trash_list));
-	if(p == NULL)
+	if(trash_list_size == trash_list_capacity)
 	{
-		return -1;
+		const int new_capacity = (trash_list_capacity == 0)
+		                       ? 64
+		                       : trash_list_capacity*2;
+		void *p = reallocarray(trash_list, new_capacity, sizeof(*trash_list));
+		if(p == NULL)
+		{
+			return -1;
+		}
+		trash_list = p;
+		trash_list_capacity = new_capacity;
 	}
-	trash_list = p;
+
+	char real[PATH_MAX*2 + 1];
+	make_real_path(trash_name, real, sizeof(real));
 
 	trash_entry_t entry = {
 		.path = strdup(original_path),
 		.trash_name = strdup(trash_name),
-		.real_trash_name = NULL,
+		.real_trash_name = strdup(real),
 	};
-	if(entry.path == NULL || entry.trash_name == NULL)
+	if(entry.path == NULL || entry.trash_name == NULL ||
+			entry.real_trash_name == NULL)
 	{
 		free_entry(&entry);
 		return -1;
 	}
 
-	++trash_list_size;
-	memmove(trash_list + pos + 1, trash_list + pos,
-			sizeof(*trash_list)*(trash_list_size - 1 - pos));
-	trash_list[pos] = entry;
+	trash_list[trash_list_size++] = entry;
 	return 0;
 }
 
+const trash_entry_t *
+trash_get_list(int *count)
+{
+	sort_list();
+	drop_removed_entries();
+	*count = trash_list_size;
+	return trash_list;
+}
+
 int
 trash_has_entry(const char original_path[], const char trash_path[])
 {
@@ -431,8 +462,10 @@ trash_has_entry(const char original_path[], const char trash_path[])
 static int
 find_in_trash(const char original_path[], const char trash_path[])
 {
+	sort_list();
+
 	char real_trash_path[PATH_MAX*2 + 1];
-	real_trash_path[0] = '\0';
+	make_real_path(trash_path, real_trash_path, sizeof(real_trash_path));
 
 	int l = 0;
 	int u = trash_list_size - 1;
@@ -443,17 +476,12 @@ find_in_trash(const char original_path[], const char trash_path[])
 		int cmp = stroscmp(trash_list[i].path, original_path);
 		if(cmp == 0)
 		{
-			const char *entry_real = get_real_trash_name(&trash_list[i]);
-			if(real_trash_path[0] == '\0')
-			{
-				make_real_path(trash_path, real_trash_path, sizeof(real_trash_path));
-			}
-			cmp = stroscmp(entry_real, real_trash_path);
+			cmp = stroscmp(trash_list[i].real_trash_name, real_trash_path);
 		}
 
 		if(cmp == 0)
 		{
-			return i;
+			return (trash_list[i].trash_name == NULL) ? (-i - 1) : i;
 		}
 		else if(cmp < 0)
 		{
@@ -553,18 +581,11 @@ is_trash_valid(const char trash_dir[], int allow_empty)
 int
 trash_restore(const char trash_name[])
 {
-	int i;
 	char full[PATH_MAX + 1];
 	char path[PATH_MAX + 1];
 
-	for(i = 0; i < trash_list_size; ++i)
-	{
-		if(entry_is(SAME_AS, &trash_list[i], trash_name))
-		{
-			break;
-		}
-	}
-	if(i >= trash_list_size)
+	const int i = find_by_trash_name(trash_name);
+	if(i < 0)
 	{
 		return -1;
 	}
@@ -604,33 +625,235 @@ trash_restore(const char trash_name[])
 static void
 remove_from_trash(const char trash_name[])
 {
-	int i;
+	const int i = find_by_trash_name(trash_name);
+	if(i >= 0)
+	{
+		remove_entry(i);
+	}
+}
+
+/* Marks entry of the trash_list as removed leaving its keys in place to keep
+ * the list and name_index ordered. */
+static void
+remove_entry(int pos)
+{
+	free(trash_list[pos].trash_name);
+	trash_list[pos].trash_name = NULL;
+	++removed_count;
+}
+
+/* Frees memory allocated by given trash entry. */
+static void
+free_entry(const trash_entry_t *entry)
+{
+	free(entry->path);
+	free(entry->trash_name);
+	free(entry->real_trash_name);
+}
+
+/* Sorts newly added entries of the trash_list into their places dropping
+ * duplicates and removed entries. */
+static void
+sort_list(void)
+{
+	if(sorted_count == trash_list_size)
+	{
+		return;
+	}
+
+	free(name_index);
+	name_index = NULL;
+
+	drop_removed_entries();
+
+	trash_entry_t *const added = trash_list + sorted_count;
+	const int nadded = trash_list_size - sorted_count;
+	qsort(added, nadded, sizeof(*added), &entry_cmp);
+
+	trash_entry_t *merged = NULL;
+	if(sorted_count != 0 && nadded != 0)
+	{
+		merged = reallocarray(NULL, trash_list_capacity, sizeof(*merged));
+	}
+
+	if(merged != NULL)
+	{
+		int i = 0, j = 0, k = 0;
+		while(i < sorted_count || j < nadded)
+		{
+			if(j == nadded ||
+					(i < sorted_count && entry_cmp(&trash_list[i], &added[j]) <= 0))
+			{
+				merged[k++] = trash_list[i++];
+			}
+			else
+			{
+				merged[k++] = added[j++];
+			}
+		}
+		free(trash_list);
+		trash_list = merged;
+	}
+	else if(sorted_count != 0 && nadded != 0)
+	{
+		/* Out of memory, sort everything in place. */
+		qsort(trash_list, trash_list_size, sizeof(*trash_list), &entry_cmp);
+	}
+
+	/* XXX: we check duplicates by original_path+trash_name, which allows
+	 *      multiple original path to be mapped to one trash file, might want to
+	 *      forbid this.  */
+	int i, j = 0;
 	for(i = 0; i < trash_list_size; ++i)
 	{
-		if(entry_is(SAME_AS, &trash_list[i], trash_name))
+		if(j != 0 && entry_cmp(&trash_list[j - 1], &trash_list[i]) == 0)
 		{
-			break;
+			LOG_INFO_MSG("File is already in trash: (`%s`, `%s`)",
+					trash_list[i].path, trash_list[i].trash_name);
+			free_entry(&trash_list[i]);
+			continue;
 		}
+
+		trash_list[j++] = trash_list[i];
 	}
-	if(i >= trash_list_size)
+
+	trash_list_size = j;
+	sorted_count = j;
+}
+
+/* Frees removed entries of the trash_list preserving order of the rest. */
+static void
+drop_removed_entries(void)
+{
+	if(removed_count == 0)
 	{
 		return;
 	}
 
-	free_entry(&trash_list[i]);
-	memmove(trash_list + i, trash_list + i + 1,
-			sizeof(*trash_list)*((trash_list_size - 1) - i));
+	free(name_index);
+	name_index = NULL;
 
-	--trash_list_size;
+	int i, j = 0;
+	int new_sorted_count = 0;
+	for(i = 0; i < trash_list_size; ++i)
+	{
+		if(trash_list[i].trash_name == NULL)
+		{
+			free_entry(&trash_list[i]);
+			continue;
+		}
+
+		if(i < sorted_count)
+		{
+			++new_sorted_count;
+		}
+		trash_list[j++] = trash_list[i];
+	}
+
+	trash_list_size = j;
+	sorted_count = new_sorted_count;
+	removed_count = 0;
 }
 
-/* Frees memory allocated by given trash entry. */
-static void
-free_entry(const trash_entry_t *entry)
+/* Compares two entries by their original paths and then by real paths in
+ * trash.  Returns negative, zero or positive number like strcmp() does. */
+static int
+entry_cmp(const void *a, const void *b)
 {
-	free(entry->path);
-	free(entry->trash_name);
-	free(entry->real_trash_name);
+	const trash_entry_t *const x = a;
+	const trash_entry_t *const y = b;
+
+	const int cmp = stroscmp(x->path, y->path);
+	return (cmp != 0) ? cmp : stroscmp(x->real_trash_name, y->real_trash_name);
+}
+
+/* Finds an entry of the trash_list by path to its file in trash.  Returns index
+ * of the entry or -1 if there is no such entry. */
+static int
+find_by_trash_name(const char trash_name[])
+{
+	sort_list();
+
+	char real[PATH_MAX*2 + 1];
+	make_real_path(trash_name, real, sizeof(real));
+
+	int i;
+	if(name_index == NULL && build_name_index() != 0)
+	{
+		for(i = 0; i < trash_list_size; ++i)
+		{
+			if(trash_list[i].trash_name != NULL &&
+					stroscmp(trash_list[i].real_trash_name, real) == 0)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	/* Look for the first entry with matching name. */
+	int l = 0;
+	int u = trash_list_size;
+	while(l < u)
+	{
+		const int m = l + (u - l)/2;
+		if(stroscmp(trash_list[name_index[m]].real_trash_name, real) < 0)
+		{
+			l = m + 1;
+		}
+		else
+		{
+			u = m;
+		}
+	}
+
+	for(i = l; i < trash_list_size; ++i)
+	{
+		const trash_entry_t *const entry = &trash_list[name_index[i]];
+		if(stroscmp(entry->real_trash_name, real) != 0)
+		{
+			break;
+		}
+		if(entry->trash_name != NULL)
+		{
+			return name_index[i];
+		}
+	}
+	return -1;
+}
+
+/* Builds index of the trash_list by real_trash_name.  Returns zero on success,
+ * otherwise non-zero is returned. */
+static int
+build_name_index(void)
+{
+	name_index = reallocarray(NULL, trash_list_size, sizeof(*name_index));
+	if(name_index == NULL)
+	{
+		return 1;
+	}
+
+	int i;
+	for(i = 0; i < trash_list_size; ++i)
+	{
+		name_index[i] = i;
+	}
+	qsort(name_index, trash_list_size, sizeof(*name_index), &name_index_cmp);
+	return 0;
+}
+
+/* Compares two elements of the name_index by real names of entries they point
+ * to falling back to their positions.  Returns negative, zero or positive
+ * number like strcmp() does. */
+static int
+name_index_cmp(const void *a, const void *b)
+{
+	const int x = *(const int *)a;
+	const int y = *(const int *)b;
+
+	const int cmp = stroscmp(trash_list[x].real_trash_name,
+			trash_list[y].real_trash_name);
+	return (cmp != 0) ? cmp : (x - y);
 }
 
 char *
@@ -794,34 +1017,6 @@ path_is(PathCheckType check, const char path[], const char other[])
 	     : (stroscmp(path_real, other_real) == 0);
 }
 
-/* An optimized for entries version of path_is(). */
-static int
-entry_is(PathCheckType check, trash_entry_t *entry, const char other[])
-{
-	char other_real[PATH_MAX*2 + 1];
-	make_real_path(other, other_real, sizeof(other_real));
-
-	const char *entry_real = get_real_trash_name(entry);
-
-	return (check == PREFIXED_WITH)
-	     ? path_starts_with(entry_real, other_real)
-	     : (stroscmp(entry_real, other_real) == 0);
-}
-
-/* Retrieves path to the entry with all symbolic but last one resolved.
- * Returns the path. */
-static const char *
-get_real_trash_name(trash_entry_t *entry)
-{
-	if(entry->real_trash_name == NULL)
-	{
-		char real[PATH_MAX*2 + 1];
-		make_real_path(entry->trash_name, real, sizeof(real));
-		entry->real_trash_name = strdup(real);
-	}
-	return entry->real_trash_name;
-}
-
 /* Resolves all but last path components in the path.  Permanently caches
  * results of previous invocations. */
 static void
@@ -969,21 +1164,17 @@ trash_get_real_name_of(const char trash_path[])
 void
 trash_prune_dead_entries(void)
 {
-	int i, j;
-
-	j = 0;
+	int i;
 	for(i = 0; i < trash_list_size; ++i)
 	{
-		if(!path_exists(trash_list[i].trash_name, NODEREF))
+		if(trash_list[i].trash_name != NULL &&
+				!path_exists(trash_list[i].trash_name, NODEREF))
 		{
-			free(trash_list[i].path);
-			free(trash_list[i].trash_name);
-			continue;
+			remove_entry(i);
 		}
-
-		trash_list[j++] = trash_list[i];
 	}
-	trash_list_size = j;
+	sort_list();
+	drop_removed_entries();
 }
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
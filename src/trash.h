@@ -36,13 +36,6 @@ typedef struct
 }
 trash_entry_t;
 
-/* List of items in all trashes.  Sorted by a compound key or path and
- * real_trash_name. */
-extern trash_entry_t *trash_list;
-
-/* Number of items in the trash_list. */
-extern int trash_list_size;
-
 /* Parses trash directory specifications.  Sets value of cfg.trash_dir as a
  * side effect.  Returns non-zero in case of error, otherwise zero is
  * returned. */
@@ -63,6 +56,11 @@ void trash_file_moved(const char src[], const char dst[]);
  * considered to be a success. */
 int trash_add_entry(const char original_path[], const char trash_name[]);
 
+/* Retrieves list of items in all trashes sorted by a compound key of path and
+ * real_trash_name.  Puts number of items to *count.  Returns the list which
+ * stays valid until trash registry is changed. */
+const trash_entry_t * trash_get_list(int *count);
+
 /* Checks whether given combination of original and trash paths is registered.
  * Returns non-zero if so, otherwise zero is returned. */
 int trash_has_entry(const char original_path[], const char trash_path[]);
@@ -72,8 +70,8 @@ int trash_has_entry(const char original_path[], const char trash_path[]);
  * NULL and sets *ntrashes to zero. */
 char ** trash_list_trashes(int *ntrashes);
 
-/* Restores a file specified by its trash_name (from trash_list array).  Returns
- * zero on success, otherwise non-zero is returned. */
+/* Restores a file specified by its trash_name (from trash_get_list() array).
+ * Returns zero on success, otherwise non-zero is returned. */
 int trash_restore(const char trash_name[]);
 
 /* Generates unique name for a file at base_path location named name (doesn't
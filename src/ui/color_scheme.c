@@ -532,6 +532,7 @@ static void restore_primary_cs(const col_scheme_t *cs);
 static void reset_to_default_cs(col_scheme_t *cs);
 static void free_cs_highlights(col_scheme_t *cs);
 static file_hi_t * clone_file_highlights(const col_scheme_t *from);
+static void index_file_highlights(col_scheme_t *cs);
 static col_attr_t * clone_column_highlights(const col_scheme_t *from);
 static void reset_cs_colors(col_scheme_t *cs);
 static int source_cs(const char name[]);
@@ -938,6 +939,8 @@ cs_assign(col_scheme_t *to, const col_scheme_t *from)
 	*to = *from;
 	to->file_hi = clone_file_highlights(from);
 	to->column_hi = clone_column_highlights(from);
+	to->file_hi_index = NULL;
+	index_file_highlights(to);
 }
 
 /* Resets color scheme to default builtin values. */
@@ -967,6 +970,9 @@ free_cs_highlights(col_scheme_t *cs)
 	cs->file_hi = NULL;
 	cs->file_hi_count = 0;
 
+	matchers_index_free(cs->file_hi_index);
+	cs->file_hi_index = NULL;
+
 	free(cs->column_hi);
 	cs->column_hi = NULL;
 	cs->column_hi_count = 0;
@@ -991,6 +997,25 @@ clone_file_highlights(const col_scheme_t *from)
 	return file_hi;
 }
 
+/* (Re)builds index over file highlights of the color scheme.  Leaves the index
+ * empty on error, in which case highlights are checked one by one. */
+static void
+index_file_highlights(col_scheme_t *cs)
+{
+	matchers_index_free(cs->file_hi_index);
+	cs->file_hi_index = matchers_index_alloc();
+
+	int i;
+	for(i = 0; i < cs->file_hi_count && cs->file_hi_index != NULL; ++i)
+	{
+		if(matchers_index_add(cs->file_hi_index, cs->file_hi[i].matchers) != 0)
+		{
+			matchers_index_free(cs->file_hi_index);
+			cs->file_hi_index = NULL;
+		}
+	}
+}
+
 /* Clones column highlight array of the *from color scheme and returns it. */
 static col_attr_t *
 clone_column_highlights(const col_scheme_t *from)
@@ -1349,6 +1374,12 @@ cs_add_file_hi(struct matchers_t *matchers, const col_attr_t *hi)
 	file_hi->hi = *hi;
 
 	++cs->file_hi_count;
+
+	if(cs->file_hi_index == NULL ||
+			matchers_index_add(cs->file_hi_index, matchers) != 0)
+	{
+		index_file_highlights(cs);
+	}
 }
 
 const col_attr_t *
@@ -1366,13 +1397,25 @@ cs_get_file_hi(const col_scheme_t *cs, const char fname[], int *hi_hint)
 	}
 
 	int i;
-	for(i = 0; i < cs->file_hi_count; ++i)
+	if(cs->file_hi_index != NULL)
 	{
-		const file_hi_t *const file_hi = &cs->file_hi[i];
-		if(matchers_match(file_hi->matchers, fname))
+		i = matchers_index_find(cs->file_hi_index, fname, 0);
+		if(i >= 0)
 		{
 			*hi_hint = i;
-			return &file_hi->hi;
+			return &cs->file_hi[i].hi;
+		}
+	}
+	else
+	{
+		for(i = 0; i < cs->file_hi_count; ++i)
+		{
+			const file_hi_t *const file_hi = &cs->file_hi[i];
+			if(matchers_match(file_hi->matchers, fname))
+			{
+				*hi_hint = i;
+				return &file_hi->hi;
+			}
 		}
 	}
 
@@ -1380,6 +1423,20 @@ cs_get_file_hi(const col_scheme_t *cs, const char fname[], int *hi_hint)
 	return NULL;
 }
 
+int
+cs_file_hi_uses_mime(const col_scheme_t *cs)
+{
+	int i;
+	for(i = 0; i < cs->file_hi_count; ++i)
+	{
+		if(matchers_use_mime(cs->file_hi[i].matchers))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
 int
 cs_del_file_hi(const char matchers_expr[])
 {
@@ -1394,6 +1451,7 @@ cs_del_file_hi(const char matchers_expr[])
 			memmove(&cs->file_hi[i], &cs->file_hi[i + 1],
 					sizeof(*cs->file_hi)*((cs->file_hi_count - 1) - i));
 			--cs->file_hi_count;
+			index_file_highlights(cs);
 			return 1;
 		}
 	}
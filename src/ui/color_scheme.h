@@ -41,6 +41,7 @@ typedef enum
 }
 ColorSchemeState;
 
+struct matchers_index_t;
 struct matchers_t;
 
 /* Single file highlight description. */
@@ -61,6 +62,7 @@ typedef struct
 
 	file_hi_t *file_hi; /* List of file highlight preferences. */
 	int file_hi_count;  /* Number of file highlight definitions. */
+	struct matchers_index_t *file_hi_index; /* Index over file_hi or NULL. */
 
 	col_attr_t *column_hi; /* List of column highlight preferences.
 	                          Unused entries are filled with 0xff. */
@@ -156,6 +158,10 @@ void cs_add_file_hi(struct matchers_t *matchers, const col_attr_t *hi);
 const col_attr_t * cs_get_file_hi(const col_scheme_t *cs, const char fname[],
 		int *hi_hint);
 
+/* Checks whether any of filename-specific highlights depends on mime types of
+ * files.  Returns non-zero if so, otherwise zero is returned. */
+int cs_file_hi_uses_mime(const col_scheme_t *cs);
+
 /* Removes filename-specific highlight by its pattern.  Returns non-zero on
  * successful removal and zero if pattern wasn't found. */
 int cs_del_file_hi(const char matchers_expr[]);
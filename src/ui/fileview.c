@@ -34,13 +34,16 @@
 #include <string.h> /* memset() strcpy() strlen() */
 
 #include "../cfg/config.h"
+#include "../compat/fs_limits.h"
 #include "../compat/pthread.h"
+#include "../int/file_magic.h"
 #include "../lua/vlua.h"
 #include "../utils/fs.h"
 #include "../utils/macros.h"
 #include "../utils/path.h"
 #include "../utils/regexp.h"
 #include "../utils/str.h"
+#include "../utils/string_array.h"
 #include "../utils/test_helpers.h"
 #include "../utils/utf8.h"
 #include "../utils/utils.h"
@@ -94,6 +97,7 @@
  * separately.
  */
 
+static void prefetch_mimetypes_of(view_t *view, int first, int count);
 static void draw_left_column(view_t *view);
 static void draw_right_column(view_t *view);
 static void draw_miller_separator(view_t *view, int column);
@@ -116,6 +120,10 @@ static void consider_scroll_bind(view_t *view);
 static cchar_t prepare_inactive_color(view_t *view, dir_entry_t *entry,
 		int line_color);
 static void redraw_cell(view_t *view, int top, int cursor, int is_current);
+static int scroll_dir_list(view_t *view, int old_top, int old_curr);
+TSTATIC int can_scroll_dir_list(view_t *view, int old_top);
+TSTATIC void get_revealed_cells(const view_t *view, int old_top, int *first,
+		int *count);
 static void compute_and_draw_cell(column_data_t *cdt, int cell,
 		size_t col_count, size_t col_width);
 static void column_line_print(const char buf[], int offset, AlignType align,
@@ -341,6 +349,8 @@ draw_dir_list_only(view_t *view)
 		visible_cells += view->window_rows;
 	}
 
+	prefetch_mimetypes_of(view, view->top_line, visible_cells);
+
 	for(x = view->top_line, cell = 0;
 			x < view->list_rows && cell < visible_cells;
 			++x, ++cell)
@@ -368,6 +378,37 @@ draw_dir_list_only(view_t *view)
 	ui_view_win_changed(view);
 
 	ui_view_redrawn(view);
+	view->drawn_top = view->top_line;
+}
+
+/* Determines mime types of count files starting at first which don't have
+ * highlighting computed in a single batch if highlighting depends on them, so
+ * that they aren't determined one by one while drawing. */
+static void
+prefetch_mimetypes_of(view_t *view, int first, int count)
+{
+	if(!cs_file_hi_uses_mime(ui_view_get_cs(view)))
+	{
+		return;
+	}
+
+	char **paths = NULL;
+	int npaths = 0;
+
+	int x;
+	for(x = first; x < view->list_rows && x < first + count; ++x)
+	{
+		const dir_entry_t *const entry = &view->dir_entry[x];
+		if(entry->hi_num == -1)
+		{
+			char full_path[PATH_MAX + 1];
+			get_full_path_of(entry, sizeof(full_path), full_path);
+			npaths = add_to_string_array(&paths, npaths, full_path);
+		}
+	}
+
+	prefetch_mimetypes(paths, npaths);
+	free_string_array(paths, npaths);
 }
 
 /* Draws a column to the left of the main part of the view. */
@@ -1034,6 +1075,107 @@ redraw_cell(view_t *view, int top, int cursor, int is_current)
 	compute_and_draw_cell(&cdt, cursor, col_count, col_width);
 }
 
+/* Updates the window after scrolling by shifting its contents and drawing only
+ * cells that became visible and the cursor.  This way cells that remain on the
+ * screen aren't formatted and printed again and curses can use scrolling of
+ * the terminal.  Returns non-zero on success and zero if the view needs to be
+ * redrawn in full. */
+static int
+scroll_dir_list(view_t *view, int old_top, int old_curr)
+{
+	if(!can_scroll_dir_list(view, old_top))
+	{
+		return 0;
+	}
+
+	size_t col_width, col_count;
+	calculate_table_conf(view, &col_count, &col_width);
+	if(!columns_matches_width(get_view_columns(view, 0), col_width))
+	{
+		return 0;
+	}
+
+	int first, count;
+	get_revealed_cells(view, old_top, &first, &count);
+	prefetch_mimetypes_of(view, view->top_line + first, count);
+
+	/* The old cursor is going to be moved along with the rest of the cells. */
+	redraw_cell(view, old_top, old_curr, 0);
+
+	const int delta = view->top_line - old_top;
+	scrollok(view->win, TRUE);
+	wscrl(view->win, delta/view->run_size);
+	scrollok(view->win, FALSE);
+
+	int cell;
+	for(cell = first; cell < first + count; ++cell)
+	{
+		column_data_t cdt = {
+			.view = view,
+			.entry = &view->dir_entry[view->top_line + cell],
+			.line_pos = view->top_line + cell,
+			.current_pos = view->list_pos,
+		};
+
+		compute_and_draw_cell(&cdt, cell, col_count, col_width);
+	}
+
+	redraw_cell(view, view->top_line, view->curr_line, 1);
+
+	if(view == curr_view)
+	{
+		consider_scroll_bind(view);
+	}
+
+	ui_view_win_changed(view);
+	view->drawn_top = view->top_line;
+	return 1;
+}
+
+/* Checks whether the window can be updated after scrolling from old_top by
+ * shifting its contents.  Returns non-zero if so, otherwise zero is
+ * returned. */
+TSTATIC int
+can_scroll_dir_list(view_t *view, int old_top)
+{
+	/* Side columns of miller view are part of the window and line numbers change
+	 * on every movement when they are relative. */
+	if(view->drawn_top != old_top || view->top_line == old_top ||
+			view->miller_view || fview_is_transposed(view) ||
+			(view->num_type & NT_REL) || stats_redraw_planned() ||
+			ui_view_update_scheduled(view))
+	{
+		return 0;
+	}
+
+	const int delta = view->top_line - old_top;
+	if(delta % view->run_size != 0 || abs(delta) >= view->window_cells)
+	{
+		return 0;
+	}
+
+	/* Highlighting of odd lines depends on their position on the screen, so
+	 * lines that are moved by an odd number of rows must be redrawn. */
+	const col_scheme_t *const cs = ui_view_get_cs(view);
+	return (delta/view->run_size)%2 == 0
+	    || !cs_is_color_set(&cs->color[ODD_LINE_COLOR]);
+}
+
+/* Computes range of cells which became visible after scrolling from old_top.
+ * *first is set to the first cell and *count to number of cells that have
+ * files. */
+TSTATIC void
+get_revealed_cells(const view_t *view, int old_top, int *first, int *count)
+{
+	const int delta = view->top_line - old_top;
+	const int begin = (delta > 0 ? view->window_cells - delta : 0);
+	const int end = MIN(delta > 0 ? view->window_cells : -delta,
+			view->list_rows - view->top_line);
+
+	*first = begin;
+	*count = MAX(end - begin, 0);
+}
+
 /* Fills in fields of cdt based on passed in arguments and
  * view/entry/line_pos/current_pos fields of cdt.  Then draws the cell. */
 static void
@@ -1547,10 +1689,14 @@ format_name(void *data, size_t buf_len, char buf[], const format_info_t *info)
 			buf + prefix_len);
 	*cdt->prefix_len = prefix_len;
 
-escape: ; /* Labels can't point to declarations. */
-	char *escaped = escape_unreadable(buf);
-	copy_str(buf, buf_len + 1U, escaped);
-	free(escaped);
+escape:
+	/* Most names don't need escaping, avoid allocating memory for them. */
+	if(has_unreadable(buf))
+	{
+		char *escaped = escape_unreadable(buf);
+		copy_str(buf, buf_len + 1U, escaped);
+		free(escaped);
+	}
 }
 
 /* Primary name group format (first value of 'sortgroups' option) callback for
@@ -1915,6 +2061,7 @@ fview_update_geometry(view_t *view)
 	view->run_size = fview_is_transposed(view) ? view->window_rows
 	                                           : view->column_count;
 	view->window_cells = view->column_count*view->window_rows;
+	view->drawn_top = -1;
 }
 
 void
@@ -1922,6 +2069,7 @@ fview_dir_updated(view_t *view)
 {
 	view->local_cs = cs_load_local(view == &lwin, view->curr_dir);
 	fview_clear_miller_preview(view);
+	view->drawn_top = -1;
 }
 
 /* Computes area description for miller preview.  Returns the area. */
@@ -1957,6 +2105,13 @@ fview_list_updated(view_t *view)
 	view->max_filename_width = 0;
 	/* Even if position will remain the same, we might need to redraw it. */
 	invalidate_cursor_pos_cache(view);
+	view->drawn_top = -1;
+
+	if(curr_stats.vlua != NULL)
+	{
+		/* Values of Lua columns don't necessarily depend only on entries. */
+		vlua_viewcolumns_drop_cache(curr_stats.vlua);
+	}
 }
 
 void
@@ -1964,6 +2119,7 @@ fview_decors_updated(view_t *view)
 {
 	/* Invalidate maximum file name widths cache. */
 	view->max_filename_width = 0;
+	view->drawn_top = -1;
 }
 
 /* Evaluates number of columns in the view.  Returns the number. */
@@ -2073,7 +2229,10 @@ fview_position_updated(view_t *view)
 
 	if(redraw)
 	{
-		draw_dir_list(view);
+		if(!scroll_dir_list(view, old_top, old_curr))
+		{
+			draw_dir_list(view);
+		}
 	}
 	else
 	{
@@ -2229,6 +2388,7 @@ void
 fview_sorting_updated(view_t *view)
 {
 	reset_view_columns(view);
+	view->drawn_top = -1;
 }
 
 /* Reinitializes view columns. */
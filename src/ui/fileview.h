@@ -174,6 +174,9 @@ TSTATIC_DEFS(
 	struct format_info_t;
 	void format_name(void *data, size_t buf_len, char buf[],
 		const struct format_info_t *info);
+	int can_scroll_dir_list(struct view_t *view, int old_top);
+	void get_revealed_cells(const struct view_t *view, int old_top, int *first,
+		int *count);
 )
 
 #endif /* VIFM__UI__FILEVIEW_H__ */
@@ -2848,6 +2848,7 @@ ui_view_erase(view_t *view, int use_global_cs)
 	col_attr_t col = ui_get_win_color(view, cs);
 	ui_set_bg(view->win, &col, -1);
 	werase(view->win);
+	view->drawn_top = -1;
 }
 
 col_attr_t
@@ -3042,5 +3043,14 @@ ui_view_query_scheduled_event(view_t *view)
 	return event;
 }
 
+int
+ui_view_update_scheduled(view_t *view)
+{
+	pthread_mutex_lock(view->timestamps_mutex);
+	const int scheduled = (view->need_redraw || view->need_reload);
+	pthread_mutex_unlock(view->timestamps_mutex);
+	return scheduled;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
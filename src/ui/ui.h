@@ -355,6 +355,16 @@ struct local_filter_t
 	int *poshist;
 	/* Number of elements in the poshist field. */
 	size_t poshist_len;
+
+	/* Positions of entries in the unfiltered list which passed the filter last
+	 * time it was applied.  Extending the filter narrows this list. */
+	int *matches;
+	/* Number of elements in the matches field. */
+	size_t matches_len;
+	/* Value of the filter that produced matches or NULL if they are unknown. */
+	char *matches_of;
+	/* Whether the filter that produced matches was case sensitive. */
+	int matches_case_sensitive;
 };
 
 /* Cached file list coupled with a watcher. */
@@ -424,6 +434,9 @@ struct view_t
 	char *last_curr_file; /* To account for file replacement. */
 	int last_seen_pos;    /* To account for movement. */
 	int last_curr_line;   /* To account for scrolling. */
+	/* Top line of the list displayed in the window or -1 if the window might not
+	 * match the list.  Allows updating the window partially. */
+	int drawn_top;
 
 	int nsaved_selection;   /* Number of items in saved_selection. */
 	char **saved_selection; /* Names of selected files. */
@@ -859,6 +872,10 @@ void ui_view_redrawn(view_t *view);
  * scheduled event. */
 UiUpdateEvent ui_view_query_scheduled_event(view_t *view);
 
+/* Checks for scheduled update without marking it as fulfilled.  Returns
+ * non-zero if there is one, otherwise zero is returned. */
+int ui_view_update_scheduled(view_t *view);
+
 TSTATIC_DEFS(
 	/* Information for formatting tab title. */
 	typedef struct
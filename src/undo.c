@@ -21,8 +21,8 @@
 #include <assert.h> /* assert() */
 #include <stddef.h> /* size_t */
 #include <stdio.h>
-#include <stdlib.h> /* free() malloc() */
-#include <string.h> /* strcpy() strdup() */
+#include <stdlib.h> /* calloc() free() malloc() */
+#include <string.h> /* memcpy() strcpy() strdup() strlen() */
 
 #include "compat/fs_limits.h"
 #include "compat/reallocarray.h"
@@ -30,6 +30,7 @@
 #include "utils/macros.h"
 #include "utils/path.h"
 #include "utils/str.h"
+#include "utils/trie.h"
 #include "utils/utils.h"
 #include "ops.h"
 #include "registers.h"
@@ -39,6 +40,17 @@
  *      within group of changes, hence fake OP_MOVETMP* operations.  Hard to
  *      tell if this can be done without such workarounds, but worth a try. */
 
+/* Block of memory from which commands of a group and their strings are
+ * allocated. */
+typedef struct block_t
+{
+	struct block_t *next; /* Previously allocated block. */
+	size_t size;          /* Size of the data. */
+	size_t used;          /* Number of used bytes of the data. */
+	char data[];          /* The memory. */
+}
+block_t;
+
 typedef struct
 {
 	char *msg;
@@ -46,26 +58,48 @@ typedef struct
 	int balance;
 	int can_undone;
 	int incomplete;
+
+	/* All memory of commands of the group lives in these blocks and is freed
+	 * only with the group, so removing single commands doesn't free anything. */
+	block_t *blocks;      /* Most recently allocated block or NULL. */
+	trie_t *dirs;         /* Interned directory prefixes of paths. */
+	const char *last_dir; /* Directory prefix that was interned last. */
 }
 group_t;
 
+/* Path split into interned directory prefix and name.  Concatenation of the
+ * two gives the original string. */
+typedef struct
+{
+	const char *dir;  /* Directory part including trailing slash or "". */
+	const char *name; /* The rest of the path. */
+}
+path_t;
+
+/* Expanded form of an operation of a command. */
 typedef struct
 {
 	OPS op;
-	const char *src;        /* NULL, buf1 or buf2 */
-	const char *dst;        /* NULL, buf1 or buf2 */
+	const char *src;        /* NULL, path1 or path2 */
+	const char *dst;        /* NULL, path1 or path2 */
 	void *data;             /* for uid_t, gid_t and mode_t */
-	const char *exists;     /* NULL, buf1 or buf2 */
-	const char *dont_exist; /* NULL, buf1 or buf2 */
+	const char *exists;     /* NULL, path1 or path2 */
+	const char *dont_exist; /* NULL, path1 or path2 */
+
+	char path1[PATH_MAX + 1]; /* First path of the command. */
+	char path2[PATH_MAX + 1]; /* Second path of the command. */
 }
 op_t;
 
+/* Compact record of a command.  Paths of its operations are determined by
+ * opers table. */
 typedef struct cmd_t
 {
-	char *buf1;
-	char *buf2;
-	op_t do_op;
-	op_t undo_op;
+	OPS op;          /* Operation to redo, undo operation is undo_op[op]. */
+	void *do_data;   /* Data of redo operation. */
+	void *undo_data; /* Data of undo operation. */
+	path_t path1;    /* First path. */
+	path_t path2;    /* Second path. */
 
 	group_t *group;
 	struct cmd_t *prev;
@@ -228,16 +262,20 @@ static char *group_msg;
 static int command_count;
 
 static int no_function(void);
-static void init_cmd(cmd_t *cmd, OPS op, void *do_data, void *undo_data);
-static void init_entry(cmd_t *cmd, const char **e, int type);
+static group_t * alloc_group(void);
+static void free_group(group_t *group);
+static void * group_alloc(group_t *group, size_t size);
+static int set_path(group_t *group, path_t *path, const char value[]);
+static const char * intern_dir(group_t *group, const char dir[]);
+static void get_op(const cmd_t *cmd, int undo, op_t *op);
+static const char * get_entry(const op_t *op, int type);
 static void remove_cmd(cmd_t *cmd);
 static int is_undo_group_possible(void);
 static int is_redo_group_possible(void);
 static int is_op_possible(const op_t *op);
-static void change_filename_in_trash(cmd_t *cmd, const char filename[]);
-static void update_entry(const char **e, const char old[], const char new[]);
+static int change_filename_in_trash(cmd_t *cmd, const char filename[]);
 static char ** fill_undolist_detail(char **list);
-static const char * get_op_desc(op_t op);
+static const char * get_op_desc(const op_t *op);
 static char ** fill_undolist_nondetail(char **list);
 
 void
@@ -339,35 +377,46 @@ un_group_add_op(OPS op, void *do_data, void *undo_data, const char buf1[],
 		return 0;
 	}
 
-	command_count++;
-
-	/* add operation to the list */
-	cmd = calloc(1, sizeof(*cmd));
-	if(cmd == NULL)
-		return -1;
-
-	cmd->buf1 = strdup(buf1);
-	cmd->buf2 = strdup(buf2);
-	cmd->prev = current;
-	init_cmd(cmd, op, do_data, undo_data);
-	if(last_group != NULL)
-	{
-		cmd->group = last_group;
-	}
-	else if((cmd->group = malloc(sizeof(group_t))) != NULL)
+	group_t *group = last_group;
+	if(group == NULL)
 	{
-		cmd->group->msg = strdup(group_msg);
-		cmd->group->error = 0;
-		cmd->group->balance = 0;
-		cmd->group->can_undone = 1;
-		cmd->group->incomplete = 0;
+		group = alloc_group();
+		if(group == NULL)
+		{
+			return -1;
+		}
 	}
-	mem_error = cmd->group == NULL || cmd->buf1 == NULL || cmd->buf2 == NULL;
+
+	/* add operation to the list */
+	cmd = group_alloc(group, sizeof(*cmd));
+	mem_error = cmd == NULL
+	         || set_path(group, &cmd->path1, buf1) != 0
+	         || set_path(group, &cmd->path2, buf2) != 0;
 	if(mem_error)
 	{
-		remove_cmd(cmd);
+		if(group != last_group)
+		{
+			free_group(group);
+		}
+		if(data_is_ptr[op])
+		{
+			free(do_data);
+		}
+		if(data_is_ptr[undo_op[op]])
+		{
+			free(undo_data);
+		}
 		return -1;
 	}
+
+	command_count++;
+
+	cmd->op = op;
+	cmd->do_data = do_data;
+	cmd->undo_data = undo_data;
+	cmd->group = group;
+	cmd->prev = current;
+	cmd->next = NULL;
 	last_group = cmd->group;
 
 	if(undo_op[op] == OP_NONE)
@@ -380,32 +429,197 @@ un_group_add_op(OPS op, void *do_data, void *undo_data, const char buf1[],
 	return 0;
 }
 
+/* Allocates new group and initializes it from group_msg.  Returns the group or
+ * NULL on error. */
+static group_t *
+alloc_group(void)
+{
+	group_t *const group = calloc(1, sizeof(*group));
+	if(group == NULL)
+	{
+		return NULL;
+	}
+
+	group->can_undone = 1;
+	group->msg = strdup(group_msg);
+	group->dirs = trie_create(NULL);
+	if(group->msg == NULL || group->dirs == NULL)
+	{
+		free_group(group);
+		return NULL;
+	}
+
+	return group;
+}
+
+/* Frees group along with all commands that belong to it. */
 static void
-init_cmd(cmd_t *cmd, OPS op, void *do_data, void *undo_data)
-{
-	cmd->do_op.op = op;
-	cmd->do_op.data = do_data;
-	cmd->undo_op.op = undo_op[op];
-	cmd->undo_op.data = undo_data;
-	init_entry(cmd, &cmd->do_op.src, opers[op][0]);
-	init_entry(cmd, &cmd->do_op.dst, opers[op][1]);
-	init_entry(cmd, &cmd->do_op.exists, opers[op][2]);
-	init_entry(cmd, &cmd->do_op.dont_exist, opers[op][3]);
-	init_entry(cmd, &cmd->undo_op.src, opers[op][4]);
-	init_entry(cmd, &cmd->undo_op.dst, opers[op][5]);
-	init_entry(cmd, &cmd->undo_op.exists, opers[op][6]);
-	init_entry(cmd, &cmd->undo_op.dont_exist, opers[op][7]);
+free_group(group_t *group)
+{
+	while(group->blocks != NULL)
+	{
+		block_t *const next = group->blocks->next;
+		free(group->blocks);
+		group->blocks = next;
+	}
+
+	trie_free(group->dirs);
+	free(group->msg);
+	free(group);
+}
+
+/* Allocates memory for a command or a string from memory of the group.  The
+ * memory is freed along with the group.  Returns pointer to the memory or NULL
+ * on error. */
+static void *
+group_alloc(group_t *group, size_t size)
+{
+	/* Blocks grow exponentially up to a limit to keep number of allocations
+	 * low for big operations without wasting memory on small ones. */
+	enum { MIN_BLOCK = 1024, MAX_BLOCK = 1024*1024 };
+
+	/* Keep everything aligned for pointers. */
+	size = (size + sizeof(void *) - 1U) & ~(sizeof(void *) - 1U);
+
+	block_t *block = group->blocks;
+	if(block == NULL || block->size - block->used < size)
+	{
+		size_t block_size = (block == NULL ? MIN_BLOCK : block->size*2U);
+		if(block_size > MAX_BLOCK)
+		{
+			block_size = MAX_BLOCK;
+		}
+		if(block_size < size)
+		{
+			block_size = size;
+		}
+
+		block = malloc(sizeof(*block) + block_size);
+		if(block == NULL)
+		{
+			return NULL;
+		}
+
+		block->next = group->blocks;
+		block->size = block_size;
+		block->used = 0U;
+		group->blocks = block;
+	}
+
+	void *const ptr = &block->data[block->used];
+	block->used += size;
+	return ptr;
+}
+
+/* Stores path in memory of the group sharing its directory part with other
+ * paths of the group.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+set_path(group_t *group, path_t *path, const char value[])
+{
+	const size_t len = strlen(value);
+	if(len > PATH_MAX)
+	{
+		return 1;
+	}
+
+	const char *const name = after_last(value, '/');
+	const size_t dir_len = name - value;
+	const size_t name_len = len - dir_len;
+
+	char dir[PATH_MAX + 1];
+	copy_str(dir, dir_len + 1U, value);
+
+	path->dir = intern_dir(group, dir);
+	if(path->dir == NULL)
+	{
+		return 1;
+	}
+
+	if(name_len == 0U)
+	{
+		path->name = "";
+		return 0;
+	}
+
+	char *const name_copy = group_alloc(group, name_len + 1U);
+	if(name_copy == NULL)
+	{
+		return 1;
+	}
+	memcpy(name_copy, name, name_len + 1U);
+	path->name = name_copy;
+	return 0;
 }
 
+/* Finds copy of the directory path in memory of the group creating it if it's
+ * not there.  Returns the copy or NULL on error. */
+static const char *
+intern_dir(group_t *group, const char dir[])
+{
+	if(dir[0] == '\0')
+	{
+		return "";
+	}
+
+	/* Consecutive commands usually deal with files of the same directory. */
+	if(group->last_dir != NULL && strcmp(group->last_dir, dir) == 0)
+	{
+		return group->last_dir;
+	}
+
+	void *data;
+	if(trie_get(group->dirs, dir, &data) != 0)
+	{
+		const size_t size = strlen(dir) + 1U;
+		data = group_alloc(group, size);
+		if(data == NULL)
+		{
+			return NULL;
+		}
+		memcpy(data, dir, size);
+
+		if(trie_set(group->dirs, dir, data) < 0)
+		{
+			return NULL;
+		}
+	}
+
+	group->last_dir = data;
+	return data;
+}
+
+/* Expands redo (if undo is zero) or undo operation of the command into *op. */
 static void
-init_entry(cmd_t *cmd, const char **e, int type)
+get_op(const cmd_t *cmd, int undo, op_t *op)
+{
+	const int base = (undo ? 4 : 0);
+
+	op->op = (undo ? undo_op[cmd->op] : cmd->op);
+	op->data = (undo ? cmd->undo_data : cmd->do_data);
+
+	snprintf(op->path1, sizeof(op->path1), "%s%s", cmd->path1.dir,
+			cmd->path1.name);
+	snprintf(op->path2, sizeof(op->path2), "%s%s", cmd->path2.dir,
+			cmd->path2.name);
+
+	op->src = get_entry(op, opers[cmd->op][base + 0]);
+	op->dst = get_entry(op, opers[cmd->op][base + 1]);
+	op->exists = get_entry(op, opers[cmd->op][base + 2]);
+	op->dont_exist = get_entry(op, opers[cmd->op][base + 3]);
+}
+
+/* Maps operand type to one of the paths of the operation.  Returns the path or
+ * NULL. */
+static const char *
+get_entry(const op_t *op, int type)
 {
 	if(type == OPER_NON)
-		*e = NULL;
+		return NULL;
 	else if(type == OPER_1ST)
-		*e = cmd->buf1;
+		return op->path1;
 	else
-		*e = cmd->buf2;
+		return op->path2;
 }
 
 static void
@@ -433,25 +647,22 @@ remove_cmd(cmd_t *cmd)
 		cmds.prev = cmd->prev;
 	}
 
+	if(data_is_ptr[cmd->op])
+		free(cmd->do_data);
+	if(data_is_ptr[undo_op[cmd->op]])
+		free(cmd->undo_data);
+
+	/* Memory of the command is owned by its group. */
 	if(last_cmd_in_group)
 	{
-		free(cmd->group->msg);
-		free(cmd->group);
 		if(last_group == cmd->group)
 			last_group = NULL;
+		free_group(cmd->group);
 	}
 	else
 	{
 		cmd->group->incomplete = 1;
 	}
-	free(cmd->buf1);
-	free(cmd->buf2);
-	if(data_is_ptr[cmd->do_op.op])
-		free(cmd->do_op.data);
-	if(data_is_ptr[cmd->undo_op.op])
-		free(cmd->undo_op.data);
-
-	free(cmd);
 
 	command_count--;
 }
@@ -506,8 +717,9 @@ un_group_undo(void)
 	{
 		if(!skip)
 		{
-			OpsResult result = do_func(current->undo_op.op, current->undo_op.data,
-					current->undo_op.src, current->undo_op.dst);
+			op_t op;
+			get_op(current, 1, &op);
+			OpsResult result = do_func(op.op, op.data, op.src, op.dst);
 			switch(result)
 			{
 				case OPS_SUCCEEDED:
@@ -542,12 +754,15 @@ is_undo_group_possible(void)
 	cmd_t *cmd = current;
 	do
 	{
+		op_t op;
+		get_op(cmd, 1, &op);
+
 		int ret;
-		ret = is_op_possible(&cmd->undo_op);
+		ret = is_op_possible(&op);
 		if(ret == 0)
 			return 0;
-		else if(ret < 0)
-			change_filename_in_trash(cmd, cmd->undo_op.dst);
+		else if(ret < 0 && change_filename_in_trash(cmd, op.dst) != 0)
+			return 0;
 		cmd = cmd->prev;
 	}
 	while(cmd != &cmds && cmd->group == cmd->next->group);
@@ -585,8 +800,9 @@ un_group_redo(void)
 		current = current->next;
 		if(!skip)
 		{
-			OpsResult result = do_func(current->do_op.op, current->do_op.data,
-					current->do_op.src, current->do_op.dst);
+			op_t op;
+			get_op(current, 0, &op);
+			OpsResult result = do_func(op.op, op.data, op.src, op.dst);
 			switch(result)
 			{
 				case OPS_SUCCEEDED:
@@ -620,13 +836,17 @@ is_redo_group_possible(void)
 	cmd_t *cmd = current;
 	do
 	{
-		int ret;
 		cmd = cmd->next;
-		ret = is_op_possible(&cmd->do_op);
+
+		op_t op;
+		get_op(cmd, 0, &op);
+
+		int ret;
+		ret = is_op_possible(&op);
 		if(ret == 0)
 			return 0;
-		else if(ret < 0)
-			change_filename_in_trash(cmd, cmd->do_op.dst);
+		else if(ret < 0 && change_filename_in_trash(cmd, op.dst) != 0)
+			return 0;
 	}
 	while(cmd->next != NULL && cmd->group == cmd->next->group);
 	return 1;
@@ -662,12 +882,15 @@ is_op_possible(const op_t *op)
 	return 1;
 }
 
-static void
+/* Picks new name in trash for the file and makes it the second path of the
+ * command.  Previous value of the path stays in memory of the group.  Returns
+ * zero on success, otherwise non-zero is returned and the command is left
+ * unchanged. */
+static int
 change_filename_in_trash(cmd_t *cmd, const char filename[])
 {
 	const char *name_tail;
 	char *new;
-	char *old;
 	char *const base_dir = strdup(filename);
 
 	remove_last_path_component(base_dir);
@@ -678,31 +901,18 @@ change_filename_in_trash(cmd_t *cmd, const char filename[])
 
 	free(base_dir);
 
-	old = cmd->buf2;
-	cmd->buf2 = new;
+	path_t path2;
+	if(set_path(cmd->group, &path2, new) != 0)
+	{
+		free(new);
+		return 1;
+	}
+	cmd->path2 = path2;
 
 	regs_rename_contents(filename, new);
 
-	update_entry(&cmd->do_op.src, old, cmd->buf2);
-	update_entry(&cmd->do_op.dst, old, cmd->buf2);
-	update_entry(&cmd->do_op.exists, old, cmd->buf2);
-	update_entry(&cmd->do_op.dont_exist, old, cmd->buf2);
-	update_entry(&cmd->undo_op.src, old, cmd->buf2);
-	update_entry(&cmd->undo_op.dst, old, cmd->buf2);
-	update_entry(&cmd->undo_op.exists, old, cmd->buf2);
-	update_entry(&cmd->undo_op.dont_exist, old, cmd->buf2);
-
-	free(old);
-}
-
-/* Checks whether *e equals old and updates it to new if so. */
-static void
-update_entry(const char **e, const char old[], const char new[])
-{
-	if(*e == old)
-	{
-		*e = new;
-	}
+	free(new);
+	return 0;
 }
 
 char **
@@ -758,15 +968,18 @@ fill_undolist_detail(char **list)
 		do
 		{
 			const char *p;
+			op_t op;
 
-			p = get_op_desc(cmd->do_op);
+			get_op(cmd, 0, &op);
+			p = get_op_desc(&op);
 			if((*list = format_str("  do: %s", p)) == NULL)
 			{
 				return list;
 			}
 			++list;
 
-			p = get_op_desc(cmd->undo_op);
+			get_op(cmd, 1, &op);
+			p = get_op_desc(&op);
 			if((*list = format_str("  undo: %s", p)) == NULL)
 			{
 				return list;
@@ -783,27 +996,27 @@ fill_undolist_detail(char **list)
 }
 
 static const char *
-get_op_desc(op_t op)
+get_op_desc(const op_t *op)
 {
 	static char buf[64 + 2*PATH_MAX] = "";
-	switch(op.op)
+	switch(op->op)
 	{
 		case OP_NONE:
 			strcpy(buf, "<no operation>");
 			break;
 		case OP_USR:
-			copy_str(buf, sizeof(buf), (const char *)op.data);
+			copy_str(buf, sizeof(buf), (const char *)op->data);
 			break;
 		case OP_REMOVE:
 		case OP_REMOVESL:
-			snprintf(buf, sizeof(buf), "rm %s", op.src);
+			snprintf(buf, sizeof(buf), "rm %s", op->src);
 			break;
 		case OP_COPY:
 		case OP_COPYA:
-			snprintf(buf, sizeof(buf), "cp %s to %s", op.src, op.dst);
+			snprintf(buf, sizeof(buf), "cp %s to %s", op->src, op->dst);
 			break;
 		case OP_COPYF:
-			snprintf(buf, sizeof(buf), "cp -f %s to %s", op.src, op.dst);
+			snprintf(buf, sizeof(buf), "cp -f %s to %s", op->src, op->dst);
 			break;
 		case OP_MOVE:
 		case OP_MOVEA:
@@ -811,45 +1024,45 @@ get_op_desc(op_t op)
 		case OP_MOVETMP2:
 		case OP_MOVETMP3:
 		case OP_MOVETMP4:
-			snprintf(buf, sizeof(buf), "mv %s to %s", op.src, op.dst);
+			snprintf(buf, sizeof(buf), "mv %s to %s", op->src, op->dst);
 			break;
 		case OP_MOVEF:
-			snprintf(buf, sizeof(buf), "mv -f %s to %s", op.src, op.dst);
+			snprintf(buf, sizeof(buf), "mv -f %s to %s", op->src, op->dst);
 			break;
 		case OP_CHOWN:
 			snprintf(buf, sizeof(buf), "chown %" PRINTF_ULL " %s",
-					(unsigned long long)(size_t)op.data, op.src);
+					(unsigned long long)(size_t)op->data, op->src);
 			break;
 		case OP_CHGRP:
 			snprintf(buf, sizeof(buf), "chown :%" PRINTF_ULL " %s",
-					(unsigned long long)(size_t)op.data, op.src);
+					(unsigned long long)(size_t)op->data, op->src);
 			break;
 #ifndef _WIN32
 		case OP_CHMOD:
 		case OP_CHMODR:
-			snprintf(buf, sizeof(buf), "chmod %s %s", (char *)op.data, op.src);
+			snprintf(buf, sizeof(buf), "chmod %s %s", (char *)op->data, op->src);
 			break;
 #else
 		case OP_ADDATTR:
-			snprintf(buf, sizeof(buf), "attrib +%s", attr_str((size_t)op.data));
+			snprintf(buf, sizeof(buf), "attrib +%s", attr_str((size_t)op->data));
 			break;
 		case OP_SUBATTR:
-			snprintf(buf, sizeof(buf), "attrib -%s", attr_str((size_t)op.data));
+			snprintf(buf, sizeof(buf), "attrib -%s", attr_str((size_t)op->data));
 			break;
 #endif
 		case OP_SYMLINK:
 		case OP_SYMLINK2:
-			snprintf(buf, sizeof(buf), "ln -s %s to %s", op.src, op.dst);
+			snprintf(buf, sizeof(buf), "ln -s %s to %s", op->src, op->dst);
 			break;
 		case OP_MKDIR:
-			snprintf(buf, sizeof(buf), "mkdir %s%s", (op.data == NULL) ? "" : "-p ",
-					op.src);
+			snprintf(buf, sizeof(buf), "mkdir %s%s", (op->data == NULL) ? "" : "-p ",
+					op->src);
 			break;
 		case OP_RMDIR:
-			snprintf(buf, sizeof(buf), "rmdir %s", op.src);
+			snprintf(buf, sizeof(buf), "rmdir %s", op->src);
 			break;
 		case OP_MKFILE:
-			snprintf(buf, sizeof(buf), "touch %s", op.src);
+			snprintf(buf, sizeof(buf), "touch %s", op->src);
 			break;
 
 		case OP_COUNT:
@@ -940,21 +1153,11 @@ un_clear_cmds_with_trash(const char trash_dir[])
 	{
 		cmd_t *prev = cur->prev;
 
-		if(cur->group->balance < 0)
-		{
-			if(cur->do_op.exists != NULL &&
-					trash_has_path_at(trash_dir, cur->do_op.exists))
-			{
-				remove_cmd(cur);
-			}
-		}
-		else
+		op_t op;
+		get_op(cur, cur->group->balance >= 0, &op);
+		if(op.exists != NULL && trash_has_path_at(trash_dir, op.exists))
 		{
-			if(cur->undo_op.exists != NULL &&
-					trash_has_path_at(trash_dir, cur->undo_op.exists))
-			{
-				remove_cmd(cur);
-			}
+			remove_cmd(cur);
 		}
 		cur = prev;
 	}
@@ -21,9 +21,11 @@
 #include <sys/stat.h> /* stat */
 
 #include <assert.h> /* assert() */
-#include <string.h> /* memcmp() memcpy() */
+#include <stdio.h> /* sscanf() */
+#include <string.h> /* memcmp() memcpy() memset() */
 
 #include "../compat/os.h"
+#include "str.h"
 
 void
 filemon_reset(filemon_t *timestamp)
@@ -90,5 +92,51 @@ filemon_equal(const filemon_t *a, const filemon_t *b)
 	    && a->inode == b->inode;
 }
 
+char *
+filemon_to_str(const filemon_t *timestamp)
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+	const long long sec = timestamp->ts.tv_sec;
+	const long nsec = timestamp->ts.tv_nsec;
+#else
+	const long long sec = timestamp->ts;
+	const long nsec = 0;
+#endif
+
+	return format_str("%d:%lld:%ld:%llu:%llu", (int)timestamp->type, sec, nsec,
+			(unsigned long long)timestamp->dev,
+			(unsigned long long)timestamp->inode);
+}
+
+int
+filemon_from_str(const char str[], filemon_t *timestamp)
+{
+	int type;
+	long long sec;
+	long nsec;
+	unsigned long long dev, inode;
+	int end = 0;
+	if(sscanf(str, "%d:%lld:%ld:%llu:%llu%n", &type, &sec, &nsec, &dev, &inode,
+				&end) != 5 || str[end] != '\0' ||
+			(type != FMT_MODIFIED && type != FMT_CHANGED))
+	{
+		filemon_reset(timestamp);
+		return 1;
+	}
+
+	/* Timestamps are compared bytewise, so don't leave garbage in padding. */
+	memset(timestamp, 0, sizeof(*timestamp));
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+	timestamp->ts.tv_sec = sec;
+	timestamp->ts.tv_nsec = nsec;
+#else
+	timestamp->ts = sec;
+#endif
+	timestamp->dev = dev;
+	timestamp->inode = inode;
+	timestamp->type = type;
+	return 0;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
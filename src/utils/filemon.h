@@ -69,6 +69,14 @@ int filemon_from_file(const char path[], FileMonType type,
  * zero is returned. */
 int filemon_equal(const filemon_t *a, const filemon_t *b);
 
+/* Formats file monitor as a string to be stored outside of the process.
+ * Returns newly allocated string or NULL on error. */
+char * filemon_to_str(const filemon_t *timestamp);
+
+/* Sets file monitor from a string produced by filemon_to_str().  Returns zero
+ * on success, otherwise non-zero is returned and *timestamp is reset. */
+int filemon_from_str(const char str[], filemon_t *timestamp);
+
 #endif /* VIFM__UTILS__FILEMON_H__ */
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
@@ -0,0 +1,634 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "fuzzy.h"
+
+#include <sys/types.h> /* DIR */
+#include <dirent.h> /* DIR dirent */
+
+#include <ctype.h> /* islower() isupper() tolower() */
+#include <stddef.h> /* NULL size_t */
+#include <stdint.h> /* intptr_t */
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* free() qsort() realloc() */
+#include <string.h> /* memcpy() strchr() strcmp() strdup() strlen() */
+
+#include "../compat/fs_limits.h"
+#include "../compat/os.h"
+#include "../compat/reallocarray.h"
+#include "cancellation.h"
+#include "filemon.h"
+#include "fs.h"
+#include "macros.h"
+#include "path.h"
+#include "str.h"
+#include "trie.h"
+
+/* Directory of the index. */
+typedef struct
+{
+	int entry;     /* Entry of the directory or -1 for the root. */
+	size_t first;  /* Index of the first child entry. */
+	size_t count;  /* Number of child entries. */
+	filemon_t mon; /* State of the directory at the moment of reading it. */
+}
+fuzzy_dir_t;
+
+/* Entry that matched a query. */
+typedef struct
+{
+	const char *path; /* Path of the entry. */
+	int score;        /* Score of the match. */
+	int len;          /* Length of the path. */
+}
+fuzzy_match_t;
+
+/* State of updating an index. */
+typedef struct
+{
+	const fuzzy_index_t *old;           /* Previous state of the index. */
+	trie_t *old_dirs;                   /* Maps paths to dirs of old state. */
+	const cancellation_t *cancellation; /* Cancellation of the update. */
+	int changed;                        /* Whether any directory was read. */
+}
+scan_ctx_t;
+
+/* Index of paths under a directory.  Paths are kept in a single buffer to be
+ * traversed quickly.  Children of each directory occupy a contiguous range of
+ * entries, which allows reusing them when directory didn't change. */
+struct fuzzy_index_t
+{
+	char *root; /* Root directory of the index. */
+
+	char *buf;      /* Relative paths stored one after another. */
+	size_t buf_len; /* Used size of the buf. */
+	size_t buf_cap; /* Allocated size of the buf. */
+
+	size_t *entries;    /* Offsets of paths in the buf. */
+	size_t entry_count; /* Number of used elements of the entries. */
+	size_t entry_cap;   /* Number of allocated elements of the entries. */
+
+	fuzzy_dir_t *dirs; /* Directories of the index. */
+	size_t dir_count;  /* Number of used elements of the dirs. */
+	size_t dir_cap;    /* Number of allocated elements of the dirs. */
+
+	char *last_query;       /* Previous query or NULL. */
+	fuzzy_match_t *matches; /* Matches of the previous query. */
+	size_t match_count;     /* Number of elements in the matches. */
+	const char **results;   /* Paths of the matches. */
+};
+
+static int has_upper(const char str[]);
+static int chars_equal(char a, char b, int ignore_case);
+static void take_storage(fuzzy_index_t *index, const fuzzy_index_t *from);
+static int get_dir_path(const fuzzy_index_t *index, int entry, char buf[],
+		size_t buf_len);
+static int scan_dir(fuzzy_index_t *index, scan_ctx_t *ctx, int entry);
+static int read_dir(fuzzy_index_t *index, const char path[], const char rel[]);
+static int add_entry(fuzzy_index_t *index, const char prefix[],
+		const char name[], int is_dir);
+static void free_storage(fuzzy_index_t *index);
+static void drop_query(fuzzy_index_t *index);
+static int get_entry_len(const fuzzy_index_t *index, size_t entry);
+static int match_cmp(const void *a, const void *b);
+
+int
+fuzzy_score(const char str[], const char query[])
+{
+	const int ignore_case = !has_upper(query);
+	const size_t str_len = strlen(str);
+	const size_t query_len = strlen(query);
+
+	if(query_len > str_len)
+	{
+		return -1;
+	}
+
+	/* Find where name starts not counting trailing slash of directories. */
+	size_t name_start = str_len;
+	if(name_start > 0 && str[name_start - 1] == '/')
+	{
+		--name_start;
+	}
+	while(name_start > 0 && str[name_start - 1] != '/')
+	{
+		--name_start;
+	}
+
+	/* Match from the end to prefer matches in file names. */
+	int score = 0;
+	size_t s = str_len;
+	size_t q = query_len;
+	size_t next = 0;
+	while(q > 0)
+	{
+		const char qc = query[--q];
+		while(s > 0 && !chars_equal(str[s - 1], qc, ignore_case))
+		{
+			--s;
+		}
+		if(s == 0)
+		{
+			return -1;
+		}
+
+		const size_t pos = --s;
+		const unsigned char prev = (pos == 0 ? '/' : str[pos - 1]);
+
+		score += 16;
+		if(prev == '/')
+		{
+			score += 12;
+		}
+		else if(strchr("_-. ", prev) != NULL)
+		{
+			score += 8;
+		}
+		else if(islower(prev) && isupper((unsigned char)str[pos]))
+		{
+			score += 8;
+		}
+
+		if(pos >= name_start)
+		{
+			score += 4;
+		}
+
+		if(q + 1 < query_len)
+		{
+			/* Reward runs of characters and penalize gaps between them. */
+			if(next == pos + 1)
+			{
+				score += 10;
+			}
+			else
+			{
+				score -= (int)MIN(next - pos - 1U, 8U);
+			}
+		}
+		next = pos;
+	}
+
+	return score;
+}
+
+/* Checks whether string contains upper case letters.  Returns non-zero if
+ * so. */
+static int
+has_upper(const char str[])
+{
+	while(*str != '\0')
+	{
+		if(isupper((unsigned char)*str++))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Compares two characters possibly ignoring case.  Returns non-zero if they are
+ * equal. */
+static int
+chars_equal(char a, char b, int ignore_case)
+{
+	if(a == b)
+	{
+		return 1;
+	}
+	return ignore_case && tolower((unsigned char)a) == tolower((unsigned char)b);
+}
+
+fuzzy_index_t *
+fuzzy_index_alloc(const char root[])
+{
+	fuzzy_index_t *const index = calloc(1, sizeof(*index));
+	if(index == NULL)
+	{
+		return NULL;
+	}
+
+	index->root = strdup(root);
+	if(index->root == NULL)
+	{
+		free(index);
+		return NULL;
+	}
+
+	return index;
+}
+
+void
+fuzzy_index_free(fuzzy_index_t *index)
+{
+	if(index == NULL)
+	{
+		return;
+	}
+
+	drop_query(index);
+	free_storage(index);
+	free(index->results);
+	free(index->root);
+	free(index);
+}
+
+const char *
+fuzzy_index_root(const fuzzy_index_t *index)
+{
+	return index->root;
+}
+
+int
+fuzzy_index_size(const fuzzy_index_t *index)
+{
+	return index->entry_count;
+}
+
+int
+fuzzy_index_update(fuzzy_index_t *index, const cancellation_t *cancellation)
+{
+	/* Map paths of directories onto their records in the old state. */
+	trie_t *const old_dirs = trie_create(NULL);
+	if(old_dirs == NULL)
+	{
+		return 1;
+	}
+
+	size_t i;
+	for(i = 0; i < index->dir_count; ++i)
+	{
+		char path[PATH_MAX + 1];
+		if(get_dir_path(index, index->dirs[i].entry, path, sizeof(path)) == 0 &&
+				trie_set(old_dirs, path, (void *)(intptr_t)(i + 1)) < 0)
+		{
+			trie_free(old_dirs);
+			return 1;
+		}
+	}
+
+	/* The new state is built next to the old one, which is restored if nothing
+	 * has changed or the update has failed. */
+	fuzzy_index_t old = *index;
+	static const fuzzy_index_t empty;
+	take_storage(index, &empty);
+
+	scan_ctx_t ctx = {
+		.old = &old,
+		.old_dirs = old_dirs,
+		.cancellation = cancellation,
+		.changed = (old.dir_count == 0U),
+	};
+	const int error = scan_dir(index, &ctx, -1);
+	trie_free(old_dirs);
+
+	if(error || !ctx.changed)
+	{
+		free_storage(index);
+		take_storage(index, &old);
+		return error;
+	}
+
+	drop_query(index);
+	free_storage(&old);
+	return 0;
+}
+
+/* Makes the index use paths and directories of another one. */
+static void
+take_storage(fuzzy_index_t *index, const fuzzy_index_t *from)
+{
+	index->buf = from->buf;
+	index->buf_len = from->buf_len;
+	index->buf_cap = from->buf_cap;
+	index->entries = from->entries;
+	index->entry_count = from->entry_count;
+	index->entry_cap = from->entry_cap;
+	index->dirs = from->dirs;
+	index->dir_count = from->dir_count;
+	index->dir_cap = from->dir_cap;
+}
+
+/* Formats full path to a directory specified by its entry (-1 for the root).
+ * Returns zero on success and non-zero if the path doesn't fit. */
+static int
+get_dir_path(const fuzzy_index_t *index, int entry, char buf[], size_t buf_len)
+{
+	const char *const rel = (entry < 0 ? "" : index->buf + index->entries[entry]);
+	const char *const sep = (ends_with_slash(index->root) ? "" : "/");
+	const int len = snprintf(buf, buf_len, "%s%s%s", index->root, sep, rel);
+	return (len < 0 || (size_t)len >= buf_len);
+}
+
+/* Adds directory specified by its entry (-1 for the root) and its subtree to
+ * the index reusing lists of children of unchanged directories of the old
+ * index.  Returns non-zero on error or cancellation. */
+static int
+scan_dir(fuzzy_index_t *index, scan_ctx_t *ctx, int entry)
+{
+	if(cancellation_requested(ctx->cancellation))
+	{
+		return 1;
+	}
+
+	char path[PATH_MAX + 1];
+	if(get_dir_path(index, entry, path, sizeof(path)) != 0)
+	{
+		/* Skip directories with paths that are too long. */
+		return 0;
+	}
+
+	filemon_t mon;
+	if(filemon_from_file(path, FMT_MODIFIED, &mon) != 0)
+	{
+		/* Only the root is required to exist. */
+		return (entry < 0);
+	}
+
+	if(index->dir_count == index->dir_cap)
+	{
+		const size_t new_cap = (index->dir_cap == 0U ? 16U : index->dir_cap*2U);
+		fuzzy_dir_t *const dirs = reallocarray(index->dirs, new_cap,
+				sizeof(*dirs));
+		if(dirs == NULL)
+		{
+			return 1;
+		}
+		index->dirs = dirs;
+		index->dir_cap = new_cap;
+	}
+
+	const size_t dir = index->dir_count++;
+	const size_t first = index->entry_count;
+	index->dirs[dir].entry = entry;
+	index->dirs[dir].first = first;
+	index->dirs[dir].mon = mon;
+
+	const fuzzy_index_t *const old = ctx->old;
+	void *data;
+	if(trie_get(ctx->old_dirs, path, &data) == 0 &&
+			filemon_equal(&old->dirs[(intptr_t)data - 1].mon, &mon))
+	{
+		const fuzzy_dir_t *const old_dir = &old->dirs[(intptr_t)data - 1];
+		size_t i;
+		for(i = 0; i < old_dir->count; ++i)
+		{
+			const char *const child = old->buf + old->entries[old_dir->first + i];
+			if(add_entry(index, "", child, 0) != 0)
+			{
+				return 1;
+			}
+		}
+	}
+	else
+	{
+		ctx->changed = 1;
+
+		const size_t root_len = strlen(index->root)
+		                      + (ends_with_slash(index->root) ? 0 : 1);
+		if(read_dir(index, path, path + root_len) != 0)
+		{
+			return 1;
+		}
+	}
+
+	const size_t count = index->entry_count - first;
+	index->dirs[dir].count = count;
+
+	size_t i;
+	for(i = first; i < first + count; ++i)
+	{
+		if(ends_with_slash(index->buf + index->entries[i]) &&
+				scan_dir(index, ctx, i) != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Adds children of a directory at the path to the index prefixing their names
+ * with the rel path.  Unreadable directories are treated as empty.  Returns
+ * non-zero on error. */
+static int
+read_dir(fuzzy_index_t *index, const char path[], const char rel[])
+{
+	DIR *const dir = os_opendir(path);
+	if(dir == NULL)
+	{
+		return 0;
+	}
+
+	struct dirent *d;
+	while((d = os_readdir(dir)) != NULL)
+	{
+		if(is_builtin_dir(d->d_name))
+		{
+			continue;
+		}
+
+		/* Entries with paths that are too long are treated as files. */
+		char full_path[PATH_MAX + 1];
+		const int len = snprintf(full_path, sizeof(full_path), "%s%s", path,
+				d->d_name);
+		const int is_dir = (len >= 0 && (size_t)len < sizeof(full_path))
+		                && entry_is_dir(full_path, d);
+
+		if(add_entry(index, rel, d->d_name, is_dir) != 0)
+		{
+			os_closedir(dir);
+			return 1;
+		}
+	}
+
+	os_closedir(dir);
+	return 0;
+}
+
+/* Appends concatenation of prefix and name optionally followed by a slash to
+ * the index.  Returns non-zero on error. */
+static int
+add_entry(fuzzy_index_t *index, const char prefix[], const char name[],
+		int is_dir)
+{
+	const size_t prefix_len = strlen(prefix);
+	const size_t name_len = strlen(name);
+	const size_t len = prefix_len + name_len + (is_dir ? 1U : 0U);
+
+	if(index->buf_len + len + 1U > index->buf_cap)
+	{
+		size_t new_cap = (index->buf_cap == 0U ? 4096U : index->buf_cap*2U);
+		while(index->buf_len + len + 1U > new_cap)
+		{
+			new_cap *= 2U;
+		}
+
+		char *const buf = realloc(index->buf, new_cap);
+		if(buf == NULL)
+		{
+			return 1;
+		}
+		index->buf = buf;
+		index->buf_cap = new_cap;
+	}
+
+	if(index->entry_count == index->entry_cap)
+	{
+		const size_t new_cap = (index->entry_cap == 0U ? 256U
+		                                               : index->entry_cap*2U);
+		size_t *const entries = reallocarray(index->entries, new_cap,
+				sizeof(*entries));
+		if(entries == NULL)
+		{
+			return 1;
+		}
+		index->entries = entries;
+		index->entry_cap = new_cap;
+	}
+
+	char *const dst = index->buf + index->buf_len;
+	memcpy(dst, prefix, prefix_len);
+	memcpy(dst + prefix_len, name, name_len);
+	if(is_dir)
+	{
+		dst[prefix_len + name_len] = '/';
+	}
+	dst[len] = '\0';
+
+	index->entries[index->entry_count++] = index->buf_len;
+	index->buf_len += len + 1U;
+	return 0;
+}
+
+/* Frees paths and directories of the index. */
+static void
+free_storage(fuzzy_index_t *index)
+{
+	free(index->buf);
+	free(index->entries);
+	free(index->dirs);
+}
+
+/* Forgets results of the previous query. */
+static void
+drop_query(fuzzy_index_t *index)
+{
+	update_string(&index->last_query, NULL);
+	free(index->matches);
+	index->matches = NULL;
+	index->match_count = 0U;
+}
+
+const char **
+fuzzy_index_query(fuzzy_index_t *index, const char query[], int *count)
+{
+	/* Every match of a query is a match of its prefix. */
+	const int narrow = (index->last_query != NULL &&
+			starts_with(query, index->last_query));
+
+	const size_t total = (narrow ? index->match_count : index->entry_count);
+	fuzzy_match_t *const matches = narrow
+	                             ? index->matches
+	                             : reallocarray(NULL, total + 1U,
+	                                            sizeof(*matches));
+	if(matches == NULL)
+	{
+		return NULL;
+	}
+
+	const char **const results = reallocarray(index->results, total + 1U,
+			sizeof(*results));
+	if(results == NULL)
+	{
+		if(!narrow)
+		{
+			free(matches);
+		}
+		return NULL;
+	}
+	index->results = results;
+
+	/* Matches are filtered in place. */
+	size_t i;
+	size_t match_count = 0U;
+	for(i = 0U; i < total; ++i)
+	{
+		const char *const path = (narrow ? matches[i].path
+		                                 : index->buf + index->entries[i]);
+		const int score = fuzzy_score(path, query);
+		if(score >= 0)
+		{
+			const int len = (narrow ? matches[i].len : get_entry_len(index, i));
+			matches[match_count].path = path;
+			matches[match_count].score = score;
+			matches[match_count].len = len;
+			++match_count;
+		}
+	}
+
+	qsort(matches, match_count, sizeof(*matches), &match_cmp);
+
+	for(i = 0U; i < match_count; ++i)
+	{
+		results[i] = matches[i].path;
+	}
+
+	if(!narrow)
+	{
+		free(index->matches);
+		index->matches = matches;
+	}
+	index->match_count = match_count;
+	(void)replace_string(&index->last_query, query);
+
+	*count = match_count;
+	return results;
+}
+
+/* Computes length of path of an entry.  Returns the length. */
+static int
+get_entry_len(const fuzzy_index_t *index, size_t entry)
+{
+	const size_t end = (entry + 1U < index->entry_count)
+	                 ? index->entries[entry + 1U]
+	                 : index->buf_len;
+	return end - index->entries[entry] - 1U;
+}
+
+/* qsort() comparer that puts better matches first.  Returns standard -1, 0, 1
+ * for comparisons. */
+static int
+match_cmp(const void *a, const void *b)
+{
+	const fuzzy_match_t *const x = a;
+	const fuzzy_match_t *const y = b;
+
+	if(x->score != y->score)
+	{
+		return (x->score > y->score ? -1 : 1);
+	}
+	if(x->len != y->len)
+	{
+		return (x->len < y->len ? -1 : 1);
+	}
+	return strcmp(x->path, y->path);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
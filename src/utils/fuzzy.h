@@ -0,0 +1,66 @@
+/* vifm
+ * Copyright (C) 2026 xaizek.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef VIFM__UTILS__FUZZY_H__
+#define VIFM__UTILS__FUZZY_H__
+
+/* Fuzzy matching of paths against a query and an index of paths of a file
+ * system tree to run such queries against. */
+
+struct cancellation_t;
+
+/* Opaque declaration of index of paths. */
+typedef struct fuzzy_index_t fuzzy_index_t;
+
+/* Matches str against the query treating the query as a subsequence.  Case is
+ * ignored unless query contains upper case letters.  Returns negative value if
+ * there is no match, otherwise score of the match which is larger for matches
+ * at starts of path components, in file names and for runs of characters. */
+int fuzzy_score(const char str[], const char query[]);
+
+/* Creates an empty index of paths under root directory, fuzzy_index_update()
+ * populates it.  Returns NULL on error. */
+fuzzy_index_t * fuzzy_index_alloc(const char root[]);
+
+/* Frees the index.  Freeing NULL is OK. */
+void fuzzy_index_free(fuzzy_index_t *index);
+
+/* Retrieves root directory of the index.  Returns the path. */
+const char * fuzzy_index_root(const fuzzy_index_t *index);
+
+/* Retrieves number of paths in the index.  Returns the number. */
+int fuzzy_index_size(const fuzzy_index_t *index);
+
+/* Brings the index in sync with the file system.  Only directories that were
+ * modified since the last update are read again.  Returns non-zero on error or
+ * cancellation, in which case the index is left as it was. */
+int fuzzy_index_update(fuzzy_index_t *index,
+		const struct cancellation_t *cancellation);
+
+/* Finds paths of the index which match the query.  Paths are relative to root
+ * and are ordered from best match to the worst one, directories end with a
+ * slash.  When the query extends the previous one, only previous results are
+ * checked.  Returns array of *count paths which is valid until the next call of
+ * this function or fuzzy_index_update() or NULL on error. */
+const char ** fuzzy_index_query(fuzzy_index_t *index, const char query[],
+		int *count);
+
+#endif /* VIFM__UTILS__FUZZY_H__ */
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
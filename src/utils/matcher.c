@@ -20,10 +20,12 @@
 
 #include <regex.h> /* regex_t regexec() regfree() */
 
-#include <stddef.h> /* NULL */
+#include <stddef.h> /* NULL size_t */
 #include <stdlib.h> /* free() malloc() */
-#include <string.h> /* strcspn() strdup() strlen() strrchr() */
+#include <string.h> /* memmove() strchr() strcspn() strdup() strlen()
+                       strrchr() */
 
+#include "../compat/reallocarray.h"
 #include "../int/file_magic.h"
 #include "globs.h"
 #include "path.h"
@@ -40,6 +42,16 @@ typedef enum
 }
 MType;
 
+/* Single pre-parsed pattern of "faster" globs. */
+typedef struct
+{
+	const char *head; /* Part before the asterisk or unescaped literal. */
+	const char *tail; /* Part after the asterisk or NULL for a literal. */
+	size_t head_len;  /* Length of the head. */
+	size_t tail_len;  /* Length of the tail. */
+}
+fglob_t;
+
 /* Wrapper for a regular expression, its state and compiled form. */
 struct matcher_t
 {
@@ -53,6 +65,9 @@ struct matcher_t
 	unsigned int fglobs : 1;    /* Whether this matcher is a special case of
 	                               globs ("faster" globs) that is optimized. */
 	regex_t regex; /* The expression in compiled form, unless matcher is empty. */
+	char *fglobs_buf;     /* Storage for strings of fglobs_list. */
+	fglob_t *fglobs_list; /* Pre-parsed "faster" globs. */
+	int fglobs_count;     /* Number of elements in fglobs_list. */
 };
 
 static int is_full_path(const char expr[], int re, int glob, int *strip);
@@ -62,10 +77,14 @@ static int compile_expr(matcher_t *m, int strip, int cs_by_def,
 		const char on_empty_re[], char **error);
 static int parse_glob(matcher_t *m, int strip, char **error);
 static int is_fglobs(char expr[]);
+static int parse_fglobs(matcher_t *m);
 static int parse_re(matcher_t *m, int strip, int cs_by_def,
 		const char on_empty_re[], char **error);
 static void free_matcher_items(matcher_t *matcher);
 static int fglobs_matches(const matcher_t *matcher, const char path[]);
+static int fglob_matches(const fglob_t *fglob, const char path[],
+		size_t path_len);
+static const char * get_fglob_ext(const fglob_t *fglob);
 static int fglobs_includes(const matcher_t *matcher, const matcher_t *like);
 static int is_negated(const char **expr);
 static int is_re_expr(const char expr[], int allow_empty);
@@ -112,6 +131,8 @@ matcher_alloc(const char expr[], int cs_by_def, int glob_by_def,
 		free(m.raw);
 		free(m.expr);
 		free(m.undec);
+		free(m.fglobs_buf);
+		free(m.fglobs_list);
 		return NULL;
 	}
 
@@ -238,6 +259,11 @@ parse_glob(matcher_t *m, int strip, char **error)
 	if(is_fglobs(m->raw))
 	{
 		m->fglobs = 1;
+		if(parse_fglobs(m) != 0)
+		{
+			replace_string(error, "Failed to parse globs.");
+			return 1;
+		}
 		return 0;
 	}
 
@@ -288,6 +314,53 @@ is_fglobs(char expr[])
 	return (glob == NULL);
 }
 
+/* Splits list of "faster" globs into pre-parsed form, so that matching doesn't
+ * need to do it on every call.  Returns zero on success, otherwise non-zero is
+ * returned. */
+static int
+parse_fglobs(matcher_t *m)
+{
+	m->fglobs_buf = strdup(m->raw);
+	if(m->fglobs_buf == NULL)
+	{
+		return 1;
+	}
+
+	char *glob = m->fglobs_buf, *state = NULL;
+	while((glob = split_and_get_dc(glob, &state)) != NULL)
+	{
+		void *p = reallocarray(m->fglobs_list, m->fglobs_count + 1,
+				sizeof(*m->fglobs_list));
+		if(p == NULL)
+		{
+			return 1;
+		}
+		m->fglobs_list = p;
+
+		fglob_t *const fglob = &m->fglobs_list[m->fglobs_count++];
+		char *const asterisk = strchr(glob, '*');
+
+		fglob->head = glob;
+		fglob->tail = NULL;
+
+		if(asterisk != NULL && asterisk != glob && asterisk[-1] == '\\')
+		{
+			/* Literal with one escaped asterisk, drop the backslash. */
+			memmove(asterisk - 1, asterisk, strlen(asterisk) + 1);
+		}
+		else if(asterisk != NULL)
+		{
+			*asterisk = '\0';
+			fglob->tail = asterisk + 1;
+			fglob->tail_len = strlen(fglob->tail);
+		}
+
+		fglob->head_len = strlen(fglob->head);
+	}
+
+	return 0;
+}
+
 /* Parses regexp flags.  Returns zero on success or non-zero on error with
  * *error containing description of it. */
 static int
@@ -342,6 +415,9 @@ matcher_clone(const matcher_t *matcher)
 	clone->expr = strdup(matcher->expr);
 	clone->raw = strdup(matcher->raw);
 	clone->undec = strdup(matcher->undec);
+	clone->fglobs_buf = NULL;
+	clone->fglobs_list = NULL;
+	clone->fglobs_count = 0;
 
 	if(clone->expr == NULL || clone->raw == NULL || clone->undec == NULL)
 	{
@@ -349,6 +425,12 @@ matcher_clone(const matcher_t *matcher)
 		return NULL;
 	}
 
+	if(clone->fglobs && parse_fglobs(clone) != 0)
+	{
+		matcher_free(clone);
+		return NULL;
+	}
+
 	/* Don't compile regex for faster globs or empty matcher. */
 	if(!clone->fglobs && clone->raw[0] != '\0')
 	{
@@ -385,6 +467,8 @@ free_matcher_items(matcher_t *matcher)
 	free(matcher->expr);
 	free(matcher->raw);
 	free(matcher->undec);
+	free(matcher->fglobs_buf);
+	free(matcher->fglobs_list);
 }
 
 int
@@ -422,56 +506,89 @@ matcher_matches(const matcher_t *matcher, const char path[])
 static int
 fglobs_matches(const matcher_t *matcher, const char path[])
 {
-	char *globs = strdup(matcher->raw);
-	char *glob = globs, *state = NULL;
-	while((glob = split_and_get_dc(glob, &state)) != NULL)
-	{
-		const char *asterisk = until_first(glob, '*');
+	const size_t path_len = strlen(path);
 
-		/* Literal with no special characters. */
-		if(*asterisk == '\0')
+	int i;
+	for(i = 0; i < matcher->fglobs_count; ++i)
+	{
+		if(fglob_matches(&matcher->fglobs_list[i], path, path_len))
 		{
-			if(strcasecmp(path, glob) == 0)
-			{
-				break;
-			}
-			continue;
+			break;
 		}
+	}
+	return (i < matcher->fglobs_count)^matcher->negated;
+}
+
+/* Checks whether given path/name is matched by a single pre-parsed glob.
+ * Returns non-zero if so, otherwise zero is returned. */
+static int
+fglob_matches(const fglob_t *fglob, const char path[], size_t path_len)
+{
+	/* Literal with no special characters. */
+	if(fglob->tail == NULL)
+	{
+		return (strcasecmp(path, fglob->head) == 0);
+	}
+
+	/* `*something` */
+	if(fglob->head_len == 0U)
+	{
+		return path[0] != '.'
+		    && path_len > fglob->tail_len
+		    && strcasecmp(path + path_len - fglob->tail_len, fglob->tail) == 0;
+	}
+
+	/* Either `something*` or `some*thing`.  First case work here by matching
+	 * its empty suffix. */
+	return path_len >= fglob->head_len + fglob->tail_len
+	    && strncasecmp(path, fglob->head, fglob->head_len) == 0
+	    && strcasecmp(path + path_len - fglob->tail_len, fglob->tail) == 0;
+}
+
+int
+matcher_get_keys(const matcher_t *matcher, matcher_key_cb cb, void *arg)
+{
+	if(!matcher->fglobs || matcher->negated || matcher->full_path ||
+			matcher->type != MT_GLOBS)
+	{
+		return 0;
+	}
 
-		size_t pos = asterisk - glob;
-		/* `*something` */
-		if(pos == 0)
+	int i;
+	for(i = 0; i < matcher->fglobs_count; ++i)
+	{
+		const fglob_t *const fglob = &matcher->fglobs_list[i];
+		if(fglob->tail != NULL && get_fglob_ext(fglob) == NULL)
 		{
-			if(path[0] != '.' && ends_with_case(path + 1, glob + 1))
-			{
-				break;
-			}
-			continue;
+			return 0;
 		}
+	}
 
-		/* Literal with one escaped asterisk. */
-		if(asterisk[-1] == '\\')
+	for(i = 0; i < matcher->fglobs_count; ++i)
+	{
+		const fglob_t *const fglob = &matcher->fglobs_list[i];
+		if(fglob->tail == NULL)
 		{
-			/* Compare parts around '\\' to ignore it. */
-			--pos;
-			if(strncasecmp(path, glob, pos) == 0 &&
-					strcasecmp(path + pos, glob + pos + 1) == 0)
-			{
-				break;
-			}
-			continue;
+			cb(fglob->head, 0, arg);
 		}
-
-		/* Either `something*` or `some*thing`.  First case work here by matching
-		 * its empty suffix. */
-		if(strncasecmp(path, glob, pos) == 0 &&
-				ends_with_case(path + pos, glob + pos + 1))
+		else
 		{
-			break;
+			cb(get_fglob_ext(fglob), 1, arg);
 		}
 	}
-	free(globs);
-	return (glob != NULL)^matcher->negated;
+
+	return 1;
+}
+
+/* Retrieves extension that all names matched by a glob must have.  Returns the
+ * extension or NULL if there is no such extension. */
+static const char *
+get_fglob_ext(const fglob_t *fglob)
+{
+	/* Suffix that contains a dot determines extension of a name ending with
+	 * it. */
+	const char *const dot = strrchr(fglob->tail, '.');
+	return (dot == NULL ? NULL : dot + 1);
 }
 
 int
@@ -593,6 +710,12 @@ matcher_is_full_path(const matcher_t *matcher)
 	return matcher->full_path;
 }
 
+int
+matcher_is_mime(const matcher_t *matcher)
+{
+	return (matcher->type == MT_MIME);
+}
+
 TSTATIC int
 matcher_is_fast(const matcher_t *matcher)
 {
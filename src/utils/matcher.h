@@ -29,6 +29,11 @@
 /* Opaque matcher type. */
 typedef struct matcher_t matcher_t;
 
+/* Type of callback invoked by matcher_get_keys() per key.  The key is either a
+ * file name or an extension (part after the last dot) as specified by
+ * is_ext. */
+typedef void (*matcher_key_cb)(const char key[], int is_ext, void *arg);
+
 /* Parses matcher expression and allocates matcher.  on_empty_re string is used
  * if passed in regexp is empty.  Returns matcher on success and sets *error to
  * NULL, otherwise NULL is returned and *error is initialized with newly
@@ -62,10 +67,19 @@ const char * matcher_get_undec(const matcher_t *matcher);
  * Returns non-zero if so, otherwise zero is returned. */
 int matcher_includes(const matcher_t *matcher, const matcher_t *like);
 
+/* Enumerates keys (names or extensions) one of which a name must have (ignoring
+ * case) to be matched by the matcher.  Returns non-zero if matcher can be
+ * described this way, otherwise zero is returned and cb isn't called. */
+int matcher_get_keys(const matcher_t *matcher, matcher_key_cb cb, void *arg);
+
 /* Checks whether given matcher is a full path matcher.  Returns non-zero if so,
  * otherwise zero is returned. */
 int matcher_is_full_path(const matcher_t *matcher);
 
+/* Checks whether given matcher matches mime types of files.  Returns non-zero
+ * if so, otherwise zero is returned. */
+int matcher_is_mime(const matcher_t *matcher);
+
 TSTATIC_DEFS(
 	int matcher_is_fast(const matcher_t *matcher);
 )
@@ -18,15 +18,20 @@
 
 #include "matchers.h"
 
-#include <stddef.h> /* NULL */
-#include <stdlib.h> /* free() malloc() */
-#include <string.h> /* strdup() */
+#include <ctype.h> /* tolower() */
+#include <stddef.h> /* NULL size_t */
+#include <stdlib.h> /* calloc() free() malloc() */
+#include <string.h> /* strdup() strlen() strrchr() */
 
+#include "../compat/fs_limits.h"
 #include "../compat/reallocarray.h"
+#include "int_stack.h"
 #include "matcher.h"
+#include "path.h"
 #include "str.h"
 #include "string_array.h"
 #include "test_helpers.h"
+#include "trie.h"
 
 /* Supported types of tokens. */
 typedef enum
@@ -55,6 +60,18 @@ struct matchers_t
 	char *expr;              /* User-entered pattern list. */
 };
 
+/* Index over a sequence of matchers, which narrows down set of candidates that
+ * need to be checked against a path. */
+struct matchers_index_t
+{
+	const matchers_t **list; /* Indexed matchers. */
+	int count;               /* Number of indexed matchers. */
+	trie_t *names;           /* Lower-cased names to lists of indexes. */
+	trie_t *exts;            /* Lower-cased extensions to lists of indexes. */
+	int_stack_t others;      /* Matchers that can't be found by a key. */
+	int failed;              /* Whether adding a key has failed. */
+};
+
 /* Parser state. */
 typedef struct
 {
@@ -73,6 +90,11 @@ static int find_pat(parsing_state_t *state, TokenType left, TokenType right);
 static int is_at_bound(const parsing_state_t *state);
 static void load_token(parsing_state_t *state, int single_char);
 static int get_token_width(TokenType tok);
+static void index_key(const char key[], int is_ext, void *arg);
+static const int_stack_t * lookup_key(trie_t *trie, const char key[]);
+static void lower_key(const char key[], char buf[], size_t buf_len);
+static int find_candidate(const int_stack_t *list, int from);
+static void free_int_stack(void *ptr);
 
 matchers_t *
 matchers_alloc(const char list[], int cs_by_def, int glob_by_def,
@@ -210,6 +232,20 @@ matchers_get_expr(const matchers_t *matchers)
 	return matchers->expr;
 }
 
+int
+matchers_use_mime(const matchers_t *matchers)
+{
+	int i;
+	for(i = 0; i < matchers->count; ++i)
+	{
+		if(matcher_is_mime(matchers->list[i]))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
 int
 matchers_includes(const matchers_t *matchers, const matchers_t *like)
 {
@@ -255,6 +291,228 @@ matchers_list(const char concat[], int *count)
 	return break_into_matchers(concat, count, 1);
 }
 
+matchers_index_t *
+matchers_index_alloc(void)
+{
+	matchers_index_t *const index = calloc(1, sizeof(*index));
+	if(index == NULL)
+	{
+		return NULL;
+	}
+
+	index->names = trie_create(&free_int_stack);
+	index->exts = trie_create(&free_int_stack);
+	if(index->names == NULL || index->exts == NULL)
+	{
+		matchers_index_free(index);
+		return NULL;
+	}
+
+	return index;
+}
+
+void
+matchers_index_free(matchers_index_t *index)
+{
+	if(index != NULL)
+	{
+		trie_free(index->names);
+		trie_free(index->exts);
+		free(index->others.data);
+		free(index->list);
+		free(index);
+	}
+}
+
+int
+matchers_index_add(matchers_index_t *index, const matchers_t *matchers)
+{
+	void *p = reallocarray(index->list, index->count + 1, sizeof(*index->list));
+	if(p == NULL)
+	{
+		return 1;
+	}
+	index->list = p;
+	index->list[index->count] = matchers;
+
+	/* All matchers of the list must match, so keys of any of them will do. */
+	int i;
+	for(i = 0; i < matchers->count; ++i)
+	{
+		if(matcher_get_keys(matchers->list[i], &index_key, index))
+		{
+			break;
+		}
+	}
+
+	if(index->failed || i == matchers->count)
+	{
+		index->failed = 0;
+		if(int_stack_push(&index->others, index->count) != 0)
+		{
+			return 1;
+		}
+	}
+
+	++index->count;
+	return 0;
+}
+
+/* matcher_get_keys() callback that adds a key for the matchers being added to
+ * the index. */
+static void
+index_key(const char key[], int is_ext, void *arg)
+{
+	matchers_index_t *const index = arg;
+	trie_t *const trie = (is_ext ? index->exts : index->names);
+
+	char lowered[NAME_MAX + 1];
+	if(strlen(key) >= sizeof(lowered))
+	{
+		index->failed = 1;
+		return;
+	}
+	lower_key(key, lowered, sizeof(lowered));
+
+	void *data;
+	if(trie_get(trie, lowered, &data) != 0)
+	{
+		data = calloc(1, sizeof(int_stack_t));
+		if(data == NULL || trie_set(trie, lowered, data) < 0)
+		{
+			free(data);
+			index->failed = 1;
+			return;
+		}
+	}
+
+	/* Same matcher can produce identical keys. */
+	int_stack_t *const list = data;
+	if(!int_stack_top_is(list, index->count) &&
+			int_stack_push(list, index->count) != 0)
+	{
+		index->failed = 1;
+	}
+}
+
+int
+matchers_index_find(const matchers_index_t *index, const char path[],
+		int from)
+{
+	const char *const name = get_last_path_component(path);
+	const char *const dot = strrchr(name, '.');
+
+	const int_stack_t *lists[] = {
+		&index->others,
+		lookup_key(index->names, name),
+		(dot == NULL ? NULL : lookup_key(index->exts, dot + 1)),
+	};
+
+	int all_candidates = 0;
+	if(strlen(name) > NAME_MAX)
+	{
+		/* Lookup might have missed a long key, so consider everything. */
+		all_candidates = 1;
+	}
+
+	for(; from < index->count; ++from)
+	{
+		if(!all_candidates)
+		{
+			int next = index->count;
+			size_t i;
+			for(i = 0U; i < sizeof(lists)/sizeof(lists[0]); ++i)
+			{
+				const int candidate = find_candidate(lists[i], from);
+				if(candidate >= 0 && candidate < next)
+				{
+					next = candidate;
+				}
+			}
+
+			from = next;
+			if(from == index->count)
+			{
+				break;
+			}
+		}
+
+		if(matchers_match(index->list[from], path))
+		{
+			return from;
+		}
+	}
+
+	return -1;
+}
+
+/* Looks up list of indexes by a key ignoring its case.  Returns the list or
+ * NULL. */
+static const int_stack_t *
+lookup_key(trie_t *trie, const char key[])
+{
+	char lowered[NAME_MAX + 1];
+	if(strlen(key) >= sizeof(lowered))
+	{
+		return NULL;
+	}
+	lower_key(key, lowered, sizeof(lowered));
+
+	void *data;
+	return (trie_get(trie, lowered, &data) == 0 ? data : NULL);
+}
+
+/* Converts key to lower case in the same way as strcasecmp() does when it
+ * compares strings. */
+static void
+lower_key(const char key[], char buf[], size_t buf_len)
+{
+	size_t i;
+	for(i = 0U; key[i] != '\0' && i < buf_len - 1U; ++i)
+	{
+		buf[i] = tolower((unsigned char)key[i]);
+	}
+	buf[i] = '\0';
+}
+
+/* Finds the smallest index in a sorted list that is not less than from.
+ * Returns the index or -1 if there is no such element. */
+static int
+find_candidate(const int_stack_t *list, int from)
+{
+	if(list == NULL || list->top == 0U || list->data[list->top - 1U] < from)
+	{
+		return -1;
+	}
+
+	size_t l = 0U, u = list->top - 1U;
+	while(l < u)
+	{
+		const size_t i = l + (u - l)/2U;
+		if(list->data[i] < from)
+		{
+			l = i + 1U;
+		}
+		else
+		{
+			u = i;
+		}
+	}
+	return list->data[l];
+}
+
+/* Frees list of indexes stored in a trie.  ptr can be NULL. */
+static void
+free_int_stack(void *ptr)
+{
+	int_stack_t *const list = ptr;
+	if(list != NULL)
+	{
+		free(list->data);
+		free(list);
+	}
+}
+
 /* Below is a parser that accepts list of patterns:
  *
  *   pattern1pattern2...patternN
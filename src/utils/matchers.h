@@ -24,6 +24,9 @@
 /* Opaque matchers type. */
 typedef struct matchers_t matchers_t;
 
+/* Opaque type of an index over a sequence of matchers. */
+typedef struct matchers_index_t matchers_index_t;
+
 /* Arguments and return value match matcher_alloc() except for first argument,
  * which is a list here. */
 matchers_t * matchers_alloc(const char list[], int cs_by_def, int glob_by_def,
@@ -46,6 +49,10 @@ int matchers_match_dir(const matchers_t *matchers, const char path[]);
 /* Retrieves original matcher expression.  Returns the expression. */
 const char * matchers_get_expr(const matchers_t *matchers);
 
+/* Checks whether any of the matchers matches mime types of files.  Returns
+ * non-zero if so, otherwise zero is returned. */
+int matchers_use_mime(const matchers_t *matchers);
+
 /* Checks whether matchers matches at least superset of what like is matching.
  * Returns non-zero if so, otherwise zero is returned. */
 int matchers_includes(const matchers_t *matchers, const matchers_t *like);
@@ -58,6 +65,23 @@ int matchers_is_expr(const char str[]);
  * length *count. */
 char ** matchers_list(const char concat[], int *count);
 
+/* Allocates an empty index.  Returns the index or NULL on error. */
+matchers_index_t * matchers_index_alloc(void);
+
+/* Frees resources of the index.  index can be NULL. */
+void matchers_index_free(matchers_index_t *index);
+
+/* Appends matchers to the sequence covered by the index.  The matchers must
+ * outlive the index.  Returns zero on success, otherwise non-zero is
+ * returned. */
+int matchers_index_add(matchers_index_t *index, const matchers_t *matchers);
+
+/* Finds first matchers in the sequence starting at position from that match the
+ * path.  Unlike checking each element in turn, only those that can match are
+ * tried.  Returns position of the matchers or -1 if there is no match. */
+int matchers_index_find(const matchers_index_t *index, const char path[],
+		int from);
+
 TSTATIC_DEFS(
 	char ** break_into_matchers(const char concat[], int *count, int is_list);
 )
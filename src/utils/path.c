@@ -729,6 +729,12 @@ find_cmd_in_path(const char cmd[], size_t path_len, char path[])
 	paths = get_paths(&paths_count);
 	for(i = 0; i < paths_count; i++)
 	{
+		/* Skip probing directories which are known not to have such file. */
+		if(!path_may_have_file(i, cmd))
+		{
+			continue;
+		}
+
 		char tmp_path[PATH_MAX + 1];
 		snprintf(tmp_path, sizeof(tmp_path), "%s/%s", paths[i], cmd);
 
@@ -608,6 +608,24 @@ escape_unreadable(const char str[])
 	return escaped;
 }
 
+int
+has_unreadable(const char str[])
+{
+	int str_len = strlen(str);
+	while(str_len > 0)
+	{
+		int char_len;
+		if(!unichar_isprint(utf8_first_char(str, &char_len)))
+		{
+			return 1;
+		}
+
+		str += char_len;
+		str_len -= char_len;
+	}
+	return 0;
+}
+
 int
 escape_unreadableo(const char str[], int prefix_len)
 {
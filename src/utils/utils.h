@@ -193,6 +193,10 @@ char * escape_for_dquotes(const char string[], size_t offset);
  * Returns newly allocated string. */
 char * escape_unreadable(const char str[]);
 
+/* Checks whether escape_unreadable() would change the string.  Returns non-zero
+ * if so, otherwise zero is returned. */
+int has_unreadable(const char str[]);
+
 /* Calculates escaping overhead for some prefix of the string.  Returns
  * byte length difference between unchanged prefix and prefix after escaping,
  * which might be positive, zero or negative. */
@@ -39,7 +39,6 @@
 #include "cfg/info.h"
 #include "compat/reallocarray.h"
 #include "engine/autocmds.h"
-#include "engine/parsing.h"
 #include "compat/fs_limits.h"
 #include "engine/mode.h"
 #include "engine/options.h"
@@ -81,6 +80,7 @@
 #include "flist_hist.h"
 #include "flist_pos.h"
 #include "fops_common.h"
+#include "instance.h"
 #include "ipc.h"
 #include "marks.h"
 #include "ops.h"
@@ -99,7 +99,6 @@ static int get_start_cwd(char buf[], size_t buf_len);
 static OpsResult undo_perform_func(OPS op, void *data, const char src[],
 		const char dst[]);
 static void parse_received_arguments(char *args[]);
-static char * eval_received_expression(const char expr[]);
 static void remote_cd(view_t *view, const char path[], int handle);
 static void check_path_for_file(view_t *view, const char path[], int handle);
 static int need_to_switch_active_pane(const char lwin_path[],
@@ -201,7 +200,7 @@ vifm_main(int argc, char *argv[])
 	 * indirectly depends on terminal initialization and IPC interaction mustn't
 	 * need a terminal. */
 	struct ipc_t *ipc = ipc_init(vifm_args.server_name, &parse_received_arguments,
-			&eval_received_expression);
+			&instance_eval_expr, &instance_exec_batch);
 	if(ipc_enabled() && ipc == NULL)
 	{
 		fputs("Failed to initialize IPC unit", stderr);
@@ -243,8 +242,9 @@ vifm_main(int argc, char *argv[])
 	if(!vifm_args.no_configs)
 	{
 		/* vifminfo must be processed this early so that it can restore last visited
-		 * directory. */
-		state_load(0);
+		 * directory.  Parts of it that aren't needed to draw the first frame are
+		 * loaded after it's drawn. */
+		state_load_lazily();
 	}
 
 	/* Export chosen IPC server name to parsing unit. */
@@ -360,6 +360,10 @@ vifm_main(int argc, char *argv[])
 	update_screen(UT_FULL);
 	modes_update();
 
+	/* The first frame is drawn, finish loading of vifminfo before any user input
+	 * is processed. */
+	state_load_deferred();
+
 	/* Run startup commands after loading file lists into views, so that commands
 	 * like +1 work. */
 	exec_startup_commands(&vifm_args);
@@ -514,23 +518,6 @@ need_to_switch_active_pane(const char lwin_path[], const char rwin_path[])
 	    && curr_view != &lwin;
 }
 
-/* Evaluates expression from a remote instance.  Returns newly allocated string
- * with the result or NULL on error. */
-static char *
-eval_received_expression(const char expr[])
-{
-	parsing_result_t result = vle_parser_eval(expr, /*interactive=*/1);
-	if(result.error != PE_NO_ERROR)
-	{
-		var_free(result.value);
-		return NULL;
-	}
-
-	char *result_str = var_to_str(result.value);
-	var_free(result.value);
-	return result_str;
-}
-
 /* Loads color scheme.  Converts old format to the new one if needed. */
 static void
 load_scheme(void)
@@ -457,6 +457,52 @@ TEST(cpmv_can_copy_or_move_files_to_a_subdirectory)
 	}
 }
 
+TEST(external_commands_process_files_in_bulk_in_background)
+{
+	char dir[] = "dir";
+	char *list[] = { dir };
+
+	cfg.use_system_calls = 0;
+
+	int move;
+	for(move = 0; move < 2; ++move)
+	{
+		create_dir("dir");
+		make_file("dir/file2", "aaa");
+		create_file("file1");
+		create_file("file2");
+		create_file("file3");
+
+		populate_dir_list(&lwin, 0);
+		assert_int_equal(4, lwin.list_rows);
+		lwin.dir_entry[1].marked = 1;
+		lwin.dir_entry[2].marked = 1;
+		lwin.dir_entry[3].marked = 1;
+
+		(void)fops_cpmv_bg(&lwin, list, ARRAY_LEN(list), move, CMLF_SKIP);
+		wait_for_bg();
+
+		assert_int_equal(3, get_file_size("dir/file2"));
+		assert_success(unlink("dir/file1"));
+		assert_success(unlink("dir/file2"));
+		assert_success(unlink("dir/file3"));
+		assert_success(rmdir("dir"));
+
+		if(move)
+		{
+			assert_failure(unlink("file1"));
+			assert_success(unlink("file2"));
+			assert_failure(unlink("file3"));
+		}
+		else
+		{
+			assert_success(unlink("file1"));
+			assert_success(unlink("file2"));
+			assert_success(unlink("file3"));
+		}
+	}
+}
+
 TEST(can_skip_existing_files)
 {
 	make_abs_path(lwin.curr_dir, sizeof(lwin.curr_dir), SANDBOX_PATH, "dir",
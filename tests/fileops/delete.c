@@ -3,7 +3,8 @@
 #include <unistd.h> /* rmdir() unlink() */
 
 #include <limits.h> /* INT_MAX */
-#include <string.h> /* strcat() */
+#include <stdio.h> /* snprintf() */
+#include <string.h> /* strcat() strlen() */
 
 #include <test-utils.h>
 
@@ -13,11 +14,14 @@
 #include "../../src/ui/ui.h"
 #include "../../src/utils/fs.h"
 #include "../../src/utils/path.h"
+#include "../../src/utils/str.h"
+#include "../../src/utils/string_array.h"
 #include "../../src/filelist.h"
 #include "../../src/fops_common.h"
 #include "../../src/fops_misc.h"
 #include "../../src/registers.h"
 #include "../../src/trash.h"
+#include "../../src/undo.h"
 
 static char options_prompt_abort(const struct custom_prompt_t *details);
 
@@ -327,6 +331,125 @@ TEST(aborting_file_deletion_aborts_remaining_files, IF(regular_unix_user))
 	remove_dir("ro");
 }
 
+TEST(external_delete_command_is_run_once_for_many_files, IF(not_windows))
+{
+	char script[PATH_MAX + 1];
+	make_abs_path(script, sizeof(script), SANDBOX_PATH, "script", saved_cwd);
+	make_file(script, "#!/bin/sh\necho run >> runs\nrm -rf \"$@\"\n");
+	assert_success(os_chmod(script, 0755));
+
+	char cmd[PATH_MAX + 10];
+	snprintf(cmd, sizeof(cmd), "%s %%f", script);
+	update_string(&cfg.delete_prg, cmd);
+
+	int bg;
+	for(bg = 0; bg < 2; ++bg)
+	{
+		create_file("a");
+		create_file("b");
+		create_file("c");
+
+		populate_dir_list(&lwin, 0);
+		int i;
+		for(i = 0; i < lwin.list_rows; ++i)
+		{
+			lwin.dir_entry[i].marked = (strlen(lwin.dir_entry[i].name) == 1);
+		}
+
+		if(!bg)
+		{
+			(void)fops_delete(&lwin, '\0', 0);
+		}
+		else
+		{
+			(void)fops_delete_bg(&lwin, 0);
+			wait_for_bg();
+		}
+
+		assert_failure(unlink("a"));
+		assert_failure(unlink("b"));
+		assert_failure(unlink("c"));
+
+		const char *lines[] = { "run", "run" };
+		file_is("runs", lines, bg + 1);
+	}
+
+	remove_file("runs");
+	remove_file(script);
+}
+
+TEST(external_delete_command_is_run_per_file_without_macro, IF(not_windows))
+{
+	char script[PATH_MAX + 1];
+	make_abs_path(script, sizeof(script), SANDBOX_PATH, "script", saved_cwd);
+	make_file(script, "#!/bin/sh\necho run >> runs\nrm -rf \"$@\"\n");
+	assert_success(os_chmod(script, 0755));
+	update_string(&cfg.delete_prg, script);
+
+	create_file("a");
+	create_file("b");
+	create_file("c");
+
+	populate_dir_list(&lwin, 0);
+	int i;
+	for(i = 0; i < lwin.list_rows; ++i)
+	{
+		lwin.dir_entry[i].marked = (strlen(lwin.dir_entry[i].name) == 1);
+	}
+	(void)fops_delete(&lwin, '\0', 0);
+
+	assert_failure(unlink("a"));
+	assert_failure(unlink("b"));
+	assert_failure(unlink("c"));
+
+	const char *lines[] = { "run", "run", "run" };
+	file_is("runs", lines, 3);
+
+	remove_file("runs");
+	remove_file(script);
+}
+
+TEST(results_of_external_delete_command_are_per_file, IF(not_windows))
+{
+	char script[PATH_MAX + 1];
+	make_abs_path(script, sizeof(script), SANDBOX_PATH, "script", saved_cwd);
+	make_file(script,
+			"#!/bin/sh\n"
+			"for f; do\n"
+			"    case \"$f\" in\n"
+			"        *keep) ;;\n"
+			"        *) rm -f \"$f\" ;;\n"
+			"    esac\n"
+			"done\n");
+	assert_success(os_chmod(script, 0755));
+
+	char cmd[PATH_MAX + 10];
+	snprintf(cmd, sizeof(cmd), "%s %%f", script);
+	update_string(&cfg.delete_prg, cmd);
+
+	create_file("a");
+	create_file("keep");
+
+	populate_dir_list(&lwin, 0);
+	assert_int_equal(3, lwin.list_rows);
+	lwin.dir_entry[0].marked = 1;
+	lwin.dir_entry[1].marked = 1;
+	(void)fops_delete(&lwin, '\0', 0);
+
+	assert_failure(unlink("a"));
+	assert_success(unlink("keep"));
+
+	/* Only the removed file is recorded. */
+	char **list = un_get_list(1);
+	const int len = count_strings(list);
+	assert_int_equal(3, len);
+	assert_true(starts_with_lit(list[1], "  do: rm "));
+	assert_true(ends_with(list[1], "/a"));
+	free_string_array(list, len);
+
+	remove_file(script);
+}
+
 static char
 options_prompt_abort(const struct custom_prompt_t *details)
 {
@@ -0,0 +1,140 @@
+#include <stic.h>
+
+#include <test-utils.h>
+
+#include "../../src/compat/fs_limits.h"
+#include "../../src/io/ior.h"
+#include "../../src/modes/dialogs/msg_dialog.h"
+#include "../../src/modes/wk.h"
+#include "../../src/utils/fs.h"
+#include "../../src/utils/path.h"
+#include "../../src/filelist.h"
+#include "../../src/fops_common.h"
+#include "../../src/fops_put.h"
+#include "../../src/registers.h"
+
+static void interrupt_copy(const char src[], const char dst[]);
+static int cancel_countdown(void *arg);
+static char options_prompt_resume(const custom_prompt_t *details);
+
+static int resume_offered;
+static char *saved_cwd;
+
+SETUP()
+{
+	saved_cwd = save_cwd();
+
+	regs_init();
+
+	view_setup(&lwin);
+	make_abs_path(lwin.curr_dir, sizeof(lwin.curr_dir), SANDBOX_PATH, "to",
+			saved_cwd);
+	curr_view = NULL;
+
+	fops_init(NULL, &options_prompt_resume);
+	resume_offered = 0;
+}
+
+TEARDOWN()
+{
+	view_teardown(&lwin);
+	regs_reset();
+	restore_cwd(saved_cwd);
+	fops_init(NULL, NULL);
+}
+
+TEST(interrupted_copy_can_be_continued_on_put, IF(not_windows))
+{
+	char src[PATH_MAX + 1], dst[PATH_MAX + 1];
+	make_abs_path(src, sizeof(src), SANDBOX_PATH, "from/dir", saved_cwd);
+	make_abs_path(dst, sizeof(dst), SANDBOX_PATH, "to/dir", saved_cwd);
+
+	create_dir(SANDBOX_PATH "/from");
+	create_dir(SANDBOX_PATH "/from/dir");
+	make_file(SANDBOX_PATH "/from/dir/a", "first");
+	make_file(SANDBOX_PATH "/from/dir/b", "second");
+	create_dir(SANDBOX_PATH "/to");
+	interrupt_copy(src, dst);
+
+	assert_success(regs_append('a', src));
+	(void)fops_put(&lwin, /*at=*/-1, /*reg_name=*/'a', /*move=*/0);
+	assert_true(resume_offered);
+
+	file_is(SANDBOX_PATH "/to/dir/a", (const char *[]){ "first" }, 1);
+	file_is(SANDBOX_PATH "/to/dir/b", (const char *[]){ "second" }, 1);
+	assert_false(ior_can_resume(src, dst));
+
+	remove_file(SANDBOX_PATH "/from/dir/a");
+	remove_file(SANDBOX_PATH "/from/dir/b");
+	remove_dir(SANDBOX_PATH "/from/dir");
+	remove_dir(SANDBOX_PATH "/from");
+	remove_file(SANDBOX_PATH "/to/dir/a");
+	remove_file(SANDBOX_PATH "/to/dir/b");
+	remove_dir(SANDBOX_PATH "/to/dir");
+	remove_dir(SANDBOX_PATH "/to");
+}
+
+TEST(continuing_is_not_offered_without_journal, IF(not_windows))
+{
+	char src[PATH_MAX + 1];
+	make_abs_path(src, sizeof(src), SANDBOX_PATH, "from/dir", saved_cwd);
+
+	create_dir(SANDBOX_PATH "/from");
+	create_dir(SANDBOX_PATH "/from/dir");
+	create_dir(SANDBOX_PATH "/to");
+	create_dir(SANDBOX_PATH "/to/dir");
+
+	assert_success(regs_append('a', src));
+	(void)fops_put(&lwin, /*at=*/-1, /*reg_name=*/'a', /*move=*/0);
+	assert_false(resume_offered);
+
+	remove_dir(SANDBOX_PATH "/from/dir");
+	remove_dir(SANDBOX_PATH "/from");
+	remove_dir(SANDBOX_PATH "/to/dir");
+	remove_dir(SANDBOX_PATH "/to");
+}
+
+/* Starts copying src to dst and cancels it in the middle. */
+static void
+interrupt_copy(const char src[], const char dst[])
+{
+	int countdown = 2;
+	io_args_t args = {
+		.arg1.src = src,
+		.arg2.dst = dst,
+		.cancellation = { .hook = &cancel_countdown, .arg = &countdown },
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	assert_false(ior_cp(&args) == IO_RES_SUCCEEDED);
+	ioe_errlst_free(&args.result.errors);
+
+	assert_true(ior_can_resume(src, dst));
+}
+
+/* Requests cancellation after specified number of checks. */
+static int
+cancel_countdown(void *arg)
+{
+	int *const countdown = arg;
+	return --*countdown < 0;
+}
+
+/* Picks continuation of interrupted copy if it's offered, otherwise aborts. */
+static char
+options_prompt_resume(const custom_prompt_t *details)
+{
+	const response_variant *variant;
+	for(variant = details->variants; variant->key != '\0'; ++variant)
+	{
+		if(variant->key == 'c')
+		{
+			resume_offered = 1;
+			return 'c';
+		}
+	}
+	return NC_C_c;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
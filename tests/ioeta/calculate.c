@@ -64,6 +64,96 @@ TEST(shallow_estimation_does_not_recur)
 	ioeta_free(estim);
 }
 
+TEST(asynchronous_estimation_gives_the_same_results)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	ioeta_calculate_async(estim, TEST_DATA_PATH "/existing-files", 0);
+	ioeta_calculate_async(estim, TEST_DATA_PATH "/various-sizes", 0);
+	ioeta_async_wait(estim);
+
+	assert_int_equal(10, estim->total_items);
+	assert_int_equal(0, estim->current_item);
+	assert_int_equal(73728, estim->total_bytes);
+	assert_int_equal(0, estim->current_byte);
+
+	/* Estimation is restarted after it has finished. */
+	ioeta_calculate_async(estim, TEST_DATA_PATH "/existing-files", 0);
+	ioeta_async_wait(estim);
+	assert_int_equal(13, estim->total_items);
+
+	ioeta_free(estim);
+}
+
+TEST(asynchronous_shallow_estimation_is_synchronous)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	ioeta_calculate_async(estim, TEST_DATA_PATH "/various-sizes", 1);
+
+	assert_null(estim->async);
+	assert_int_equal(1, estim->total_items);
+	assert_int_equal(0, estim->total_bytes);
+
+	ioeta_free(estim);
+}
+
+TEST(asynchronous_estimation_can_be_abandoned)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	ioeta_calculate_async(estim, TEST_DATA_PATH, 0);
+	ioeta_calculate_async(estim, TEST_DATA_PATH, 0);
+
+	ioeta_free(estim);
+}
+
+TEST(results_of_asynchronous_estimation_survive_restore)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	ioeta_estim_t save = ioeta_save(estim);
+	ioeta_calculate_async(estim, TEST_DATA_PATH "/various-sizes", 0);
+	ioeta_async_wait(estim);
+	ioeta_restore(estim, &save);
+	ioeta_release(&save);
+
+	assert_int_equal(7, estim->total_items);
+	assert_int_equal(73728, estim->total_bytes);
+
+	ioeta_free(estim);
+}
+
+TEST(progress_and_asynchronous_estimation_are_not_summed)
+{
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	/* Processing gets ahead of estimation. */
+	ioeta_update_bulk(estim, "a", 3, 1000);
+	assert_int_equal(3, estim->total_items);
+	assert_int_equal(1000, estim->total_bytes);
+
+	/* Estimation catches up without counting processed items twice. */
+	ioeta_calculate_async(estim, TEST_DATA_PATH "/various-sizes", 0);
+	ioeta_async_wait(estim);
+	assert_int_equal(7, estim->total_items);
+	assert_int_equal(73728, estim->total_bytes);
+
+	/* Progress within estimates doesn't change them. */
+	ioeta_update(estim, "b", "b", 1, 100);
+	assert_int_equal(4, estim->current_item);
+	assert_int_equal(7, estim->total_items);
+	assert_int_equal(73728, estim->total_bytes);
+
+	/* Processing gets ahead of estimation again. */
+	ioeta_update_bulk(estim, "c", 5, 80000);
+	ioeta_async_merge(estim);
+	assert_int_equal(9, estim->total_items);
+	assert_int_equal(81100, estim->total_bytes);
+
+	ioeta_free(estim);
+}
+
 #ifndef _WIN32
 
 TEST(symlink_calculated_as_zero_bytes)
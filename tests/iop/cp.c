@@ -6,10 +6,12 @@
 #endif
 #include <sys/stat.h> /* chmod() stat */
 #include <sys/types.h> /* stat */
-#include <unistd.h> /* _Exit() lstat() */
+#include <unistd.h> /* _Exit() lstat() truncate() */
 
 #include <signal.h> /* SIGXFSZ SIG_IGN signal() */
+#include <stdio.h> /* FILE fclose() fopen() fputc() */
 #include <stdlib.h> /* EXIT_FAILURE EXIT_SUCCESS */
+#include <time.h> /* CLOCK_MONOTONIC clock_gettime() timespec */
 
 #include <test-utils.h>
 
@@ -561,6 +563,82 @@ TEST(append_truncates_destination_files_on_error, IF(not_windows))
 	delete_test_file(SANDBOX_PATH "/two-lines");
 }
 
+/* Creates file of specified size filled with non-repeating pattern. */
+static void
+make_file_of_size(const char path[], int size)
+{
+	FILE *const f = fopen(path, "wb");
+	assert_non_null(f);
+
+	int i;
+	for(i = 0; i < size; ++i)
+	{
+		(void)fputc(i%251, f);
+	}
+	fclose(f);
+}
+
+TEST(file_can_be_copied_without_caching)
+{
+	/* Size that isn't a multiple of block size nor of I/O alignment. */
+	make_file_of_size(SANDBOX_PATH "/big", 3*1024*1024 + 123);
+
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/big",
+		.arg2.dst = SANDBOX_PATH "/big-copy",
+		.arg4.no_cache = 1,
+		.arg4.direct_io = 1,
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	assert_int_equal(IO_RES_SUCCEEDED, iop_cp(&args));
+	assert_int_equal(0, args.result.errors.error_count);
+
+	assert_true(files_are_identical(SANDBOX_PATH "/big",
+				SANDBOX_PATH "/big-copy"));
+
+	/* Appending continues from unaligned offset. */
+	assert_success(truncate(SANDBOX_PATH "/big-copy", 1000));
+	args.arg3.crs = IO_CRS_APPEND_TO_FILES;
+	assert_int_equal(IO_RES_SUCCEEDED, iop_cp(&args));
+	assert_int_equal(0, args.result.errors.error_count);
+
+	assert_true(files_are_identical(SANDBOX_PATH "/big",
+				SANDBOX_PATH "/big-copy"));
+
+	delete_test_file(SANDBOX_PATH "/big");
+	delete_test_file(SANDBOX_PATH "/big-copy");
+}
+
+TEST(speed_of_copying_can_be_limited)
+{
+	make_file_of_size(SANDBOX_PATH "/file", 64*1024 + 1);
+
+	io_args_t args = {
+		.arg1.src = SANDBOX_PATH "/file",
+		.arg2.dst = SANDBOX_PATH "/file-copy",
+		.arg4.rate_limit = 320,
+	};
+	ioe_errlst_init(&args.result.errors);
+
+	struct timespec start, end;
+	assert_success(clock_gettime(CLOCK_MONOTONIC, &start));
+	assert_int_equal(IO_RES_SUCCEEDED, iop_cp(&args));
+	assert_success(clock_gettime(CLOCK_MONOTONIC, &end));
+	assert_int_equal(0, args.result.errors.error_count);
+
+	/* 64 KiB at 320 KiB/s take at least 200 ms. */
+	const long elapsed_ms = (end.tv_sec - start.tv_sec)*1000
+	                      + (end.tv_nsec - start.tv_nsec)/1000000;
+	assert_true(elapsed_ms >= 190);
+
+	assert_true(files_are_identical(SANDBOX_PATH "/file",
+				SANDBOX_PATH "/file-copy"));
+
+	delete_test_file(SANDBOX_PATH "/file");
+	delete_test_file(SANDBOX_PATH "/file-copy");
+}
+
 #endif
 
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
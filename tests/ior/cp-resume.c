@@ -0,0 +1,222 @@
+#include <stic.h>
+
+#include <sys/stat.h> /* stat */
+
+#include <stdio.h> /* FILE fclose() fopen() fprintf() */
+
+#include <test-utils.h>
+
+#include "../../src/compat/os.h"
+#include "../../src/io/ioeta.h"
+#include "../../src/io/ior.h"
+
+#include "utils.h"
+
+static int cancel_countdown(void *arg);
+
+TEST(interrupted_copy_of_directory_can_be_continued, IF(not_windows))
+{
+	create_empty_dir(SANDBOX_PATH "/from");
+	create_empty_dir(SANDBOX_PATH "/from/sub");
+	make_file(SANDBOX_PATH "/from/a", "first");
+	make_file(SANDBOX_PATH "/from/sub/b", "second");
+	make_file(SANDBOX_PATH "/from/sub/c", "third");
+
+	{
+		int countdown = 4;
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.cancellation = { .hook = &cancel_countdown, .arg = &countdown },
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_false(ior_cp(&args) == IO_RES_SUCCEEDED);
+		ioe_errlst_free(&args.result.errors);
+	}
+
+	assert_true(ior_can_resume(SANDBOX_PATH "/from", SANDBOX_PATH "/to"));
+	assert_false(ior_can_resume(SANDBOX_PATH "/from/sub", SANDBOX_PATH "/to"));
+
+	{
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.arg3.crs = IO_CRS_APPEND_TO_FILES,
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_int_equal(IO_RES_SUCCEEDED, ior_cp(&args));
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	assert_false(ior_can_resume(SANDBOX_PATH "/from", SANDBOX_PATH "/to"));
+	assert_false(file_exists(SANDBOX_PATH "/.to.vifm-journal"));
+
+	file_is(SANDBOX_PATH "/to/a", (const char *[]){ "first" }, 1);
+	file_is(SANDBOX_PATH "/to/sub/b", (const char *[]){ "second" }, 1);
+	file_is(SANDBOX_PATH "/to/sub/c", (const char *[]){ "third" }, 1);
+
+	delete_tree(SANDBOX_PATH "/from");
+	delete_tree(SANDBOX_PATH "/to");
+}
+
+TEST(continuing_copy_relies_on_journal, IF(not_windows))
+{
+	struct stat partial, done;
+
+	create_empty_dir(SANDBOX_PATH "/from");
+	make_file(SANDBOX_PATH "/from/partial", "0123456789");
+	make_file(SANDBOX_PATH "/from/done", "abcd");
+	make_file(SANDBOX_PATH "/from/new", "new");
+	assert_success(os_stat(SANDBOX_PATH "/from/partial", &partial));
+	assert_success(os_stat(SANDBOX_PATH "/from/done", &done));
+
+	create_empty_dir(SANDBOX_PATH "/to");
+	/* Only the beginning is known to have reached storage. */
+	make_file(SANDBOX_PATH "/to/partial", "01234garbage");
+	/* Different contents proves that the file isn't copied again. */
+	make_file(SANDBOX_PATH "/to/done", "ABCD");
+
+	FILE *const fp = fopen(SANDBOX_PATH "/.to.vifm-journal", "w");
+	assert_non_null(fp);
+	fprintf(fp, "vifm copy journal 1\n%s\n", SANDBOX_PATH "/from");
+	fprintf(fp, "f 10 %lld /partial\n", (long long)partial.st_mtime);
+	fprintf(fp, "s 5 /partial\n");
+	fprintf(fp, "f 4 %lld /done\n", (long long)done.st_mtime);
+	fprintf(fp, "d /done\n");
+	fprintf(fp, "f 3 0 /new");
+	fclose(fp);
+
+	const io_cancellation_t no_cancellation = {};
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	{
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.arg3.crs = IO_CRS_APPEND_TO_FILES,
+			.estim = estim,
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_int_equal(IO_RES_SUCCEEDED, ior_cp(&args));
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	assert_int_equal(10 + 4 + 3, estim->current_byte);
+	ioeta_free(estim);
+
+	file_is(SANDBOX_PATH "/to/partial", (const char *[]){ "0123456789" }, 1);
+	file_is(SANDBOX_PATH "/to/done", (const char *[]){ "ABCD" }, 1);
+	file_is(SANDBOX_PATH "/to/new", (const char *[]){ "new" }, 1);
+	assert_false(file_exists(SANDBOX_PATH "/.to.vifm-journal"));
+
+	delete_tree(SANDBOX_PATH "/from");
+	delete_tree(SANDBOX_PATH "/to");
+}
+
+TEST(interrupted_move_of_directory_can_be_continued, IF(not_windows))
+{
+	create_empty_dir(SANDBOX_PATH "/from");
+	make_file(SANDBOX_PATH "/from/a", "first");
+	make_file(SANDBOX_PATH "/from/b", "second");
+
+	{
+		/* Moving across file systems is done by copying. */
+		int countdown = 2;
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.cancellation = { .hook = &cancel_countdown, .arg = &countdown },
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_false(ior_cp(&args) == IO_RES_SUCCEEDED);
+		ioe_errlst_free(&args.result.errors);
+	}
+
+	{
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.arg3.crs = IO_CRS_APPEND_TO_FILES,
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_int_equal(IO_RES_SUCCEEDED, ior_mv(&args));
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	assert_false(file_exists(SANDBOX_PATH "/from"));
+	assert_false(file_exists(SANDBOX_PATH "/.to.vifm-journal"));
+	file_is(SANDBOX_PATH "/to/a", (const char *[]){ "first" }, 1);
+	file_is(SANDBOX_PATH "/to/b", (const char *[]){ "second" }, 1);
+
+	delete_tree(SANDBOX_PATH "/to");
+}
+
+TEST(journal_is_removed_with_destination, IF(not_windows))
+{
+	create_empty_dir(SANDBOX_PATH "/from");
+	make_file(SANDBOX_PATH "/from/a", "first");
+	make_file(SANDBOX_PATH "/from/b", "second");
+
+	{
+		int countdown = 2;
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.cancellation = { .hook = &cancel_countdown, .arg = &countdown },
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_false(ior_cp(&args) == IO_RES_SUCCEEDED);
+		ioe_errlst_free(&args.result.errors);
+	}
+
+	assert_true(file_exists(SANDBOX_PATH "/.to.vifm-journal"));
+
+	/* User deletes partial copy instead of continuing it. */
+	delete_tree(SANDBOX_PATH "/to");
+
+	assert_false(ior_can_resume(SANDBOX_PATH "/from", SANDBOX_PATH "/to"));
+	assert_false(file_exists(SANDBOX_PATH "/.to.vifm-journal"));
+
+	delete_tree(SANDBOX_PATH "/from");
+}
+
+TEST(copy_that_created_nothing_leaves_no_journal, IF(not_windows))
+{
+	create_empty_dir(SANDBOX_PATH "/from");
+	make_file(SANDBOX_PATH "/from/a", "first");
+
+	{
+		int countdown = 0;
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.cancellation = { .hook = &cancel_countdown, .arg = &countdown },
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_false(ior_cp(&args) == IO_RES_SUCCEEDED);
+		ioe_errlst_free(&args.result.errors);
+	}
+
+	assert_false(file_exists(SANDBOX_PATH "/to"));
+	assert_false(file_exists(SANDBOX_PATH "/.to.vifm-journal"));
+
+	delete_tree(SANDBOX_PATH "/from");
+}
+
+/* Requests cancellation after specified number of checks. */
+static int
+cancel_countdown(void *arg)
+{
+	int *const countdown = arg;
+	return --*countdown < 0;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
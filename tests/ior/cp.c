@@ -4,9 +4,14 @@
 #include <sys/types.h> /* stat */
 #include <unistd.h> /* F_OK access() */
 
+#include <stdint.h> /* uint64_t */
+#include <stdio.h> /* snprintf() */
+
 #include <test-utils.h>
 
+#include "../../src/compat/fs_limits.h"
 #include "../../src/compat/os.h"
+#include "../../src/io/ioeta.h"
 #include "../../src/io/iop.h"
 #include "../../src/io/ior.h"
 #include "../../src/utils/fs.h"
@@ -652,6 +657,101 @@ TEST(symlink_to_dir_is_symlink_after_copy, IF(not_windows))
 	}
 }
 
+TEST(small_files_are_copied_with_their_attributes, IF(not_windows))
+{
+	create_empty_dir(SANDBOX_PATH "/from");
+	create_empty_dir(SANDBOX_PATH "/from/sub");
+	make_file(SANDBOX_PATH "/from/a", "first");
+	make_file(SANDBOX_PATH "/from/sub/b", "second");
+	create_empty_file(SANDBOX_PATH "/from/sub/empty");
+	assert_success(chmod(SANDBOX_PATH "/from/a", 0640));
+	assert_success(chmod(SANDBOX_PATH "/from/sub/b", 0751));
+	reset_timestamp(SANDBOX_PATH "/from/a");
+	reset_timestamp(SANDBOX_PATH "/from/sub/b");
+
+	const io_cancellation_t no_cancellation = {};
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	{
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.estim = estim,
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_int_equal(IO_RES_SUCCEEDED, ior_cp(&args));
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	assert_int_equal(11, estim->current_byte);
+	ioeta_free(estim);
+
+	file_is(SANDBOX_PATH "/to/a", (const char *[]){ "first" }, 1);
+	file_is(SANDBOX_PATH "/to/sub/b", (const char *[]){ "second" }, 1);
+	assert_int_equal(0, get_file_size(SANDBOX_PATH "/to/sub/empty"));
+
+	struct stat src, dst;
+	assert_success(os_stat(SANDBOX_PATH "/from/a", &src));
+	assert_success(os_stat(SANDBOX_PATH "/to/a", &dst));
+	assert_int_equal(0640, dst.st_mode & 07777);
+	assert_int_equal(src.st_mtime, dst.st_mtime);
+	assert_success(os_stat(SANDBOX_PATH "/from/sub/b", &src));
+	assert_success(os_stat(SANDBOX_PATH "/to/sub/b", &dst));
+	assert_int_equal(0751, dst.st_mode & 07777);
+	assert_int_equal(src.st_mtime, dst.st_mtime);
+
+	delete_tree(SANDBOX_PATH "/from");
+	delete_tree(SANDBOX_PATH "/to");
+}
+
+TEST(many_small_files_are_copied)
+{
+	enum { NFILES = 300 };
+
+	char path[PATH_MAX + 1];
+	char contents[32];
+	uint64_t size = 0U;
+	int i;
+
+	create_empty_dir(SANDBOX_PATH "/from");
+	for(i = 0; i < NFILES; ++i)
+	{
+		snprintf(path, sizeof(path), "%s/from/file%d", SANDBOX_PATH, i);
+		snprintf(contents, sizeof(contents), "file%d", i);
+		make_file(path, contents);
+		size += get_file_size(path);
+	}
+
+	const io_cancellation_t no_cancellation = {};
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	{
+		io_args_t args = {
+			.arg1.src = SANDBOX_PATH "/from",
+			.arg2.dst = SANDBOX_PATH "/to",
+			.estim = estim,
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_int_equal(IO_RES_SUCCEEDED, ior_cp(&args));
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	assert_int_equal(size, estim->current_byte);
+	ioeta_free(estim);
+
+	for(i = 0; i < NFILES; ++i)
+	{
+		snprintf(path, sizeof(path), "%s/to/file%d", SANDBOX_PATH, i);
+		snprintf(contents, sizeof(contents), "file%d", i);
+		file_is(path, (const char *[]){ contents }, 1);
+	}
+
+	delete_tree(SANDBOX_PATH "/from");
+	delete_tree(SANDBOX_PATH "/to");
+}
+
 static int
 confirm_overwrite(io_args_t *args, const char src[], const char dst[])
 {
@@ -2,7 +2,14 @@
 
 #include <unistd.h> /* F_OK access() */
 
+#include <stdio.h> /* FILE fclose() fopen() fputs() snprintf() */
+
+#include <test-utils.h>
+
+#include "../../src/compat/fs_limits.h"
 #include "../../src/compat/os.h"
+#include "../../src/io/ioeta.h"
+#include "../../src/io/iop.h"
 #include "../../src/io/ior.h"
 #include "../../src/utils/fs.h"
 
@@ -65,5 +72,89 @@ TEST(non_empty_directory_is_removed)
 	assert_failure(access(DIRECTORY_NAME, F_OK));
 }
 
+TEST(tree_is_removed_and_progress_is_reported)
+{
+	enum { NDIRS = 10, NSUBDIRS = 3, NFILES = 20 };
+
+	int i, j, k;
+	os_mkdir(DIRECTORY_NAME, 0700);
+	for(i = 0; i < NDIRS; ++i)
+	{
+		char path[PATH_MAX + 1];
+		snprintf(path, sizeof(path), "%s/dir%d", DIRECTORY_NAME, i);
+		os_mkdir(path, 0700);
+
+		for(j = 0; j < NSUBDIRS; ++j)
+		{
+			snprintf(path, sizeof(path), "%s/dir%d/sub%d", DIRECTORY_NAME, i, j);
+			os_mkdir(path, 0700);
+
+			for(k = 0; k < NFILES; ++k)
+			{
+				snprintf(path, sizeof(path), "%s/dir%d/sub%d/file%d", DIRECTORY_NAME,
+						i, j, k);
+				FILE *const f = fopen(path, "w");
+				assert_non_null(f);
+				fputs("1234", f);
+				fclose(f);
+			}
+		}
+	}
+
+	const io_cancellation_t no_cancellation = {};
+	ioeta_estim_t *const estim = ioeta_alloc(NULL, no_cancellation);
+
+	{
+		io_args_t args = {
+			.arg1.src = DIRECTORY_NAME,
+			.estim = estim,
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_int_equal(IO_RES_SUCCEEDED, ior_rm(&args));
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	assert_failure(access(DIRECTORY_NAME, F_OK));
+
+	const int nfiles = NDIRS*NSUBDIRS*NFILES;
+	assert_int_equal(nfiles + NDIRS*NSUBDIRS + NDIRS + 1, estim->current_item);
+	assert_int_equal(nfiles*4, estim->current_byte);
+
+	ioeta_free(estim);
+}
+
+TEST(symlinks_to_directories_are_not_followed, IF(not_windows))
+{
+	create_non_empty_dir(SANDBOX_PATH "/target", FILE_NAME);
+	os_mkdir(DIRECTORY_NAME, 0700);
+
+	{
+		io_args_t args = {
+			.arg1.path = SANDBOX_PATH "/target",
+			.arg2.target = DIRECTORY_NAME "/link",
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_int_equal(IO_RES_SUCCEEDED, iop_ln(&args));
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	{
+		io_args_t args = {
+			.arg1.src = DIRECTORY_NAME,
+		};
+		ioe_errlst_init(&args.result.errors);
+
+		assert_int_equal(IO_RES_SUCCEEDED, ior_rm(&args));
+		assert_int_equal(0, args.result.errors.error_count);
+	}
+
+	assert_failure(access(DIRECTORY_NAME, F_OK));
+	assert_success(access(SANDBOX_PATH "/target/" FILE_NAME, F_OK));
+
+	delete_tree(SANDBOX_PATH "/target");
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
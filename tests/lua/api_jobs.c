@@ -262,6 +262,114 @@ TEST(vifmjob_onexit_bad)
 			ui_sb_last());
 }
 
+TEST(vifmjob_streaming_requires_output)
+{
+	BLUA_ENDS(vlua, ": 'online' and 'onchunk' require 'iomode' to be \"r\"",
+			"vifm.startjob { cmd = 'echo', iomode = 'w', online = print }");
+}
+
+TEST(vifmjob_streaming_takes_stdout)
+{
+	BLUA_ENDS(vlua, ": Output of the job is passed to callbacks",
+			"job = vifm.startjob { cmd = 'echo', online = print }"
+			"job:stdout()");
+}
+
+TEST(vifmjob_online, IF(not_windows))
+{
+	var_t var = var_from_int(0);
+	setvar("v:jobcount", var);
+	var_free(var);
+
+	GLUA_EQ(vlua, "",
+			"lines = {}"
+			"info = { cmd = 'printf \"a\\nb\\r\\nc\"',"
+			"         online = function(line) lines[#lines + 1] = line end,"
+			"         onexit = function() lines[#lines + 1] = 'exit' end }"
+			"vifm.startjob(info)");
+
+	wait_for_job();
+	vlua_process_callbacks(vlua);
+
+	GLUA_EQ(vlua, "a|b|c|exit", "print(table.concat(lines, '|'))");
+}
+
+TEST(vifmjob_online_crlf_split_between_reads, IF(not_windows))
+{
+	var_t var = var_from_int(0);
+	setvar("v:jobcount", var);
+	var_free(var);
+
+	GLUA_EQ(vlua, "",
+			"lines = {}"
+			"info = { cmd = 'printf \"a\\r\"; sleep 0.2; printf \"\\nb\\r\\n\"',"
+			"         online = function(line) lines[#lines + 1] = line end }"
+			"vifm.startjob(info)");
+
+	/* Read "a\r" before the rest of the output is produced. */
+	usleep(100000);
+	vlua_process_callbacks(vlua);
+
+	wait_for_job();
+	vlua_process_callbacks(vlua);
+
+	GLUA_EQ(vlua, "a|b", "print(table.concat(lines, '|'))");
+}
+
+TEST(vifmjob_onchunk, IF(not_windows))
+{
+	var_t var = var_from_int(0);
+	setvar("v:jobcount", var);
+	var_free(var);
+
+	GLUA_EQ(vlua, "",
+			"out = ''"
+			"info = { cmd = 'printf \"a\\nb\"',"
+			"         onchunk = function(chunk) out = out .. chunk end }"
+			"vifm.startjob(info)");
+
+	wait_for_job();
+	vlua_process_callbacks(vlua);
+
+	GLUA_EQ(vlua, "a\nb", "print(out)");
+}
+
+TEST(vifmjob_wait_consumes_output, IF(not_windows))
+{
+	GLUA_EQ(vlua, "",
+			"lines = {}"
+			"info = { cmd = 'echo a; echo b',"
+			"         online = function(line) lines[#lines + 1] = line end }"
+			"vifm.startjob(info):wait()");
+
+	vlua_process_callbacks(vlua);
+
+	GLUA_EQ(vlua, "a|b", "print(table.concat(lines, '|'))");
+}
+
+TEST(vifmjob_large_output_is_streamed, IF(not_windows))
+{
+	GLUA_EQ(vlua, "",
+			"count = 0 "
+			"info = { cmd = 'seq 1 100000',"
+			"         online = function() count = count + 1 end }"
+			"vifm.startjob(info)");
+
+	/* The job can't finish without its output being consumed. */
+	int i;
+	for(i = 0; i < 1000; ++i)
+	{
+		vlua_process_callbacks(vlua);
+		if(vlua_run_string(vlua, "if count < 100000 then error() end") == 0)
+		{
+			break;
+		}
+		usleep(5000);
+	}
+
+	GLUA_EQ(vlua, "100000", "print(count)");
+}
+
 static void
 setup_io_tester(void)
 {
@@ -81,6 +81,29 @@ TEST(vifmview_entry)
 	GLUA_EQ(vlua, "nil", "print(vifm.currview():entry(3))");
 }
 
+TEST(vifmview_entries)
+{
+	lwin.dir_entry[0].size = 10;
+	lwin.dir_entry[0].type = FT_REG;
+	lwin.dir_entry[1].selected = 1;
+	lwin.dir_entry[1].type = FT_DIR;
+
+	GLUA_EQ(vlua, "",
+			"t = vifm.currview():entries({ fields = { 'name', 'size', 'type',"
+			"                                         'selected' } })");
+	GLUA_EQ(vlua, "2\t2\t2\t2", "print(#t.name, #t.size, #t.type, #t.selected)");
+	GLUA_EQ(vlua, "file0\t10\treg\tfalse",
+			"print(t.name[1], t.size[1], t.type[1], t.selected[1])");
+	GLUA_EQ(vlua, "file1\t0\tdir\ttrue",
+			"print(t.name[2], t.size[2], t.type[2], t.selected[2])");
+	GLUA_EQ(vlua, "nil", "print(t.mtime)");
+
+	BLUA_ENDS(vlua, ": Unknown entry field: bad",
+			"vifm.currview():entries({ fields = { 'bad' } })");
+	BLUA_ENDS(vlua, ": Field name must be a string",
+			"vifm.currview():entries({ fields = { {} } })");
+}
+
 TEST(vifmview_cursor)
 {
 	GLUA_EQ(vlua, "2", "print(vifm.currview().cursor.pos)");
@@ -1,12 +1,14 @@
 #include <stic.h>
 
-#include <string.h> /* memcpy() */
+#include <string.h> /* memcpy() strdup() */
 
 #include "../../src/lua/vlua.h"
 #include "../../src/ui/column_view.h"
 #include "../../src/ui/fileview.h"
 #include "../../src/ui/ui.h"
+#include "../../src/utils/dynarray.h"
 #include "../../src/opt_handlers.h"
+#include "../../src/status.h"
 
 #include <test-utils.h>
 
@@ -14,6 +16,8 @@
 
 static void column_line_print(const char buf[], int offset, AlignType align,
 		const char full_column[], const format_info_t *info);
+static void setup_entries(void);
+static const char * format_entry(int pos);
 
 enum { MAX_WIDTH = 40 };
 
@@ -175,6 +179,161 @@ TEST(symlinks, IF(not_windows))
 	remove_file(SANDBOX_PATH "/symlink");
 }
 
+TEST(values_are_cached)
+{
+	opt_handlers_setup();
+	lwin.columns = columns_create();
+	curr_stats.vlua = vlua;
+
+	GLUA_EQ(vlua, "",
+			"calls = 0\n"
+			"function handler(info)"
+			"  calls = calls + 1\n"
+			"  return { text = info.entry.name .. calls }"
+			"end");
+	GLUA_EQ(vlua, "true",
+			"print(vifm.addcolumntype { name = 'Test',"
+			"                           handler = handler,"
+			"                           cache = true })");
+
+	process_set_args("viewcolumns=-40{Test}", 0, 1);
+	columns_set_line_print_func(&column_line_print);
+
+	dir_entry_t entry = { .name = "name", .origin = "origin", .mtime = 1 };
+	column_data_t cdt = { .view = &lwin, .entry = &entry, .line_pos = -1 };
+	columns_format_line(lwin.columns, &cdt, MAX_WIDTH);
+	assert_string_equal("name1                                   ", print_buffer);
+	columns_format_line(lwin.columns, &cdt, MAX_WIDTH);
+	assert_string_equal("name1                                   ", print_buffer);
+
+	/* Modification invalidates the value. */
+	entry.mtime = 2;
+	columns_format_line(lwin.columns, &cdt, MAX_WIDTH);
+	assert_string_equal("name2                                   ", print_buffer);
+
+	vlua_viewcolumns_drop_cache(vlua);
+	columns_format_line(lwin.columns, &cdt, MAX_WIDTH);
+	assert_string_equal("name3                                   ", print_buffer);
+
+	opt_handlers_teardown();
+	curr_stats.vlua = NULL;
+}
+
+TEST(errors_are_not_cached)
+{
+	opt_handlers_setup();
+	lwin.columns = columns_create();
+	curr_stats.vlua = vlua;
+
+	GLUA_EQ(vlua, "",
+			"fail = true\n"
+			"function handler(info)"
+			"  if fail then error('failed') end\n"
+			"  return { text = 'ok' }"
+			"end");
+	GLUA_EQ(vlua, "true",
+			"print(vifm.addcolumntype { name = 'Test',"
+			"                           handler = handler,"
+			"                           cache = true })");
+
+	process_set_args("viewcolumns=-40{Test}", 0, 1);
+	columns_set_line_print_func(&column_line_print);
+
+	dir_entry_t entry = { .name = "name", .origin = "origin" };
+	column_data_t cdt = { .view = &lwin, .entry = &entry, .line_pos = -1 };
+	columns_format_line(lwin.columns, &cdt, MAX_WIDTH);
+	assert_string_equal("ERROR                                   ", print_buffer);
+
+	GLUA_EQ(vlua, "", "fail = false");
+	columns_format_line(lwin.columns, &cdt, MAX_WIDTH);
+	assert_string_equal("ok                                      ", print_buffer);
+
+	opt_handlers_teardown();
+	curr_stats.vlua = NULL;
+}
+
+TEST(batch_handler_receives_visible_entries)
+{
+	opt_handlers_setup();
+	lwin.columns = columns_create();
+	curr_stats.vlua = vlua;
+	setup_entries();
+
+	GLUA_EQ(vlua, "",
+			"calls = 0\n"
+			"function handler(info)"
+			"  calls = calls + 1\n"
+			"  local results = {}\n"
+			"  for i, entry in ipairs(info.entries) do"
+			"    results[i] = { text = entry.name .. '/' .. #info.entries }"
+			"  end\n"
+			"  return results "
+			"end");
+	GLUA_EQ(vlua, "true",
+			"print(vifm.addcolumntype { name = 'Test',"
+			"                           handler = handler,"
+			"                           batch = true })");
+
+	process_set_args("viewcolumns=-40{Test}", 0, 1);
+	columns_set_line_print_func(&column_line_print);
+
+	assert_string_equal("file1/2                                 ",
+			format_entry(1));
+	assert_string_equal("file0/2                                 ",
+			format_entry(0));
+	GLUA_EQ(vlua, "1", "print(calls)");
+
+	/* Entries outside of the window are processed one by one. */
+	assert_string_equal("file2/1                                 ",
+			format_entry(2));
+	GLUA_EQ(vlua, "2", "print(calls)");
+
+	opt_handlers_teardown();
+	curr_stats.vlua = NULL;
+}
+
+TEST(async_handler_sets_values_later)
+{
+	opt_handlers_setup();
+	lwin.columns = columns_create();
+	curr_stats.vlua = vlua;
+	setup_entries();
+
+	GLUA_EQ(vlua, "",
+			"function handler(info)"
+			"  set = info.set\n"
+			"  entries = info.entries\n"
+			"end");
+	GLUA_EQ(vlua, "true",
+			"print(vifm.addcolumntype { name = 'Test',"
+			"                           handler = handler,"
+			"                           batch = true,"
+			"                           async = true })");
+
+	process_set_args("viewcolumns=-40{Test}", 0, 1);
+	columns_set_line_print_func(&column_line_print);
+
+	assert_string_equal("                                        ",
+			format_entry(0));
+	GLUA_EQ(vlua, "2", "print(#entries)");
+
+	(void)stats_update_fetch();
+	GLUA_EQ(vlua, "", "set(2, { text = entries[2].name })");
+	assert_int_equal(UT_REDRAW, stats_update_fetch());
+
+	assert_string_equal("                                        ",
+			format_entry(0));
+	assert_string_equal("file1                                   ",
+			format_entry(1));
+
+	BLUA_ENDS(vlua, ": Entry index is out of range: 3", "set(3, {})");
+	BLUA_ENDS(vlua, "bad argument #2 to 'set' (table expected, got nil)",
+			"set(1, nil)");
+
+	opt_handlers_teardown();
+	curr_stats.vlua = NULL;
+}
+
 static void
 column_line_print(const char buf[], int offset, AlignType align,
 		const char full_column[], const format_info_t *info)
@@ -182,5 +341,34 @@ column_line_print(const char buf[], int offset, AlignType align,
 	memcpy(print_buffer + offset, buf, strlen(buf));
 }
 
+/* Fills the view with three entries two of which are visible. */
+static void
+setup_entries(void)
+{
+	strcpy(lwin.curr_dir, "/lwin");
+	lwin.list_rows = 3;
+	lwin.top_line = 0;
+	lwin.window_cells = 2;
+	lwin.dir_entry = dynarray_cextend(NULL,
+			lwin.list_rows*sizeof(*lwin.dir_entry));
+	lwin.dir_entry[0].name = strdup("file0");
+	lwin.dir_entry[0].origin = &lwin.curr_dir[0];
+	lwin.dir_entry[1].name = strdup("file1");
+	lwin.dir_entry[1].origin = &lwin.curr_dir[0];
+	lwin.dir_entry[2].name = strdup("file2");
+	lwin.dir_entry[2].origin = &lwin.curr_dir[0];
+}
+
+/* Formats line for an entry of the view.  Returns pointer to the result. */
+static const char *
+format_entry(int pos)
+{
+	column_data_t cdt = {
+		.view = &lwin, .entry = &lwin.dir_entry[pos], .line_pos = pos
+	};
+	columns_format_line(lwin.columns, &cdt, MAX_WIDTH);
+	return print_buffer;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
@@ -0,0 +1,106 @@
+#include <stic.h>
+
+#include <unistd.h> /* chdir() */
+
+#include <stdio.h> /* snprintf() */
+#include <string.h> /* strcpy() */
+
+#include <test-utils.h>
+
+#include "../../src/compat/fs_limits.h"
+#include "../../src/engine/keys.h"
+#include "../../src/menus/fuzzy_menu.h"
+#include "../../src/modes/menu.h"
+#include "../../src/modes/modes.h"
+#include "../../src/modes/wk.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/fs.h"
+#include "../../src/utils/path.h"
+#include "../../src/cmd_core.h"
+#include "../../src/filelist.h"
+#include "../../src/status.h"
+
+static char test_data[PATH_MAX + 1];
+
+SETUP_ONCE()
+{
+	char cwd[PATH_MAX + 1];
+	assert_non_null(get_cwd(cwd, sizeof(cwd)));
+	make_abs_path(test_data, sizeof(test_data), TEST_DATA_PATH, "tree", cwd);
+}
+
+SETUP()
+{
+	modes_init();
+	cmds_init();
+
+	curr_view = &lwin;
+	other_view = &rwin;
+	view_setup(&lwin);
+	view_setup(&rwin);
+	strcpy(lwin.curr_dir, test_data);
+
+	opt_handlers_setup();
+
+	curr_stats.load_stage = -1;
+}
+
+TEARDOWN()
+{
+	fuzzy_menu_reset();
+
+	opt_handlers_teardown();
+
+	vle_keys_reset();
+
+	view_teardown(&lwin);
+	view_teardown(&rwin);
+	curr_view = NULL;
+	other_view = NULL;
+
+	curr_stats.load_stage = 0;
+}
+
+TEST(matches_are_listed_in_menu)
+{
+	assert_success(cmds_dispatch("fuzzy file3", &lwin, CIT_COMMAND));
+
+	assert_int_equal(1, menu_get_current()->len);
+	assert_string_equal("dir1/dir2/dir4/file3", menu_get_current()->items[0]);
+	assert_string_equal("Fuzzy file3", menu_get_current()->title);
+
+	(void)vle_keys_exec(WK_ESC);
+}
+
+TEST(enter_navigates_to_matched_file)
+{
+	assert_success(chdir(test_data));
+	assert_success(cmds_dispatch("fuzzy d4f3", &lwin, CIT_COMMAND));
+
+	(void)vle_keys_exec(WK_CR);
+
+	char dst[PATH_MAX + 1];
+	snprintf(dst, sizeof(dst), "%s/dir1/dir2/dir4", test_data);
+	assert_true(paths_are_equal(lwin.curr_dir, dst));
+}
+
+TEST(matches_can_be_put_in_custom_view)
+{
+	assert_success(cmds_dispatch("fuzzy! file", &lwin, CIT_COMMAND));
+
+	assert_true(flist_custom_active(&lwin));
+	assert_int_equal(CV_VERY, lwin.custom.type);
+	assert_string_equal("Fuzzy file", lwin.custom.title);
+	assert_int_equal(5, lwin.list_rows);
+	assert_string_equal("file4", lwin.dir_entry[0].name);
+	assert_string_equal("file5", lwin.dir_entry[1].name);
+}
+
+TEST(no_matches_leave_view_intact)
+{
+	assert_failure(cmds_dispatch("fuzzy! nothing-matches", &lwin, CIT_COMMAND));
+	assert_false(flist_custom_active(&lwin));
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
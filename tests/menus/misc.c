@@ -1,6 +1,10 @@
 #include <stic.h>
 
+#include <unistd.h> /* usleep() */
+
 #include <stddef.h> /* NULL */
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* free() */
 #include <string.h> /* strcpy() */
 
 #include <test-utils.h>
@@ -9,9 +13,11 @@
 #include "../../src/compat/os.h"
 #include "../../src/cfg/config.h"
 #include "../../src/engine/keys.h"
+#include "../../src/engine/mode.h"
 #include "../../src/modes/menu.h"
 #include "../../src/modes/modes.h"
 #include "../../src/modes/wk.h"
+#include "../../src/menus/menus.h"
 #include "../../src/ui/statusbar.h"
 #include "../../src/ui/ui.h"
 #include "../../src/utils/str.h"
@@ -19,6 +25,9 @@
 #include "../../src/filelist.h"
 #include "../../src/status.h"
 
+static void make_locate_script(const char body[]);
+static void wait_for_menu(void);
+
 /* This tests various menus and generic things that need mode activation. */
 
 SETUP()
@@ -478,10 +487,12 @@ TEST(locate_menu_can_escape_args, IF(not_windows))
 			"for arg; do echo \"$arg\"; done\n");
 
 	assert_success(cmds_dispatch("locate a  b", &lwin, CIT_COMMAND));
+	wait_for_menu();
 	assert_int_equal(1, menu_get_current()->len);
 	assert_string_equal("a  b", menu_get_current()->items[0]);
 
 	assert_success(cmds_dispatch("locate -a  b", &lwin, CIT_COMMAND));
+	wait_for_menu();
 	assert_int_equal(2, menu_get_current()->len);
 	assert_string_equal("-a", menu_get_current()->items[0]);
 	assert_string_equal("b", menu_get_current()->items[1]);
@@ -503,11 +514,13 @@ TEST(can_start_menu_from_menus, IF(not_windows))
 
 	/* Start menu mode with a :grep. */
 	assert_success(cmds_dispatch1("grep endif", &lwin, CIT_COMMAND));
+	wait_for_menu();
 	assert_string_equal("Grep endif", menu_get_current()->title);
 	assert_int_equal(4, menu_get_current()->len);
 
 	/* Run a new :grep while in menu mode. */
 	assert_success(cmds_dispatch1("grep finish", &lwin, CIT_MENU_COMMAND));
+	wait_for_menu();
 	assert_string_equal("Grep finish", menu_get_current()->title);
 	assert_int_equal(2, menu_get_current()->len);
 
@@ -538,11 +551,13 @@ TEST(find_cmd, IF(not_windows))
 
 	/* Start menu mode with a :find. */
 	assert_success(cmds_dispatch1("find *.vifm", &lwin, CIT_COMMAND));
+	wait_for_menu();
 	assert_string_equal("Find *.vifm", menu_get_current()->title);
 	assert_int_equal(7, menu_get_current()->len);
 
 	/* Run a new good :find while in menu mode. */
 	assert_success(cmds_dispatch1("find finish-*.%c:e", &lwin, CIT_MENU_COMMAND));
+	wait_for_menu();
 	assert_string_equal("Find finish-*.vifm", menu_get_current()->title);
 	assert_int_equal(2, menu_get_current()->len);
 
@@ -554,5 +569,89 @@ TEST(find_cmd, IF(not_windows))
 	opt_handlers_teardown();
 }
 
+TEST(menu_is_displayed_before_command_finishes, IF(not_windows))
+{
+	char flag_path[PATH_MAX + 1];
+	make_abs_path(flag_path, sizeof(flag_path), SANDBOX_PATH, "flag", NULL);
+
+	char script[PATH_MAX*2];
+	snprintf(script, sizeof(script),
+			"echo first\n"
+			"while [ ! -f '%s' ]; do sleep 0.01; done\n"
+			"echo second\n", flag_path);
+	make_locate_script(script);
+
+	assert_success(cmds_dispatch("locate x", &lwin, CIT_COMMAND));
+	assert_true(vle_mode_is(MENU_MODE));
+
+	menu_data_t *menu = menu_get_current();
+	assert_int_equal(1, menu->len);
+	assert_string_equal("first", menu->items[0]);
+	assert_non_null(menu->stream);
+
+	/* Search covers items that are added later. */
+	(void)menus_search("second", menu, /*print_errors=*/0);
+	assert_int_equal(0, menus_search_matched(menu));
+
+	create_file(flag_path);
+	wait_for_menu();
+
+	assert_int_equal(2, menu->len);
+	assert_string_equal("first", menu->items[0]);
+	assert_string_equal("second", menu->items[1]);
+	assert_int_equal(1, menus_search_matched(menu));
+
+	(void)vle_keys_exec(WK_ESC);
+
+	remove_file(flag_path);
+	remove_file(SANDBOX_PATH "/script");
+}
+
+TEST(ctrl_c_stops_loading_of_menu, IF(not_windows))
+{
+	make_locate_script("while true; do echo line; sleep 0.01; done\n");
+
+	assert_success(cmds_dispatch("locate x", &lwin, CIT_COMMAND));
+	menu_data_t *menu = menu_get_current();
+	assert_non_null(menu->stream);
+
+	(void)vle_keys_exec(WK_C_c);
+	assert_true(vle_mode_is(MENU_MODE));
+	assert_null(menu->stream);
+	assert_true(menu->len > 0);
+	assert_true(ends_with(menu->title, "(cancelled)"));
+
+	(void)vle_keys_exec(WK_C_c);
+	assert_false(vle_mode_is(MENU_MODE));
+
+	remove_file(SANDBOX_PATH "/script");
+}
+
+/* Makes a shell script with the specified body to be used by :locate. */
+static void
+make_locate_script(const char body[])
+{
+	char script_path[PATH_MAX + 1];
+	make_abs_path(script_path, sizeof(script_path), SANDBOX_PATH, "script", NULL);
+	update_string(&cfg.locate_prg, script_path);
+
+	char *const script = format_str("#!/bin/sh\n%s", body);
+	create_executable(SANDBOX_PATH "/script");
+	make_file(SANDBOX_PATH "/script", script);
+	free(script);
+}
+
+/* Waits until all items of the current menu are loaded. */
+static void
+wait_for_menu(void)
+{
+	menu_data_t *const menu = menu_get_current();
+	while(menu->stream != NULL)
+	{
+		usleep(1000);
+		modmenu_check_for_updates();
+	}
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
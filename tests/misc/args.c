@@ -232,6 +232,18 @@ TEST(remote_expr_is_parsed, IF(with_remote_cmds))
 	args_free(&args);
 }
 
+TEST(remote_batch_is_parsed, IF(with_remote_cmds))
+{
+	args_t args = { };
+	char *argv[] = { "vifm", "--server-name", "name", "--remote-batch", "-",
+		NULL };
+
+	args_parse(&args, ARRAY_LEN(argv) - 1U, argv, "/");
+	assert_string_equal("-", args.remote_batch);
+	assert_string_equal("name", args.target_name);
+	args_free(&args);
+}
+
 TEST(server_name_becomes_target_name, IF(with_remote_cmds))
 {
 	args_t args = { };
@@ -8,6 +8,7 @@
 
 #include <test-utils.h>
 
+#include "../../src/cfg/config.h"
 #include "../../src/compat/pthread.h"
 #include "../../src/engine/var.h"
 #include "../../src/engine/variables.h"
@@ -19,9 +20,23 @@
 #include "../../src/signals.h"
 #include "../../src/status.h"
 
+/* State of a task that waits for a permission to finish. */
+typedef struct
+{
+	int started; /* Whether the task has started. */
+	int open;    /* Whether the task can finish. */
+}
+gate_t;
+
 static void on_job_exit(struct bg_job_t *job, void *data);
 static void task(bg_op_t *bg_op, void *arg);
 static void wait_until_locked(pthread_spinlock_t *lock);
+static void gated_task(bg_op_t *bg_op, void *arg);
+static void open_gate(gate_t *gate);
+static int gate_started(gate_t *gate);
+static void wait_gate_start(gate_t *gate);
+
+static pthread_mutex_t gates_lock = PTHREAD_MUTEX_INITIALIZER;
 
 SETUP_ONCE()
 {
@@ -134,6 +149,32 @@ TEST(jobcount_variable_gets_updated)
 	pthread_spin_destroy(&locks[1]);
 }
 
+TEST(tasks_do_not_wait_for_operations)
+{
+	gate_t gates[3] = {};
+
+	cfg.bg_threads = 2;
+
+	assert_success(bg_execute("op1", "", 0, 1, &gated_task, &gates[0]));
+	assert_success(bg_execute("op2", "", 0, 1, &gated_task, &gates[1]));
+	assert_success(bg_execute("task", "", 0, 0, &gated_task, &gates[2]));
+
+	/* The second operation waits, because the other worker is for tasks. */
+	wait_gate_start(&gates[0]);
+	wait_gate_start(&gates[2]);
+	usleep(20000);
+	assert_false(gate_started(&gates[1]));
+
+	open_gate(&gates[0]);
+	wait_gate_start(&gates[1]);
+
+	open_gate(&gates[1]);
+	open_gate(&gates[2]);
+	wait_for_all_bg();
+
+	cfg.bg_threads = 0;
+}
+
 TEST(job_can_survive_on_its_own)
 {
 	assert_success(bg_run_external("exit 71", 1, SHELL_BY_APP, NULL));
@@ -298,6 +339,54 @@ task(bg_op_t *bg_op, void *arg)
 	pthread_spin_unlock(&locks[0]);
 }
 
+static void
+gated_task(bg_op_t *bg_op, void *arg)
+{
+	gate_t *const gate = arg;
+
+	pthread_mutex_lock(&gates_lock);
+	gate->started = 1;
+	while(!gate->open)
+	{
+		pthread_mutex_unlock(&gates_lock);
+		usleep(5000);
+		pthread_mutex_lock(&gates_lock);
+	}
+	pthread_mutex_unlock(&gates_lock);
+}
+
+static void
+open_gate(gate_t *gate)
+{
+	pthread_mutex_lock(&gates_lock);
+	gate->open = 1;
+	pthread_mutex_unlock(&gates_lock);
+}
+
+static int
+gate_started(gate_t *gate)
+{
+	pthread_mutex_lock(&gates_lock);
+	const int started = gate->started;
+	pthread_mutex_unlock(&gates_lock);
+	return started;
+}
+
+static void
+wait_gate_start(gate_t *gate)
+{
+	int counter = 0;
+	while(!gate_started(gate))
+	{
+		usleep(5000);
+		if(++counter > 100)
+		{
+			assert_fail("Waiting for too long.");
+			break;
+		}
+	}
+}
+
 static void
 wait_until_locked(pthread_spinlock_t *lock)
 {
@@ -0,0 +1,276 @@
+#include <stic.h>
+
+#include <stdio.h> /* snprintf() */
+
+#include <test-utils.h>
+
+#include "../../src/compat/fs_limits.h"
+#include "../../src/int/desktop.h"
+#include "../../src/utils/fs.h"
+#include "../../src/filetype.h"
+
+static desktop_db_t *db;
+static assoc_records_t handlers;
+
+SETUP()
+{
+	db = desktop_db_alloc(SANDBOX_PATH, NULL);
+	assert_non_null(db);
+}
+
+TEARDOWN()
+{
+	ft_assoc_records_free(&handlers);
+	desktop_db_free(db);
+	remove_dir_content(SANDBOX_PATH);
+}
+
+TEST(freeing_null_db_does_nothing)
+{
+	desktop_db_free(NULL);
+}
+
+TEST(handlers_are_found_by_mime_type)
+{
+	make_file(SANDBOX_PATH "/viewer.desktop",
+			"Name=Viewer\nExec=viewer %f\nMimeType=image/png;image/jpeg;\n");
+	make_file(SANDBOX_PATH "/editor.desktop",
+			"Name=Editor\nExec=editor --new\nMimeType=text/plain\n");
+	make_file(SANDBOX_PATH "/not-desktop",
+			"Name=Nope\nExec=nope\nMimeType=image/png\n");
+
+	desktop_db_find(db, "image/jpeg", &handlers);
+	assert_int_equal(1, handlers.count);
+	assert_string_equal("viewer %f", handlers.list[0].command);
+	assert_string_equal("Viewer", handlers.list[0].description);
+	ft_assoc_records_free(&handlers);
+
+	desktop_db_find(db, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	assert_string_equal("editor --new %f", handlers.list[0].command);
+	ft_assoc_records_free(&handlers);
+
+	desktop_db_find(db, "image", &handlers);
+	assert_int_equal(0, handlers.count);
+}
+
+TEST(subdirectories_are_processed)
+{
+	create_dir(SANDBOX_PATH "/sub");
+	make_file(SANDBOX_PATH "/sub/app.desktop",
+			"Name=App\nExec=app %U\nMimeType=text/plain;\n");
+
+	desktop_db_find(db, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	assert_string_equal("app %f", handlers.list[0].command);
+}
+
+TEST(files_are_not_reread_if_timestamps_are_unchanged)
+{
+	make_file(SANDBOX_PATH "/app.desktop",
+			"Name=App\nExec=app\nMimeType=text/plain;\n");
+	reset_timestamp(SANDBOX_PATH "/app.desktop");
+	reset_timestamp(SANDBOX_PATH);
+
+	desktop_db_find(db, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	ft_assoc_records_free(&handlers);
+
+	/* Emulate change that didn't update timestamps. */
+	make_file(SANDBOX_PATH "/app.desktop",
+			"Name=App\nExec=app\nMimeType=image/png;\n");
+	reset_timestamp(SANDBOX_PATH "/app.desktop");
+	reset_timestamp(SANDBOX_PATH);
+
+	desktop_db_find(db, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	ft_assoc_records_free(&handlers);
+
+	/* Adding a file does change it. */
+	make_file(SANDBOX_PATH "/other.desktop",
+			"Name=Other\nExec=other\nMimeType=text/plain;\n");
+
+	desktop_db_find(db, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	assert_string_equal("Other", handlers.list[0].description);
+	ft_assoc_records_free(&handlers);
+
+	desktop_db_find(db, "image/png", &handlers);
+	assert_int_equal(1, handlers.count);
+	assert_string_equal("App", handlers.list[0].description);
+}
+
+TEST(files_changed_in_place_are_reread)
+{
+	make_file(SANDBOX_PATH "/app.desktop",
+			"Name=App\nExec=app\nMimeType=text/plain;\n");
+	reset_timestamp(SANDBOX_PATH "/app.desktop");
+	reset_timestamp(SANDBOX_PATH);
+
+	desktop_db_find(db, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	ft_assoc_records_free(&handlers);
+
+	/* Directory's timestamp stays the same, but file's one changes. */
+	make_file(SANDBOX_PATH "/app.desktop",
+			"Name=App\nExec=app\nMimeType=image/png;\n");
+	reset_timestamp(SANDBOX_PATH);
+
+	desktop_db_find(db, "text/plain", &handlers);
+	assert_int_equal(0, handlers.count);
+	desktop_db_find(db, "image/png", &handlers);
+	assert_int_equal(1, handlers.count);
+}
+
+TEST(appearance_of_root_is_detected)
+{
+	desktop_db_t *const missing = desktop_db_alloc(SANDBOX_PATH "/apps", NULL);
+
+	desktop_db_find(missing, "text/plain", &handlers);
+	assert_int_equal(0, handlers.count);
+
+	create_dir(SANDBOX_PATH "/apps");
+	make_file(SANDBOX_PATH "/apps/app.desktop",
+			"Name=App\nExec=app\nMimeType=text/plain;\n");
+
+	desktop_db_find(missing, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+
+	desktop_db_free(missing);
+}
+
+TEST(all_mime_types_are_indexed_in_one_pass)
+{
+	enum { NFILES = 30 };
+
+	int i;
+	for(i = 0; i < NFILES; ++i)
+	{
+		char path[PATH_MAX + 1];
+		char contents[128];
+		snprintf(path, sizeof(path), "%s/app%d.desktop", SANDBOX_PATH, i);
+		snprintf(contents, sizeof(contents),
+				"Name=App%d\nExec=app%d\nMimeType=type/%d;text/plain;\n", i, i, i%10);
+		make_file(path, contents);
+		reset_timestamp(path);
+	}
+	reset_timestamp(SANDBOX_PATH);
+
+	desktop_db_find(db, "text/plain", &handlers);
+	assert_int_equal(NFILES, handlers.count);
+	ft_assoc_records_free(&handlers);
+
+	/* Timestamps are kept intact, so only the database knows old types. */
+	for(i = 0; i < NFILES; ++i)
+	{
+		char path[PATH_MAX + 1];
+		snprintf(path, sizeof(path), "%s/app%d.desktop", SANDBOX_PATH, i);
+		make_file(path, "Name=New\nExec=new\nMimeType=new/type;\n");
+		reset_timestamp(path);
+	}
+	reset_timestamp(SANDBOX_PATH);
+
+	for(i = 0; i < 10; ++i)
+	{
+		char type[16];
+		snprintf(type, sizeof(type), "type/%d", i);
+		desktop_db_find(db, type, &handlers);
+		assert_int_equal(NFILES/10, handlers.count);
+		ft_assoc_records_free(&handlers);
+	}
+
+	desktop_db_find(db, "new/type", &handlers);
+	assert_int_equal(0, handlers.count);
+}
+
+TEST(cache_is_used_by_another_database)
+{
+	create_dir(SANDBOX_PATH "/apps");
+	make_file(SANDBOX_PATH "/apps/app.desktop",
+			"Name=App\nExec=app\nMimeType=text/plain;\n");
+	reset_timestamp(SANDBOX_PATH "/apps/app.desktop");
+	reset_timestamp(SANDBOX_PATH "/apps");
+
+	desktop_db_t *cached = desktop_db_alloc(SANDBOX_PATH "/apps",
+			SANDBOX_PATH "/cache.json");
+	desktop_db_find(cached, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	ft_assoc_records_free(&handlers);
+	desktop_db_free(cached);
+
+	/* Timestamps are kept intact, so only the cache knows the old type. */
+	make_file(SANDBOX_PATH "/apps/app.desktop",
+			"Name=App\nExec=app\nMimeType=image/png;\n");
+	reset_timestamp(SANDBOX_PATH "/apps/app.desktop");
+	reset_timestamp(SANDBOX_PATH "/apps");
+
+	cached = desktop_db_alloc(SANDBOX_PATH "/apps", SANDBOX_PATH "/cache.json");
+	desktop_db_find(cached, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	assert_string_equal("app %f", handlers.list[0].command);
+	assert_string_equal("App", handlers.list[0].description);
+	ft_assoc_records_free(&handlers);
+	desktop_db_find(cached, "image/png", &handlers);
+	assert_int_equal(0, handlers.count);
+	desktop_db_free(cached);
+}
+
+TEST(stale_cache_is_ignored)
+{
+	create_dir(SANDBOX_PATH "/apps");
+	make_file(SANDBOX_PATH "/apps/app.desktop",
+			"Name=App\nExec=app\nMimeType=text/plain;\n");
+	reset_timestamp(SANDBOX_PATH "/apps");
+
+	desktop_db_t *cached = desktop_db_alloc(SANDBOX_PATH "/apps",
+			SANDBOX_PATH "/cache.json");
+	desktop_db_find(cached, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	ft_assoc_records_free(&handlers);
+	desktop_db_free(cached);
+
+	make_file(SANDBOX_PATH "/apps/other.desktop",
+			"Name=Other\nExec=other\nMimeType=text/plain;\n");
+
+	cached = desktop_db_alloc(SANDBOX_PATH "/apps", SANDBOX_PATH "/cache.json");
+	desktop_db_find(cached, "text/plain", &handlers);
+	assert_int_equal(2, handlers.count);
+	ft_assoc_records_free(&handlers);
+	desktop_db_free(cached);
+
+	/* Change of a file in place is detected as well. */
+	make_file(SANDBOX_PATH "/apps/app.desktop",
+			"Name=App\nExec=app\nMimeType=image/png;\n");
+	reset_timestamp(SANDBOX_PATH "/apps");
+
+	cached = desktop_db_alloc(SANDBOX_PATH "/apps", SANDBOX_PATH "/cache.json");
+	desktop_db_find(cached, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	assert_string_equal("Other", handlers.list[0].description);
+	desktop_db_free(cached);
+}
+
+TEST(unsuitable_cache_is_ignored)
+{
+	create_dir(SANDBOX_PATH "/apps");
+	make_file(SANDBOX_PATH "/apps/app.desktop",
+			"Name=App\nExec=app\nMimeType=text/plain;\n");
+
+	make_file(SANDBOX_PATH "/cache.json", "{");
+	desktop_db_t *cached = desktop_db_alloc(SANDBOX_PATH "/apps",
+			SANDBOX_PATH "/cache.json");
+	desktop_db_find(cached, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	ft_assoc_records_free(&handlers);
+	desktop_db_free(cached);
+
+	make_file(SANDBOX_PATH "/cache.json",
+			"{\"root\":\"/other\",\"dirs\":[],\"handlers\":{}}");
+	cached = desktop_db_alloc(SANDBOX_PATH "/apps", SANDBOX_PATH "/cache.json");
+	desktop_db_find(cached, "text/plain", &handlers);
+	assert_int_equal(1, handlers.count);
+	desktop_db_free(cached);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
@@ -3,6 +3,7 @@
 #include <unistd.h> /* unlink() */
 
 #include <stdio.h> /* fopen() fclose() */
+#include <stdlib.h> /* free() */
 #include <string.h> /* strcmp() */
 
 #include <test-utils.h>
@@ -15,6 +16,8 @@
 #include "../../src/utils/path.h"
 
 static void check_empty_file(const char fname[]);
+static int has_file_prog(void);
+static int has_file_prog_and_not_windows(void);
 static int has_mime_type_detection_and_symlinks(void);
 static int has_mime_type_detection_and_can_test_cache(void);
 static int has_mime_type_detection(void);
@@ -84,6 +87,75 @@ TEST(empty_magic_handlers_on_no_mime_type_detection,
 	remove_file(SANDBOX_PATH "/file");
 }
 
+TEST(file_prog_determines_types_of_many_files_in_order, IF(has_file_prog))
+{
+	char *paths[] = {
+		TEST_DATA_PATH "/read/two-lines",
+		TEST_DATA_PATH "/read/binary-data",
+		TEST_DATA_PATH "/read/very-long-line",
+	};
+	char *types[3];
+
+	assert_success(get_file_mimetypes(paths, 3, types));
+	assert_string_equal("text/plain", types[0]);
+	assert_false(strcmp("text/plain", types[1]) == 0);
+	assert_string_equal("text/plain", types[2]);
+
+	free(types[0]);
+	free(types[1]);
+	free(types[2]);
+}
+
+TEST(file_prog_skips_files_with_new_lines_in_names,
+		IF(has_file_prog_and_not_windows))
+{
+	copy_file(TEST_DATA_PATH "/read/binary-data", SANDBOX_PATH "/a\nb");
+
+	char *paths[] = {
+		TEST_DATA_PATH "/read/two-lines",
+		SANDBOX_PATH "/a\nb",
+		TEST_DATA_PATH "/read/binary-data",
+		TEST_DATA_PATH "/read/very-long-line",
+	};
+	char *types[4];
+
+	assert_success(get_file_mimetypes(paths, 4, types));
+	assert_string_equal("text/plain", types[0]);
+	assert_string_equal(NULL, types[1]);
+	assert_false(strcmp("text/plain", types[2]) == 0);
+	assert_string_equal("text/plain", types[3]);
+
+	free(types[0]);
+	free(types[2]);
+	free(types[3]);
+
+	assert_success(get_file_mimetypes(paths + 1, 1, types));
+	assert_string_equal(NULL, types[0]);
+
+	remove_file(SANDBOX_PATH "/a\nb");
+}
+
+TEST(prefetching_mimetypes_fills_cache,
+		IF(has_mime_type_detection_and_can_test_cache))
+{
+	copy_file(TEST_DATA_PATH "/read/very-long-line", SANDBOX_PATH "/text");
+	copy_file(TEST_DATA_PATH "/read/very-long-line", SANDBOX_PATH "/file");
+	reset_timestamp(SANDBOX_PATH "/text");
+	reset_timestamp(SANDBOX_PATH "/file");
+
+	char *paths[] = { SANDBOX_PATH "/text", SANDBOX_PATH "/file" };
+	prefetch_mimetypes(paths, 2);
+
+	/* Cached type is used for a file with the same timestamp. */
+	copy_file(TEST_DATA_PATH "/read/binary-data", SANDBOX_PATH "/file");
+	reset_timestamp(SANDBOX_PATH "/file");
+	assert_string_equal("text/plain", get_mimetype(SANDBOX_PATH "/file", 1));
+	assert_string_equal("text/plain", get_mimetype(SANDBOX_PATH "/text", 1));
+
+	remove_file(SANDBOX_PATH "/text");
+	remove_file(SANDBOX_PATH "/file");
+}
+
 static void
 check_empty_file(const char fname[])
 {
@@ -96,6 +168,31 @@ check_empty_file(const char fname[])
 	}
 }
 
+static int
+has_file_prog_and_not_windows(void)
+{
+#ifndef _WIN32
+	return has_file_prog();
+#else
+	return 0;
+#endif
+}
+
+static int
+has_file_prog(void)
+{
+	char *paths[] = { TEST_DATA_PATH "/read/two-lines" };
+	char *types[1];
+	if(get_file_mimetypes(paths, 1, types) != 0)
+	{
+		return 0;
+	}
+
+	const int works = (types[0] != NULL && strcmp(types[0], "text/plain") == 0);
+	free(types[0]);
+	return works;
+}
+
 static int
 has_mime_type_detection_and_symlinks(void)
 {
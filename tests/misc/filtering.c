@@ -1,6 +1,7 @@
 #include <stic.h>
 
 #include <limits.h> /* INT_MAX */
+#include <stdio.h> /* snprintf() */
 #include <stdlib.h> /* free() */
 #include <string.h> /* strcpy() strdup() */
 
@@ -31,6 +32,8 @@
 	assert_true( \
 			filters_file_is_visible(&view, flist_get_dir(&view), name, is_dir, 1))
 
+static void make_many_files(view_t *view, int n);
+
 static char cwd[PATH_MAX + 1];
 
 SETUP_ONCE()
@@ -527,5 +530,146 @@ TEST(case_is_ignored_by_noninteractive_local_filter)
 	cfg.ignore_case = 0;
 }
 
+TEST(extending_literal_local_filter_narrows_matches)
+{
+	assert_int_equal(0, local_filter_set(&lwin, "with"));
+	assert_int_equal(7, lwin.list_rows);
+	assert_int_equal(0, local_filter_set(&lwin, "withn"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("withnonodots", lwin.dir_entry[0].name);
+
+	/* Shortening the filter brings back files that were filtered out. */
+	assert_int_equal(0, local_filter_set(&lwin, "with"));
+	assert_int_equal(7, lwin.list_rows);
+
+	local_filter_cancel(&lwin);
+	assert_int_equal(7, lwin.list_rows);
+}
+
+TEST(extending_local_filter_with_regex_checks_all_files)
+{
+	assert_int_equal(0, local_filter_set(&lwin, "withn"));
+	assert_int_equal(1, lwin.list_rows);
+
+	assert_int_equal(0, local_filter_set(&lwin, "withn|round"));
+	assert_int_equal(2, lwin.list_rows);
+	assert_string_equal("with(round)", lwin.dir_entry[0].name);
+	assert_string_equal("withnonodots", lwin.dir_entry[1].name);
+
+	local_filter_cancel(&lwin);
+}
+
+TEST(making_local_filter_case_insensitive_checks_all_files)
+{
+	cfg.ignore_case = 1;
+	cfg.smart_case = 1;
+
+	assert_int_equal(0, local_filter_set(&lwin, "withS"));
+	assert_int_equal(1, lwin.list_rows);
+
+	/* Without upper case letters the filter starts ignoring case. */
+	assert_int_equal(0, local_filter_set(&lwin, "with"));
+	assert_int_equal(0, local_filter_set(&lwin, "withs"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("withSPECS+*^$?|\\", lwin.dir_entry[0].name);
+
+	local_filter_cancel(&lwin);
+
+	cfg.ignore_case = 0;
+	cfg.smart_case = 0;
+}
+
+TEST(narrowed_local_filter_is_accepted_correctly)
+{
+	assert_int_equal(0, local_filter_set(&lwin, "with"));
+	assert_int_equal(0, local_filter_set(&lwin, "with."));
+	assert_int_equal(0, local_filter_set(&lwin, "with\\."));
+	assert_int_equal(0, local_filter_set(&lwin, "with\\.\\."));
+	local_filter_accept(&lwin, /*update_history=*/0);
+
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("with....dots", lwin.dir_entry[0].name);
+}
+
+TEST(custom_tree_is_narrowed_by_local_filter)
+{
+	char test_data[PATH_MAX + 1];
+	char path[PATH_MAX + 1];
+
+	make_abs_path(test_data, sizeof(test_data), TEST_DATA_PATH, "", cwd);
+
+	flist_custom_start(&lwin, "test");
+	snprintf(path, sizeof(path), "%s/%s", test_data, "compare");
+	flist_custom_add(&lwin, path);
+	snprintf(path, sizeof(path), "%s/%s", test_data, "read");
+	flist_custom_add(&lwin, path);
+	snprintf(path, sizeof(path), "%s/%s", test_data, "rename");
+	flist_custom_add(&lwin, path);
+	snprintf(path, sizeof(path), "%s/%s", test_data, "tree");
+	flist_custom_add(&lwin, path);
+	assert_true(flist_custom_finish(&lwin, CV_REGULAR, 0) == 0);
+
+	assert_success(flist_load_tree(&lwin, test_data, INT_MAX));
+	assert_int_equal(5, lwin.list_rows);
+
+	assert_int_equal(0, local_filter_set(&lwin, "e"));
+	const int with_e = lwin.list_rows;
+	assert_int_equal(0, local_filter_set(&lwin, "re"));
+	assert_true(lwin.list_rows <= with_e);
+	assert_int_equal(0, local_filter_set(&lwin, "ren"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("rename", lwin.dir_entry[0].name);
+	assert_int_equal(0, lwin.dir_entry[0].child_count);
+
+	local_filter_accept(&lwin, /*update_history=*/0);
+	assert_int_equal(1, lwin.list_rows);
+}
+
+TEST(extending_local_filter_checks_only_previous_matches)
+{
+	make_many_files(&lwin, 100);
+
+	assert_int_equal(0, local_filter_set(&lwin, "file0000"));
+	assert_int_equal(10, lwin.list_rows);
+
+	/* Rename a file that didn't match, so that it matches extended filter, but
+	 * do it behind the back of the filter. */
+	dir_entry_t *const entry = &lwin.local_filter.unfiltered[50];
+	assert_string_equal("file00050", entry->name);
+	replace_string(&entry->name, "file00001-copy");
+
+	assert_int_equal(0, local_filter_set(&lwin, "file00001"));
+	assert_int_equal(1, lwin.list_rows);
+	assert_string_equal("file00001", lwin.dir_entry[0].name);
+
+	/* Not an extension of the previous filter, so all files are checked. */
+	assert_int_equal(0, local_filter_set(&lwin, "ile00001"));
+	assert_int_equal(2, lwin.list_rows);
+
+	local_filter_cancel(&lwin);
+	assert_int_equal(100, lwin.list_rows);
+}
+
+/* Replaces list of files of the view with n generated entries. */
+static void
+make_many_files(view_t *view, int n)
+{
+	free_dir_entries(&view->dir_entry, &view->list_rows);
+
+	view->dir_entry = dynarray_cextend(NULL, n*sizeof(*view->dir_entry));
+	view->list_rows = n;
+	view->list_pos = 0;
+	view->selected_files = 0;
+
+	int i;
+	for(i = 0; i < n; ++i)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "file%05d", i);
+		view->dir_entry[i].name = strdup(name);
+		view->dir_entry[i].origin = &view->curr_dir[0];
+	}
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
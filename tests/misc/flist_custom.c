@@ -294,6 +294,7 @@ TEST(unsorted_view_remains_one_on_vifminfo_reread_on_restart)
 	curr_stats.restart_in_progress = 1;
 	state_load(1);
 	curr_stats.restart_in_progress = 0;
+	cfg.config_dir[0] = '\0';
 
 	assert_true(lwin.custom.type == CV_VERY);
 	assert_int_equal(SK_NONE, lwin.sort[0]);
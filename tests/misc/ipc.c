@@ -1,14 +1,25 @@
 #include <stic.h>
 
+#ifndef _WIN32
+#include <sys/socket.h> /* AF_UNIX SOCK_STREAM bind() listen() socket() */
+#include <sys/stat.h> /* stat umask() */
+#include <sys/un.h> /* sockaddr_un */
+#include <unistd.h> /* chown() close() getuid() unlink() */
+#endif
+
 #include <stddef.h> /* NULL */
+#include <stdio.h> /* snprintf() */
 #include <stdlib.h> /* free() malloc() */
 #include <string.h> /* memset() strcmp() strdup() */
 
 #include <test-utils.h>
 
+#include "../../src/compat/fs_limits.h"
+#include "../../src/utils/path.h"
 #include "../../src/utils/str.h"
 #include "../../src/utils/string_array.h"
 #include "../../src/background.h"
+#include "../../src/instance.h"
 #include "../../src/ipc.h"
 
 static void test_ipc_args(char *args[]);
@@ -16,9 +27,12 @@ static void test_ipc_args2(char *args[]);
 static void recursive_ipc_args(char *args[]);
 static char * test_ipc_eval(const char expr[]);
 static char * test_ipc_eval_error(const char expr[]);
+static char * test_ipc_batch(const char batch[]);
+static char * slow_ipc_batch(const char batch[]);
 static void other_instance(bg_op_t *bg_op, void *arg);
 static int enabled_and_not_in_wine(void);
 static int enabled_and_not_windows(void);
+static int enabled_and_root(void);
 
 static const char NAME[] = "vifm-test";
 static int nmessages;
@@ -42,29 +56,34 @@ TEST(destroy_null, IF(ipc_enabled))
 
 TEST(create_and_destroy, IF(ipc_enabled))
 {
-	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
+	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 	assert_non_null(ipc);
 	ipc_free(ipc);
 }
 
 TEST(name_can_be_null, IF(ipc_enabled))
 {
-	ipc_t *const ipc = ipc_init(NULL, &test_ipc_args, &test_ipc_eval);
+	ipc_t *const ipc = ipc_init(NULL, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 	assert_non_null(ipc);
 	ipc_free(ipc);
 }
 
 TEST(name_is_taken_into_account, IF(ipc_enabled))
 {
-	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
+	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 	assert_string_starts_with(NAME, ipc_get_name(ipc));
 	ipc_free(ipc);
 }
 
 TEST(names_do_not_repeat, IF(enabled_and_not_in_wine))
 {
-	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
-	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 	assert_true(strcmp(ipc_get_name(ipc1), ipc_get_name(ipc2)) != 0);
 	ipc_free(ipc1);
 	ipc_free(ipc2);
@@ -73,7 +92,8 @@ TEST(names_do_not_repeat, IF(enabled_and_not_in_wine))
 TEST(instance_is_listed_when_it_exists, IF(enabled_and_not_in_wine))
 {
 	int len;
-	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
+	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 	char **const list = ipc_list(&len);
 	assert_true(is_in_string_array(list, len, ipc_get_name(ipc)));
 	free_string_array(list, len);
@@ -85,7 +105,8 @@ TEST(instance_is_not_listed_after_it_is_freed, IF(ipc_enabled))
 	int len;
 	char **list;
 
-	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
+	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 	char *const name = strdup(ipc_get_name(ipc));
 	ipc_free(ipc);
 
@@ -101,8 +122,10 @@ TEST(message_is_delivered, IF(enabled_and_not_in_wine))
 	char msg[] = "test message";
 	char *data[] = { msg, NULL };
 
-	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
-	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval);
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval,
+			&test_ipc_batch);
 
 	assert_success(ipc_send(ipc1, ipc_get_name(ipc2), data));
 	assert_false(ipc_check(ipc1));
@@ -128,8 +151,10 @@ TEST(large_message_is_delivered, IF(enabled_and_not_in_wine))
 
 	char *data[] = { msg, NULL };
 
-	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
-	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval);
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval,
+			&test_ipc_batch);
 
 	assert_success(bg_execute("", "", 0, 1, &other_instance, ipc2));
 
@@ -154,8 +179,10 @@ TEST(expr_is_evaluated, IF(enabled_and_not_in_wine))
 	const char expr[] = "good expression";
 	char *result;
 
-	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
-	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval);
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval,
+			&test_ipc_batch);
 
 	assert_success(bg_execute("", "", 0, 1, &other_instance, ipc2));
 
@@ -181,8 +208,10 @@ TEST(eval_error_is_handled, IF(enabled_and_not_in_wine))
 	const char expr[] = "bad expression";
 	char *result;
 
-	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
-	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval_error);
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval_error,
+			&test_ipc_batch);
 
 	assert_success(bg_execute("", "", 0, 1, &other_instance, ipc2));
 
@@ -203,13 +232,81 @@ TEST(eval_error_is_handled, IF(enabled_and_not_in_wine))
 	free(result);
 }
 
+TEST(batch_is_executed, IF(enabled_and_not_in_wine))
+{
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval,
+			&test_ipc_batch);
+
+	assert_success(bg_execute("", "", 0, 1, &other_instance, ipc2));
+
+	char *result = ipc_batch(ipc1, ipc_get_name(ipc2), "[]");
+	assert_false(ipc_check(ipc1));
+
+	wait_for_bg();
+
+	ipc_free(ipc1);
+	ipc_free(ipc2);
+
+	assert_int_equal(0, nmessages2);
+	assert_string_equal("batch: []", result);
+	free(result);
+}
+
+TEST(batch_is_handled_by_instance, IF(enabled_and_not_in_wine))
+{
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval,
+			&instance_exec_batch);
+
+	assert_success(bg_execute("", "", 0, 1, &other_instance, ipc2));
+	char *result = ipc_batch(ipc1, ipc_get_name(ipc2), "[{}]");
+	wait_for_bg();
+
+	assert_success(bg_execute("", "", 0, 1, &other_instance, ipc2));
+	char *error = ipc_batch(ipc1, ipc_get_name(ipc2), "[");
+	wait_for_bg();
+
+	ipc_free(ipc1);
+	ipc_free(ipc2);
+
+	assert_string_equal("[{\"ok\":false}]", result);
+	free(result);
+	assert_string_equal(NULL, error);
+}
+
+TEST(slow_batch_is_waited_for, IF(enabled_and_not_windows))
+{
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval,
+			&slow_ipc_batch);
+
+	assert_success(bg_execute("", "", 0, 1, &other_instance, ipc2));
+
+	/* Processing takes longer than evaluation of an expression may take. */
+	char *result = ipc_batch(ipc1, ipc_get_name(ipc2), "[]");
+
+	wait_for_bg();
+
+	ipc_free(ipc1);
+	ipc_free(ipc2);
+
+	assert_string_equal("batch: []", result);
+	free(result);
+}
+
 TEST(checking_ipc_from_ipc_handler_is_noop, IF(enabled_and_not_windows))
 {
 	char msg[] = "test message";
 	char *data[] = { msg, NULL };
 
-	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
-	ipc_t *const ipc2 = ipc_init(NAME, &recursive_ipc_args, &test_ipc_eval);
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &recursive_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 
 	recursive_ipc = ipc2;
 
@@ -222,12 +319,107 @@ TEST(checking_ipc_from_ipc_handler_is_noop, IF(enabled_and_not_windows))
 	ipc_free(ipc2);
 }
 
+TEST(abandoned_socket_is_reused, IF(enabled_and_not_windows))
+{
+#ifndef _WIN32
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/vifm-ipc-%s",
+			get_tmpdir(), NAME);
+
+	/* Emulate socket left behind by a crashed instance. */
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	assert_true(fd != -1);
+	assert_success(bind(fd, (struct sockaddr *)&addr, sizeof(addr)));
+	close(fd);
+
+	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	assert_string_equal(NAME, ipc_get_name(ipc));
+	ipc_free(ipc);
+#endif
+}
+
+TEST(socket_is_accessible_only_by_its_owner, IF(enabled_and_not_windows))
+{
+#ifndef _WIN32
+	const mode_t saved_umask = umask(0);
+	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	umask(saved_umask);
+
+	char path[PATH_MAX + 1];
+	snprintf(path, sizeof(path), "%s/vifm-ipc-%s", get_tmpdir(),
+			ipc_get_name(ipc));
+
+	struct stat st;
+	assert_success(stat(path, &st));
+	assert_int_equal(0600, st.st_mode & 0777);
+
+	ipc_free(ipc);
+#endif
+}
+
+TEST(sockets_of_other_users_are_ignored, IF(enabled_and_root))
+{
+#ifndef _WIN32
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/vifm-ipc-%s",
+			get_tmpdir(), NAME);
+
+	/* Emulate server of another user. */
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	assert_true(fd != -1);
+	assert_success(bind(fd, (struct sockaddr *)&addr, sizeof(addr)));
+	assert_success(listen(fd, 1));
+	assert_success(chown(addr.sun_path, getuid() + 1, -1));
+
+	int len;
+	char **list = ipc_list(&len);
+	assert_false(is_in_string_array(list, len, NAME));
+	free_string_array(list, len);
+
+	/* It isn't taken over either. */
+	ipc_t *const ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	assert_false(strcmp(NAME, ipc_get_name(ipc)) == 0);
+	ipc_free(ipc);
+
+	close(fd);
+	assert_success(unlink(addr.sun_path));
+#endif
+}
+
+TEST(several_expressions_in_a_row_are_evaluated, IF(enabled_and_not_in_wine))
+{
+	int i;
+
+	ipc_t *const ipc1 = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
+	ipc_t *const ipc2 = ipc_init(NAME, &test_ipc_args2, &test_ipc_eval,
+			&test_ipc_batch);
+
+	for(i = 0; i < 3; ++i)
+	{
+		assert_success(bg_execute("", "", 0, 1, &other_instance, ipc2));
+
+		char *result = ipc_eval(ipc1, ipc_get_name(ipc2), "good expression");
+		assert_string_equal("good result", result);
+		free(result);
+
+		wait_for_bg();
+	}
+
+	ipc_free(ipc1);
+	ipc_free(ipc2);
+}
+
 TEST(no_send_to_self, IF(enabled_and_not_in_wine))
 {
 	char msg[] = "test message";
 	char *data[] = { msg, NULL };
 
-	ipc_t *ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
+	ipc_t *ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 
 	assert_failure(ipc_send(ipc, ipc_get_name(ipc), data));
 	assert_false(ipc_check(ipc));
@@ -241,7 +433,8 @@ TEST(no_eval_to_self, IF(enabled_and_not_in_wine))
 {
 	const char expr[] = "good expression";
 
-	ipc_t *ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval);
+	ipc_t *ipc = ipc_init(NAME, &test_ipc_args, &test_ipc_eval,
+			&test_ipc_batch);
 
 	assert_string_equal(NULL, ipc_eval(ipc, ipc_get_name(ipc), expr));
 	assert_false(ipc_check(ipc));
@@ -287,6 +480,21 @@ test_ipc_eval_error(const char expr[])
 	return NULL;
 }
 
+static char *
+test_ipc_batch(const char batch[])
+{
+	return format_str("batch: %s", batch);
+}
+
+static char *
+slow_ipc_batch(const char batch[])
+{
+#ifndef _WIN32
+	usleep(1500*1000);
+#endif
+	return test_ipc_batch(batch);
+}
+
 static void
 other_instance(bg_op_t *bg_op, void *arg)
 {
@@ -318,5 +526,15 @@ enabled_and_not_windows(void)
 #endif
 }
 
+static int
+enabled_and_root(void)
+{
+#ifndef _WIN32
+	return ipc_enabled() && getuid() == 0;
+#else
+	return 0;
+#endif
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
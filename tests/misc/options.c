@@ -690,6 +690,29 @@ TEST(iooptions)
 	assert_success(cmds_dispatch("set iooptions=datasync", &lwin, CIT_COMMAND));
 	assert_false(cfg.fast_file_cloning);
 	assert_true(cfg.data_sync);
+	assert_false(cfg.no_cache);
+	assert_false(cfg.direct_io);
+
+	assert_success(cmds_dispatch("set iooptions=nocache,directio", &lwin,
+				CIT_COMMAND));
+	assert_false(cfg.data_sync);
+	assert_true(cfg.no_cache);
+	assert_true(cfg.direct_io);
+}
+
+TEST(iorate, IF(not_windows))
+{
+	assert_success(cmds_dispatch("set iorate=1024", &lwin, CIT_COMMAND));
+	assert_int_equal(1024, cfg.io_rate);
+
+	vle_tb_clear(vle_err);
+	assert_failure(cmds_dispatch("set iorate=-1", &lwin, CIT_COMMAND));
+	assert_string_equal("Argument must be >= 0: -1\n"
+			"Invalid argument for :set command", vle_tb_get_data(vle_err));
+	assert_int_equal(1024, cfg.io_rate);
+
+	assert_success(cmds_dispatch("set iorate=0", &lwin, CIT_COMMAND));
+	assert_int_equal(0, cfg.io_rate);
 }
 
 TEST(mouse)
@@ -15,6 +15,7 @@
 #include "../../src/utils/gmux.h"
 #include "../../src/utils/shmem.h"
 #include "../../src/utils/utils.h"
+#include "../../src/registers.h"
 
 static void spawn_regcmd(int number);
 static void send_query(int instance, const char query[]);
@@ -331,11 +332,71 @@ sync_disable(int instance)
 	fclose(instance_stdout[instance]);
 }
 
+TEST(unchanged_registers_are_not_overwritten, IF(not_wine))
+{
+	spawn_regcmd(0);
+	send_query(0, "sync_enable,test-shmem\n");
+	receive_ack(0);
+	sync_from(0);
+
+	/* Instance 0 doesn't learn about this change before writing its own. */
+	send_query(2, "set,h,newh\n");
+	send_query(2, "sync_to\n");
+	receive_ack(2);
+	send_query(0, "set,i,newi\n");
+	send_query(0, "sync_to\n");
+	receive_ack(0);
+	sync_from(2);
+
+	check_register_contents(2, 'h', "h,1,newh,");
+	check_register_contents(2, 'i', "i,1,newi,");
+
+	sync_from(0);
+	check_register_contents(0, 'h', "h,1,newh,");
+
+	sync_disable(0);
+}
+
 TEST(teardown_once, IF(not_wine))
 {
 	sync_disable(2);
 }
 
+TEST(only_changed_registers_are_synchronized, IF(not_wine))
+{
+	gmux_destroy(gmux_create("regs-test-local"));
+	shmem_destroy(shmem_create("regs-test-local", 10, 10));
+
+	regs_init();
+	regs_append('a', "/a");
+	regs_sync_enable("test-local");
+	assert_true(regs_sync_enabled());
+
+	/* Forget contents of registers without marking them as changed. */
+	regs_reset();
+	regs_init();
+
+	regs_append('b', "/b");
+	regs_sync_to_shared_memory();
+
+	/* Register that wasn't changed elsewhere isn't loaded back... */
+	assert_int_equal(0, regs_find('a')->nfiles);
+
+	/* ...and isn't written out. */
+	regs_sync_enable("test-local");
+	regs_sync_from_shared_memory();
+	assert_int_equal(1, regs_find('a')->nfiles);
+	assert_string_equal("/a", regs_find('a')->files[0]);
+	assert_int_equal(1, regs_find('b')->nfiles);
+	assert_string_equal("/b", regs_find('b')->files[0]);
+
+	regs_sync_disable();
+	regs_reset();
+
+	gmux_destroy(gmux_create("regs-test-local"));
+	shmem_destroy(shmem_create("regs-test-local", 10, 10));
+}
+
 #ifndef _WIN32
 
 static pid_t
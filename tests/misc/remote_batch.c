@@ -0,0 +1,115 @@
+#include <stic.h>
+
+#include <stdlib.h> /* free() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/engine/parsing.h"
+#include "../../src/engine/variables.h"
+#include "../../src/modes/modes.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/env.h"
+#include "../../src/cmd_core.h"
+#include "../../src/instance.h"
+#include "../../src/status.h"
+
+SETUP()
+{
+	curr_view = &lwin;
+	other_view = &rwin;
+	view_setup(&lwin);
+	view_setup(&rwin);
+
+	vle_parser_init(&env_get);
+	init_variables();
+	cmds_init();
+	modes_init();
+	opt_handlers_setup();
+}
+
+TEARDOWN()
+{
+	view_teardown(&lwin);
+	view_teardown(&rwin);
+
+	vle_cmds_reset();
+	opt_handlers_teardown();
+	clear_envvars();
+	clear_variables();
+	(void)stats_update_fetch();
+}
+
+TEST(malformed_batch_is_rejected)
+{
+	assert_null(instance_exec_batch(""));
+	assert_null(instance_exec_batch("["));
+	assert_null(instance_exec_batch("{}"));
+	assert_null(instance_exec_batch("\"cmd\""));
+}
+
+TEST(empty_batch_produces_empty_array)
+{
+	char *reply = instance_exec_batch("[]");
+	assert_string_equal("[]", reply);
+	free(reply);
+}
+
+TEST(entry_without_cmd_or_expr_fails)
+{
+	char *reply = instance_exec_batch("[{},{\"command\":\"echo\"},1,"
+			"{\"cmd\":1}]");
+	assert_string_equal("[{\"ok\":false},{\"ok\":false},{\"ok\":false},"
+			"{\"ok\":false}]", reply);
+	free(reply);
+}
+
+TEST(commands_report_success)
+{
+	char *reply = instance_exec_batch("[{\"cmd\":\"let $REMOTE_BATCH = 1\"},"
+			"{\"cmd\":\"nosuchcommand\"}]");
+	assert_string_equal("[{\"ok\":true},{\"ok\":false}]", reply);
+	free(reply);
+
+	char *value = instance_eval_expr("$REMOTE_BATCH");
+	assert_string_equal("1", value);
+	free(value);
+}
+
+TEST(expressions_report_results)
+{
+	char *reply = instance_exec_batch("[{\"expr\":\"1 + 2\"},{\"expr\":\"1 +\"},"
+			"{\"expr\":\"'a'.'b'\"}]");
+	assert_string_equal("[{\"ok\":true,\"result\":\"3\"},{\"ok\":false},"
+			"{\"ok\":true,\"result\":\"ab\"}]", reply);
+	free(reply);
+}
+
+TEST(requests_are_processed_in_order)
+{
+	char *reply = instance_exec_batch("[{\"expr\":\"$REMOTE_BATCH\"},"
+			"{\"cmd\":\"let $REMOTE_BATCH = 'value'\"},"
+			"{\"expr\":\"$REMOTE_BATCH\"}]");
+	assert_string_equal("[{\"ok\":true,\"result\":\"\"},{\"ok\":true},"
+			"{\"ok\":true,\"result\":\"value\"}]", reply);
+	free(reply);
+}
+
+TEST(screen_is_updated_once_at_the_end)
+{
+	/* A command on its own leaves a pending redraw. */
+	assert_success(cmds_dispatch("set quickview", curr_view, CIT_COMMAND));
+	assert_int_equal(UT_REDRAW, stats_update_fetch());
+
+	/* Batch processes the redraws requested by its commands by itself. */
+	char *reply = instance_exec_batch("[{\"cmd\":\"set noquickview\"},"
+			"{\"cmd\":\"set quickview\"}]");
+	assert_string_equal("[{\"ok\":true},{\"ok\":true}]", reply);
+	free(reply);
+
+	assert_false(stats_silenced_ui());
+	assert_int_equal(UT_NONE, stats_update_fetch());
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
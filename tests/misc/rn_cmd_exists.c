@@ -1,11 +1,45 @@
 #include <stic.h>
 
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* free() */
+#include <string.h> /* strdup() */
+
 #include <test-utils.h>
 
+#include "../../src/compat/fs_limits.h"
+#include "../../src/int/path_env.h"
+#include "../../src/utils/env.h"
+#include "../../src/utils/fs.h"
+#include "../../src/utils/path.h"
+#include "../../src/utils/str.h"
+#include "../../src/utils/utils.h"
 #include "../../src/filetype.h"
 #include "../../src/running.h"
 #include "../../src/status.h"
 
+static void set_path(const char value[]);
+
+static char sandbox[PATH_MAX + 1];
+static char *saved_path_env;
+
+SETUP_ONCE()
+{
+	char cwd[PATH_MAX + 1];
+	assert_non_null(get_cwd(cwd, sizeof(cwd)));
+	make_abs_path(sandbox, sizeof(sandbox), SANDBOX_PATH, "", cwd);
+}
+
+SETUP()
+{
+	saved_path_env = strdup(env_get("PATH"));
+}
+
+TEARDOWN()
+{
+	set_path(saved_path_env);
+	free(saved_path_env);
+}
+
 TEST(system_shell_exists)
 {
 #ifdef _WIN32
@@ -39,5 +73,115 @@ TEST(exe_path_with_backslashes, IF(windows))
 	ft_init(NULL);
 }
 
+TEST(commands_are_looked_up_in_path, IF(not_windows))
+{
+	create_executable(SANDBOX_PATH "/exe");
+	create_file(SANDBOX_PATH "/file");
+	create_dir(SANDBOX_PATH "/dir");
+
+	set_path(sandbox);
+
+	assert_true(rn_cmd_exists("exe"));
+	assert_false(rn_cmd_exists("file"));
+	assert_false(rn_cmd_exists("dir"));
+	assert_false(rn_cmd_exists("missing"));
+
+	remove_file(SANDBOX_PATH "/exe");
+	remove_file(SANDBOX_PATH "/file");
+	remove_dir(SANDBOX_PATH "/dir");
+}
+
+TEST(listings_of_path_directories_are_cached, IF(not_windows))
+{
+	create_file(SANDBOX_PATH "/a");
+	create_file(SANDBOX_PATH "/c");
+
+	set_path(sandbox);
+
+	size_t paths_count;
+	char **const paths = get_paths(&paths_count);
+	assert_int_equal(1, paths_count);
+	assert_true(paths_are_equal(sandbox, paths[0]));
+
+	int count;
+	char **names = get_path_files(0, &count);
+	assert_int_equal(2, count);
+	assert_string_equal("a", names[0]);
+	assert_string_equal("c", names[1]);
+
+	assert_true(path_may_have_file(0, "a"));
+	assert_false(path_may_have_file(0, "b"));
+	assert_true(path_may_have_file(0, "c"));
+	/* Paths are not in the cache. */
+	assert_true(path_may_have_file(0, "b/a"));
+
+	create_executable(SANDBOX_PATH "/b");
+	/* Forced update drops cached listings. */
+	update_path_env(1);
+	assert_true(path_may_have_file(0, "b"));
+	assert_true(rn_cmd_exists("b"));
+
+	remove_file(SANDBOX_PATH "/a");
+	remove_file(SANDBOX_PATH "/b");
+	remove_file(SANDBOX_PATH "/c");
+}
+
+TEST(relative_paths_are_not_cached)
+{
+	set_path(".");
+	int count;
+	assert_null(get_path_files(0, &count));
+	assert_true(path_may_have_file(0, "anything"));
+}
+
+TEST(lookups_do_not_probe_every_directory, IF(not_windows))
+{
+	enum { NDIRS = 3 };
+
+	char path_env[NDIRS*(PATH_MAX + 1)];
+	size_t len = 0U;
+	int i;
+	for(i = 0; i < NDIRS; ++i)
+	{
+		char dir[PATH_MAX + 1];
+		snprintf(dir, sizeof(dir), "%s/dir%d", sandbox, i);
+		create_dir(dir);
+		reset_timestamp(dir);
+		len += snprintf(path_env + len, sizeof(path_env) - len, "%s%s",
+				(i == 0 ? "" : ":"), dir);
+	}
+
+	set_path(path_env);
+	assert_failure(find_cmd_in_path("cmd", 0U, NULL));
+
+	/* A file that appears in a directory which looks unchanged isn't probed
+	 * for... */
+	create_executable(SANDBOX_PATH "/dir1/cmd");
+	reset_timestamp(SANDBOX_PATH "/dir1");
+	assert_failure(find_cmd_in_path("cmd", 0U, NULL));
+
+	/* ...until listings are read anew. */
+	update_path_env(1);
+	char path[PATH_MAX + 1];
+	assert_success(find_cmd_in_path("cmd", sizeof(path), path));
+	assert_true(ends_with(path, "/dir1/cmd"));
+
+	remove_file(SANDBOX_PATH "/dir1/cmd");
+	for(i = 0; i < NDIRS; ++i)
+	{
+		char dir[PATH_MAX + 1];
+		snprintf(dir, sizeof(dir), "%s/dir%d", sandbox, i);
+		remove_dir(dir);
+	}
+}
+
+/* Sets value of $PATH and makes sure its new value will be used. */
+static void
+set_path(const char value[])
+{
+	env_set("PATH", value);
+	update_path_env(1);
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
@@ -13,6 +13,8 @@
 #include "../../src/utils/fs.h"
 #include "../../src/trash.h"
 
+static int trash_size(void);
+
 static char sandbox[PATH_MAX + 1];
 static char *saved_cwd;
 
@@ -79,11 +81,11 @@ TEST(trash_allows_multiple_files_with_same_original_path)
 
 	snprintf(path, sizeof(path), "%s/trashed_1", sandbox);
 	assert_success(trash_add_entry("/some/path/src", path));
-	assert_int_equal(1, trash_list_size);
+	assert_int_equal(1, trash_size());
 
 	snprintf(path, sizeof(path), "%s/trashed_2", sandbox);
 	assert_success(trash_add_entry("/some/path/src", path));
-	assert_int_equal(2, trash_list_size);
+	assert_int_equal(2, trash_size());
 }
 
 TEST(trash_specs_are_expanded_correctly)
@@ -114,12 +116,117 @@ TEST(trash_dir_can_be_a_symlink, IF(not_windows))
 	char path[PATH_MAX + 1];
 	snprintf(path, sizeof(path), "%s/trashed", trash);
 	assert_success(trash_add_entry("/some/path/src", path));
-	assert_int_equal(3, trash_list_size);
+	assert_int_equal(3, trash_size());
 	assert_true(trash_has_path(path));
 
 	remove_file("dir-link");
 	remove_dir("dir");
 }
 
+TEST(entries_are_sorted_and_deduplicated)
+{
+	char path[PATH_MAX + 1];
+	snprintf(path, sizeof(path), "%s/sorted_a", sandbox);
+
+	assert_success(trash_add_entry("/sorted/b", path));
+	assert_success(trash_add_entry("/sorted/a", path));
+	assert_success(trash_add_entry("/sorted/b", path));
+	assert_success(trash_add_entry("/sorted/a", path));
+
+	assert_true(trash_has_entry("/sorted/a", path));
+	assert_true(trash_has_entry("/sorted/b", path));
+	assert_false(trash_has_entry("/sorted/c", path));
+
+	int count, i, found = 0;
+	const trash_entry_t *const list = trash_get_list(&count);
+	for(i = 0; i < count; ++i)
+	{
+		if(strcmp(list[i].trash_name, path) == 0)
+		{
+			assert_string_equal(found == 0 ? "/sorted/a" : "/sorted/b",
+					list[i].path);
+			++found;
+		}
+		if(i != 0)
+		{
+			assert_true(strcmp(list[i - 1].path, list[i].path) <= 0);
+		}
+	}
+	assert_int_equal(2, found);
+}
+
+TEST(entries_are_dropped_by_emptying_trash)
+{
+	char path[PATH_MAX + 1];
+	snprintf(path, sizeof(path), "%s/emptied", sandbox);
+	assert_success(trash_add_entry("/emptied", path));
+	assert_true(trash_has_entry("/emptied", path));
+
+	trash_empty(sandbox);
+	wait_for_bg();
+	assert_false(trash_has_entry("/emptied", path));
+	assert_int_equal(0, trash_size());
+}
+
+TEST(many_entries_are_tracked)
+{
+	enum { NENTRIES = 1000 };
+
+	assert_success(trash_set_specs(sandbox));
+
+	char orig[PATH_MAX + 1], path[PATH_MAX + 1];
+	int i;
+
+	for(i = 0; i < NENTRIES; ++i)
+	{
+		snprintf(orig, sizeof(orig), "/orig/%d", NENTRIES - i);
+		snprintf(path, sizeof(path), "%s/%d_file", sandbox, i);
+		assert_success(trash_add_entry(orig, path));
+	}
+	/* Duplicates are dropped. */
+	for(i = 0; i < NENTRIES; i += 3)
+	{
+		snprintf(orig, sizeof(orig), "/orig/%d", NENTRIES - i);
+		snprintf(path, sizeof(path), "%s/%d_file", sandbox, i);
+		assert_success(trash_add_entry(orig, path));
+	}
+	assert_int_equal(NENTRIES, trash_size());
+
+	for(i = 0; i < NENTRIES; i += 7)
+	{
+		snprintf(orig, sizeof(orig), "/orig/%d", NENTRIES - i);
+		snprintf(path, sizeof(path), "%s/%d_file", sandbox, i);
+		assert_true(trash_has_entry(orig, path));
+		trash_file_moved(path, orig);
+	}
+
+	assert_int_equal(NENTRIES - (NENTRIES + 6)/7, trash_size());
+	snprintf(orig, sizeof(orig), "/orig/%d", NENTRIES);
+	snprintf(path, sizeof(path), "%s/0_file", sandbox);
+	assert_false(trash_has_entry(orig, path));
+	snprintf(orig, sizeof(orig), "/orig/%d", NENTRIES - 1);
+	snprintf(path, sizeof(path), "%s/1_file", sandbox);
+	assert_true(trash_has_entry(orig, path));
+
+	int count;
+	const trash_entry_t *const list = trash_get_list(&count);
+	for(i = 1; i < count; ++i)
+	{
+		assert_true(strcmp(list[i - 1].path, list[i].path) <= 0);
+	}
+
+	trash_prune_dead_entries();
+	assert_int_equal(0, trash_size());
+}
+
+/* Retrieves number of entries in trash.  Returns the number. */
+static int
+trash_size(void)
+{
+	int count;
+	(void)trash_get_list(&count);
+	return count;
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
@@ -7,7 +7,11 @@
 #include "../../src/modes/modes.h"
 #include "../../src/modes/visual.h"
 #include "../../src/modes/wk.h"
+#include "../../src/ui/color_scheme.h"
+#include "../../src/ui/colors.h"
+#include "../../src/ui/fileview.h"
 #include "../../src/ui/ui.h"
+#include "../../src/status.h"
 
 static view_t *const view = &lwin;
 
@@ -22,6 +26,11 @@ SETUP()
 	curr_view = view;
 
 	cfg.scroll_off = 0;
+	cs_reset(&cfg.cs);
+
+	/* Pending redraws prevent partial updates of the view. */
+	(void)stats_update_fetch();
+	(void)ui_view_query_scheduled_event(view);
 }
 
 TEARDOWN()
@@ -247,5 +256,104 @@ TEST(scrolling_beyond_edges_visual)
 	modvis_leave(0, 1, 0);
 }
 
+TEST(scrolling_by_less_than_a_page_updates_only_revealed_cells)
+{
+	int first, count;
+
+	view->window_rows = 5;
+	setup_grid(view, 2, 21, 1);
+	view->drawn_top = 4;
+
+	view->top_line = 8;
+	assert_true(can_scroll_dir_list(view, 4));
+	get_revealed_cells(view, 4, &first, &count);
+	assert_int_equal(6, first);
+	assert_int_equal(4, count);
+
+	view->top_line = 2;
+	assert_true(can_scroll_dir_list(view, 4));
+	get_revealed_cells(view, 4, &first, &count);
+	assert_int_equal(0, first);
+	assert_int_equal(2, count);
+
+	/* Only cells with files are revealed at the end of the list. */
+	view->drawn_top = 8;
+	view->top_line = 12;
+	assert_true(can_scroll_dir_list(view, 8));
+	get_revealed_cells(view, 8, &first, &count);
+	assert_int_equal(6, first);
+	assert_int_equal(3, count);
+}
+
+TEST(scrolling_can_require_full_redraw)
+{
+	view->window_rows = 5;
+	setup_grid(view, 2, 21, 1);
+	view->drawn_top = 4;
+
+	/* Nothing to scroll. */
+	view->top_line = 4;
+	assert_false(can_scroll_dir_list(view, 4));
+	/* Not by whole rows. */
+	view->top_line = 5;
+	assert_false(can_scroll_dir_list(view, 4));
+	/* By a page or more. */
+	view->top_line = 14;
+	assert_false(can_scroll_dir_list(view, 4));
+	/* Window doesn't show old_top. */
+	view->top_line = 8;
+	assert_false(can_scroll_dir_list(view, 2));
+
+	view->num_type = NT_REL;
+	assert_false(can_scroll_dir_list(view, 4));
+	view->num_type = NT_NONE;
+
+	view->miller_view = 1;
+	assert_false(can_scroll_dir_list(view, 4));
+	view->miller_view = 0;
+
+	assert_true(can_scroll_dir_list(view, 4));
+}
+
+TEST(odd_lines_highlighting_limits_scrolling)
+{
+	view->window_rows = 5;
+	setup_grid(view, 2, 21, 1);
+	view->drawn_top = 4;
+
+	cfg.cs.color[ODD_LINE_COLOR].bg = 1;
+
+	/* Odd number of rows. */
+	view->top_line = 6;
+	assert_false(can_scroll_dir_list(view, 4));
+	/* Even number of rows. */
+	view->top_line = 8;
+	assert_true(can_scroll_dir_list(view, 4));
+
+	cs_reset(&cfg.cs);
+	view->top_line = 6;
+	assert_true(can_scroll_dir_list(view, 4));
+}
+
+TEST(changes_of_list_require_full_redraw)
+{
+	view->window_rows = 5;
+	setup_grid(view, 2, 21, 1);
+	view->top_line = 8;
+
+	view->drawn_top = 4;
+	fview_list_updated(view);
+	assert_int_equal(-1, view->drawn_top);
+	assert_false(can_scroll_dir_list(view, 4));
+
+	view->drawn_top = 4;
+	fview_sorting_updated(view);
+	assert_int_equal(-1, view->drawn_top);
+
+	view->drawn_top = 4;
+	fview_update_geometry(view);
+	assert_int_equal(-1, view->drawn_top);
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */
@@ -0,0 +1,305 @@
+#include <stic.h>
+
+#include <unistd.h> /* F_OK access() */
+
+#include <stdio.h> /* FILE fclose() fopen() remove() */
+#include <stdlib.h> /* free() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/cfg/info.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/hist.h"
+#include "../../src/utils/parson.h"
+#include "../../src/utils/file_streams.h"
+#include "../../src/marks.h"
+#include "../../src/status.h"
+
+static void entry_is_applied(const char base[], const char entry[],
+		const char expected[]);
+
+static char *saved_locale;
+
+SETUP_ONCE()
+{
+	make_abs_path(cfg.config_dir, sizeof(cfg.config_dir), SANDBOX_PATH, "", NULL);
+	saved_locale = drop_locale();
+}
+
+TEARDOWN_ONCE()
+{
+	cfg.config_dir[0] = '\0';
+	restore_locale(saved_locale);
+}
+
+SETUP()
+{
+	view_setup(&lwin);
+	view_setup(&rwin);
+	curr_view = &lwin;
+
+	cfg_resize_histories(10);
+
+	cfg.vifm_info = 0;
+}
+
+TEARDOWN()
+{
+	cfg_resize_histories(0);
+
+	view_teardown(&lwin);
+	view_teardown(&rwin);
+
+	cfg.vifm_info = 0;
+}
+
+TEST(history_entries_are_moved_to_the_end)
+{
+	entry_is_applied(
+			"{\"cmd-hist\":[{\"text\":\"a\",\"ts\":1},{\"text\":\"b\",\"ts\":2}]}",
+			"{\"cmd-hist\":[{\"text\":\"a\",\"ts\":3}]}",
+			"{\"cmd-hist\":[{\"text\":\"b\",\"ts\":2},{\"text\":\"a\",\"ts\":3}]}");
+}
+
+TEST(history_is_trimmed_to_its_size)
+{
+	cfg_resize_histories(2);
+	entry_is_applied(
+			"{\"cmd-hist\":[{\"text\":\"a\",\"ts\":1},{\"text\":\"b\",\"ts\":2}]}",
+			"{\"cmd-hist\":[{\"text\":\"c\",\"ts\":3}]}",
+			"{\"cmd-hist\":[{\"text\":\"b\",\"ts\":2},{\"text\":\"c\",\"ts\":3}]}");
+}
+
+TEST(missing_history_is_left_intact)
+{
+	entry_is_applied("{\"cmd-hist\":[{\"text\":\"a\",\"ts\":1}]}",
+			"{\"journal-since\":5}",
+			"{\"cmd-hist\":[{\"text\":\"a\",\"ts\":1}]}");
+}
+
+TEST(removed_marks_are_dropped_and_foreign_ones_are_kept)
+{
+	entry_is_applied(
+			"{\"marks\":{"
+				"\"a\":{\"dir\":\"\\/old\",\"file\":\"f\",\"ts\":1},"
+				"\"b\":{\"dir\":\"\\/removed\",\"file\":\"f\",\"ts\":2},"
+				"\"c\":{\"dir\":\"\\/foreign\",\"file\":\"f\",\"ts\":7},"
+				"\"d\":{\"dir\":\"\\/updated\",\"file\":\"f\",\"ts\":8}"
+			"}}",
+			"{\"marks\":{"
+				"\"a\":{\"dir\":\"\\/new\",\"file\":\"f\",\"ts\":6}"
+			"},\"journal-removed\":{\"marks\":[\"b\",\"d\"]},"
+			"\"journal-since\":5}",
+			"{\"marks\":{"
+				"\"a\":{\"dir\":\"\\/new\",\"file\":\"f\",\"ts\":6},"
+				"\"d\":{\"dir\":\"\\/updated\",\"file\":\"f\",\"ts\":8},"
+				"\"c\":{\"dir\":\"\\/foreign\",\"file\":\"f\",\"ts\":7}"
+			"}}");
+}
+
+TEST(unchanged_marks_are_kept)
+{
+	entry_is_applied(
+			"{\"marks\":{"
+				"\"a\":{\"dir\":\"\\/a\",\"file\":\"f\",\"ts\":1},"
+				"\"b\":{\"dir\":\"\\/b\",\"file\":\"f\",\"ts\":2}"
+			"}}",
+			"{\"marks\":{"
+				"\"c\":{\"dir\":\"\\/c\",\"file\":\"f\",\"ts\":6}"
+			"},\"journal-since\":5}",
+			"{\"marks\":{"
+				"\"a\":{\"dir\":\"\\/a\",\"file\":\"f\",\"ts\":1},"
+				"\"b\":{\"dir\":\"\\/b\",\"file\":\"f\",\"ts\":2},"
+				"\"c\":{\"dir\":\"\\/c\",\"file\":\"f\",\"ts\":6}"
+			"}}");
+}
+
+TEST(newer_bmarks_are_not_overwritten)
+{
+	entry_is_applied(
+			"{\"bmarks\":{\"\\/path\":{\"tags\":\"new\",\"ts\":9}}}",
+			"{\"bmarks\":{\"\\/path\":{\"tags\":\"old\",\"ts\":3}},"
+			"\"journal-since\":1}",
+			"{\"bmarks\":{\"\\/path\":{\"tags\":\"new\",\"ts\":9}}}");
+}
+
+TEST(other_sections_are_merged)
+{
+	entry_is_applied("{\"regs\":{\"a\":[\"\\/x\"]},\"color-scheme\":\"a\"}",
+			"{\"regs\":{\"b\":[\"\\/y\"]}}",
+			"{\"regs\":{\"b\":[\"\\/y\"],\"a\":[\"\\/x\"]},"
+			"\"color-scheme\":\"a\"}");
+}
+
+TEST(missing_sections_are_left_intact)
+{
+	entry_is_applied("{\"regs\":{\"a\":[\"\\/x\"]},\"color-scheme\":\"a\"}",
+			"{\"color-scheme\":\"b\",\"journal-since\":1}",
+			"{\"regs\":{\"a\":[\"\\/x\"]},\"color-scheme\":\"b\"}");
+}
+
+TEST(directory_history_is_merged)
+{
+	entry_is_applied(
+			"{\"gtabs\":[{\"panes\":["
+				"{\"ptabs\":[{\"history\":[{\"dir\":\"\\/a\",\"ts\":1}]}]},"
+				"{\"ptabs\":[{\"history\":[]}]}"
+			"]}]}",
+			"{\"gtabs\":[{\"panes\":["
+				"{\"ptabs\":[{\"history\":[{\"dir\":\"\\/b\",\"ts\":2}]}]},"
+				"{\"ptabs\":[{\"history\":[]}]}"
+			"]}]}",
+			"{\"gtabs\":[{\"panes\":["
+				"{\"ptabs\":[{\"history\":["
+					"{\"dir\":\"\\/a\",\"ts\":1},{\"dir\":\"\\/b\",\"ts\":2}"
+				"]}]},"
+				"{\"ptabs\":[{\"history\":[]}]}"
+			"]}]}");
+}
+
+TEST(journal_is_appended_to_and_replayed)
+{
+	/* Round-trip tests of other fixtures might leave state file behind. */
+	(void)remove(SANDBOX_PATH "/vifminfo.json");
+
+	cfg.vifm_info = VINFO_JOURNAL | VINFO_CHISTORY;
+
+	hist_add(&curr_stats.cmd_hist, "command0", 0);
+
+	/* State file doesn't exist, so it's written in full. */
+	write_info_file();
+	assert_failure(access(SANDBOX_PATH "/vifminfo.json.journal", F_OK));
+
+	hist_add(&curr_stats.cmd_hist, "command1", -1);
+
+	write_info_file();
+	assert_success(access(SANDBOX_PATH "/vifminfo.json.journal", F_OK));
+
+	/* Clear histories. */
+	cfg_resize_histories(0);
+	cfg_resize_histories(10);
+
+	state_load(0);
+
+	assert_int_equal(2, curr_stats.cmd_hist.size);
+	assert_string_equal("command1", curr_stats.cmd_hist.items[0].text);
+	assert_string_equal("command0", curr_stats.cmd_hist.items[1].text);
+
+	assert_success(remove(SANDBOX_PATH "/vifminfo.json.journal"));
+	assert_success(remove(SANDBOX_PATH "/vifminfo.json"));
+}
+
+TEST(journal_contains_only_changes)
+{
+	(void)remove(SANDBOX_PATH "/vifminfo.json");
+
+	cfg.vifm_info = VINFO_JOURNAL | VINFO_CHISTORY | VINFO_REGISTERS;
+
+	hist_add(&curr_stats.cmd_hist, "command0", 0);
+	write_info_file();
+	hist_add(&curr_stats.cmd_hist, "command1", -1);
+	write_info_file();
+	write_info_file();
+
+	FILE *fp = fopen(SANDBOX_PATH "/vifminfo.json.journal", "r");
+	assert_non_null(fp);
+
+	char *line = read_line(fp, NULL);
+	JSON_Value *entry = json_parse_string(line);
+	assert_non_null(json_object_get_array(json_object(entry), "cmd-hist"));
+	assert_false(json_object_has_value(json_object(entry), "gtabs"));
+	assert_false(json_object_has_value(json_object(entry), "regs"));
+	json_value_free(entry);
+
+	/* Nothing but history has changed since the previous store. */
+	line = read_line(fp, line);
+	entry = json_parse_string(line);
+	assert_true(json_object_has_value(json_object(entry), "journal-since"));
+	assert_false(json_object_has_value(json_object(entry), "gtabs"));
+	assert_false(json_object_has_value(json_object(entry), "regs"));
+	json_value_free(entry);
+
+	free(line);
+	fclose(fp);
+
+	assert_success(remove(SANDBOX_PATH "/vifminfo.json.journal"));
+	assert_success(remove(SANDBOX_PATH "/vifminfo.json"));
+}
+
+TEST(removed_marks_are_journaled)
+{
+	(void)remove(SANDBOX_PATH "/vifminfo.json");
+
+	cfg.vifm_info = VINFO_JOURNAL | VINFO_MARKS;
+
+	assert_success(marks_set_user(curr_view, 'a', "/a", "f"));
+	assert_success(marks_set_user(curr_view, 'b', "/b", "f"));
+	state_store();
+	marks_clear_one(curr_view, 'a');
+	state_store();
+
+	marks_clear_all();
+	state_load(0);
+
+	assert_true(marks_is_empty(curr_view, 'a'));
+	assert_false(marks_is_empty(curr_view, 'b'));
+
+	marks_clear_all();
+	assert_success(remove(SANDBOX_PATH "/vifminfo.json.journal"));
+	assert_success(remove(SANDBOX_PATH "/vifminfo.json"));
+}
+
+TEST(journal_is_folded_into_file_when_disabled)
+{
+	(void)remove(SANDBOX_PATH "/vifminfo.json");
+
+	cfg.vifm_info = VINFO_JOURNAL | VINFO_CHISTORY;
+
+	hist_add(&curr_stats.cmd_hist, "command0", 0);
+	write_info_file();
+	hist_add(&curr_stats.cmd_hist, "command1", -1);
+	write_info_file();
+	assert_success(access(SANDBOX_PATH "/vifminfo.json.journal", F_OK));
+
+	cfg.vifm_info = VINFO_CHISTORY;
+	cfg_resize_histories(0);
+	cfg_resize_histories(10);
+	hist_add(&curr_stats.cmd_hist, "command2", -1);
+
+	write_info_file();
+	assert_failure(access(SANDBOX_PATH "/vifminfo.json.journal", F_OK));
+
+	cfg_resize_histories(0);
+	cfg_resize_histories(10);
+
+	state_load(0);
+
+	assert_int_equal(3, curr_stats.cmd_hist.size);
+	assert_string_equal("command2", curr_stats.cmd_hist.items[0].text);
+	assert_string_equal("command1", curr_stats.cmd_hist.items[1].text);
+	assert_string_equal("command0", curr_stats.cmd_hist.items[2].text);
+
+	assert_success(remove(SANDBOX_PATH "/vifminfo.json"));
+}
+
+/* Checks that application of journal entry to base state produces expected
+ * result. */
+static void
+entry_is_applied(const char base[], const char entry[], const char expected[])
+{
+	JSON_Value *base_value = json_parse_string(base);
+	JSON_Value *entry_value = json_parse_string(entry);
+
+	apply_journal_entry(json_object(base_value), json_object(entry_value));
+
+	char *result = json_serialize_to_string(base_value);
+	assert_string_equal(expected, result);
+	free(result);
+
+	json_value_free(entry_value);
+	json_value_free(base_value);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
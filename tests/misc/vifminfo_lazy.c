@@ -0,0 +1,219 @@
+#include <stic.h>
+
+#include <stdio.h> /* FILE fclose() fopen() fprintf() fputs() remove() */
+
+#include <test-utils.h>
+
+#include "../../src/cfg/config.h"
+#include "../../src/cfg/info.h"
+#include "../../src/ui/ui.h"
+#include "../../src/utils/hist.h"
+#include "../../src/bmarks.h"
+#include "../../src/marks.h"
+#include "../../src/status.h"
+
+static void write_large_vifminfo(int n);
+static int count_bmarks(void);
+static void count_bmark(const char path[], const char tags[], time_t timestamp,
+		void *arg);
+
+SETUP_ONCE()
+{
+	make_abs_path(cfg.config_dir, sizeof(cfg.config_dir), SANDBOX_PATH, "", NULL);
+}
+
+TEARDOWN_ONCE()
+{
+	cfg.config_dir[0] = '\0';
+}
+
+SETUP()
+{
+	view_setup(&lwin);
+	view_setup(&rwin);
+	curr_view = &lwin;
+
+	cfg_resize_histories(10);
+	marks_clear_all();
+
+	FILE *const f = fopen(SANDBOX_PATH "/vifminfo.json", "w");
+	fputs("{"
+	        "\"cmd-hist\":[{\"text\":\"cmd1\",\"ts\":1},{\"text\":\"cmd2\",\"ts\":2}],"
+	        "\"search-hist\":[{\"text\":\"{[\\\"]}\",\"ts\":1}],"
+	        "\"bmarks\":{\"\\/bmark\":{\"tags\":\"tag\",\"ts\":1}},"
+	        /* Cleared marks are timestamped, so use the date from the future. */
+	        "\"marks\":{\"x\":{\"dir\":\"\\/dir\",\"file\":\"file\",\"ts\":4e9}},"
+	        "\"color-scheme\":\"lazy\""
+	      "}", f);
+	fclose(f);
+}
+
+TEARDOWN()
+{
+	remove_file(SANDBOX_PATH "/vifminfo.json");
+
+	/* Drop anything that might have been left unloaded. */
+	state_load_deferred();
+
+	bmarks_clear();
+	marks_clear_all();
+	cfg_resize_histories(0);
+	curr_stats.color_scheme[0] = '\0';
+
+	view_teardown(&lwin);
+	view_teardown(&rwin);
+}
+
+TEST(only_part_of_state_is_loaded_lazily)
+{
+	state_load_lazily();
+
+	assert_string_equal("lazy", curr_stats.color_scheme);
+	assert_int_equal(0, curr_stats.cmd_hist.size);
+	assert_int_equal(0, curr_stats.search_hist.size);
+	assert_int_equal(0, count_bmarks());
+	assert_true(marks_is_empty(&lwin, 'x'));
+
+	state_load_deferred();
+
+	assert_int_equal(2, curr_stats.cmd_hist.size);
+	assert_string_equal("cmd2", curr_stats.cmd_hist.items[0].text);
+	assert_string_equal("cmd1", curr_stats.cmd_hist.items[1].text);
+	assert_int_equal(1, curr_stats.search_hist.size);
+	assert_string_equal("{[\"]}", curr_stats.search_hist.items[0].text);
+	assert_int_equal(1, count_bmarks());
+	assert_false(marks_is_empty(&lwin, 'x'));
+}
+
+TEST(newer_state_is_not_overwritten_by_deferred_one)
+{
+	state_load_lazily();
+
+	hist_add(&curr_stats.cmd_hist, "cmd0", -1);
+	assert_success(bmarks_setup("/bmark", "newtag", 10));
+	marks_setup_user(&lwin, 'x', "/newdir", "newfile", 5e9);
+
+	state_load_deferred();
+
+	assert_int_equal(3, curr_stats.cmd_hist.size);
+	assert_string_equal("cmd0", curr_stats.cmd_hist.items[0].text);
+	assert_string_equal("cmd2", curr_stats.cmd_hist.items[1].text);
+	assert_string_equal("cmd1", curr_stats.cmd_hist.items[2].text);
+	assert_false(bmark_is_older("/bmark", 10));
+	assert_false(marks_is_older(&lwin, 'x', 5e9));
+}
+
+TEST(deferred_history_does_not_extend_history)
+{
+	cfg_resize_histories(1);
+
+	state_load_lazily();
+	state_load_deferred();
+
+	assert_int_equal(1, curr_stats.cmd_hist.size);
+	assert_string_equal("cmd2", curr_stats.cmd_hist.items[0].text);
+}
+
+TEST(loading_state_drops_deferred_part)
+{
+	state_load_lazily();
+	state_load(0);
+	hist_add(&curr_stats.cmd_hist, "cmd1", -1);
+
+	state_load_deferred();
+
+	assert_int_equal(2, curr_stats.cmd_hist.size);
+	assert_string_equal("cmd1", curr_stats.cmd_hist.items[0].text);
+	assert_string_equal("cmd2", curr_stats.cmd_hist.items[1].text);
+}
+
+TEST(malformed_state_is_loaded_eagerly)
+{
+	FILE *const f = fopen(SANDBOX_PATH "/vifminfo.json", "w");
+	fputs("{\"cmd-hist\":[{\"text\":\"cmd\"}]", f);
+	fclose(f);
+
+	state_load_lazily();
+	assert_int_equal(0, curr_stats.cmd_hist.size);
+
+	state_load_deferred();
+	assert_int_equal(0, curr_stats.cmd_hist.size);
+}
+
+TEST(large_sections_are_skipped_until_needed)
+{
+	enum { N = 3000 };
+	write_large_vifminfo(N);
+	cfg_resize_histories(N);
+
+	state_load_lazily();
+
+	assert_int_equal(0, count_bmarks());
+	assert_int_equal(0, curr_stats.cmd_hist.size);
+	assert_int_equal(0, curr_stats.search_hist.size);
+	assert_int_equal(0, curr_stats.prompt_hist.size);
+
+	state_load_deferred();
+
+	assert_int_equal(N, count_bmarks());
+	assert_int_equal(N, curr_stats.cmd_hist.size);
+	assert_int_equal(N, curr_stats.search_hist.size);
+	assert_int_equal(N, curr_stats.prompt_hist.size);
+
+	/* Deferred part is applied only once. */
+	bmarks_clear();
+	state_load_deferred();
+	assert_int_equal(0, count_bmarks());
+}
+
+/* Writes vifminfo.json with n bookmarks and n entries in several histories. */
+static void
+write_large_vifminfo(int n)
+{
+	static const char *hists[] = { "cmd-hist", "search-hist", "prompt-hist" };
+
+	FILE *const f = fopen(SANDBOX_PATH "/vifminfo.json", "w");
+	fputs("{\"bmarks\":{", f);
+
+	int i, j;
+	for(i = 0; i < n; ++i)
+	{
+		fprintf(f, "%s\"\\/bookmarked\\/path%d\":{\"tags\":\"t%d\",\"ts\":%d}",
+				i == 0 ? "" : ",", i, i%10, i);
+	}
+	fputs("}", f);
+
+	for(j = 0; j < (int)(sizeof(hists)/sizeof(hists[0])); ++j)
+	{
+		fprintf(f, ",\"%s\":[", hists[j]);
+		for(i = 0; i < n; ++i)
+		{
+			fprintf(f, "%s{\"text\":\"entry number %d\",\"ts\":%d}",
+					i == 0 ? "" : ",", i, i);
+		}
+		fputs("]", f);
+	}
+
+	fputs("}", f);
+	fclose(f);
+}
+
+/* Counts number of bookmarks.  Returns the number. */
+static int
+count_bmarks(void)
+{
+	int count = 0;
+	bmarks_list(&count_bmark, &count);
+	return count;
+}
+
+/* bmarks_list() callback that counts bookmarks. */
+static void
+count_bmark(const char path[], const char tags[], time_t timestamp, void *arg)
+{
+	int *count = arg;
+	++*count;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
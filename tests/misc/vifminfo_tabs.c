@@ -33,6 +33,8 @@ TEARDOWN_ONCE()
 {
 	columns_teardown();
 
+	cfg.config_dir[0] = '\0';
+
 	curr_view = NULL;
 	other_view = NULL;
 
@@ -84,6 +84,7 @@ void
 conf_setup(void)
 {
 	update_string(&cfg.slow_fs_list, "");
+	update_string(&cfg.no_cache_fs_list, "");
 	update_string(&cfg.apropos_prg, "");
 	update_string(&cfg.cd_path, "");
 	update_string(&cfg.find_prg, "");
@@ -128,6 +129,7 @@ void
 conf_teardown(void)
 {
 	update_string(&cfg.slow_fs_list, NULL);
+	update_string(&cfg.no_cache_fs_list, NULL);
 	update_string(&cfg.apropos_prg, NULL);
 	update_string(&cfg.cd_path, NULL);
 	update_string(&cfg.find_prg, NULL);
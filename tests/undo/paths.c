@@ -0,0 +1,136 @@
+#include <stic.h>
+
+#include <stdio.h> /* snprintf() */
+#include <string.h> /* memset() strcmp() */
+
+#include "../../src/compat/fs_limits.h"
+#include "../../src/undo.h"
+
+#include "test.h"
+
+static OpsResult exec_func(OPS op, void *data, const char src[],
+		const char dst[]);
+static OpsResult check_order_func(OPS op, void *data, const char src[],
+		const char dst[]);
+
+static char last_src[PATH_MAX + 1];
+static char last_dst[PATH_MAX + 1];
+static int next_index;
+static int order_errors;
+
+TEARDOWN()
+{
+	un_reset();
+}
+
+TEST(paths_are_passed_back_unchanged)
+{
+	static int undo_levels = 10;
+	init_undo_list_for_tests(&exec_func, &undo_levels);
+
+	const char *const paths[][2] = {
+		{ "/dir/sub/file", "/dir/sub/other" },
+		{ "/dir/sub/", "/dir/file" },
+		{ "name", "/name" },
+		{ "/", "relative/path" },
+	};
+
+	int i;
+	for(i = 0; i < (int)(sizeof(paths)/sizeof(paths[0])); ++i)
+	{
+		un_group_open("msg");
+		assert_success(un_group_add_op(OP_MOVE, NULL, NULL, paths[i][0],
+					paths[i][1]));
+		un_group_close();
+	}
+
+	for(i = (int)(sizeof(paths)/sizeof(paths[0])) - 1; i >= 0; --i)
+	{
+		assert_int_equal(UN_ERR_SUCCESS, un_group_undo());
+		assert_string_equal(paths[i][1], last_src);
+		assert_string_equal(paths[i][0], last_dst);
+	}
+
+	for(i = 0; i < (int)(sizeof(paths)/sizeof(paths[0])); ++i)
+	{
+		assert_int_equal(UN_ERR_SUCCESS, un_group_redo());
+		assert_string_equal(paths[i][0], last_src);
+		assert_string_equal(paths[i][1], last_dst);
+	}
+}
+
+TEST(too_long_paths_are_rejected)
+{
+	static int undo_levels = 10;
+	init_undo_list_for_tests(&exec_func, &undo_levels);
+
+	char long_path[PATH_MAX + 2];
+	memset(long_path, 'a', sizeof(long_path) - 1U);
+	long_path[sizeof(long_path) - 1U] = '\0';
+
+	un_group_open("msg");
+	assert_failure(un_group_add_op(OP_MOVE, NULL, NULL, long_path, "b"));
+	assert_failure(un_group_add_op(OP_MOVE, NULL, NULL, "a", long_path));
+	un_group_close();
+
+	assert_true(un_last_group_empty());
+}
+
+TEST(big_groups_are_undone_and_redone_in_order)
+{
+	enum { NOPS = 20000 };
+
+	static int undo_levels = NOPS;
+	init_undo_list_for_tests(&check_order_func, &undo_levels);
+
+	un_group_open("msg");
+	int i;
+	for(i = 0; i < NOPS; ++i)
+	{
+		char src[64], dst[64];
+		snprintf(src, sizeof(src), "/some/long/directory/path/%d", i);
+		snprintf(dst, sizeof(dst), "/some/other/directory/%d", i);
+		assert_success(un_group_add_op(OP_MOVE, NULL, NULL, src, dst));
+	}
+	un_group_close();
+
+	next_index = NOPS - 1;
+	order_errors = 0;
+	assert_int_equal(UN_ERR_SUCCESS, un_group_undo());
+	assert_int_equal(-1, next_index);
+	assert_int_equal(0, order_errors);
+
+	next_index = 0;
+	assert_int_equal(UN_ERR_SUCCESS, un_group_redo());
+	assert_int_equal(NOPS, next_index);
+	assert_int_equal(0, order_errors);
+}
+
+static OpsResult
+exec_func(OPS op, void *data, const char src[], const char dst[])
+{
+	snprintf(last_src, sizeof(last_src), "%s", src);
+	snprintf(last_dst, sizeof(last_dst), "%s", dst);
+	return OPS_SUCCEEDED;
+}
+
+/* Checks that operations come in expected order. */
+static OpsResult
+check_order_func(OPS op, void *data, const char src[], const char dst[])
+{
+	const int undo = (strncmp(src, "/some/other/", 12) == 0);
+
+	char expected[64];
+	snprintf(expected, sizeof(expected), "/some/long/directory/path/%d",
+			next_index);
+	if(strcmp(undo ? dst : src, expected) != 0)
+	{
+		++order_errors;
+	}
+
+	next_index += (undo ? -1 : 1);
+	return OPS_SUCCEEDED;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
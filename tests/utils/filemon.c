@@ -1,6 +1,7 @@
 #include <stic.h>
 
 #include <stdio.h> /* FILE fclose() fopen() */
+#include <stdlib.h> /* free() */
 
 #include <test-utils.h>
 
@@ -94,5 +95,33 @@ TEST(failed_read_from_file_resets_filemon)
 	assert_false(filemon_equal(&mon, &mon));
 }
 
+TEST(filemon_survives_conversion_to_string)
+{
+	filemon_t mon, restored;
+	assert_success(filemon_from_file(TEST_DATA_PATH "/existing-files/a",
+				FMT_MODIFIED, &mon));
+
+	char *const str = filemon_to_str(&mon);
+	assert_non_null(str);
+	assert_success(filemon_from_str(str, &restored));
+	free(str);
+
+	assert_true(filemon_equal(&mon, &restored));
+}
+
+TEST(malformed_string_resets_filemon)
+{
+	filemon_t mon;
+	assert_success(filemon_from_file(TEST_DATA_PATH "/existing-files/a",
+				FMT_MODIFIED, &mon));
+
+	assert_failure(filemon_from_str("", &mon));
+	assert_false(filemon_is_set(&mon));
+	assert_failure(filemon_from_str("0:1:2:3:4", &mon));
+	assert_failure(filemon_from_str("1:1:2:3", &mon));
+	assert_failure(filemon_from_str("1:1:2:3:4x", &mon));
+	assert_false(filemon_is_set(&mon));
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 : */
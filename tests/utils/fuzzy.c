@@ -0,0 +1,276 @@
+#include <stic.h>
+
+#include <stdio.h> /* snprintf() */
+
+#include <test-utils.h>
+
+#include "../../src/compat/fs_limits.h"
+#include "../../src/utils/cancellation.h"
+#include "../../src/utils/fs.h"
+#include "../../src/utils/fuzzy.h"
+
+static void make_tree(int ndirs, int nfiles);
+static int counting_hook(void *arg);
+
+static fuzzy_index_t *idx;
+
+/* Number of calls of counting_hook(). */
+static int hook_calls;
+/* Number of calls of counting_hook() after which it requests cancellation. */
+static int hook_limit;
+
+/* Cancellation that is driven by the two variables above. */
+static const cancellation_t cancellation = { .hook = &counting_hook };
+
+SETUP()
+{
+	idx = fuzzy_index_alloc(SANDBOX_PATH);
+	assert_non_null(idx);
+
+	hook_calls = 0;
+	hook_limit = 0;
+}
+
+TEARDOWN()
+{
+	fuzzy_index_free(idx);
+	remove_dir_content(SANDBOX_PATH);
+}
+
+TEST(query_is_matched_as_subsequence)
+{
+	assert_true(fuzzy_score("abc", "") >= 0);
+	assert_true(fuzzy_score("abc", "ac") >= 0);
+	assert_true(fuzzy_score("abc", "abc") >= 0);
+	assert_true(fuzzy_score("abc", "acb") < 0);
+	assert_true(fuzzy_score("abc", "abcd") < 0);
+	assert_true(fuzzy_score("", "a") < 0);
+}
+
+TEST(case_is_ignored_unless_query_has_upper_case)
+{
+	assert_true(fuzzy_score("ReadMe", "readme") >= 0);
+	assert_true(fuzzy_score("ReadMe", "RM") >= 0);
+	assert_true(fuzzy_score("readme", "ReadMe") < 0);
+}
+
+TEST(better_matches_have_higher_score)
+{
+	/* Matches in file names. */
+	assert_true(fuzzy_score("src/main.c", "main") >
+	            fuzzy_score("main/src.c", "main"));
+	/* Starts of words. */
+	assert_true(fuzzy_score("foo_bar.c", "fb") >
+	            fuzzy_score("fooxbar.c", "fb"));
+	assert_true(fuzzy_score("fooBar.c", "fb") >
+	            fuzzy_score("foobar.c", "fb"));
+	/* Runs of characters. */
+	assert_true(fuzzy_score("abc.txt", "abc") >
+	            fuzzy_score("a_b_c.txt", "abc"));
+	/* Smaller gaps. */
+	assert_true(fuzzy_score("axbc", "abc") > fuzzy_score("axxxbc", "abc"));
+}
+
+TEST(missing_root_is_an_error)
+{
+	fuzzy_index_t *const missing = fuzzy_index_alloc(SANDBOX_PATH "/missing");
+	assert_failure(fuzzy_index_update(missing, &no_cancellation));
+	fuzzy_index_free(missing);
+}
+
+TEST(index_lists_files_recursively)
+{
+	create_dir(SANDBOX_PATH "/dir");
+	create_dir(SANDBOX_PATH "/dir/sub");
+	create_file(SANDBOX_PATH "/dir/sub/file");
+	create_file(SANDBOX_PATH "/top");
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(4, fuzzy_index_size(idx));
+
+	int count;
+	const char **paths = fuzzy_index_query(idx, "file", &count);
+	assert_int_equal(1, count);
+	assert_string_equal("dir/sub/file", paths[0]);
+
+	paths = fuzzy_index_query(idx, "sub", &count);
+	assert_int_equal(2, count);
+	assert_string_equal("dir/sub/", paths[0]);
+	assert_string_equal("dir/sub/file", paths[1]);
+}
+
+TEST(results_are_ranked)
+{
+	create_dir(SANDBOX_PATH "/main");
+	create_file(SANDBOX_PATH "/main/src.c");
+	create_file(SANDBOX_PATH "/main.c");
+	create_file(SANDBOX_PATH "/my-main.c");
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+
+	int count;
+	const char **const paths = fuzzy_index_query(idx, "main", &count);
+	assert_int_equal(4, count);
+	assert_string_equal("main/", paths[0]);
+	assert_string_equal("main.c", paths[1]);
+	assert_string_equal("my-main.c", paths[2]);
+	assert_string_equal("main/src.c", paths[3]);
+}
+
+TEST(extended_query_gives_the_same_results)
+{
+	create_file(SANDBOX_PATH "/abc");
+	create_file(SANDBOX_PATH "/acb");
+	create_file(SANDBOX_PATH "/bca");
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+
+	int count;
+	(void)fuzzy_index_query(idx, "a", &count);
+	assert_int_equal(3, count);
+	(void)fuzzy_index_query(idx, "ab", &count);
+	assert_int_equal(2, count);
+	const char **const paths = fuzzy_index_query(idx, "abc", &count);
+	assert_int_equal(1, count);
+	assert_string_equal("abc", paths[0]);
+
+	/* Shortening brings back other matches. */
+	(void)fuzzy_index_query(idx, "b", &count);
+	assert_int_equal(3, count);
+}
+
+TEST(changes_of_file_system_are_picked_up)
+{
+	create_dir(SANDBOX_PATH "/dir");
+	create_dir(SANDBOX_PATH "/dir/sub");
+	create_file(SANDBOX_PATH "/dir/sub/file");
+	create_dir(SANDBOX_PATH "/other");
+	create_file(SANDBOX_PATH "/other/file");
+	reset_timestamp(SANDBOX_PATH "/dir");
+	reset_timestamp(SANDBOX_PATH "/dir/sub");
+	reset_timestamp(SANDBOX_PATH "/other");
+	reset_timestamp(SANDBOX_PATH);
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(5, fuzzy_index_size(idx));
+
+	create_file(SANDBOX_PATH "/dir/sub/new");
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(6, fuzzy_index_size(idx));
+
+	int count;
+	const char **const paths = fuzzy_index_query(idx, "new", &count);
+	assert_int_equal(1, count);
+	assert_string_equal("dir/sub/new", paths[0]);
+
+	remove_file(SANDBOX_PATH "/dir/sub/new");
+	remove_file(SANDBOX_PATH "/dir/sub/file");
+	remove_dir(SANDBOX_PATH "/dir/sub");
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(3, fuzzy_index_size(idx));
+
+	(void)fuzzy_index_query(idx, "file", &count);
+	assert_int_equal(1, count);
+}
+
+TEST(update_can_be_cancelled)
+{
+	make_tree(3, 1);
+
+	assert_failure(fuzzy_index_update(idx, &cancellation));
+	assert_int_equal(1, hook_calls);
+	assert_int_equal(0, fuzzy_index_size(idx));
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(6, fuzzy_index_size(idx));
+}
+
+TEST(cancelled_update_keeps_previous_state)
+{
+	make_tree(3, 1);
+	reset_timestamp(SANDBOX_PATH);
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(6, fuzzy_index_size(idx));
+
+	create_file(SANDBOX_PATH "/dir2/new");
+
+	hook_limit = 3;
+	assert_failure(fuzzy_index_update(idx, &cancellation));
+	assert_int_equal(6, fuzzy_index_size(idx));
+
+	int count;
+	(void)fuzzy_index_query(idx, "new", &count);
+	assert_int_equal(0, count);
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(7, fuzzy_index_size(idx));
+}
+
+TEST(every_directory_is_checked_once_per_update)
+{
+	make_tree(3, 1);
+
+	hook_limit = -1;
+	assert_success(fuzzy_index_update(idx, &cancellation));
+	assert_int_equal(4, hook_calls);
+
+	hook_calls = 0;
+	assert_success(fuzzy_index_update(idx, &cancellation));
+	assert_int_equal(4, hook_calls);
+}
+
+TEST(update_rereads_only_changed_directories)
+{
+	make_tree(3, 2);
+	reset_timestamp(SANDBOX_PATH);
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(9, fuzzy_index_size(idx));
+
+	/* Changes to directories that look unmodified aren't noticed. */
+	remove_file(SANDBOX_PATH "/dir0/file0");
+	reset_timestamp(SANDBOX_PATH "/dir0");
+	remove_file(SANDBOX_PATH "/dir1/file0");
+
+	assert_success(fuzzy_index_update(idx, &no_cancellation));
+	assert_int_equal(8, fuzzy_index_size(idx));
+
+	int count;
+	const char **const paths = fuzzy_index_query(idx, "file0", &count);
+	assert_int_equal(2, count);
+	assert_string_equal("dir0/file0", paths[0]);
+	assert_string_equal("dir2/file0", paths[1]);
+}
+
+/* Creates ndirs directories in sandbox with nfiles files in each. */
+static void
+make_tree(int ndirs, int nfiles)
+{
+	int i, j;
+	for(i = 0; i < ndirs; ++i)
+	{
+		char path[PATH_MAX + 1];
+		snprintf(path, sizeof(path), "%s/dir%d", SANDBOX_PATH, i);
+		create_dir(path);
+
+		for(j = 0; j < nfiles; ++j)
+		{
+			snprintf(path, sizeof(path), "%s/dir%d/file%d", SANDBOX_PATH, i, j);
+			create_file(path);
+		}
+
+		snprintf(path, sizeof(path), "%s/dir%d", SANDBOX_PATH, i);
+		reset_timestamp(path);
+	}
+}
+
+static int
+counting_hook(void *arg)
+{
+	++hook_calls;
+	return (hook_limit >= 0 && hook_calls > hook_limit);
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
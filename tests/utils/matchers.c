@@ -206,6 +206,27 @@ TEST(mime_patterns)
 	free_string_array(list, count);
 }
 
+TEST(use_of_mime_types_is_detected)
+{
+	char *error = NULL;
+	matchers_t *m;
+
+	m = matchers_alloc("{*.c}/x/", 0, 1, "", &error);
+	assert_non_null(m);
+	assert_false(matchers_use_mime(m));
+	matchers_free(m);
+
+	m = matchers_alloc("{*.c}<text/plain>", 0, 1, "", &error);
+	assert_non_null(m);
+	assert_true(matchers_use_mime(m));
+	matchers_free(m);
+
+	m = matchers_alloc("!<text/*>", 0, 1, "", &error);
+	assert_non_null(m);
+	assert_true(matchers_use_mime(m));
+	matchers_free(m);
+}
+
 TEST(matchers_are_cloned)
 {
 	char *error = NULL;
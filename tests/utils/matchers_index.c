@@ -0,0 +1,173 @@
+#include <stic.h>
+
+#include <stdio.h> /* snprintf() */
+#include <stdlib.h> /* free() */
+
+#include "../../src/utils/matchers.h"
+
+static void add(const char expr[]);
+
+static matchers_t *list[8];
+static int count;
+static matchers_index_t *idx;
+
+SETUP()
+{
+	idx = matchers_index_alloc();
+	assert_non_null(idx);
+	count = 0;
+}
+
+TEARDOWN()
+{
+	matchers_index_free(idx);
+	while(count > 0)
+	{
+		matchers_free(list[--count]);
+	}
+}
+
+TEST(freeing_null_index_does_nothing)
+{
+	matchers_index_free(NULL);
+}
+
+TEST(empty_index_matches_nothing)
+{
+	assert_int_equal(-1, matchers_index_find(idx, "file", 0));
+}
+
+TEST(first_match_is_found)
+{
+	add("{*.c,*.h}");
+	add("/^a/");
+	add("{Makefile}");
+	add("{*.c}");
+
+	assert_int_equal(0, matchers_index_find(idx, "b.c", 0));
+	assert_int_equal(1, matchers_index_find(idx, "a.c", 1));
+	assert_int_equal(3, matchers_index_find(idx, "b.c", 1));
+	assert_int_equal(2, matchers_index_find(idx, "makefile", 0));
+	assert_int_equal(1, matchers_index_find(idx, "ab", 0));
+	assert_int_equal(-1, matchers_index_find(idx, "b", 0));
+	assert_int_equal(-1, matchers_index_find(idx, "b.c", 4));
+}
+
+TEST(case_of_keys_is_ignored)
+{
+	add("{*.TaR.gZ}");
+	add("{README}");
+
+	assert_int_equal(0, matchers_index_find(idx, "a.tar.gz", 0));
+	assert_int_equal(0, matchers_index_find(idx, "A.TAR.GZ", 0));
+	assert_int_equal(-1, matchers_index_find(idx, "a.gz", 0));
+	assert_int_equal(1, matchers_index_find(idx, "readme", 0));
+}
+
+TEST(names_are_extracted_from_paths)
+{
+	add("{*.c}");
+	add("{{/dir/*.c}}");
+	add("{dir/}");
+
+	assert_int_equal(0, matchers_index_find(idx, "/dir/a.c", 0));
+	assert_int_equal(1, matchers_index_find(idx, "/dir/a.c", 1));
+	assert_int_equal(2, matchers_index_find(idx, "/path/dir/", 0));
+}
+
+TEST(unindexable_matchers_are_checked)
+{
+	add("!{*.c}");
+	add("{*~,a*}");
+	add("{*.c}<text/plain>");
+	add("{.*.c}");
+
+	assert_int_equal(1, matchers_index_find(idx, "a.c", 0));
+	assert_int_equal(0, matchers_index_find(idx, "b~", 0));
+	assert_int_equal(3, matchers_index_find(idx, ".a.c", 1));
+}
+
+TEST(matchers_of_a_list_must_all_match)
+{
+	add("{*.c}{a*}");
+
+	assert_int_equal(0, matchers_index_find(idx, "a.c", 0));
+	assert_int_equal(-1, matchers_index_find(idx, "b.c", 0));
+}
+
+TEST(index_agrees_with_trying_matchers_in_turn)
+{
+	enum { NMATCHERS = 300, NNAMES = 2000 };
+
+	matchers_t *many[NMATCHERS];
+	matchers_index_t *big_index = matchers_index_alloc();
+
+	int i, j;
+	for(i = 0; i < NMATCHERS; ++i)
+	{
+		/* Every third list can't be indexed and has to be tried in turn. */
+		char expr[64];
+		if(i%3 == 0)
+		{
+			snprintf(expr, sizeof(expr), "{*.ext%d,name%d*}", i, i%7);
+		}
+		else
+		{
+			snprintf(expr, sizeof(expr), "{*.ext%d}", i);
+		}
+
+		char *error;
+		many[i] = matchers_alloc(expr, 0, 1, "", &error);
+		assert_non_null(many[i]);
+		assert_success(matchers_index_add(big_index, many[i]));
+	}
+
+	int nfound = 0;
+	for(i = 0; i < NNAMES; ++i)
+	{
+		char name[64];
+		if(i%5 == 0)
+		{
+			snprintf(name, sizeof(name), "name%d", i%7);
+		}
+		else
+		{
+			snprintf(name, sizeof(name), "file%d.ext%d", i, i%(NMATCHERS*2));
+		}
+
+		for(j = 0; j < NMATCHERS; ++j)
+		{
+			if(matchers_match(many[j], name))
+			{
+				break;
+			}
+		}
+
+		const int expected = (j == NMATCHERS ? -1 : j);
+		assert_int_equal(expected, matchers_index_find(big_index, name, 0));
+		nfound += (expected >= 0);
+	}
+
+	matchers_index_free(big_index);
+	for(i = 0; i < NMATCHERS; ++i)
+	{
+		matchers_free(many[i]);
+	}
+
+	assert_true(nfound > 0);
+	assert_true(nfound < NNAMES);
+}
+
+/* Allocates matchers and adds them to the index. */
+static void
+add(const char expr[])
+{
+	char *error;
+	list[count] = matchers_alloc(expr, 0, 1, "", &error);
+	assert_non_null(list[count]);
+	assert_success(matchers_index_add(idx, list[count]));
+	++count;
+}
+
+/* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
+/* vim: set cinoptions+=t0 filetype=c : */
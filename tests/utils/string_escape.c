@@ -56,5 +56,15 @@ TEST(escape_unreadable_handles_composite_characters)
 	free(escaped);
 }
 
+TEST(has_unreadable_agrees_with_escape_unreadable)
+{
+	assert_true(has_unreadable("prefix\x01suffix"));
+	assert_true(has_unreadable("unicode\xe2\x80\x8etest"));
+	assert_true(has_unreadable("L\224sungswege"));
+	assert_false(has_unreadable(""));
+	assert_false(has_unreadable("plain name.txt"));
+	assert_false(has_unreadable("prefix\x6f\xcc\x88\x61\xcc\x88suffix"));
+}
+
 /* vim: set tabstop=2 softtabstop=2 shiftwidth=2 noexpandtab cinoptions-=(0 : */
 /* vim: set cinoptions+=t0 filetype=c : */